@@ -3,10 +3,18 @@
 from __future__ import annotations
 
 from .color import Color
+from .mutable_palette import MutablePalette
 from .palette import Palette
 from .qualpal import Qualpal
 from .utils import get_palette, list_palettes
 
-__all__ = ["Color", "Palette", "Qualpal", "get_palette", "list_palettes"]
+__all__ = [
+    "Color",
+    "MutablePalette",
+    "Palette",
+    "Qualpal",
+    "get_palette",
+    "list_palettes",
+]
 
 __version__ = "1.1.0"
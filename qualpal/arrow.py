@@ -0,0 +1,111 @@
+"""Exchange of color columns through the Arrow C data interface.
+
+Columns are exchanged through the Arrow PyCapsule interface, so any Arrow
+implementation (pyarrow, polars, DuckDB, nanoarrow, ...) can be used without
+qualpal depending on one. Color columns may hold hex strings (utf8, large
+utf8, or dictionary-encoded strings) or RGB bytes
+(``fixed_size_list<uint8, 3>``); they are decoded natively, without creating
+a Python object per color.
+"""
+
+from __future__ import annotations
+
+from typing import Any
+
+import _qualpal
+
+
+def is_arrow_column(obj: object) -> bool:
+    """Check whether an object exports Arrow data through PyCapsules.
+
+    Parameters
+    ----------
+    obj : object
+        Any object
+
+    Returns
+    -------
+    bool
+        True if ``obj`` implements ``__arrow_c_array__`` or
+        ``__arrow_c_stream__``
+    """
+    return hasattr(obj, "__arrow_c_array__") or hasattr(obj, "__arrow_c_stream__")
+
+
+def colors_from_arrow(column: Any) -> memoryview:
+    """Read an Arrow color column as 8-bit RGB values.
+
+    Parameters
+    ----------
+    column : Arrow array or chunked array
+        Object implementing ``__arrow_c_array__`` (e.g. ``pyarrow.Array``)
+        or ``__arrow_c_stream__`` (e.g. ``pyarrow.ChunkedArray`` or a
+        polars Series), holding hex strings or ``fixed_size_list<uint8, 3>``
+        values without nulls
+
+    Returns
+    -------
+    memoryview
+        uint8 buffer of shape (n, 3), accepted by the functions in
+        :mod:`qualpal.contrast` and :mod:`qualpal.scoring`
+
+    Raises
+    ------
+    TypeError
+        If ``column`` is not an Arrow column
+    ValueError
+        If the column type is unsupported, it contains nulls, or a string
+        is not a hex color
+
+    Examples
+    --------
+    >>> import pyarrow as pa  # doctest: +SKIP
+    >>> from qualpal.arrow import colors_from_arrow
+    >>> colors_from_arrow(pa.array(['#ff0000', '#00ff00'])).tolist()  # doctest: +SKIP
+    [[255, 0, 0], [0, 255, 0]]
+    """
+    if hasattr(column, "__arrow_c_array__"):
+        schema, array = column.__arrow_c_array__()
+        return memoryview(_qualpal.arrow_colors(schema, array))
+    if hasattr(column, "__arrow_c_stream__"):
+        stream = column.__arrow_c_stream__()
+        return memoryview(_qualpal.arrow_color_stream(stream))
+    msg = f"Expected an Arrow array or stream, got {type(column).__name__}"
+    raise TypeError(msg)
+
+
+def to_arrow(values: Any) -> _qualpal.ArrowColumn:
+    """Export a buffer of results as an Arrow column.
+
+    Parameters
+    ----------
+    values : buffer
+        One-dimensional float64, int64 or uint8 buffer, exported as a
+        primitive column, or two-dimensional buffer of shape (n, w),
+        exported as ``fixed_size_list<T, w>``. This covers the distance,
+        score and index buffers returned by qualpal. The values are copied
+        once into native storage.
+
+    Returns
+    -------
+    ArrowColumn
+        Object implementing ``__arrow_c_array__`` and
+        ``__arrow_c_schema__``, which e.g. ``pyarrow.array()`` accepts
+        without copying
+
+    Raises
+    ------
+    ValueError
+        If the element type or number of dimensions is unsupported
+
+    Examples
+    --------
+    >>> from qualpal import Palette
+    >>> from qualpal.arrow import to_arrow
+    >>> pal = Palette(['#ff0000', '#fe0000', '#00ff00'])
+    >>> indptr, indices, distances = pal.knn_graph(1)
+    >>> column = to_arrow(distances)
+    >>> len(column), column.format
+    (3, 'g')
+    """
+    return _qualpal.arrow_column(values)
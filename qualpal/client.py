@@ -0,0 +1,221 @@
+"""Client for the qualpal-server palette daemon.
+
+The server is a native executable, built with ``-DQUALPAL_BUILD_SERVER=ON``,
+that listens on a Unix domain socket and keeps its caches of candidate
+sets, named palettes and job results warm across all of its clients. Each
+message is a 4-byte big-endian length followed by that many bytes of JSON.
+
+This module does not import the extension module, so processes that only
+talk to the server stay light.
+"""
+
+from __future__ import annotations
+
+import json
+import os
+import socket
+import struct
+from pathlib import Path
+from typing import TYPE_CHECKING, Any
+
+if TYPE_CHECKING:
+    from collections.abc import Sequence
+
+_LENGTH = struct.Struct(">I")
+
+
+def default_socket_path() -> str:
+    """Socket path that qualpal-server listens on by default.
+
+    Returns
+    -------
+    str
+        ``$XDG_RUNTIME_DIR/qualpal.sock``, or ``/tmp/qualpal-UID.sock`` if
+        ``XDG_RUNTIME_DIR`` is not set
+    """
+    runtime = os.environ.get("XDG_RUNTIME_DIR")
+    if runtime:
+        return str(Path(runtime) / "qualpal.sock")
+    return f"/tmp/qualpal-{os.getuid()}.sock"
+
+
+class JobError(RuntimeError):
+    """A job sent to qualpal-server failed."""
+
+
+class PaletteClient:
+    """Connection to a qualpal-server process.
+
+    Jobs are dictionaries with a ``type`` ('generate', 'generate_grouped',
+    'analyze', 'distance' or 'get_palette') and the parameters of that
+    type, named as in :class:`qualpal.Qualpal` and :class:`qualpal.Palette`.
+    Requests on one connection are answered in order; use one client per
+    thread.
+
+    Parameters
+    ----------
+    path : str | os.PathLike | None, optional
+        Socket path, by default :func:`default_socket_path`
+    timeout : float | None, optional
+        Timeout in seconds for connecting and for each response
+
+    Examples
+    --------
+    >>> from qualpal.client import PaletteClient
+    >>> with PaletteClient() as client:  # doctest: +SKIP
+    ...     client.generate(4, h_range=[0, 360], c_range=[0.5, 1],
+    ...                     l_range=[0.3, 0.7])
+    ['#...', '#...', '#...', '#...']
+    """
+
+    def __init__(
+        self,
+        path: str | os.PathLike[str] | None = None,
+        timeout: float | None = None,
+    ) -> None:
+        self._socket = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self._socket.settimeout(timeout)
+        try:
+            self._socket.connect(
+                os.fspath(path) if path is not None else default_socket_path()
+            )
+        except OSError:
+            self._socket.close()
+            raise
+
+    def close(self) -> None:
+        """Close the connection."""
+        self._socket.close()
+
+    def __enter__(self) -> PaletteClient:
+        """Return the client."""
+        return self
+
+    def __exit__(self, *args: object) -> None:
+        """Close the connection."""
+        self.close()
+
+    def request(self, message: Any) -> Any:
+        """Send one request and return the decoded response.
+
+        Parameters
+        ----------
+        message : Any
+            A job, a list of jobs, or ``{"type": "stats"}``
+
+        Returns
+        -------
+        Any
+            The server's response, see :meth:`run` and :meth:`run_many`
+
+        Raises
+        ------
+        ConnectionError
+            If the server closes the connection
+        """
+        payload = json.dumps(message, separators=(",", ":")).encode()
+        self._socket.sendall(_LENGTH.pack(len(payload)) + payload)
+        (size,) = _LENGTH.unpack(self._receive(_LENGTH.size))
+        return json.loads(self._receive(size))
+
+    def run(self, job: dict[str, Any]) -> dict[str, Any]:
+        """Run one job and return its result.
+
+        Parameters
+        ----------
+        job : dict[str, Any]
+            Job description
+
+        Returns
+        -------
+        dict[str, Any]
+            Result of the job, e.g. ``{"palette": [...]}`` for 'generate'
+
+        Raises
+        ------
+        JobError
+            If the job failed
+        """
+        return _result(self.request(job))
+
+    def run_many(self, jobs: Sequence[dict[str, Any]]) -> list[dict[str, Any]]:
+        """Run jobs together on the server's thread pool.
+
+        Parameters
+        ----------
+        jobs : Sequence[dict[str, Any]]
+            Job descriptions
+
+        Returns
+        -------
+        list[dict[str, Any]]
+            Output of each job, in order: ``{"id": ..., "result": ...}`` or
+            ``{"id": ..., "error": message}``, so that one failed job does
+            not hide the results of the others
+        """
+        return self.request(list(jobs))
+
+    def generate(self, n: int, **kwargs: Any) -> list[str]:
+        """Generate a palette on the server.
+
+        Parameters
+        ----------
+        n : int
+            Number of colors
+        **kwargs : Any
+            Generation parameters, e.g. ``h_range``, ``colors``, ``palette``,
+            ``cvd``, ``background`` or ``metric``
+
+        Returns
+        -------
+        list[str]
+            Hex colors of the palette
+        """
+        return self.run({"type": "generate", "n": n, **kwargs})["palette"]
+
+    def distance_matrix(
+        self, colors: Sequence[str], metric: str = "ciede2000"
+    ) -> list[list[float]]:
+        """Compute a distance matrix on the server.
+
+        Parameters
+        ----------
+        colors : Sequence[str]
+            Hex colors
+        metric : str, default="ciede2000"
+            Distance metric
+
+        Returns
+        -------
+        list[list[float]]
+            Pairwise distances
+        """
+        job = {"type": "distance", "colors": list(colors), "metric": metric}
+        return self.run(job)["matrix"]
+
+    def stats(self) -> dict[str, int]:
+        """Return the sizes and hit counts of the server's caches.
+
+        Returns
+        -------
+        dict[str, int]
+            Number of entries, hits and misses of the result, candidate set
+            and named palette caches
+        """
+        return self.request({"type": "stats"})
+
+    def _receive(self, size: int) -> bytes:
+        data = bytearray()
+        while len(data) < size:
+            chunk = self._socket.recv(size - len(data))
+            if not chunk:
+                msg = "qualpal-server closed the connection"
+                raise ConnectionError(msg)
+            data.extend(chunk)
+        return bytes(data)
+
+
+def _result(output: dict[str, Any]) -> dict[str, Any]:
+    if "error" in output:
+        raise JobError(output["error"])
+    return output["result"]
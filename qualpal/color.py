@@ -177,6 +177,31 @@ class Color:
         l, c, h = _qualpal.rgb_to_lch(self._r, self._g, self._b)
         return (l, c, h)
 
+    def oklab(self) -> tuple[float, float, float]:
+        """Get OKLab tuple.
+
+        Returns
+        -------
+        tuple[float, float, float]
+            OKLab values as (l, a, b) where l is in range [0, 1]
+        """
+        l, a, b = _qualpal.rgb_to_oklab(self._r, self._g, self._b)
+        return (l, a, b)
+
+    def cam16ucs(self) -> tuple[float, float, float]:
+        """Get CAM16-UCS tuple.
+
+        Uses a D65 adopting white, an adapting luminance of 64/(5π) cd/m²,
+        a background luminance factor of 20 and an average surround.
+
+        Returns
+        -------
+        tuple[float, float, float]
+            CAM16-UCS values as (j, a, b) where j is in range [0, 100]
+        """
+        j, a, b = _qualpal.rgb_to_cam16ucs(self._r, self._g, self._b)
+        return (j, a, b)
+
     def distance(self, other: Color | str, metric: str = "ciede2000") -> float:
         """Calculate perceptual color difference to another color.
 
@@ -189,6 +214,10 @@ class Color:
             - 'ciede2000' (default): CIEDE2000 metric
             - 'din99d': DIN99d metric
             - 'cie76': CIE76 (Euclidean distance in Lab space)
+            - 'oklab': Euclidean distance in OKLab, scaled by 100
+            - 'cam16ucs': Euclidean distance in CAM16-UCS
+            - 'cie94': CIE94 (graphic arts), symmetrized
+            - 'cmc': CMC l:c with l=2, c=1, symmetrized
 
         Returns
         -------
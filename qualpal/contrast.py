@@ -0,0 +1,129 @@
+"""WCAG relative luminance and contrast ratios."""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING, Union
+
+import _qualpal
+
+from qualpal.arrow import colors_from_arrow, is_arrow_column
+from qualpal.palette import Palette
+
+if TYPE_CHECKING:
+    from collections.abc import Sequence
+
+    from qualpal.color import Color
+
+    Colors = Union[Palette, Sequence[Union[Color, str]], bytes, memoryview]
+
+
+def _rgb_buffer(colors: Colors) -> object:
+    """Return colors as a buffer of 8-bit RGB values, three per color.
+
+    Objects that already support the buffer protocol (e.g. ``bytes`` or a
+    uint8 NumPy array of shape (n, 3)) are passed through unchanged, and
+    Arrow color columns are decoded natively.
+    """
+    if is_arrow_column(colors):
+        return colors_from_arrow(colors)
+    try:
+        memoryview(colors)
+    except TypeError:
+        pass
+    else:
+        return colors
+    if not isinstance(colors, Palette):
+        colors = Palette(colors)
+    return bytes.fromhex("".join(h[1:] for h in colors.hex()))
+
+
+def relative_luminance(colors: Colors) -> memoryview:
+    """Calculate the WCAG relative luminance of each color.
+
+    Parameters
+    ----------
+    colors : Palette | Sequence[Color | str] | buffer
+        Colors as a Palette, a sequence of Colors or hex strings, a uint8
+        buffer of shape (n, 3), or an Arrow color column
+
+    Returns
+    -------
+    memoryview
+        float64 buffer with the luminance of each color, in range [0, 1]
+
+    Examples
+    --------
+    >>> from qualpal.contrast import relative_luminance
+    >>> relative_luminance(['#000000', '#ffffff']).tolist()
+    [0.0, 1.0]
+    """
+    return memoryview(_qualpal.relative_luminance(_rgb_buffer(colors)))
+
+
+def contrast_matrix(foreground: Colors, background: Colors) -> memoryview:
+    """Calculate the WCAG contrast ratio of every foreground/background pair.
+
+    Parameters
+    ----------
+    foreground : Palette | Sequence[Color | str] | buffer
+        The m foreground colors
+    background : Palette | Sequence[Color | str] | buffer
+        The n background colors
+
+    Returns
+    -------
+    memoryview
+        float64 buffer of shape (m, n) with contrast ratios in range [1, 21]
+
+    Examples
+    --------
+    >>> from qualpal.contrast import contrast_matrix
+    >>> ratios = contrast_matrix(['#000000', '#777777'], ['#ffffff'])
+    >>> round(ratios[0, 0], 2)
+    21.0
+    """
+    return memoryview(
+        _qualpal.contrast_matrix(_rgb_buffer(foreground), _rgb_buffer(background))
+    )
+
+
+def best_contrast(
+    colors: Colors,
+    candidates: Colors = ("#000000", "#ffffff"),
+) -> tuple[list[int], memoryview]:
+    """Find the candidate with the highest contrast for each color.
+
+    Typically used to pick a text color for each palette entry.
+
+    Parameters
+    ----------
+    colors : Palette | Sequence[Color | str] | buffer
+        Colors to find a contrasting candidate for
+    candidates : Palette | Sequence[Color | str] | buffer
+        Candidate colors (default: black and white)
+
+    Returns
+    -------
+    tuple[list[int], memoryview]
+        Index of the best candidate for each color (the first one among
+        ties) and the corresponding contrast ratios as a float64 buffer
+
+    Raises
+    ------
+    ValueError
+        If there are no candidates
+
+    Examples
+    --------
+    >>> from qualpal.contrast import best_contrast
+    >>> best, ratios = best_contrast(['#ffff00', '#000080'])
+    >>> best
+    [0, 1]
+    """
+    candidate_buffer = _rgb_buffer(candidates)
+    if memoryview(candidate_buffer).nbytes == 0:
+        msg = "Need at least 1 candidate color"
+        raise ValueError(msg)
+
+    best, ratios = _qualpal.best_contrast(_rgb_buffer(colors), candidate_buffer)
+    return best, memoryview(ratios)
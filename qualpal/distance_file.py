@@ -0,0 +1,146 @@
+"""Distance matrices stored on disk.
+
+Files are written by :meth:`qualpal.Palette.write_distance_matrix`: a
+64-byte header followed by the matrix in native byte order, full (n x n,
+row-major) or condensed (the n (n - 1) / 2 upper-triangle entries, ordered
+as by ``scipy.spatial.distance.pdist``).
+"""
+
+from __future__ import annotations
+
+import os
+import struct
+from pathlib import Path
+from typing import Any
+
+_MAGIC = b"QPALDIST"
+_HEADER = struct.Struct("8sIIIIQQ16s8x")
+_LAYOUTS = {0: "full", 1: "condensed"}
+_DTYPES = {4: "f4", 8: "f8"}
+
+
+def read_distance_header(path: str | os.PathLike[str]) -> dict[str, Any]:
+    """Read the header of a distance matrix file.
+
+    Parameters
+    ----------
+    path : str | os.PathLike
+        File written by :meth:`qualpal.Palette.write_distance_matrix`
+
+    Returns
+    -------
+    dict[str, Any]
+        ``n`` (number of colors), ``layout`` ('full' or 'condensed'),
+        ``dtype`` (NumPy type string with byte order, e.g. '<f8'),
+        ``metric``, ``offset`` (byte offset of the data) and ``shape``
+
+    Raises
+    ------
+    ValueError
+        If the file is not a distance matrix file or is truncated
+
+    Examples
+    --------
+    >>> import tempfile
+    >>> from pathlib import Path
+    >>> from qualpal import Palette
+    >>> from qualpal.distance_file import read_distance_header
+    >>> tmp = tempfile.TemporaryDirectory()
+    >>> path = Path(tmp.name) / 'dist.qpd'
+    >>> Palette(['#ff0000', '#00ff00']).write_distance_matrix(path)
+    >>> read_distance_header(path)['shape']
+    (2, 2)
+    >>> tmp.cleanup()
+    """
+    with Path(path).open("rb") as f:
+        raw = f.read(_HEADER.size)
+        size = f.seek(0, os.SEEK_END)
+
+    if len(raw) < _HEADER.size or raw[:8] != _MAGIC:
+        msg = f"'{os.fspath(path)}' is not a qualpal distance matrix file"
+        raise ValueError(msg)
+
+    order = "<" if struct.unpack("<I", raw[12:16])[0] == 0x01020304 else ">"
+    header = struct.Struct(order + _HEADER.format)
+    _, version, _, layout, itemsize, n, offset, metric = header.unpack(raw)
+    if version != 1 or layout not in _LAYOUTS or itemsize not in _DTYPES:
+        msg = f"Unsupported distance matrix file (version {version})"
+        raise ValueError(msg)
+
+    layout_name = _LAYOUTS[layout]
+    shape = (n, n) if layout_name == "full" else (n * (n - 1) // 2,)
+    count = shape[0] * shape[1] if layout_name == "full" else shape[0]
+    if size < offset + count * itemsize:
+        msg = f"'{os.fspath(path)}' is truncated"
+        raise ValueError(msg)
+
+    return {
+        "n": n,
+        "layout": layout_name,
+        "dtype": order + _DTYPES[itemsize],
+        "metric": metric.rstrip(b"\0").decode("ascii"),
+        "offset": offset,
+        "shape": shape,
+    }
+
+
+def open_distance_matrix(path: str | os.PathLike[str], mode: str = "r") -> Any:
+    """Memory-map a distance matrix file as a NumPy array.
+
+    No data is read or copied up front; pages are loaded on access.
+
+    Parameters
+    ----------
+    path : str | os.PathLike
+        File written by :meth:`qualpal.Palette.write_distance_matrix`
+    mode : str
+        Memory-map mode: 'r' (default, read-only), 'r+' or 'c'
+        (copy-on-write), as for ``numpy.memmap``
+
+    Returns
+    -------
+    numpy.memmap
+        Array of shape (n, n) for the full layout, or (n (n - 1) / 2,) for
+        the condensed layout
+
+    Raises
+    ------
+    ImportError
+        If NumPy is not installed
+    ValueError
+        If the file is not a valid distance matrix file
+
+    Examples
+    --------
+    >>> import tempfile
+    >>> from pathlib import Path
+    >>> from qualpal import Palette
+    >>> from qualpal.distance_file import open_distance_matrix
+    >>> tmp = tempfile.TemporaryDirectory()
+    >>> path = Path(tmp.name) / 'dist.qpd'
+    >>> Palette(['#ff0000', '#00ff00']).write_distance_matrix(path)
+    >>> matrix = open_distance_matrix(path)  # doctest: +SKIP
+    >>> matrix[0, 1] == matrix[1, 0]  # doctest: +SKIP
+    True
+    >>> del matrix  # doctest: +SKIP
+    >>> tmp.cleanup()
+    """
+    try:
+        import numpy as np  # noqa: PLC0415
+    except ImportError as e:
+        msg = (
+            "numpy is required to open distance matrix files. "
+            "Install it with: pip install numpy"
+        )
+        raise ImportError(msg) from e
+
+    header = read_distance_header(path)
+    if 0 in header["shape"]:
+        return np.zeros(header["shape"], dtype=header["dtype"])
+    return np.memmap(
+        path,
+        dtype=np.dtype(header["dtype"]),
+        mode=mode,
+        offset=header["offset"],
+        shape=header["shape"],
+    )
@@ -0,0 +1,69 @@
+"""Mapping of colors into the sRGB gamut."""
+
+from __future__ import annotations
+
+import _qualpal
+
+
+def gamut_map(
+    values: object,
+    space: str = "lch",
+    output: str | None = None,
+) -> memoryview:
+    """Map colors into the sRGB gamut by reducing their chroma.
+
+    Colors built in CIE LCh, Lab, OKLCh or OKLab, such as points along a
+    gradient or the shades of a theme, often fall outside sRGB, and clipping
+    their RGB components shifts their hue and lightness. Instead, each color
+    keeps its lightness and hue, and its chroma is reduced to the largest
+    value that is displayable. Colors already in the gamut are returned
+    unchanged.
+
+    The gamut boundary of each space is tabulated over lightness and hue on
+    first use, and each color is refined from the table by a short binary
+    search. All colors are mapped natively and in parallel, without holding
+    the GIL.
+
+    Parameters
+    ----------
+    values : buffer
+        float64 buffer (e.g. a NumPy array or ``array.array('d')``) of shape
+        ``(n, 3)``, or flat with a length that is a multiple of three
+    space : str
+        Coordinates of ``values``: 'lch' (default) for L*, C*, h with h in
+        degrees, 'lab' for L*, a*, b*, 'oklch' for L, C, h or 'oklab' for L,
+        a, b. L* is clamped to [0, 100] and OKLab L to [0, 1]. Chroma is
+        reduced in CIE LCh for the first two and in OKLCh for the others.
+    output : str | None
+        Coordinates of the result: 'lch', 'lab', 'oklch', 'oklab' or 'rgb'
+        (sRGB components in [0, 1]). Defaults to ``space``.
+
+    Returns
+    -------
+    memoryview
+        float64 buffer of shape ``(n, 3)``. ``numpy.asarray`` wraps it
+        without copying. Colors with a non-finite coordinate map to NaN.
+
+    Raises
+    ------
+    ValueError
+        If values is not a float64 buffer with three columns, or space or
+        output is unknown
+
+    Notes
+    -----
+    Near the yellow cusp in CIE LCh, and near blue in OKLCh, a ray of
+    constant lightness and hue can leave the gamut and enter it again at
+    higher chroma; the outermost in-gamut chroma is kept.
+
+    Examples
+    --------
+    >>> from array import array
+    >>> from qualpal.gamut import gamut_map
+    >>> lch = gamut_map(array("d", [60.0, 120.0, 40.0, 50.0, 20.0, 200.0]))
+    >>> [[round(x, 2) for x in row] for row in lch.tolist()]
+    [[60.0, 81.87, 40.0], [50.0, 20.0, 200.0]]
+    """
+    if output is None:
+        output = space
+    return memoryview(_qualpal.gamut_map(values, space, output))
@@ -0,0 +1,85 @@
+"""Color assignment to the nodes of graphs and maps."""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from qualpal.palette import Palette
+from qualpal.qualpal import Qualpal
+
+if TYPE_CHECKING:
+    from collections.abc import Sequence
+
+    from qualpal.color import Color
+
+
+def assign_colors(
+    indptr: object,
+    indices: object,
+    colors: Palette | Sequence[Color | str] | int,
+    metric: str = "ciede2000",
+) -> tuple[Palette, memoryview]:
+    """Color a graph so that adjacent nodes get perceptually distant colors.
+
+    Choropleth maps and network diagrams need neighboring regions or nodes to
+    be easy to tell apart. This assigns a color to every node so that the
+    smallest distance between the colors of adjacent nodes is as large as
+    possible. Colors may be used any number of times.
+
+    The assignment runs natively: a DSATUR-style greedy coloring that colors
+    the most constrained node next, followed by local repair of the closest
+    edges. It is a heuristic, not guaranteed to be optimal, and scales to
+    graphs with hundreds of thousands of nodes.
+
+    Parameters
+    ----------
+    indptr : buffer
+        One-dimensional int64 buffer (e.g. a NumPy array or
+        ``array.array('q')``) with the ``n_nodes + 1`` row offsets of the
+        adjacency matrix in compressed sparse row form, such as
+        ``scipy.sparse.csr_matrix.indptr`` or the first buffer returned by
+        :meth:`Palette.knn_graph`.
+    indices : buffer
+        One-dimensional int64 buffer with the neighbors of node i at
+        ``indices[indptr[i]:indptr[i + 1]]``. The graph is treated as
+        undirected, so each edge may be listed in one or both rows.
+        Self-loops are ignored.
+    colors : Palette | Sequence[Color | str] | int
+        Colors to assign, or the number of colors to generate with
+        :class:`Qualpal` using its defaults.
+    metric : str
+        Distance metric to use (default: 'ciede2000')
+
+    Returns
+    -------
+    tuple[Palette, memoryview]
+        The palette, and an int64 buffer with the index in the palette of
+        each node's color.
+
+    Raises
+    ------
+    ValueError
+        If the buffers have the wrong type or shape, the CSR arrays are
+        inconsistent, or the graph has nodes but there are no colors.
+
+    Examples
+    --------
+    >>> from array import array
+    >>> from qualpal.graph import assign_colors
+    >>> # A path of three nodes: 0 - 1 - 2
+    >>> indptr, indices = array('q', [0, 1, 2, 2]), array('q', [1, 2])
+    >>> palette, node_colors = assign_colors(
+    ...     indptr, indices, ['#000000', '#ffffff', '#111111']
+    ... )
+    >>> [palette.hex()[c] for c in node_colors]
+    ['#ffffff', '#000000', '#ffffff']
+    """
+    if isinstance(colors, int):
+        palette = Qualpal(metric=metric).generate(colors)
+    elif isinstance(colors, Palette):
+        palette = colors
+    else:
+        palette = Palette(colors)
+
+    node_colors = palette._data.assign_to_graph(indptr, indices, metric)
+    return palette, memoryview(node_colors)
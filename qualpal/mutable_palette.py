@@ -0,0 +1,328 @@
+"""MutablePalette class."""
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+import _qualpal
+
+from qualpal.color import Color
+from qualpal.palette import Palette, _to_hex
+
+if TYPE_CHECKING:
+    from collections.abc import Iterator, Sequence
+
+
+class MutablePalette:
+    """A palette for interactive editing with incrementally updated distances.
+
+    The pairwise distance matrix and each color's nearest neighbor are cached
+    under a fixed metric. Adding, removing or replacing a color computes only
+    the n - 1 distances involving that color, so analysis stays fast for
+    palettes with hundreds of colors. The ``min_distance_if_*`` methods answer
+    what-if questions without modifying the palette.
+
+    Colors whose nearest neighbor was the edited color look up their new one
+    in their cached rows, without computing distances, at O(n) each. An edit
+    therefore costs O(n) distances plus O(n * k) lookups, where k is the
+    number of such colors; when most colors share one nearest neighbor, an
+    edit to it is O(n^2). Likewise, :meth:`min_distance` scans the row of
+    each duplicated color, so it costs O(n * d) for d duplicates.
+
+    Each method runs under a lock of its own palette, so a palette can be
+    shared between threads, also without the GIL. A sequence of calls, such
+    as :meth:`pop`, is not atomic.
+    """
+
+    def __init__(
+        self, colors: Sequence[Color | str] = (), metric: str = "ciede2000"
+    ) -> None:
+        """Create a MutablePalette.
+
+        Parameters
+        ----------
+        colors : Sequence[Color | str]
+            Initial colors, as Color objects or hex strings
+        metric : str
+            Distance metric: 'ciede2000' (default), 'din99d', 'cie76',
+            'oklab', 'cam16ucs', 'cie94', or 'cmc'. Fixed for the lifetime of
+            the palette.
+
+        Raises
+        ------
+        ValueError
+            If any color or the metric is invalid
+        TypeError
+            If any color has an invalid type
+        """
+        self._data = _qualpal.MutablePalette([_to_hex(c) for c in colors], metric)
+
+    @property
+    def metric(self) -> str:
+        """Get the distance metric."""
+        return self._data.metric
+
+    def _index(self, index: int) -> int:
+        """Normalize a possibly negative index."""
+        n = len(self._data)
+        if index < 0:
+            index += n
+        if not 0 <= index < n:
+            msg = "palette index out of range"
+            raise IndexError(msg)
+        return index
+
+    def __len__(self) -> int:
+        """Return the number of colors in the palette."""
+        return len(self._data)
+
+    def __getitem__(self, index: int) -> Color:
+        """Get the color at an index."""
+        return Color(self._data.hex_at(self._index(index)))
+
+    def __setitem__(self, index: int, color: Color | str) -> None:
+        """Replace the color at an index."""
+        self._data.replace(self._index(index), _to_hex(color))
+
+    def __delitem__(self, index: int) -> None:
+        """Remove the color at an index."""
+        self._data.remove(self._index(index))
+
+    def __iter__(self) -> Iterator[Color]:
+        """Iterate over colors in the palette."""
+        return (Color(h) for h in self._data.hex())
+
+    def append(self, color: Color | str) -> None:
+        """Add a color to the end of the palette.
+
+        Parameters
+        ----------
+        color : Color | str
+            Color object or hex string
+        """
+        self._data.append(_to_hex(color))
+
+    def insert(self, index: int, color: Color | str) -> None:
+        """Insert a color before an index.
+
+        Out-of-range indices are clamped, as for ``list.insert``.
+
+        Parameters
+        ----------
+        index : int
+            Position to insert at
+        color : Color | str
+            Color object or hex string
+        """
+        n = len(self._data)
+        if index < 0:
+            index = max(index + n, 0)
+        self._data.insert(min(index, n), _to_hex(color))
+
+    def pop(self, index: int = -1) -> Color:
+        """Remove and return the color at an index (default last).
+
+        Parameters
+        ----------
+        index : int
+            Index of the color to remove
+
+        Returns
+        -------
+        Color
+            The removed color
+        """
+        index = self._index(index)
+        color = Color(self._data.hex_at(index))
+        self._data.remove(index)
+        return color
+
+    def hex(self) -> list[str]:
+        """Get list of hex color strings.
+
+        Returns
+        -------
+        list[str]
+            List of hex strings in format #rrggbb (lowercase)
+        """
+        return self._data.hex()
+
+    def to_palette(self) -> Palette:
+        """Get an immutable snapshot of the current colors.
+
+        Returns
+        -------
+        Palette
+            Palette with the current colors
+        """
+        return Palette._from_data(self._data.palette())
+
+    def distance(self, i: int, j: int) -> float:
+        """Get the cached distance between two colors.
+
+        Parameters
+        ----------
+        i, j : int
+            Indices of the colors
+
+        Returns
+        -------
+        float
+            Distance between colors i and j
+        """
+        return self._data.distance(self._index(i), self._index(j))
+
+    def distance_matrix(self) -> list[list[float]]:
+        """Get the pairwise distance matrix.
+
+        Returns
+        -------
+        list[list[float]]
+            Symmetric distance matrix where element [i][j] is the distance
+            between colors i and j
+        """
+        return memoryview(self._data.distance_matrix()).tolist()
+
+    def min_distance(self) -> float:
+        """Get the minimum pairwise distance.
+
+        As with ``Palette.min_distance``, duplicate colors are skipped.
+
+        Returns
+        -------
+        float
+            Minimum distance between any two colors
+
+        Raises
+        ------
+        ValueError
+            If the palette has fewer than 2 colors
+        """
+        self._require_pairs()
+        return self._data.min_distance()
+
+    def min_distances(self) -> list[float]:
+        """Get the distance from each color to its nearest neighbor.
+
+        Returns
+        -------
+        list[float]
+            List where element i is the minimum distance from color i to
+            any other color
+
+        Raises
+        ------
+        ValueError
+            If the palette has fewer than 2 colors
+        """
+        self._require_pairs()
+        return self._data.min_distances()
+
+    def nearest_neighbors(self) -> list[int]:
+        """Get the index of each color's nearest neighbor.
+
+        Returns
+        -------
+        list[int]
+            List where element i is the index of the color closest to
+            color i. Ties are resolved in favor of the lower index.
+
+        Raises
+        ------
+        ValueError
+            If the palette has fewer than 2 colors
+        """
+        self._require_pairs()
+        return self._data.nearest_neighbors()
+
+    def min_distance_if_added(self, color: Color | str) -> float:
+        """Get the minimum distance the palette would have with a new color.
+
+        Parameters
+        ----------
+        color : Color | str
+            Candidate color
+
+        Returns
+        -------
+        float
+            Minimum pairwise distance after appending the color
+
+        Raises
+        ------
+        ValueError
+            If the palette is empty
+        """
+        if len(self) < 1:
+            msg = "Need at least 1 color to evaluate an addition"
+            raise ValueError(msg)
+        return self._data.min_distance_if_added(_to_hex(color))
+
+    def min_distance_if_removed(self, index: int) -> float:
+        """Get the minimum distance the palette would have without a color.
+
+        Parameters
+        ----------
+        index : int
+            Index of the color to leave out
+
+        Returns
+        -------
+        float
+            Minimum pairwise distance after removing the color
+
+        Raises
+        ------
+        ValueError
+            If the palette has fewer than 3 colors
+        """
+        if len(self) < 3:
+            msg = "Need at least 3 colors to evaluate a removal"
+            raise ValueError(msg)
+        return self._data.min_distance_if_removed(self._index(index))
+
+    def min_distance_if_replaced(self, index: int, color: Color | str) -> float:
+        """Get the minimum distance the palette would have after a replacement.
+
+        Parameters
+        ----------
+        index : int
+            Index of the color to replace
+        color : Color | str
+            Candidate replacement color
+
+        Returns
+        -------
+        float
+            Minimum pairwise distance after replacing the color
+
+        Raises
+        ------
+        ValueError
+            If the palette has fewer than 2 colors
+
+        Examples
+        --------
+        >>> from qualpal import MutablePalette
+        >>> pal = MutablePalette(['#ff0000', '#fe0000', '#0000ff'])
+        >>> pal.min_distance() < 1
+        True
+        >>> pal.min_distance_if_replaced(1, '#00ff00') > 50
+        True
+        """
+        self._require_pairs()
+        return self._data.min_distance_if_replaced(self._index(index), _to_hex(color))
+
+    def _require_pairs(self) -> None:
+        if len(self) < 2:
+            msg = "Need at least 2 colors to compute distances"
+            raise ValueError(msg)
+
+    def __str__(self) -> str:
+        """String representation showing hex colors."""
+        hex_list = ", ".join(f"'{h}'" for h in self.hex())
+        return f"MutablePalette([{hex_list}], metric='{self.metric}')"
+
+    def __repr__(self) -> str:
+        """Developer representation."""
+        return self.__str__()
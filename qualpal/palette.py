@@ -3,20 +3,48 @@
 from __future__ import annotations
 
 import json
-from typing import TYPE_CHECKING, overload
+import os
+from typing import TYPE_CHECKING, Any, overload
 
 import _qualpal
 
+from qualpal.arrow import colors_from_arrow
 from qualpal.color import Color
 
 if TYPE_CHECKING:
     from collections.abc import Iterator, Sequence
 
 
+def _to_hex(color: Color | str) -> str:
+    """Validate a color given as Color or hex string and return its hex."""
+    if isinstance(color, Color):
+        return color.hex()
+    if isinstance(color, str):
+        return Color(color).hex()
+    msg = f"Invalid color type: {type(color)}"
+    raise TypeError(msg)
+
+
+def _validate_cvd_condition(cvd_type: str, severity: float) -> None:
+    """Validate one CVD type and severity."""
+    valid_types = {"protan", "deutan", "tritan"}
+    if cvd_type not in valid_types:
+        msg = f"cvd_type must be one of {valid_types}, got '{cvd_type}'"
+        raise ValueError(msg)
+    if not isinstance(severity, (int, float)):
+        msg = "severity must be a number"
+        raise TypeError(msg)
+    if not 0.0 <= severity <= 1.0:
+        msg = f"severity must be in range [0, 1], got {severity}"
+        raise ValueError(msg)
+
+
 class Palette:
     """A collection of colors that behaves like a list.
 
-    Palette objects are immutable.
+    Palette objects are immutable. Colors are stored natively as contiguous
+    RGB and Lab arrays, so slicing is a cheap view and the analysis methods
+    run directly on the stored Lab values.
     """
 
     def __init__(self, colors: Sequence[Color | str]) -> None:
@@ -32,19 +60,102 @@ class Palette:
         ValueError
             If any color is invalid
         """
-        self._colors: list[Color] = []
-        for c in colors:
-            if isinstance(c, Color):
-                self._colors.append(c)
-            elif isinstance(c, str):
-                self._colors.append(Color(c))
-            else:
-                msg = f"Invalid color type: {type(c)}"
-                raise TypeError(msg)
+        self._data = _qualpal.PaletteData([_to_hex(c) for c in colors])
+
+    @classmethod
+    def _from_data(cls, data: _qualpal.PaletteData) -> Palette:
+        """Wrap native palette data without copying or validating it."""
+        palette = cls.__new__(cls)
+        palette._data = data
+        return palette
+
+    @classmethod
+    def from_arrow(cls, column: Any) -> Palette:
+        """Create a Palette from an Arrow color column.
+
+        The column is decoded natively through the Arrow C data interface,
+        without converting it to a list of strings first.
+
+        Parameters
+        ----------
+        column : Arrow array or chunked array
+            Object implementing ``__arrow_c_array__`` or
+            ``__arrow_c_stream__`` (e.g. from pyarrow or polars), holding
+            hex strings or ``fixed_size_list<uint8, 3>`` RGB values
+
+        Returns
+        -------
+        Palette
+            Palette with one color per row of the column
+
+        Raises
+        ------
+        TypeError
+            If ``column`` is not an Arrow column
+        ValueError
+            If the column type is unsupported, it contains nulls, or a
+            string is not a hex color
+
+        Examples
+        --------
+        >>> import pyarrow as pa  # doctest: +SKIP
+        >>> from qualpal import Palette
+        >>> Palette.from_arrow(pa.array(['#FF0000', '#00ff00'])).hex()  # doctest: +SKIP
+        ['#ff0000', '#00ff00']
+        """
+        rgb = colors_from_arrow(column)
+        return cls._from_data(_qualpal.PaletteData.from_rgb8(rgb))
+
+    @classmethod
+    def from_bytes(cls, data: bytes | bytearray | memoryview) -> Palette:
+        """Restore a Palette serialized with :meth:`to_bytes`.
+
+        The stored RGB and Lab values are copied as they are; no color is
+        parsed or converted again.
+
+        Parameters
+        ----------
+        data : bytes | bytearray | memoryview
+            Output of :meth:`to_bytes`
+
+        Returns
+        -------
+        Palette
+            Palette with the serialized colors
+
+        Raises
+        ------
+        ValueError
+            If ``data`` does not hold a serialized palette, or was written on
+            a machine with a different byte order
+
+        Examples
+        --------
+        >>> from qualpal import Palette
+        >>> pal = Palette(['#ff0000', '#00ff00'])
+        >>> Palette.from_bytes(pal.to_bytes()) == pal
+        True
+        """
+        return cls._from_data(_qualpal.PaletteData.from_bytes(data))
+
+    def to_bytes(self) -> bytes:
+        """Serialize the palette compactly, with its cached Lab values.
+
+        The result holds the RGB and Lab coordinates as float64 in native
+        byte order, 48 bytes per color after a 24-byte header. It is also
+        what pickling a Palette stores, so palettes sent to worker
+        processes are not converted again on arrival.
+
+        Returns
+        -------
+        bytes
+            Serialized palette, see :meth:`from_bytes`
+        """
+        return self._data.to_bytes()
 
     def __len__(self) -> int:
         """Return the number of colors in the palette."""
-        return len(self._colors)
+        return len(self._data)
 
     @overload
     def __getitem__(self, index: int) -> Color: ...
@@ -63,15 +174,16 @@ class Palette:
         Returns
         -------
         Color | Palette
-            Single Color if index is int, new Palette if index is slice
+            Single Color if index is int, new Palette if index is slice.
+            Slices share storage with this palette.
         """
         if isinstance(index, slice):
-            return Palette(self._colors[index])
-        return self._colors[index]
+            return Palette._from_data(self._data[index])
+        return Color(self._data[index])
 
     def __iter__(self) -> Iterator[Color]:
         """Iterate over colors in the palette."""
-        return iter(self._colors)
+        return (Color(h) for h in self._data.hex())
 
     def __contains__(self, item: object) -> bool:
         """Check if a color is in the palette.
@@ -87,11 +199,11 @@ class Palette:
             True if color is in palette, False otherwise
         """
         if isinstance(item, Color):
-            return item in self._colors
+            return item.hex() in self._data.hex()
         if isinstance(item, str):
             try:
                 color = Color(item)
-                return color in self._colors
+                return color.hex() in self._data.hex()
             except ValueError:
                 return False
         return False
@@ -104,7 +216,38 @@ class Palette:
         list[str]
             List of hex strings in format #rrggbb (lowercase)
         """
-        return [c.hex() for c in self._colors]
+        return self._data.hex()
+
+    def to_arrow(self, kind: str = "hex") -> _qualpal.ArrowColumn:
+        """Export the colors as an Arrow column.
+
+        Parameters
+        ----------
+        kind : str
+            'hex' (default) for utf8 hex strings, 'rgb' for
+            ``fixed_size_list<uint8, 3>`` RGB bytes, or 'lab' for
+            ``fixed_size_list<double, 3>`` Lab coordinates. Lab coordinates
+            share memory with the palette unless it is a strided slice.
+
+        Returns
+        -------
+        ArrowColumn
+            Object implementing ``__arrow_c_array__`` and
+            ``__arrow_c_schema__``, accepted e.g. by ``pyarrow.array()``
+
+        Raises
+        ------
+        ValueError
+            If kind is unknown
+
+        Examples
+        --------
+        >>> from qualpal import Palette
+        >>> column = Palette(['#ff0000', '#00ff00']).to_arrow('rgb')
+        >>> len(column), column.format
+        (2, '+w:3')
+        """
+        return self._data.to_arrow(kind)
 
     def rgb(self) -> list[tuple[float, float, float]]:
         """Get RGB values as list of tuples.
@@ -114,7 +257,44 @@ class Palette:
         list[tuple[float, float, float]]
             List of RGB tuples in range [0.0, 1.0]
         """
-        return [c.rgb() for c in self._colors]
+        return [tuple(c) for c in memoryview(self._data.rgb_array()).tolist()]
+
+    def array(self, space: str = "rgb") -> memoryview:
+        """Get the stored color coordinates as a zero-copy buffer.
+
+        Parameters
+        ----------
+        space : str
+            Color space of the coordinates: 'rgb' (default, in range
+            [0.0, 1.0]) or 'lab'.
+
+        Returns
+        -------
+        memoryview
+            Read-only 2-D float64 buffer of shape (n, 3) that shares memory
+            with the palette. It can be passed to ``numpy.asarray`` without
+            copying.
+
+        Raises
+        ------
+        ValueError
+            If space is not 'rgb' or 'lab'
+
+        Examples
+        --------
+        >>> from qualpal import Palette
+        >>> pal = Palette(['#ff0000', '#00ff00'])
+        >>> pal.array().shape
+        (2, 3)
+        >>> round(pal.array('lab')[0, 0])  # Lightness of red
+        53
+        """
+        if space == "rgb":
+            return memoryview(self._data.rgb_array())
+        if space == "lab":
+            return memoryview(self._data.lab_array())
+        msg = f"space must be 'rgb' or 'lab', got '{space}'"
+        raise ValueError(msg)
 
     def to_css(self, prefix: str = "color") -> list[str]:
         """Export palette as CSS custom properties (CSS variables).
@@ -139,7 +319,7 @@ class Palette:
         ['--theme-1: #ff0000;', '--theme-2: #00ff00;', '--theme-3: #0000ff;']
         """
         return [
-            f"--{prefix}-{i}: {color.hex()};" for i, color in enumerate(self._colors, 1)
+            f"--{prefix}-{i}: {hex_color};" for i, hex_color in enumerate(self.hex(), 1)
         ]
 
     def to_json(self) -> str:
@@ -201,12 +381,12 @@ class Palette:
             raise ImportError(msg) from e
 
         # Validate labels
-        if isinstance(labels, list) and len(labels) != len(self._colors):
-            msg = f"Number of labels ({len(labels)}) must match number of colors ({len(self._colors)})"
+        if isinstance(labels, list) and len(labels) != len(self):
+            msg = f"Number of labels ({len(labels)}) must match number of colors ({len(self)})"
             raise ValueError(msg)
 
         # Create figure
-        n_colors = len(self._colors)
+        n_colors = len(self)
 
         # Handle empty palette
         if n_colors == 0:
@@ -229,10 +409,10 @@ class Palette:
         fig, ax = plt.subplots(figsize=(n_colors * 1.5, 2))
 
         # Draw color swatches
-        for i, color in enumerate(self._colors):
+        for i, hex_color in enumerate(self.hex()):
             ax.add_patch(
                 Rectangle(
-                    (i, 0), 1, 1, facecolor=color.hex(), edgecolor="black", linewidth=1
+                    (i, 0), 1, 1, facecolor=hex_color, edgecolor="black", linewidth=1
                 )
             )
 
@@ -241,11 +421,11 @@ class Palette:
 
         if labels is True:
             # Use hex codes as labels
-            for i, color in enumerate(self._colors):
+            for i, hex_color in enumerate(self.hex()):
                 ax.text(
                     i + 0.5,
                     -0.15,
-                    color.hex(),
+                    hex_color,
                     ha="center",
                     va="top",
                     fontsize=9,
@@ -286,6 +466,10 @@ class Palette:
             - 'ciede2000' (default): CIEDE2000 metric
             - 'din99d': DIN99d metric
             - 'cie76': CIE76 (Euclidean distance in Lab space)
+            - 'oklab': Euclidean distance in OKLab, scaled by 100
+            - 'cam16ucs': Euclidean distance in CAM16-UCS
+            - 'cie94': CIE94 (graphic arts), symmetrized
+            - 'cmc': CMC l:c with l=2, c=1, symmetrized
 
         Returns
         -------
@@ -303,20 +487,149 @@ class Palette:
         >>> matrix[0][0]  # Distance to self
         0.0
         """
-        # Get hex colors
-        hex_colors = [c.hex() for c in self._colors]
+        return memoryview(self._data.distance_matrix(metric)).tolist()
+
+    def cvd_distance_matrix(
+        self,
+        cvd: dict[str, float | Sequence[float]] | None = None,
+        metric: str = "ciede2000",
+        reduction: str = "min",
+        weights: dict[str, float] | None = None,
+    ) -> list[list[float]]:
+        """Calculate a distance matrix that accounts for color vision deficiency.
+
+        Distances are computed under normal vision and under each simulated
+        deficiency, and combined element-wise in a single native pass. With
+        the default ``reduction='min'``, element [i][j] is the smallest
+        distance between colors i and j under any of the conditions, i.e.
+        the worst case for colorblind safety.
+
+        Parameters
+        ----------
+        cvd : dict[str, float | Sequence[float]] | None
+            Deficiencies to simulate, mapping 'protan', 'deutan' or 'tritan'
+            to a severity in [0, 1] or a sequence of severities. Defaults to
+            complete deficiency of all three types.
+        metric : str
+            Distance metric to use (default: 'ciede2000')
+        reduction : str
+            How distances are combined: 'min' (default) for the element-wise
+            minimum, or 'mean' for the element-wise weighted mean.
+        weights : dict[str, float] | None
+            Non-negative weight of 'normal' vision and of each deficiency
+            type (applied to all of its severities). Missing keys default to
+            1.0. Conditions with zero weight are left out, so
+            ``{'normal': 0}`` considers simulated vision only.
+
+        Returns
+        -------
+        list[list[float]]
+            Symmetric matrix with zeros on the diagonal
+
+        Raises
+        ------
+        ValueError
+            If a CVD type, severity, weight or the reduction is invalid, or
+            all weights are zero
+
+        Examples
+        --------
+        >>> from qualpal import Palette
+        >>> pal = Palette(['#ff0000', '#00ff00', '#0000ff'])
+        >>> worst = pal.cvd_distance_matrix()
+        >>> worst[0][1] < pal.distance_matrix()[0][1]
+        True
+        """
+        valid_types = {"protan", "deutan", "tritan"}
+        if cvd is None:
+            cvd = dict.fromkeys(sorted(valid_types), 1.0)
+        weights = {} if weights is None else weights
+
+        unknown = set(weights) - valid_types - {"normal"}
+        if unknown:
+            msg = f"weights keys must be in {valid_types | {'normal'}}"
+            raise ValueError(msg)
+        for key, weight in weights.items():
+            if not isinstance(weight, (int, float)) or weight < 0:
+                msg = f"weights['{key}'] must be a non-negative number"
+                raise ValueError(msg)
+
+        conditions = []
+        for cvd_type, severities in cvd.items():
+            if isinstance(severities, (int, float)):
+                severities = [severities]
+            for severity in severities:
+                _validate_cvd_condition(cvd_type, severity)
+                weight = float(weights.get(cvd_type, 1.0))
+                conditions.append((cvd_type, float(severity), weight))
+
+        matrix = self._data.cvd_distance_matrix(
+            metric, conditions, float(weights.get("normal", 1.0)), reduction
+        )
+        return memoryview(matrix).tolist()
+
+    def write_distance_matrix(
+        self,
+        path: str | os.PathLike[str],
+        metric: str = "ciede2000",
+        layout: str = "full",
+        dtype: str = "float64",
+        tile_bytes: int = 64 * 2**20,
+    ) -> None:
+        """Write the pairwise distance matrix to a memory-mappable file.
+
+        Rows are computed in parallel, a block at a time, and appended to
+        the file, so matrices far larger than memory can be produced. Open
+        the result with :func:`qualpal.distance_file.open_distance_matrix`.
 
-        # Call C++ function (returns flat array)
-        flat_matrix = _qualpal.color_distance_matrix(hex_colors, metric)
+        Parameters
+        ----------
+        path : str | os.PathLike
+            Output file, replaced if it exists
+        metric : str
+            Distance metric to use (default: 'ciede2000')
+        layout : str
+            'full' (default) for the n x n matrix, or 'condensed' for the
+            n (n - 1) / 2 upper-triangle entries in the order of
+            ``scipy.spatial.distance.pdist``
+        dtype : str
+            'float64' (default) or 'float32'
+        tile_bytes : int
+            Memory used for the block of rows being computed
+            (default: 64 MiB). At least one row is always computed.
+
+        Raises
+        ------
+        ValueError
+            If the layout, dtype or metric is invalid, or tile_bytes is not
+            positive
+        RuntimeError
+            If the file cannot be written
 
-        # Convert to 2D list
-        n = len(self._colors)
-        matrix = []
-        for i in range(n):
-            row = flat_matrix[i * n : (i + 1) * n]
-            matrix.append(row)
+        Examples
+        --------
+        >>> import tempfile
+        >>> from pathlib import Path
+        >>> from qualpal import Palette
+        >>> from qualpal.distance_file import open_distance_matrix
+        >>> tmp = tempfile.TemporaryDirectory()
+        >>> path = Path(tmp.name) / 'dist.qpd'
+        >>> pal = Palette(['#ff0000', '#00ff00', '#0000ff'])
+        >>> pal.write_distance_matrix(path, layout='condensed')
+        >>> open_distance_matrix(path).shape  # doctest: +SKIP
+        (3,)
+        >>> tmp.cleanup()
+        """
+        if dtype not in ("float32", "float64"):
+            msg = f"dtype must be 'float32' or 'float64', got '{dtype}'"
+            raise ValueError(msg)
+        if not isinstance(tile_bytes, int) or tile_bytes <= 0:
+            msg = "tile_bytes must be a positive integer"
+            raise ValueError(msg)
 
-        return matrix
+        self._data.write_distance_matrix(
+            os.fspath(path), metric, layout, dtype == "float32", tile_bytes
+        )
 
     def min_distance(self, metric: str = "ciede2000") -> float:
         """Get the minimum pairwise distance between any two colors.
@@ -339,21 +652,12 @@ class Palette:
         >>> min_dist > 0
         True
         """
-        if len(self._colors) < 2:
+        if len(self) < 2:
             msg = "Need at least 2 colors to compute minimum distance"
             raise ValueError(msg)
 
-        matrix = self.distance_matrix(metric)
-
-        # Find minimum non-zero distance
-        min_dist = float("inf")
-        for i in range(len(matrix)):
-            for j in range(i + 1, len(matrix)):  # Only upper triangle
-                dist = matrix[i][j]
-                if dist > 0 and dist < min_dist:
-                    min_dist = dist
-
-        return min_dist
+        # Smallest non-zero distance over all pairs
+        return self._data.min_distance(metric)
 
     def min_distances(self, metric: str = "ciede2000") -> list[float]:
         """Get minimum distance for each color to its nearest neighbor.
@@ -379,26 +683,274 @@ class Palette:
         >>> all(d > 0 for d in min_dists)
         True
         """
-        if len(self._colors) < 2:
+        if len(self) < 2:
             msg = "Need at least 2 colors to compute minimum distances"
             raise ValueError(msg)
 
-        matrix = self.distance_matrix(metric)
+        return self._data.min_distances(metric)
 
-        # For each color, find its minimum distance to any other color
-        min_dists = []
-        for i in range(len(matrix)):
-            min_dist = float("inf")
-            for j in range(len(matrix)):
-                if i != j and matrix[i][j] < min_dist:
-                    min_dist = matrix[i][j]
-            min_dists.append(min_dist)
+    def nearest_neighbors(self, metric: str = "ciede2000") -> list[int]:
+        """Get the index of each color's nearest neighbor.
 
-        return min_dists
+        Parameters
+        ----------
+        metric : str
+            Distance metric to use (default: 'ciede2000')
+
+        Returns
+        -------
+        list[int]
+            List where element i is the index of the color closest to
+            color i. Ties are resolved in favor of the lower index.
+
+        Raises
+        ------
+        ValueError
+            If the palette has fewer than 2 colors
+
+        Examples
+        --------
+        >>> from qualpal import Palette
+        >>> pal = Palette(['#ff0000', '#fe0000', '#00ff00', '#00fe00'])
+        >>> pal.nearest_neighbors()
+        [1, 0, 3, 2]
+        """
+        if len(self) < 2:
+            msg = "Need at least 2 colors to compute nearest neighbors"
+            raise ValueError(msg)
+
+        return self._data.nearest_neighbors(metric)
+
+    def close_pairs(
+        self, threshold: float, metric: str = "ciede2000"
+    ) -> list[tuple[int, int, float]]:
+        """Find all pairs of colors that are closer than a threshold.
+
+        Colors are bucketed into a spatial grid so that only pairs in
+        neighboring cells are compared, which makes this much faster than
+        scanning the full distance matrix when few pairs are close.
+
+        Parameters
+        ----------
+        threshold : float
+            Pairs with a distance strictly below this value are returned
+        metric : str
+            Distance metric to use (default: 'ciede2000')
+
+        Returns
+        -------
+        list[tuple[int, int, float]]
+            Tuples ``(i, j, distance)`` with ``i < j``, sorted by ``i`` and
+            then ``j``
+
+        Raises
+        ------
+        TypeError
+            If threshold is not a number
+        ValueError
+            If threshold is negative or NaN
+
+        Examples
+        --------
+        >>> from qualpal import Palette
+        >>> pal = Palette(['#ff0000', '#fe0000', '#00ff00', '#00fe00'])
+        >>> [(i, j) for i, j, _ in pal.close_pairs(2.0)]
+        [(0, 1), (2, 3)]
+        """
+        if not isinstance(threshold, (int, float)):
+            msg = "threshold must be a number"
+            raise TypeError(msg)
+        if not threshold >= 0:
+            msg = f"threshold must be non-negative, got {threshold}"
+            raise ValueError(msg)
+
+        first, second, distances = self._data.pairs_within(metric, float(threshold))
+        return list(zip(first, second, memoryview(distances).tolist()))
+
+    def knn_graph(
+        self, k: int, metric: str = "ciede2000"
+    ) -> tuple[memoryview, memoryview, memoryview]:
+        """Find the k nearest neighbors of every color.
+
+        The graph is built with a spatial index and exact distances, without
+        forming the full distance matrix, so it scales to color sets far too
+        large for :meth:`distance_matrix`.
+
+        Parameters
+        ----------
+        k : int
+            Number of neighbors per color. Capped at ``len(self) - 1``.
+        metric : str
+            Distance metric to use (default: 'ciede2000')
+
+        Returns
+        -------
+        tuple[memoryview, memoryview, memoryview]
+            The graph in compressed sparse row form: ``(indptr, indices,
+            distances)``. The neighbors of color i are
+            ``indices[indptr[i]:indptr[i + 1]]``, nearest first with ties
+            broken by index, at the matching ``distances``. ``indptr`` and
+            ``indices`` hold 64-bit integers, ``distances`` 64-bit floats;
+            ``numpy.asarray`` wraps each without copying, and
+            ``scipy.sparse.csr_matrix((distances, indices, indptr))``
+            builds a sparse matrix.
+
+        Raises
+        ------
+        TypeError
+            If k is not an integer
+        ValueError
+            If k is less than 1
+
+        Examples
+        --------
+        >>> from qualpal import Palette
+        >>> pal = Palette(['#ff0000', '#fe0000', '#00ff00', '#00fe00'])
+        >>> indptr, indices, distances = pal.knn_graph(1)
+        >>> indptr.tolist()
+        [0, 1, 2, 3, 4]
+        >>> indices.tolist()
+        [1, 0, 3, 2]
+        """
+        if not isinstance(k, int) or isinstance(k, bool):
+            msg = "k must be an integer"
+            raise TypeError(msg)
+        if k < 1:
+            msg = f"k must be at least 1, got {k}"
+            raise ValueError(msg)
+
+        indptr, indices, distances = self._data.knn_graph(metric, k)
+        return memoryview(indptr), memoryview(indices), memoryview(distances)
+
+    def perceptual_order(self, metric: str = "ciede2000") -> list[int]:
+        """Find an order in which neighboring colors are most distinct.
+
+        Stacked charts and ordered legends show each color next to its
+        neighbors in the order. This finds the order whose smallest distance
+        between neighbors is largest, breaking ties by the largest total
+        distance between neighbors.
+
+        Palettes of up to 12 colors are ordered optimally. Larger palettes are
+        ordered by nearest insertion followed by 2-opt and Or-opt local
+        search, which is not guaranteed to be optimal.
+
+        Parameters
+        ----------
+        metric : str
+            Distance metric to use (default: 'ciede2000')
+
+        Returns
+        -------
+        list[int]
+            Permutation of ``range(len(self))``; position k holds the index of
+            the color to show k-th
+
+        Examples
+        --------
+        >>> from qualpal import Palette
+        >>> pal = Palette(['#000000', '#111111', '#ffffff', '#eeeeee'])
+        >>> pal.reorder().hex()
+        ['#eeeeee', '#000000', '#ffffff', '#111111']
+        """
+        return self._data.perceptual_order(metric)
+
+    def reorder(self, metric: str = "ciede2000") -> Palette:
+        """Reorder the colors so that neighboring colors are most distinct.
+
+        Parameters
+        ----------
+        metric : str
+            Distance metric to use (default: 'ciede2000')
+
+        Returns
+        -------
+        Palette
+            New palette with the colors in :meth:`perceptual_order`
+        """
+        hex_colors = self._data.hex()
+        return Palette([hex_colors[i] for i in self.perceptual_order(metric)])
+
+    def match(
+        self, previous: Palette | Sequence[Color | str], metric: str = "ciede2000"
+    ) -> list[int]:
+        """Order this palette to keep the colors of a previous palette.
+
+        When a chart gains or loses a series and its palette is regenerated,
+        the new colors come in an unrelated order. This matches the new
+        colors to the previous ones so that the total distance between
+        matched colors is as small as possible, by solving the assignment
+        problem on the distances between the two palettes in O(n^3) time.
+
+        Parameters
+        ----------
+        previous : Palette | Sequence[Color | str]
+            Colors of the existing series, in series order
+        metric : str
+            Distance metric to use (default: 'ciede2000')
+
+        Returns
+        -------
+        list[int]
+            Permutation of ``range(len(self))``. The colors matched to
+            ``previous`` come first, in the order of the colors they match,
+            followed by the unmatched colors in their original order. If this
+            palette has at least as many colors as ``previous``, color
+            ``order[i]`` is the match of ``previous[i]``.
+
+        Examples
+        --------
+        >>> from qualpal import Palette
+        >>> old = Palette(['#ff0000', '#0000ff'])
+        >>> new = Palette(['#00ff00', '#0000ee', '#ee0000'])
+        >>> order = new.match(old)
+        >>> order
+        [2, 1, 0]
+        >>> [new.hex()[i] for i in order]
+        ['#ee0000', '#0000ee', '#00ff00']
+        """
+        if not isinstance(previous, Palette):
+            previous = Palette(previous)
+
+        matched = [j for j in self._data.match(previous._data, metric) if j >= 0]
+        taken = set(matched)
+        return matched + [j for j in range(len(self)) if j not in taken]
+
+    def simulate_cvd(self, cvd_type: str, severity: float = 1.0) -> Palette:
+        """Simulate color vision deficiency on every color in the palette.
+
+        Parameters
+        ----------
+        cvd_type : str
+            Type of color vision deficiency: 'protan', 'deutan', or 'tritan'
+        severity : float
+            Severity of the deficiency in range [0, 1] (default: 1.0)
+
+        Returns
+        -------
+        Palette
+            New Palette showing how the colors appear with CVD. Each color
+            equals ``Color.simulate_cvd`` applied to the original color.
+
+        Raises
+        ------
+        ValueError
+            If cvd_type is invalid or severity is out of range
+
+        Examples
+        --------
+        >>> from qualpal import Palette
+        >>> pal = Palette(['#ff0000', '#00ff00', '#0000ff'])
+        >>> deutan = pal.simulate_cvd('deutan')
+        >>> deutan.min_distance() > 0
+        True
+        """
+        _validate_cvd_condition(cvd_type, severity)
+
+        return Palette._from_data(self._data.simulate_cvd(cvd_type, severity))
 
     def __str__(self) -> str:
         """String representation showing hex colors."""
-        hex_list = ", ".join(f"'{c.hex()}'" for c in self._colors)
+        hex_list = ", ".join(f"'{h}'" for h in self.hex())
         return f"Palette([{hex_list}])"
 
     def __repr__(self) -> str:
@@ -413,16 +965,16 @@ class Palette:
         str
             HTML string with colored swatches in a row
         """
-        if not self._colors:
+        if len(self) == 0:
             return '<div style="font-style: italic; color: #888;">Empty palette</div>'
 
         swatches = []
-        for color in self._colors:
+        for hex_color in self.hex():
             swatches.append(
                 f'<div style="display: inline-block; text-align: center; margin: 4px;">'
-                f'<div style="width: 60px; height: 60px; background-color: {color.hex()}; '
+                f'<div style="width: 60px; height: 60px; background-color: {hex_color}; '
                 f'border: 1px solid #333; border-radius: 4px; margin-bottom: 4px;"></div>'
-                f'<div style="font-family: monospace; font-size: 11px;">{color.hex()}</div>'
+                f'<div style="font-family: monospace; font-size: 11px;">{hex_color}</div>'
                 f"</div>"
             )
 
@@ -438,7 +990,7 @@ class Palette:
         if not isinstance(other, Palette):
             return NotImplemented
 
-        return self._colors == other._colors
+        return self.hex() == other.hex()
 
     def __ne__(self, other: object) -> bool:
         """Check inequality."""
@@ -454,4 +1006,12 @@ class Palette:
 
         Since Palette is immutable, it can be hashed.
         """
-        return hash(tuple(self._colors))
+        return hash(tuple(self.hex()))
+
+    def __getstate__(self) -> bytes:
+        """Return the state for pickling, see :meth:`to_bytes`."""
+        return self.to_bytes()
+
+    def __setstate__(self, state: bytes) -> None:
+        """Restore the state written by :meth:`__getstate__`."""
+        self._data = _qualpal.PaletteData.from_bytes(state)
@@ -2,17 +2,67 @@
 
 from __future__ import annotations
 
+import json
 import re
+import struct
 from typing import TYPE_CHECKING
 
 import _qualpal
 
+from qualpal.arrow import is_arrow_column
 from qualpal.color import Color
 from qualpal.palette import Palette
 
 if TYPE_CHECKING:
     from collections.abc import Sequence
 
+# Header of a serialized Qualpal: magic and format version
+_STATE_HEADER = struct.Struct("<8sI")
+_STATE_MAGIC = b"QPALCONF"
+_STATE_VERSION = 1
+
+
+def _validate_cvd(value: dict[str, float]) -> None:
+    """Validate a CVD specification mapping deficiency types to severities."""
+    valid_types = {"protan", "deutan", "tritan"}
+    if not isinstance(value, dict):
+        msg = "cvd must be a dict"
+        raise TypeError(msg)
+    if not set(value.keys()).issubset(valid_types):
+        msg = f"cvd keys must be in {valid_types}"
+        raise ValueError(msg)
+    for k, v in value.items():
+        if not isinstance(v, (int, float)):
+            msg = f"cvd['{k}'] must be a number"
+            raise TypeError(msg)
+        if not 0.0 <= v <= 1.0:
+            msg = f"cvd['{k}'] must be between 0.0 and 1.0"
+            raise ValueError(msg)
+
+
+def _normalize_backgrounds(value: dict[str, float]) -> dict[str, float]:
+    """Validate weighted backgrounds and lower-case their hex colors."""
+    if not isinstance(value, dict):
+        msg = "backgrounds must be a dict"
+        raise TypeError(msg)
+    normalized: dict[str, float] = {}
+    for color, weight in value.items():
+        if not isinstance(color, str) or not re.match(r"^#[0-9a-fA-F]{6}$", color):
+            msg = f"Invalid hex color: {color}"
+            raise ValueError(msg)
+        if not isinstance(weight, (int, float)):
+            msg = f"backgrounds['{color}'] must be a number"
+            raise TypeError(msg)
+        if not 0.0 < weight < float("inf"):
+            msg = f"backgrounds['{color}'] must be positive"
+            raise ValueError(msg)
+        key = color.lower()
+        if normalized.get(key, weight) != weight:
+            msg = f"backgrounds gives {key} twice with different weights"
+            raise ValueError(msg)
+        normalized[key] = weight
+    return normalized
+
 
 class Qualpal:
     """Generate qualitative color palettes with distinct colors.
@@ -34,20 +84,29 @@ class Qualpal:
         max_memory: float = 1.0,
         colorspace_size: int = 1000,
         white_point: str | None = None,
+        backgrounds: dict[str, float] | None = None,
+        cvd_mode: str = "combined",
     ) -> None:
         """Initialize Qualpal object.
 
         Parameters
         ----------
         colors : Sequence[str] | None
-            List of hex color strings to use as starting point.
+            List of hex color strings to use as starting point, or an Arrow
+            color column (see :meth:`Palette.from_arrow`).
             Mutually exclusive with colorspace and palette.
 
         colorspace : dict[str, tuple[float, float]] | None
             Colorspace specification with ranges for each dimension.
             Keys depend on 'space' parameter:
             - 'hsl': 'h', 's', 'l'
-            - 'lchab': 'h', 'c', 'l'
+            - 'lchab': 'h', 'c', 'l', with L* in [0, 100]. Only the part of
+              the region inside the sRGB gamut is sampled, so all
+              colorspace_size samples are displayable candidates.
+            - 'oklch': 'h', 'c', 'l', with L in [0, 1] and chroma on the
+              OKLab scale (at most about 0.32 in sRGB). Sampled inside the
+              sRGB gamut like 'lchab'; pair it with metric='oklab' to
+              measure distances in the same space.
             Each value is a (min, max) tuple.
             Mutually exclusive with colors and palette.
 
@@ -56,14 +115,18 @@ class Qualpal:
             Mutually exclusive with colors and colorspace.
 
         space : str
-            Color space to use: 'hsl' (default) or 'lchab'.
+            Color space to use: 'hsl' (default), 'lchab' or 'oklch'.
 
         cvd : dict[str, float] | None
             Color vision deficiency simulation. Keys: 'protan', 'deutan', 'tritan'.
             Values: 0.0 (normal) to 1.0 (complete deficiency).
 
         metric : str
-            Color difference metric: 'ciede2000' (default), 'din99d', or 'cie76'.
+            Color difference metric: 'ciede2000' (default), 'din99d', 'cie76',
+            'oklab', 'cam16ucs', 'cie94', or 'cmc'. The last four are not
+            part of the qualpal C++ library; with them, colors are selected
+            natively and max_memory and white_point have no effect. 'oklab'
+            is a plain Euclidean distance, the cheapest of them all.
 
         background : str | None
             Background color as hex string (e.g., '#ffffff').
@@ -78,6 +141,25 @@ class Qualpal:
             Reference white point for color conversions: 'd65' (default),
             'd50', 'd55', 'a', or 'e'.
 
+        backgrounds : dict[str, float] | None
+            Several background colors as hex strings, mapped to positive
+            weights, e.g. ``{'#ffffff': 1.0, '#1e1e1e': 1.0}`` for a palette
+            that works in both light and dark themes. Colors are selected to
+            stand out from all of them at once, and distances to a
+            background are divided by its weight. ``background``, if also
+            given, joins them with weight 1, unless it is among them already.
+            Colors are then selected
+            natively, and max_memory and white_point have no effect.
+
+        cvd_mode : str
+            How several deficiencies in ``cvd`` are handled: 'combined'
+            (default) applies them in turn to every color, as one condition;
+            'worst_case' makes the palette safe for each of them and for
+            normal vision at the same time, counting every pair of colors
+            with its smallest distance over these conditions. 'worst_case'
+            selects colors natively, so max_memory and white_point have no
+            effect.
+
         Raises
         ------
         ValueError
@@ -114,10 +196,10 @@ class Qualpal:
         if colorspace is not None:
             if space == "hsl":
                 required = {"h", "s", "l"}
-            elif space == "lchab":
+            elif space in ("lchab", "oklch"):
                 required = {"h", "c", "l"}
             else:
-                msg = f"space must be 'hsl' or 'lchab', got '{space}'"
+                msg = f"space must be 'hsl', 'lchab' or 'oklch', got '{space}'"
                 raise ValueError(msg)
 
             if not isinstance(colorspace, dict):
@@ -141,6 +223,10 @@ class Qualpal:
                     msg = f"colorspace['{key}'] min must be < max"
                     raise ValueError(msg)
 
+        # Decode Arrow color columns natively, once
+        if colors is not None and is_arrow_column(colors):
+            colors = Palette.from_arrow(colors).hex()
+
         # Store input mode
         self._colors = colors
         self._colorspace = colorspace
@@ -151,14 +237,18 @@ class Qualpal:
         self._cvd: dict[str, float] | None = None
         self._metric: str = "ciede2000"
         self._background: str | None = None
+        self._backgrounds: dict[str, float] | None = None
+        self._cvd_mode: str = "combined"
         self._max_memory: float = 1.0
         self._colorspace_size: int = 1000
         self._white_point: str | None = None
 
         # Use setters for validation even in __init__
         self.cvd = cvd
+        self.cvd_mode = cvd_mode
         self.metric = metric
         self.background = background
+        self.backgrounds = backgrounds
         self.max_memory = max_memory
         self.colorspace_size = colorspace_size
         self.white_point = white_point
@@ -186,22 +276,34 @@ class Qualpal:
             If keys are invalid or values are out of range.
         """
         if value is not None:
-            valid_types = {"protan", "deutan", "tritan"}
-            if not isinstance(value, dict):
-                msg = "cvd must be a dict"
-                raise TypeError(msg)
-            if not set(value.keys()).issubset(valid_types):
-                msg = f"cvd keys must be in {valid_types}"
-                raise ValueError(msg)
-            for k, v in value.items():
-                if not isinstance(v, (int, float)):
-                    msg = f"cvd['{k}'] must be a number"
-                    raise TypeError(msg)
-                if not 0.0 <= v <= 1.0:
-                    msg = f"cvd['{k}'] must be between 0.0 and 1.0"
-                    raise ValueError(msg)
+            _validate_cvd(value)
         self._cvd = value
 
+    @property
+    def cvd_mode(self) -> str:
+        """Get how several color vision deficiencies are handled."""
+        return self._cvd_mode
+
+    @cvd_mode.setter
+    def cvd_mode(self, value: str) -> None:
+        """Set how several color vision deficiencies are handled.
+
+        Parameters
+        ----------
+        value : str
+            'combined' to apply the deficiencies in turn, or 'worst_case' to
+            optimize for each of them and normal vision at the same time.
+
+        Raises
+        ------
+        ValueError
+            If value is not one of the valid options.
+        """
+        if value not in ("combined", "worst_case"):
+            msg = "cvd_mode must be 'combined' or 'worst_case'"
+            raise ValueError(msg)
+        self._cvd_mode = value
+
     @property
     def metric(self) -> str:
         """Get color difference metric."""
@@ -214,14 +316,15 @@ class Qualpal:
         Parameters
         ----------
         value : str
-            Metric name: 'ciede2000', 'din99d', or 'cie76'.
+            Metric name: 'ciede2000', 'din99d', 'cie76', 'oklab', 'cam16ucs',
+            'cie94', or 'cmc'.
 
         Raises
         ------
         ValueError
             If metric is not one of the valid options.
         """
-        valid = {"ciede2000", "din99d", "cie76"}
+        valid = {"ciede2000", "din99d", "cie76", "oklab", "cam16ucs", "cie94", "cmc"}
         if value not in valid:
             msg = f"metric must be one of {valid}"
             raise ValueError(msg)
@@ -257,6 +360,33 @@ class Qualpal:
                 raise ValueError(msg)
         self._background = value
 
+    @property
+    def backgrounds(self) -> dict[str, float] | None:
+        """Get weighted background colors."""
+        return self._backgrounds
+
+    @backgrounds.setter
+    def backgrounds(self, value: dict[str, float] | None) -> None:
+        """Set weighted background colors.
+
+        Parameters
+        ----------
+        value : dict[str, float] | None
+            Hex color strings mapped to positive weights, or None. The colors
+            are stored in lower case.
+
+        Raises
+        ------
+        TypeError
+            If value is not a dict or a weight is not numeric.
+        ValueError
+            If a hex color is invalid, a weight is not positive, or a color
+            is given twice, in different case, with different weights.
+        """
+        if value is not None:
+            value = _normalize_backgrounds(value)
+        self._backgrounds = value
+
     @property
     def max_memory(self) -> float:
         """Get maximum memory in GB."""
@@ -385,58 +515,18 @@ class Qualpal:
             msg = "n must be positive"
             raise ValueError(msg)
 
-        # Determine input mode and call appropriate C++ function
         try:
-            if self._colors is not None:
-                # Colors mode: select from provided colors
-                hex_colors = _qualpal.generate_palette_unified(
-                    n=n,
-                    colors=list(self._colors),
-                    background=self._background,
-                    metric=self._metric,
-                    max_memory=self._max_memory,
-                    white_point=self._white_point,
-                )
-            elif self._palette is not None:
-                # Palette mode: load named palette and select
-                hex_colors = _qualpal.generate_palette_unified(
-                    n=n,
-                    palette_name=self._palette,
-                    background=self._background,
-                    metric=self._metric,
-                    max_memory=self._max_memory,
-                    white_point=self._white_point,
-                )
-            elif self._colorspace is not None:
-                # Colorspace mode: sample from color space
-                # Convert colorspace to C++ format
-                if self._space == "hsl":
-                    h_range = list(self._colorspace["h"])
-                    c_range = list(self._colorspace["s"])  # saturation -> chroma
-                    l_range = list(self._colorspace["l"])
-                elif self._space == "lchab":
-                    h_range = list(self._colorspace["h"])
-                    c_range = list(self._colorspace["c"])
-                    l_range = list(self._colorspace["l"])
-                else:
-                    msg = f"Unsupported color space: {self._space}"
-                    raise RuntimeError(msg)
-
-                hex_colors = _qualpal.generate_palette_unified(
-                    n=n,
-                    h_range=h_range,
-                    c_range=c_range,
-                    l_range=l_range,
-                    cvd=self._cvd,
-                    background=self._background,
-                    metric=self._metric,
-                    max_memory=self._max_memory,
-                    white_point=self._white_point,
-                )
-            else:
-                msg = "No input source available for generation"
-                raise RuntimeError(msg)
-
+            hex_colors = _qualpal.generate_palette_unified(
+                n=n,
+                cvd=self._cvd,
+                cvd_mode=self._cvd_mode,
+                background=self._background,
+                backgrounds=self._backgrounds,
+                metric=self._metric,
+                max_memory=self._max_memory,
+                white_point=self._white_point,
+                **self._source_kwargs(),
+            )
         except ValueError as e:
             # Re-raise C++ validation errors with context
             msg = f"Palette generation failed: {e}"
@@ -451,3 +541,193 @@ class Qualpal:
 
         # Return Palette object
         return Palette(colors)
+
+    def generate_grouped(
+        self, n_groups: int, group_size: int, spread: float = 0.5
+    ) -> list[Palette]:
+        """Generate groups of related colors, e.g. for grouped series.
+
+        Produces ``n_groups`` hue families of ``group_size`` colors each.
+        The groups are as distinct from each other as possible, while the
+        colors within a group share a range of hues and differ mostly in
+        lightness and chroma, yet stay distinguishable.
+
+        It is solved as one structured problem rather than by nested calls
+        to :meth:`generate`. One anchor color per group is selected from the
+        candidates. The hue circle is then split into sectors around the
+        anchors, and each group's colors are selected from the middle of its
+        sector only. Grayish candidates (CIE LCh chroma below 15) have no
+        meaningful hue and are left out.
+
+        Parameters
+        ----------
+        n_groups : int
+            Number of groups.
+        group_size : int
+            Number of colors per group.
+        spread : float
+            Fraction of each hue sector that its group may use, in (0, 1]
+            (default: 0.5). Smaller values give tighter hue families with
+            wider gaps between groups.
+
+        Returns
+        -------
+        list[Palette]
+            The groups in order of hue, each starting with its anchor.
+
+        Raises
+        ------
+        TypeError
+            If n_groups or group_size is not an integer.
+        ValueError
+            If n_groups, group_size or spread is out of range.
+        RuntimeError
+            If generation fails, e.g. a group's hue sector holds too few
+            candidates.
+
+        Notes
+        -----
+        Colors are selected natively, so max_memory and white_point have
+        no effect. All other settings apply within and across groups.
+        """
+        for name, value in (("n_groups", n_groups), ("group_size", group_size)):
+            if isinstance(value, bool) or not isinstance(value, int):
+                msg = f"{name} must be an integer"
+                raise TypeError(msg)
+            if value <= 0:
+                msg = f"{name} must be positive"
+                raise ValueError(msg)
+        if not 0.0 < spread <= 1.0:
+            msg = "spread must be in (0, 1]"
+            raise ValueError(msg)
+
+        try:
+            groups = _qualpal.generate_palette_grouped(
+                n_groups=n_groups,
+                group_size=group_size,
+                spread=spread,
+                cvd=self._cvd,
+                cvd_mode=self._cvd_mode,
+                background=self._background,
+                backgrounds=self._backgrounds,
+                metric=self._metric,
+                **self._source_kwargs(),
+            )
+        except ValueError as e:
+            msg = f"Palette generation failed: {e}"
+            raise RuntimeError(msg) from e
+
+        return [Palette([Color(c) for c in group]) for group in groups]
+
+    def to_bytes(self) -> bytes:
+        """Serialize the configuration compactly.
+
+        The result is a short binary header followed by the settings as
+        compact JSON. It is also what pickling a Qualpal stores. Candidate
+        colors are not included: they are sampled, or parsed, and cached
+        natively on first use in each process. To ship precomputed
+        candidates, use :class:`qualpal.shared.SharedCandidates`.
+
+        Returns
+        -------
+        bytes
+            Serialized configuration, see :meth:`from_bytes`
+
+        Examples
+        --------
+        >>> from qualpal import Qualpal
+        >>> qp = Qualpal(palette="ColorBrewer:Set2", cvd={"deutan": 0.7})
+        >>> Qualpal.from_bytes(qp.to_bytes()).cvd
+        {'deutan': 0.7}
+        """
+        config = {
+            "colors": None if self._colors is None else list(self._colors),
+            "colorspace": self._colorspace,
+            "palette": self._palette,
+            "space": self._space,
+            "cvd": self._cvd,
+            "metric": self._metric,
+            "background": self._background,
+            "max_memory": self._max_memory,
+            "colorspace_size": self._colorspace_size,
+            "white_point": self._white_point,
+            "backgrounds": self._backgrounds,
+            "cvd_mode": self._cvd_mode,
+        }
+        payload = json.dumps(config, separators=(",", ":")).encode()
+        return _STATE_HEADER.pack(_STATE_MAGIC, _STATE_VERSION) + payload
+
+    @classmethod
+    def from_bytes(cls, data: bytes | bytearray | memoryview) -> Qualpal:
+        """Restore a Qualpal serialized with :meth:`to_bytes`.
+
+        Parameters
+        ----------
+        data : bytes | bytearray | memoryview
+            Output of :meth:`to_bytes`
+
+        Returns
+        -------
+        Qualpal
+            Generator with the serialized configuration
+
+        Raises
+        ------
+        ValueError
+            If ``data`` does not hold a serialized configuration, or a
+            setting in it is invalid
+        """
+        qp = cls.__new__(cls)
+        qp.__setstate__(bytes(data))
+        return qp
+
+    def __getstate__(self) -> bytes:
+        """Return the state for pickling, see :meth:`to_bytes`."""
+        return self.to_bytes()
+
+    def __setstate__(self, state: bytes) -> None:
+        """Restore the state written by :meth:`__getstate__`.
+
+        The settings go through the same validation as in ``__init__``.
+        """
+        header = _STATE_HEADER.size
+        if len(state) < header:
+            msg = "Data does not hold a serialized Qualpal"
+            raise ValueError(msg)
+        magic, version = _STATE_HEADER.unpack_from(state)
+        if magic != _STATE_MAGIC:
+            msg = "Data does not hold a serialized Qualpal"
+            raise ValueError(msg)
+        if version != _STATE_VERSION:
+            msg = f"Unsupported Qualpal format version {version}"
+            raise ValueError(msg)
+        config = json.loads(state[header:])
+        if config["colorspace"] is not None:
+            config["colorspace"] = {
+                k: tuple(v) for k, v in config["colorspace"].items()
+            }
+        Qualpal.__init__(self, **config)
+
+    def _source_kwargs(self) -> dict[str, object]:
+        """Arguments describing the input source, for the C++ functions."""
+        if self._colors is not None:
+            return {"colors": list(self._colors)}
+        if self._palette is not None:
+            return {"palette_name": self._palette}
+        if self._colorspace is None:
+            msg = "No input source available for generation"
+            raise RuntimeError(msg)
+        if self._space == "hsl":
+            c_key = "s"  # saturation -> chroma
+        elif self._space in ("lchab", "oklch"):
+            c_key = "c"
+        else:
+            msg = f"Unsupported color space: {self._space}"
+            raise RuntimeError(msg)
+        return {
+            "h_range": list(self._colorspace["h"]),
+            "c_range": list(self._colorspace[c_key]),
+            "l_range": list(self._colorspace["l"]),
+            "space": self._space,
+            "colorspace_size": self._colorspace_size,
+        }
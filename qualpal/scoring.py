@@ -0,0 +1,117 @@
+"""Batched palette scoring."""
+
+from __future__ import annotations
+
+from array import array
+from typing import TYPE_CHECKING
+
+import _qualpal
+
+from qualpal.color import Color
+from qualpal.palette import Palette
+from qualpal.qualpal import _validate_cvd
+
+if TYPE_CHECKING:
+    from collections.abc import Sequence
+
+
+def pack_palettes(palettes: Sequence[Palette]) -> tuple[array, bytes]:
+    """Pack palettes into the offsets and RGB buffers used by score_palettes.
+
+    Parameters
+    ----------
+    palettes : Sequence[Palette]
+        Palettes to pack
+
+    Returns
+    -------
+    tuple[array, bytes]
+        ``offsets``, an int64 array of length ``len(palettes) + 1`` where
+        palette ``p`` spans colors ``offsets[p]`` to ``offsets[p + 1]``, and
+        ``rgb``, the 8-bit RGB values of all colors, three bytes per color.
+
+    Examples
+    --------
+    >>> from qualpal import Palette
+    >>> from qualpal.scoring import pack_palettes
+    >>> offsets, rgb = pack_palettes([Palette(['#ff0000']), Palette([])])
+    >>> list(offsets), rgb
+    ([0, 1, 1], b'\\xff\\x00\\x00')
+    """
+    offsets = array("q", [0])
+    rgb = bytearray()
+    for palette in palettes:
+        rgb.extend(bytes.fromhex("".join(h[1:] for h in palette.hex())))
+        offsets.append(offsets[-1] + len(palette))
+    return offsets, bytes(rgb)
+
+
+def score_palettes(
+    offsets: object,
+    rgb: object,
+    metric: str = "ciede2000",
+    background: str | None = None,
+    cvd: dict[str, float] | None = None,
+) -> dict[str, memoryview]:
+    """Score many candidate palettes in one native pass.
+
+    The batch is given in a ragged layout: palette ``p`` consists of rows
+    ``offsets[p]`` to ``offsets[p + 1]`` of ``rgb``. Each distinct color is
+    converted to Lab, and simulated for each CVD condition, only once across
+    the whole batch, and the palettes are scored in parallel.
+
+    Parameters
+    ----------
+    offsets : buffer
+        One-dimensional int64 buffer (e.g. a NumPy array or
+        ``array.array('q')``) with ``n_palettes + 1`` non-decreasing values.
+    rgb : buffer
+        uint8 buffer of shape (n_colors, 3), or a flat buffer such as
+        ``bytes`` with three values per color.
+    metric : str
+        Distance metric: 'ciede2000' (default), 'din99d', 'cie76', 'oklab',
+        'cam16ucs', 'cie94', or 'cmc'.
+    background : str | None
+        Background color as hex string. If given, the distance from each
+        palette to the background is computed.
+    cvd : dict[str, float] | None
+        CVD conditions, mapping 'protan', 'deutan' or 'tritan' to a severity
+        in [0, 1]. If given, the minimum pairwise distance under the worst
+        condition is computed.
+
+    Returns
+    -------
+    dict[str, memoryview]
+        One float64 buffer of length ``n_palettes`` per score:
+
+        - ``'min_distance'``: minimum pairwise distance, counting duplicate
+          colors as 0 (infinity for palettes with fewer than 2 colors)
+        - ``'background_distance'``: minimum distance between any color and
+          the background (only if ``background`` is given)
+        - ``'cvd_min_distance'``: minimum pairwise distance under the worst
+          CVD condition (only if ``cvd`` is given)
+
+    Raises
+    ------
+    ValueError
+        If the buffers have the wrong type or shape, the offsets are
+        inconsistent, or any option is invalid.
+
+    Examples
+    --------
+    >>> from qualpal import Palette
+    >>> from qualpal.scoring import pack_palettes, score_palettes
+    >>> palettes = [Palette(['#ff0000', '#00ff00']), Palette(['#000000', '#ffffff'])]
+    >>> scores = score_palettes(*pack_palettes(palettes), background='#ffffff')
+    >>> scores['background_distance'].tolist()[1]
+    0.0
+    """
+    if background is not None:
+        background = Color(background).hex()
+    if cvd is not None:
+        _validate_cvd(cvd)
+
+    scores = _qualpal.score_palettes(
+        offsets, rgb, metric=metric, background=background, cvd=cvd
+    )
+    return {name: memoryview(values) for name, values in scores.items()}
@@ -0,0 +1,365 @@
+"""Candidate sets shared between processes.
+
+Generation spends most of its setup sampling candidate colors and
+converting them to Lab, once per deficiency that it considers. A
+:class:`SharedCandidates` does this once, in the publishing process, and
+stores the result in a named shared memory segment. Worker processes attach
+to the segment by name and select palettes or measure distances on it in
+place, without copying or converting the candidates again.
+"""
+
+from __future__ import annotations
+
+import os
+import sys
+from multiprocessing import resource_tracker, shared_memory
+from typing import TYPE_CHECKING, Any
+
+import _qualpal
+
+from qualpal.color import Color
+from qualpal.palette import Palette, _to_hex
+from qualpal.qualpal import Qualpal, _normalize_backgrounds, _validate_cvd
+
+if TYPE_CHECKING:
+    from collections.abc import Sequence
+
+
+class SharedCandidates:
+    """Candidate colors, with their Lab coordinates, in shared memory.
+
+    Create a set with :meth:`publish` and open it in other processes with
+    :meth:`attach`, or pass it to them directly: a pickled set attaches to
+    the same segment when it is unpickled, so it can be handed to
+    ``multiprocessing`` or ``concurrent.futures`` workers as an argument.
+
+    The set holds one view of the candidates for normal vision and one for
+    each published color vision deficiency.
+
+    Examples
+    --------
+    >>> from concurrent.futures import ProcessPoolExecutor
+    >>> from qualpal import Qualpal
+    >>> from qualpal.shared import SharedCandidates
+    >>> shared = SharedCandidates.publish(Qualpal(cvd={"deutan": 1.0}))
+    >>> shared.views
+    ['normal', 'deutan']
+    >>> with ProcessPoolExecutor() as pool:  # doctest: +SKIP
+    ...     palettes = list(pool.map(shared.generate, [3, 5, 8]))
+    >>> shared.close()
+    >>> shared.unlink()
+    """
+
+    def __init__(self, shm: shared_memory.SharedMemory) -> None:
+        """Wrap a shared memory segment that holds a candidate set.
+
+        Use :meth:`publish` or :meth:`attach` instead.
+        """
+        self._shm = shm
+        self._set: Any = _qualpal.CandidateSet(shm.buf)
+
+    @classmethod
+    def publish(
+        cls,
+        source: Qualpal | Sequence[str],
+        cvd: dict[str, float] | None = None,
+        name: str | None = None,
+    ) -> SharedCandidates:
+        """Compute a candidate set and publish it in a new segment.
+
+        Parameters
+        ----------
+        source : Qualpal | Sequence[str]
+            A configured generator, whose colors, named palette or sampled
+            colorspace become the candidates, or hex colors.
+        cvd : dict[str, float] | None, optional
+            Deficiencies to store simulated views for, as in
+            :attr:`Qualpal.cvd`. By default the generator's ``cvd``, if
+            ``source`` is a generator. Severities of 0 are left out.
+        name : str | None, optional
+            Name of the segment, by default a random one
+
+        Returns
+        -------
+        SharedCandidates
+            The published set. This process owns the segment and should
+            :meth:`unlink` it when no process needs it any more.
+
+        Raises
+        ------
+        FileExistsError
+            If a segment called ``name`` already exists
+        ValueError
+            If ``cvd`` is invalid or the candidates cannot be sampled
+        """
+        if isinstance(source, Qualpal):
+            rgb = _qualpal.candidate_colors(**source._source_kwargs())
+            if cvd is None:
+                cvd = source.cvd
+        else:
+            rgb = Palette(list(source)).array()
+        cvd = dict(cvd or {})
+        _validate_cvd(cvd)
+        cvd = {k: float(v) for k, v in cvd.items() if v > 0}
+
+        size = _qualpal.candidate_set_bytes(len(rgb), len(cvd))
+        shm = shared_memory.SharedMemory(name=name, create=True, size=size)
+        try:
+            _qualpal.write_candidate_set(shm.buf, rgb, cvd)
+        except BaseException:
+            shm.close()
+            shm.unlink()
+            raise
+        return cls(shm)
+
+    @classmethod
+    def attach(cls, name: str) -> SharedCandidates:
+        """Attach to a set published by another process.
+
+        Parameters
+        ----------
+        name : str
+            Name of the segment, see :attr:`name`
+
+        Returns
+        -------
+        SharedCandidates
+            The set, read in place. Closing it leaves the segment alone.
+
+        Raises
+        ------
+        FileNotFoundError
+            If there is no segment called ``name``
+        ValueError
+            If the segment does not hold a candidate set
+        """
+        if sys.version_info >= (3, 13):
+            shm = shared_memory.SharedMemory(name=name, track=False)
+        else:
+            shm = shared_memory.SharedMemory(name=name)
+            # Attaching registers the segment too, and the resource tracker
+            # would remove it when this process exits
+            if os.name == "posix":
+                tracked = shm._name  # type: ignore[attr-defined]
+                resource_tracker.unregister(tracked, "shared_memory")
+        try:
+            return cls(shm)
+        except BaseException:
+            shm.close()
+            raise
+
+    @classmethod
+    def from_bytes(
+        cls, data: bytes | bytearray | memoryview, name: str | None = None
+    ) -> SharedCandidates:
+        """Publish a set serialized with :meth:`to_bytes` in a new segment.
+
+        The data is copied into the segment as it is; no candidate is
+        converted or simulated again.
+
+        Parameters
+        ----------
+        data : bytes | bytearray | memoryview
+            Output of :meth:`to_bytes`
+        name : str | None, optional
+            Name of the segment, by default a random one
+
+        Returns
+        -------
+        SharedCandidates
+            The published set, owned by this process like one from
+            :meth:`publish`
+
+        Raises
+        ------
+        FileExistsError
+            If a segment called ``name`` already exists
+        ValueError
+            If ``data`` does not hold a candidate set
+        """
+        view = memoryview(data).cast("B")
+        shm = shared_memory.SharedMemory(name=name, create=True, size=len(view))
+        try:
+            shm.buf[: len(view)] = view
+            return cls(shm)
+        except BaseException:
+            shm.close()
+            shm.unlink()
+            raise
+
+    def to_bytes(self) -> bytes:
+        """Copy the set out of its segment.
+
+        Returns
+        -------
+        bytes
+            The candidates with their Lab coordinates in every view, in the
+            layout of the segment (float64 in native byte order), e.g. to
+            store them or to publish them elsewhere with :meth:`from_bytes`
+        """
+        size = _qualpal.candidate_set_bytes(len(self), len(self.views) - 1)
+        return bytes(self._shm.buf[:size])
+
+    @property
+    def name(self) -> str:
+        """Name of the shared memory segment."""
+        return self._shm.name
+
+    @property
+    def views(self) -> list[str]:
+        """Names of the views: 'normal', then each published deficiency."""
+        return list(self._set.views)
+
+    @property
+    def cvd(self) -> dict[str, float]:
+        """Published deficiencies mapped to their severities."""
+        return dict(zip(self._set.views[1:], self._set.severities[1:]))
+
+    def __len__(self) -> int:
+        """Return the number of candidate colors."""
+        return len(self._set)
+
+    def rgb(self) -> memoryview:
+        """Get the RGB values of the candidates.
+
+        Returns
+        -------
+        memoryview
+            Read-only float64 buffer of shape (n, 3), in range [0.0, 1.0],
+            that shares memory with the segment
+        """
+        return memoryview(self._set.rgb_array())
+
+    def lab(self, view: str = "normal") -> memoryview:
+        """Get the Lab coordinates of the candidates in one view.
+
+        Parameters
+        ----------
+        view : str, optional
+            Name of the view, by default 'normal'
+
+        Returns
+        -------
+        memoryview
+            Read-only float64 buffer of shape (n, 3) that shares memory with
+            the segment
+
+        Raises
+        ------
+        ValueError
+            If there is no such view
+        """
+        return memoryview(self._set.lab_array(view))
+
+    def generate(
+        self,
+        n: int,
+        metric: str = "ciede2000",
+        views: Sequence[str] | None = None,
+        background: str | None = None,
+        backgrounds: dict[str, float] | None = None,
+    ) -> Palette:
+        """Select a palette of distinct colors from the candidates.
+
+        Colors are selected natively, as with ``cvd_mode='worst_case'`` of
+        :class:`Qualpal`: every pair counts with its smallest distance over
+        ``views``.
+
+        Parameters
+        ----------
+        n : int
+            Number of colors
+        metric : str, optional
+            Color difference metric, by default 'ciede2000'
+        views : Sequence[str] | None, optional
+            Views to keep the colors distinct in, by default all of them
+        background : str | None, optional
+            Background color to stand out from, with weight 1
+        backgrounds : dict[str, float] | None, optional
+            Background colors mapped to positive weights, as in
+            :attr:`Qualpal.backgrounds`
+
+        Returns
+        -------
+        Palette
+            The selected colors
+
+        Raises
+        ------
+        TypeError
+            If n is not an integer
+        ValueError
+            If n is not positive, a view or metric is unknown, or there are
+            fewer than n candidates
+        """
+        if not isinstance(n, int):
+            msg = "n must be an integer"
+            raise TypeError(msg)
+        if n <= 0:
+            msg = "n must be positive"
+            raise ValueError(msg)
+        weights = _normalize_backgrounds(dict(backgrounds or {}))
+        if background is not None:
+            weights.setdefault(background.lower(), 1.0)
+        hex_colors = self._set.select(n, metric, list(views or []), weights)
+        return Palette([Color(c) for c in hex_colors])
+
+    def distances(
+        self, color: Color | str, metric: str = "ciede2000", view: str = "normal"
+    ) -> memoryview:
+        """Get the distance from a color to every candidate.
+
+        Parameters
+        ----------
+        color : Color | str
+            Query color; it is simulated like the candidates of ``view``
+        metric : str, optional
+            Color difference metric, by default 'ciede2000'
+        view : str, optional
+            Name of the view, by default 'normal'
+
+        Returns
+        -------
+        memoryview
+            Float64 buffer of length n
+
+        Raises
+        ------
+        ValueError
+            If the view or metric is unknown
+        TypeError
+            If color is neither a Color nor a string
+        """
+        return memoryview(self._set.distances(_to_hex(color), metric, view))
+
+    def close(self) -> None:
+        """Detach from the segment.
+
+        Buffers returned by :meth:`rgb` and :meth:`lab` refer to the
+        segment and must be released first.
+        """
+        self._set = None
+        self._shm.close()
+
+    def unlink(self) -> None:
+        """Remove the segment once every process has closed it."""
+        self._shm.unlink()
+
+    def __enter__(self) -> SharedCandidates:
+        """Return the set itself."""
+        return self
+
+    def __exit__(self, *args: object) -> None:
+        """Close the set."""
+        self.close()
+
+    def __reduce__(self) -> tuple[Any, tuple[str]]:
+        """Pickle the set as a reference to its segment."""
+        return (SharedCandidates.attach, (self.name,))
+
+    def __repr__(self) -> str:
+        """Return a short description of the set."""
+        return (
+            f"SharedCandidates(name={self.name!r}, n={len(self)}, "
+            f"views={self.views})"
+        )
@@ -0,0 +1,85 @@
+/**
+ * @file array.h
+ * @brief Read-only strided arrays exposed to Python via the buffer protocol
+ *
+ * An Array either owns its data or is a view into storage owned by another
+ * native object (such as a palette), in which case it keeps that storage
+ * alive for as long as the array, or any memoryview of it, exists.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+template<typename T>
+class Array
+{
+public:
+  /**
+   * @brief Create a C-contiguous array that owns its data
+   * @param data Elements in row-major order
+   * @param shape Extent of each dimension
+   */
+  Array(std::vector<T> data, std::vector<std::ptrdiff_t> shape)
+    : shape_(std::move(shape))
+  {
+    auto owned = std::make_shared<std::vector<T>>(std::move(data));
+    ptr_ = owned->data();
+    owner_ = std::move(owned);
+    strides_.resize(shape_.size());
+    std::ptrdiff_t stride = 1;
+    for (std::size_t k = shape_.size(); k-- > 0;) {
+      strides_[k] = stride;
+      stride *= shape_[k];
+    }
+  }
+
+  /**
+   * @brief Create a strided view into storage kept alive by @p owner
+   * @param owner Shared handle to the storage that @p ptr points into
+   * @param ptr Pointer to the first element of the view
+   * @param shape Extent of each dimension
+   * @param strides Stride of each dimension, in elements
+   */
+  Array(std::shared_ptr<const void> owner,
+        const T* ptr,
+        std::vector<std::ptrdiff_t> shape,
+        std::vector<std::ptrdiff_t> strides)
+    : owner_(std::move(owner))
+    , ptr_(ptr)
+    , shape_(std::move(shape))
+    , strides_(std::move(strides))
+  {
+  }
+
+  const T* data() const { return ptr_; }
+
+  /// Shared handle to the storage that data() points into
+  const std::shared_ptr<const void>& owner() const { return owner_; }
+
+  std::size_t ndim() const { return shape_.size(); }
+
+  const std::vector<std::ptrdiff_t>& shape() const { return shape_; }
+
+  /// Strides in elements
+  const std::vector<std::ptrdiff_t>& strides() const { return strides_; }
+
+  /// Strides in bytes, as required by the buffer protocol
+  std::vector<std::ptrdiff_t> byte_strides() const
+  {
+    std::vector<std::ptrdiff_t> out(strides_.size());
+    for (std::size_t k = 0; k < strides_.size(); ++k) {
+      out[k] = strides_[k] * static_cast<std::ptrdiff_t>(sizeof(T));
+    }
+    return out;
+  }
+
+private:
+  std::shared_ptr<const void> owner_;
+  const T* ptr_;
+  std::vector<std::ptrdiff_t> shape_;
+  std::vector<std::ptrdiff_t> strides_;
+};
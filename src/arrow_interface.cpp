@@ -0,0 +1,350 @@
+/**
+ * @file arrow_interface.cpp
+ * @brief Implementation of Arrow C data interface import and export
+ */
+
+#include "arrow_interface.h"
+
+#include "color_conversions.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+template<typename T>
+const char*
+arrow_format();
+
+template<>
+const char*
+arrow_format<double>()
+{
+  return "g";
+}
+
+template<>
+const char*
+arrow_format<std::int64_t>()
+{
+  return "l";
+}
+
+template<>
+const char*
+arrow_format<std::uint8_t>()
+{
+  return "C";
+}
+
+/// Throw if any of the @p length elements of @p array from physical index
+/// @p first on is null
+void
+check_no_nulls(const ArrowArray& array, std::int64_t first, std::int64_t length)
+{
+  if (array.null_count == 0 || array.n_buffers < 1 ||
+      array.buffers[0] == nullptr) {
+    return;
+  }
+  const auto* validity = static_cast<const std::uint8_t*>(array.buffers[0]);
+  for (std::int64_t i = first; i < first + length; ++i) {
+    if (!((validity[i / 8] >> (i % 8)) & 1)) {
+      throw std::invalid_argument("Arrow color columns must not contain nulls");
+    }
+  }
+}
+
+/// Throw if any element of @p array is null
+void
+check_no_nulls(const ArrowArray& array)
+{
+  check_no_nulls(array, array.offset, array.length);
+}
+
+template<typename Offset>
+void
+import_hex_strings(const ArrowArray& array, std::vector<std::uint8_t>& rgb8)
+{
+  const auto* offsets = static_cast<const Offset*>(array.buffers[1]);
+  const auto* chars = static_cast<const char*>(array.buffers[2]);
+  for (std::int64_t i = array.offset; i < array.offset + array.length; ++i) {
+    const auto length = static_cast<std::size_t>(offsets[i + 1] - offsets[i]);
+    const std::string hex(chars + offsets[i], length);
+    for (const double c : hex_to_rgb(hex)) {
+      rgb8.push_back(static_cast<std::uint8_t>(std::lround(c * 255.0)));
+    }
+  }
+}
+
+template<typename Index>
+void
+import_dictionary_indices(const ArrowArray& array,
+                          const std::vector<std::uint8_t>& dictionary,
+                          std::vector<std::uint8_t>& rgb8)
+{
+  const auto* indices = static_cast<const Index*>(array.buffers[1]);
+  const auto n = static_cast<std::int64_t>(dictionary.size() / 3);
+  for (std::int64_t i = array.offset; i < array.offset + array.length; ++i) {
+    const auto k = static_cast<std::int64_t>(indices[i]);
+    if (k < 0 || k >= n) {
+      throw std::invalid_argument("Arrow dictionary index out of range");
+    }
+    rgb8.insert(rgb8.end(), &dictionary[3 * k], &dictionary[3 * k + 3]);
+  }
+}
+
+struct SchemaData
+{
+  std::string format;
+  std::string name;
+  std::vector<ArrowSchema*> children;
+};
+
+void
+release_schema(ArrowSchema* schema)
+{
+  auto* data = static_cast<SchemaData*>(schema->private_data);
+  for (ArrowSchema* child : data->children) {
+    if (child->release != nullptr) {
+      child->release(child);
+    }
+    delete child;
+  }
+  delete data;
+  schema->release = nullptr;
+}
+
+/// Fill @p out with a schema that owns @p children
+void
+fill_schema(ArrowSchema* out,
+            std::string format,
+            std::string name,
+            std::vector<ArrowSchema*> children)
+{
+  auto* data = new SchemaData{ std::move(format), std::move(name), {} };
+  data->children = std::move(children);
+  out->format = data->format.c_str();
+  out->name = data->name.c_str();
+  out->metadata = nullptr;
+  out->flags = 0;
+  out->n_children = static_cast<std::int64_t>(data->children.size());
+  out->children = data->children.empty() ? nullptr : data->children.data();
+  out->dictionary = nullptr;
+  out->release = release_schema;
+  out->private_data = data;
+}
+
+struct ArrayData
+{
+  std::shared_ptr<const void> owner;
+  std::vector<const void*> buffers;
+  std::vector<ArrowArray*> children;
+};
+
+void
+release_array(ArrowArray* array)
+{
+  auto* data = static_cast<ArrayData*>(array->private_data);
+  for (ArrowArray* child : data->children) {
+    if (child->release != nullptr) {
+      child->release(child);
+    }
+    delete child;
+  }
+  delete data;
+  array->release = nullptr;
+}
+
+/// Fill @p out with a non-null array whose buffers are kept alive by
+/// @p owner
+void
+fill_array(ArrowArray* out,
+           std::int64_t length,
+           std::shared_ptr<const void> owner,
+           std::vector<const void*> buffers,
+           std::vector<ArrowArray*> children)
+{
+  auto* data = new ArrayData{ std::move(owner), std::move(buffers), {} };
+  data->children = std::move(children);
+  out->length = length;
+  out->null_count = 0;
+  out->offset = 0;
+  out->n_buffers = static_cast<std::int64_t>(data->buffers.size());
+  out->n_children = static_cast<std::int64_t>(data->children.size());
+  out->buffers = data->buffers.data();
+  out->children = data->children.empty() ? nullptr : data->children.data();
+  out->dictionary = nullptr;
+  out->release = release_array;
+  out->private_data = data;
+}
+
+} // namespace
+
+void
+import_arrow_colors(const ArrowSchema& schema,
+                    const ArrowArray& array,
+                    std::vector<std::uint8_t>& rgb8)
+{
+  check_no_nulls(array);
+  const std::string format = schema.format;
+
+  if (schema.dictionary != nullptr) {
+    std::vector<std::uint8_t> dictionary;
+    import_arrow_colors(*schema.dictionary, *array.dictionary, dictionary);
+    if (format == "c") {
+      import_dictionary_indices<std::int8_t>(array, dictionary, rgb8);
+    } else if (format == "s") {
+      import_dictionary_indices<std::int16_t>(array, dictionary, rgb8);
+    } else if (format == "i") {
+      import_dictionary_indices<std::int32_t>(array, dictionary, rgb8);
+    } else if (format == "l") {
+      import_dictionary_indices<std::int64_t>(array, dictionary, rgb8);
+    } else {
+      throw std::invalid_argument("Unsupported Arrow dictionary index type: " +
+                                  format);
+    }
+  } else if (format == "u") {
+    import_hex_strings<std::int32_t>(array, rgb8);
+  } else if (format == "U") {
+    import_hex_strings<std::int64_t>(array, rgb8);
+  } else if (format == "+w:3" && schema.n_children == 1 &&
+             std::strcmp(schema.children[0]->format, "C") == 0) {
+    // child.offset counts channels and array.offset counts colors
+    const ArrowArray& child = *array.children[0];
+    const std::int64_t start = child.offset + 3 * array.offset;
+    check_no_nulls(child, start, 3 * array.length);
+    const auto* values = static_cast<const std::uint8_t*>(child.buffers[1]);
+    rgb8.insert(rgb8.end(), values + start, values + start + 3 * array.length);
+  } else {
+    throw std::invalid_argument(
+      "Unsupported Arrow color type: " + format +
+      ". Must be utf8 or large utf8 hex strings, or "
+      "fixed_size_list<uint8, 3>");
+  }
+}
+
+std::vector<std::uint8_t>
+import_arrow_color_stream(ArrowArrayStream& stream)
+{
+  const auto fail = [&stream]() {
+    const char* message = stream.get_last_error(&stream);
+    throw std::runtime_error(message != nullptr ? message
+                                                : "Arrow stream error");
+  };
+
+  ArrowSchema schema;
+  if (stream.get_schema(&stream, &schema) != 0) {
+    fail();
+  }
+  const std::unique_ptr<ArrowSchema, void (*)(ArrowSchema*)> schema_guard(
+    &schema, [](ArrowSchema* s) { s->release(s); });
+
+  std::vector<std::uint8_t> rgb8;
+  while (true) {
+    ArrowArray array;
+    if (stream.get_next(&stream, &array) != 0) {
+      fail();
+    }
+    if (array.release == nullptr) {
+      break;
+    }
+    const std::unique_ptr<ArrowArray, void (*)(ArrowArray*)> array_guard(
+      &array, [](ArrowArray* a) { a->release(a); });
+    import_arrow_colors(schema, array, rgb8);
+  }
+  return rgb8;
+}
+
+template<typename T>
+ArrowColumn::ArrowColumn(const Array<T>& values)
+{
+  if (values.ndim() < 1 || values.ndim() > 2) {
+    throw std::invalid_argument(
+      "Only one- and two-dimensional arrays can be exported to Arrow");
+  }
+  length_ = values.shape()[0];
+  if (values.ndim() == 2) {
+    width_ = values.shape()[1];
+    format_ = "+w:" + std::to_string(width_);
+    child_format_ = arrow_format<T>();
+  } else {
+    format_ = arrow_format<T>();
+  }
+
+  const auto& strides = values.strides();
+  const bool contiguous =
+    (length_ <= 1 || strides[0] == width_) &&
+    (values.ndim() == 1 || width_ <= 1 || strides[1] == 1);
+  if (contiguous) {
+    values_ = values.data();
+    owner_ = values.owner();
+    return;
+  }
+
+  auto copy = std::make_shared<std::vector<T>>();
+  copy->reserve(static_cast<std::size_t>(length_ * width_));
+  const std::ptrdiff_t inner = values.ndim() == 2 ? strides[1] : 0;
+  for (std::int64_t i = 0; i < length_; ++i) {
+    for (std::int64_t k = 0; k < width_; ++k) {
+      copy->push_back(values.data()[i * strides[0] + k * inner]);
+    }
+  }
+  values_ = copy->data();
+  owner_ = std::move(copy);
+}
+
+template ArrowColumn::ArrowColumn(const Array<double>&);
+template ArrowColumn::ArrowColumn(const Array<std::int64_t>&);
+template ArrowColumn::ArrowColumn(const Array<std::uint8_t>&);
+
+ArrowColumn::ArrowColumn(const std::vector<std::string>& strings)
+  : format_("u")
+  , length_(static_cast<std::int64_t>(strings.size()))
+{
+  struct Utf8
+  {
+    std::vector<std::int32_t> offsets;
+    std::string chars;
+  };
+  auto data = std::make_shared<Utf8>();
+  data->offsets.reserve(strings.size() + 1);
+  data->offsets.push_back(0);
+  for (const auto& s : strings) {
+    if (data->chars.size() + s.size() >
+        static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+      throw std::length_error("Strings too long for an Arrow utf8 column");
+    }
+    data->chars += s;
+    data->offsets.push_back(static_cast<std::int32_t>(data->chars.size()));
+  }
+  values_ = data->chars.data();
+  offsets_ = data->offsets.data();
+  owner_ = std::move(data);
+}
+
+void
+ArrowColumn::export_schema(ArrowSchema* out) const
+{
+  std::vector<ArrowSchema*> children;
+  if (!child_format_.empty()) {
+    children.push_back(new ArrowSchema);
+    fill_schema(children.back(), child_format_, "item", {});
+  }
+  fill_schema(out, format_, "", std::move(children));
+}
+
+void
+ArrowColumn::export_array(ArrowArray* out) const
+{
+  if (offsets_ != nullptr) {
+    fill_array(out, length_, owner_, { nullptr, offsets_, values_ }, {});
+  } else if (!child_format_.empty()) {
+    auto* child = new ArrowArray;
+    fill_array(child, length_ * width_, owner_, { nullptr, values_ }, {});
+    fill_array(out, length_, owner_, { nullptr }, { child });
+  } else {
+    fill_array(out, length_, owner_, { nullptr, values_ }, {});
+  }
+}
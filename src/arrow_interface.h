@@ -0,0 +1,165 @@
+/**
+ * @file arrow_interface.h
+ * @brief Color columns exchanged through the Arrow C data interface
+ *
+ * The Arrow C data interface is a small ABI of plain C structs, so columns
+ * can be exchanged with any Arrow implementation (pyarrow, polars, DuckDB,
+ * ...) without linking against one. The struct definitions below are
+ * reproduced from the specification, guarded so that they coexist with
+ * other copies.
+ *
+ * Color columns are imported from utf8 or large utf8 arrays of hex strings,
+ * or from fixed_size_list<uint8, 3> arrays of RGB bytes. Columns are
+ * exported as utf8, primitive or fixed_size_list arrays whose buffers stay
+ * owned by the producing object until the consumer releases them.
+ */
+
+#pragma once
+
+#include "array.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+  struct ArrowSchema
+  {
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+  };
+
+  struct ArrowArray
+  {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+  };
+
+#endif // ARROW_C_DATA_INTERFACE
+
+#ifndef ARROW_C_STREAM_INTERFACE
+#define ARROW_C_STREAM_INTERFACE
+
+  struct ArrowArrayStream
+  {
+    // Callbacks providing stream functionality
+    int (*get_schema)(struct ArrowArrayStream*, struct ArrowSchema* out);
+    int (*get_next)(struct ArrowArrayStream*, struct ArrowArray* out);
+    const char* (*get_last_error)(struct ArrowArrayStream*);
+
+    // Release callback
+    void (*release)(struct ArrowArrayStream*);
+
+    // Opaque producer-specific data
+    void* private_data;
+  };
+
+#endif // ARROW_C_STREAM_INTERFACE
+}
+
+/**
+ * @brief Append the colors of an Arrow array to a buffer of RGB bytes
+ * @param schema Type of @p array: utf8 ("u") or large utf8 ("U") hex
+ * strings, or fixed_size_list<uint8, 3> ("+w:3" with a "C" child)
+ * @param array Array data; not released
+ * @param rgb8 Output: three bytes per color are appended
+ * @throws std::invalid_argument If the type is unsupported, the array
+ * contains nulls, or a string is not a hex color
+ */
+void
+import_arrow_colors(const ArrowSchema& schema,
+                    const ArrowArray& array,
+                    std::vector<std::uint8_t>& rgb8);
+
+/**
+ * @brief Read every color of an Arrow array stream
+ * @param stream Stream of arrays of a type accepted by
+ * import_arrow_colors(); each array is released after it is read, the stream
+ * itself is not
+ * @return Three RGB bytes per color, chunks concatenated
+ * @throws std::runtime_error If the stream reports an error
+ */
+std::vector<std::uint8_t>
+import_arrow_color_stream(ArrowArrayStream& stream);
+
+/**
+ * @brief Column that can be exported through the Arrow C data interface
+ *
+ * Exported arrays share the column's buffers and keep them alive until
+ * released, so a column may be exported any number of times, and may be
+ * destroyed while exported arrays are still in use.
+ */
+class ArrowColumn
+{
+public:
+  /**
+   * @brief Export an array as a column
+   * @param values One-dimensional array, exported as a primitive column, or
+   * n x w array, exported as fixed_size_list<T, w>
+   *
+   * C-contiguous arrays are exported without copying.
+   */
+  template<typename T>
+  explicit ArrowColumn(const Array<T>& values);
+
+  /// Export strings as a utf8 column
+  explicit ArrowColumn(const std::vector<std::string>& strings);
+
+  /// Number of elements (rows) in the column
+  std::int64_t length() const { return length_; }
+
+  /// Arrow format string of the column type
+  const std::string& format() const { return format_; }
+
+  /// Fill @p out with the column type; release it with out->release
+  void export_schema(ArrowSchema* out) const;
+
+  /// Fill @p out with the column data; release it with out->release
+  void export_array(ArrowArray* out) const;
+
+private:
+  std::string format_;
+  /// Format of the values of a fixed_size_list column, otherwise empty
+  std::string child_format_;
+  std::int64_t width_ = 1;
+  std::int64_t length_ = 0;
+  /// Values (character data for utf8)
+  const void* values_ = nullptr;
+  /// Offsets into values_ for utf8, otherwise null
+  const std::int32_t* offsets_ = nullptr;
+  /// Keeps values_ and offsets_ alive
+  std::shared_ptr<const void> owner_;
+};
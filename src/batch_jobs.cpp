@@ -0,0 +1,414 @@
+/**
+ * @file batch_jobs.cpp
+ * @brief Implementation of JSON palette jobs
+ */
+
+#include "batch_jobs.h"
+
+#include "color_conversions.h"
+#include "color_distance.h"
+#include "cvd_distance.h"
+#include "palette_data.h"
+#include "palette_generation.h"
+#include "palette_scoring.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+std::optional<double>
+get_number(const Json& job, std::string_view key)
+{
+  const Json* value = job.find(key);
+  if (value == nullptr || value->is_null()) {
+    return std::nullopt;
+  }
+  if (!value->is_number()) {
+    throw std::invalid_argument("'" + std::string(key) +
+                                "' must be a number");
+  }
+  return value->as_number();
+}
+
+/// Non-negative integer parameter
+std::optional<std::size_t>
+get_count(const Json& job, std::string_view key)
+{
+  const auto value = get_number(job, key);
+  if (!value.has_value()) {
+    return std::nullopt;
+  }
+  if (!(*value >= 0) || *value != std::floor(*value) || *value > 1e15) {
+    throw std::invalid_argument("'" + std::string(key) +
+                                "' must be a non-negative integer");
+  }
+  return static_cast<std::size_t>(*value);
+}
+
+std::size_t
+require_count(const Json& job, std::string_view key)
+{
+  const auto value = get_count(job, key);
+  if (!value.has_value()) {
+    throw std::invalid_argument("Missing '" + std::string(key) + "'");
+  }
+  return *value;
+}
+
+std::optional<std::string>
+get_string(const Json& job, std::string_view key)
+{
+  const Json* value = job.find(key);
+  if (value == nullptr || value->is_null()) {
+    return std::nullopt;
+  }
+  if (!value->is_string()) {
+    throw std::invalid_argument("'" + std::string(key) +
+                                "' must be a string");
+  }
+  return value->as_string();
+}
+
+std::optional<std::vector<double>>
+get_numbers(const Json& job, std::string_view key)
+{
+  const Json* value = job.find(key);
+  if (value == nullptr || value->is_null()) {
+    return std::nullopt;
+  }
+  if (!value->is_array()) {
+    throw std::invalid_argument("'" + std::string(key) +
+                                "' must be an array of numbers");
+  }
+  std::vector<double> out;
+  for (const auto& item : value->as_array()) {
+    if (!item.is_number()) {
+      throw std::invalid_argument("'" + std::string(key) +
+                                  "' must be an array of numbers");
+    }
+    out.push_back(item.as_number());
+  }
+  return out;
+}
+
+/// Range of a colorspace dimension: a minimum and a maximum
+std::optional<std::vector<double>>
+get_range(const Json& job, std::string_view key)
+{
+  auto range = get_numbers(job, key);
+  if (range.has_value() &&
+      (range->size() != 2 || !std::isfinite((*range)[0]) ||
+       !std::isfinite((*range)[1]))) {
+    throw std::invalid_argument("'" + std::string(key) +
+                                "' must be an array of two finite numbers");
+  }
+  return range;
+}
+
+std::optional<std::vector<std::string>>
+get_strings(const Json& job, std::string_view key)
+{
+  const Json* value = job.find(key);
+  if (value == nullptr || value->is_null()) {
+    return std::nullopt;
+  }
+  if (!value->is_array()) {
+    throw std::invalid_argument("'" + std::string(key) +
+                                "' must be an array of strings");
+  }
+  std::vector<std::string> out;
+  for (const auto& item : value->as_array()) {
+    if (!item.is_string()) {
+      throw std::invalid_argument("'" + std::string(key) +
+                                  "' must be an array of strings");
+    }
+    out.push_back(item.as_string());
+  }
+  return out;
+}
+
+/// Object of numbers, such as CVD severities or background weights
+std::optional<std::map<std::string, double>>
+get_weights(const Json& job, std::string_view key)
+{
+  const Json* value = job.find(key);
+  if (value == nullptr || value->is_null()) {
+    return std::nullopt;
+  }
+  if (!value->is_object()) {
+    throw std::invalid_argument("'" + std::string(key) +
+                                "' must be an object of numbers");
+  }
+  std::map<std::string, double> out;
+  for (const auto& [name, item] : value->as_object()) {
+    if (!item.is_number()) {
+      throw std::invalid_argument("'" + std::string(key) +
+                                  "' must be an object of numbers");
+    }
+    out[name] = item.as_number();
+  }
+  return out;
+}
+
+/// CVD types mapped to severities, checked before any simulation runs
+std::optional<std::map<std::string, double>>
+get_cvd(const Json& job)
+{
+  auto cvd = get_weights(job, "cvd");
+  if (cvd.has_value()) {
+    validate_cvd_conditions(*cvd);
+  }
+  return cvd;
+}
+
+std::vector<std::string>
+require_colors(const Json& job)
+{
+  auto colors = get_strings(job, "colors");
+  if (!colors.has_value()) {
+    throw std::invalid_argument("Missing 'colors'");
+  }
+  return std::move(*colors);
+}
+
+Json
+strings_to_json(const std::vector<std::string>& values)
+{
+  return Json::Array(values.begin(), values.end());
+}
+
+Json
+numbers_to_json(const std::vector<double>& values)
+{
+  return Json::Array(values.begin(), values.end());
+}
+
+/// Rows of a row-major n x n matrix
+Json
+matrix_to_json(const double* data, std::size_t n)
+{
+  Json::Array rows;
+  rows.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    rows.emplace_back(Json::Array(data + i * n, data + (i + 1) * n));
+  }
+  return rows;
+}
+
+Json
+run_generate(const Json& job)
+{
+  const auto palette = generate_palette_unified(
+    static_cast<int>(require_count(job, "n")),
+    get_range(job, "h_range"),
+    get_range(job, "c_range"),
+    get_range(job, "l_range"),
+    get_strings(job, "colors"),
+    get_string(job, "palette"),
+    get_cvd(job),
+    get_string(job, "background"),
+    get_string(job, "metric"),
+    get_number(job, "max_memory"),
+    get_string(job, "white_point"),
+    get_string(job, "space"),
+    get_count(job, "colorspace_size"),
+    get_weights(job, "backgrounds"),
+    get_string(job, "cvd_mode"));
+  return Json::Object{ { "palette", strings_to_json(palette) } };
+}
+
+Json
+run_generate_grouped(const Json& job)
+{
+  const auto groups = generate_palette_grouped(
+    static_cast<int>(require_count(job, "n_groups")),
+    static_cast<int>(require_count(job, "group_size")),
+    get_number(job, "spread").value_or(0.5),
+    get_range(job, "h_range"),
+    get_range(job, "c_range"),
+    get_range(job, "l_range"),
+    get_strings(job, "colors"),
+    get_string(job, "palette"),
+    get_cvd(job),
+    get_string(job, "background"),
+    get_string(job, "metric"),
+    get_string(job, "space"),
+    get_count(job, "colorspace_size"),
+    get_weights(job, "backgrounds"),
+    get_string(job, "cvd_mode"));
+
+  Json::Array out;
+  for (const auto& group : groups) {
+    out.push_back(strings_to_json(group));
+  }
+  return Json::Object{ { "groups", std::move(out) } };
+}
+
+Json
+run_analyze(const Json& job)
+{
+  const PaletteData palette(require_colors(job));
+  const std::string metric = get_string(job, "metric").value_or("ciede2000");
+  const auto background = get_string(job, "background");
+  const auto cvd = get_cvd(job).value_or(std::map<std::string, double>{});
+
+  // The palette-level scores come from the batch scorer, as one palette
+  const auto rgb = palette.rgb8();
+  const std::int64_t offsets[] = { 0,
+                                   static_cast<std::int64_t>(palette.size()) };
+  const auto scores = score_palettes(offsets,
+                                     1,
+                                     rgb.data(),
+                                     palette.size(),
+                                     parse_metric(metric),
+                                     background,
+                                     cvd);
+
+  Json::Array nearest;
+  for (const auto j : palette.nearest_neighbors(metric)) {
+    nearest.emplace_back(static_cast<double>(j));
+  }
+  Json::Object out = {
+    { "min_distance", scores.min_distance[0] },
+    { "min_distances", numbers_to_json(palette.min_distances(metric)) },
+    { "nearest", std::move(nearest) },
+  };
+  if (!scores.background_distance.empty()) {
+    out.emplace_back("background_distance", scores.background_distance[0]);
+  }
+  if (!scores.cvd_min_distance.empty()) {
+    out.emplace_back("cvd_min_distance", scores.cvd_min_distance[0]);
+  }
+  return out;
+}
+
+Json
+run_distance(const Json& job)
+{
+  const PaletteData palette(require_colors(job));
+  const std::string metric = get_string(job, "metric").value_or("ciede2000");
+  const auto cvd = get_cvd(job);
+
+  if (!cvd.has_value()) {
+    const auto matrix = palette.distance_matrix(metric);
+    return Json::Object{ { "matrix",
+                           matrix_to_json(matrix.data(), palette.size()) } };
+  }
+
+  std::vector<CvdCondition> conditions;
+  for (const auto& [cvd_type, severity] : *cvd) {
+    conditions.push_back({ cvd_type, severity, 1.0 });
+  }
+  const auto matrix = palette.cvd_distance_matrix(
+    metric, conditions, 1.0, get_string(job, "reduction").value_or("min"));
+  return Json::Object{ { "matrix",
+                         matrix_to_json(matrix.data(), palette.size()) } };
+}
+
+} // namespace
+
+Json
+run_job(const Json& job)
+{
+  if (!job.is_object()) {
+    throw std::invalid_argument("A job must be a JSON object");
+  }
+  const auto type = get_string(job, "type");
+  if (!type.has_value()) {
+    throw std::invalid_argument("Missing 'type'");
+  }
+  if (*type == "generate") {
+    return run_generate(job);
+  }
+  if (*type == "generate_grouped") {
+    return run_generate_grouped(job);
+  }
+  if (*type == "analyze") {
+    return run_analyze(job);
+  }
+  if (*type == "distance") {
+    return run_distance(job);
+  }
+  if (*type == "get_palette") {
+    const auto name = get_string(job, "name");
+    if (!name.has_value()) {
+      throw std::invalid_argument("Missing 'name'");
+    }
+    return Json::Object{ { "palette", strings_to_json(get_palette(*name)) } };
+  }
+  throw std::invalid_argument("Unknown job type: " + *type +
+                              ". Must be 'generate', 'generate_grouped', "
+                              "'analyze', 'distance' or 'get_palette'");
+}
+
+Json
+run_job_output(const Json& job, bool timings, bool& ok, ResultCache* results)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  Json id;
+  if (const Json* value = job.find("id")) {
+    id = *value;
+  }
+
+  Json::Object out;
+  try {
+    // Jobs are deterministic, so a job without its id identifies its result
+    std::string key;
+    std::optional<Json> result;
+    if (results != nullptr && job.is_object()) {
+      Json::Object fields;
+      for (const auto& [name, value] : job.as_object()) {
+        if (name != "id") {
+          fields.emplace_back(name, value);
+        }
+      }
+      key = Json(std::move(fields)).dump();
+      result = results->get(key);
+    }
+    if (!result.has_value()) {
+      result = run_job(job);
+      // Large results, such as distance matrices of many colors, are not
+      // kept, so the cache is bounded in bytes as well as in entries
+      if (results != nullptr && result->dump().size() <= max_cached_result) {
+        results->put(key, *result);
+      }
+    }
+    out = { { "id", std::move(id) }, { "result", std::move(*result) } };
+    ok = true;
+  } catch (const std::exception& e) {
+    out = { { "id", std::move(id) }, { "error", e.what() } };
+    ok = false;
+  }
+
+  if (timings) {
+    const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+    out.emplace_back("time_ms", elapsed.count());
+  }
+  return out;
+}
+
+std::string
+run_job_line(std::string_view line, bool timings, bool& ok)
+{
+  Json job;
+  try {
+    job = Json::parse(line);
+  } catch (const std::exception& e) {
+    ok = false;
+    Json::Object out = { { "id", Json() }, { "error", e.what() } };
+    if (timings) {
+      out.emplace_back("time_ms", 0.0);
+    }
+    return Json(std::move(out)).dump();
+  }
+  return run_job_output(job, timings, ok).dump();
+}
@@ -0,0 +1,85 @@
+/**
+ * @file batch_jobs.h
+ * @brief Palette jobs described as JSON, for the command-line tool
+ *
+ * A job is a JSON object with a "type" and the parameters of that type,
+ * named as in the Python bindings:
+ *
+ * - "generate": generate_palette_unified() with "n" and any of "h_range",
+ *   "c_range", "l_range", "colors", "palette", "cvd", "background",
+ *   "metric", "max_memory", "white_point", "space", "colorspace_size",
+ *   "backgrounds" and "cvd_mode". The result holds the "palette".
+ * - "generate_grouped": generate_palette_grouped() with "n_groups",
+ *   "group_size", "spread" (default 0.5) and the generation parameters
+ *   above, except "max_memory" and "white_point". The result holds the
+ *   "groups".
+ * - "analyze": scores of the "colors" under "metric", with an optional
+ *   "background" and "cvd" conditions. The result holds "min_distance",
+ *   "min_distances" and "nearest", plus "background_distance" and
+ *   "cvd_min_distance" when requested.
+ * - "distance": the "matrix" of distances between the "colors" under
+ *   "metric", or, with "cvd" conditions, combined over normal vision and
+ *   the conditions with "reduction" ("min" by default).
+ * - "get_palette": the colors of the named palette "name", as "palette".
+ *
+ * The metric defaults to "ciede2000". Ranges are arrays of a minimum and a
+ * maximum, and "cvd" maps 'protan', 'deutan' or 'tritan' to severities in
+ * [0, 1]. An optional "id" of any type is copied to the output, so results
+ * can be matched to their jobs.
+ */
+
+#pragma once
+
+#include "json.h"
+#include "lru_cache.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Run a job
+ * @param job Job object, see the file description
+ * @return Result of the job
+ * @throws std::invalid_argument If the job is malformed or fails
+ */
+Json
+run_job(const Json& job);
+
+/// Results of jobs, keyed by the compact JSON of the job without its "id"
+using ResultCache = LruCache<std::string, Json>;
+
+/// Largest result, in bytes of compact JSON, that run_job_output() caches
+constexpr std::size_t max_cached_result = 16u << 10;
+
+/**
+ * @brief Run a job and wrap its result for output
+ *
+ * Errors are reported in the output rather than thrown, so one bad job
+ * does not stop a batch.
+ *
+ * @param job Job object, see the file description
+ * @param timings Whether to add the time spent on the job, in milliseconds,
+ * as "time_ms"
+ * @param ok Output: whether the job succeeded
+ * @param results Optional cache of results; jobs found in it are not run
+ * again, and the results of the others are added unless they are larger
+ * than max_cached_result
+ * @return An object with the job's "id" (null if it has none) and either
+ * its "result" or an "error" message
+ */
+Json
+run_job_output(const Json& job,
+               bool timings,
+               bool& ok,
+               ResultCache* results = nullptr);
+
+/**
+ * @brief Run a job given as one line of JSON
+ * @param line JSON text of the job
+ * @param timings See run_job_output()
+ * @param ok Output: whether the job succeeded
+ * @return One line of JSON, without the newline, see run_job_output()
+ */
+std::string
+run_job_line(std::string_view line, bool timings, bool& ok);
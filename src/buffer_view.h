@@ -0,0 +1,103 @@
+/**
+ * @file buffer_view.h
+ * @brief Typed, validated access to Python buffer-protocol objects
+ *
+ * Used by the bindings to accept NumPy arrays, memoryviews, array.array or
+ * any other buffer exporter without depending on NumPy. Contiguous buffers
+ * are used in place; strided ones are gathered into a contiguous copy.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <vector>
+
+template<typename T>
+class BufferView
+{
+public:
+  /**
+   * @brief Request a buffer and check its element type and shape
+   * @param buffer Object supporting the buffer protocol
+   * @param name Argument name, used in error messages
+   * @param columns If positive, the buffer must be either two-dimensional
+   * with this many columns or one-dimensional with a length divisible by it;
+   * otherwise it must be one-dimensional
+   * @throws pybind11::value_error If the type or shape does not match
+   */
+  BufferView(const pybind11::buffer& buffer,
+             const std::string& name,
+             pybind11::ssize_t columns = 0)
+    : info_(buffer.request())
+  {
+    if (!info_.item_type_is_equivalent_to<T>()) {
+      throw pybind11::value_error(name + " has element format '" +
+                                  info_.format + "', expected '" +
+                                  pybind11::format_descriptor<T>::format() +
+                                  "'");
+    }
+
+    if (info_.ndim == 1) {
+      size_ = static_cast<std::size_t>(info_.shape[0]);
+      if (columns > 0 && info_.shape[0] % columns != 0) {
+        throw pybind11::value_error(name + " length must be a multiple of " +
+                                    std::to_string(columns));
+      }
+    } else if (info_.ndim == 2 && columns > 0 && info_.shape[1] == columns) {
+      size_ = static_cast<std::size_t>(info_.shape[0] * columns);
+    } else {
+      throw pybind11::value_error(
+        name + (columns > 0 ? " must have shape (n, " +
+                                std::to_string(columns) + ") or (" +
+                                std::to_string(columns) + " * n,)"
+                            : " must be one-dimensional"));
+    }
+
+    // Gather strided buffers into row-major order
+    if (!contiguous()) {
+      copy_.reserve(size_);
+      const auto* base = static_cast<const char*>(info_.ptr);
+      if (info_.ndim == 1) {
+        for (pybind11::ssize_t i = 0; i < info_.shape[0]; ++i) {
+          copy_.push_back(
+            *reinterpret_cast<const T*>(base + i * info_.strides[0]));
+        }
+      } else {
+        for (pybind11::ssize_t i = 0; i < info_.shape[0]; ++i) {
+          for (pybind11::ssize_t j = 0; j < info_.shape[1]; ++j) {
+            copy_.push_back(*reinterpret_cast<const T*>(
+              base + i * info_.strides[0] + j * info_.strides[1]));
+          }
+        }
+      }
+    }
+  }
+
+  /// Pointer to the elements in row-major order
+  const T* data() const
+  {
+    return copy_.empty() ? static_cast<const T*>(info_.ptr) : copy_.data();
+  }
+
+  /// Total number of elements
+  std::size_t size() const { return size_; }
+
+private:
+  bool contiguous() const
+  {
+    pybind11::ssize_t expected = sizeof(T);
+    for (auto k = info_.ndim; k-- > 0;) {
+      if (info_.shape[k] > 1 && info_.strides[k] != expected) {
+        return false;
+      }
+      expected *= info_.shape[k];
+    }
+    return true;
+  }
+
+  pybind11::buffer_info info_;
+  std::size_t size_ = 0;
+  std::vector<T> copy_;
+};
@@ -0,0 +1,288 @@
+/**
+ * @file candidate_set.cpp
+ * @brief Implementation of shared candidate sets
+ */
+
+#include "candidate_set.h"
+
+#include "color_conversions.h"
+#include "palette_selection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t header_size = 64;
+constexpr std::size_t view_size = 24;
+constexpr std::size_t name_size = 16;
+constexpr std::uint32_t version = 1;
+
+/// @p a + @p b, checked for overflow
+std::size_t
+checked_add(std::size_t a, std::size_t b)
+{
+  if (a > std::numeric_limits<std::size_t>::max() - b) {
+    throw std::invalid_argument("Candidate set is too large");
+  }
+  return a + b;
+}
+
+/// @p a * @p b, checked for overflow
+std::size_t
+checked_mul(std::size_t a, std::size_t b)
+{
+  if (b != 0 && a > std::numeric_limits<std::size_t>::max() / b) {
+    throw std::invalid_argument("Candidate set is too large");
+  }
+  return a * b;
+}
+
+/// Lab coordinates of @p rgb, simulated for a deficiency unless @p severity
+/// is 0
+std::vector<double>
+simulated_lab(const std::vector<double>& rgb,
+              const std::string& cvd_type,
+              double severity)
+{
+  const auto n = static_cast<std::ptrdiff_t>(rgb.size() / 3);
+  std::vector<double> lab(rgb.size());
+#pragma omp parallel for if (n > 4096)
+  for (std::ptrdiff_t i = 0; i < n; ++i) {
+    std::array<double, 3> c = { rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2] };
+    if (severity > 0) {
+      c = simulate_cvd(c[0], c[1], c[2], cvd_type, severity);
+    }
+    const auto l = rgb_to_lab(c[0], c[1], c[2]);
+    std::copy(l.begin(), l.end(), &lab[3 * i]);
+  }
+  return lab;
+}
+
+} // namespace
+
+std::size_t
+candidate_set_bytes(std::size_t n_colors, std::size_t n_conditions)
+{
+  // Sizes come from headers that other processes wrote, so they may be
+  // arbitrary
+  const std::size_t n_views = checked_add(n_conditions, 1);
+  const std::size_t arrays =
+    checked_mul(checked_mul(sizeof(double) * 3, n_colors),
+                checked_add(n_views, 1));
+  return checked_add(checked_add(header_size, checked_mul(view_size, n_views)),
+                     arrays);
+}
+
+void
+write_candidate_set(void* data,
+                    std::size_t size,
+                    const std::vector<double>& rgb,
+                    const std::map<std::string, double>& cvd)
+{
+  if (rgb.size() % 3 != 0) {
+    throw std::invalid_argument("RGB values must come in triples");
+  }
+  validate_cvd_conditions(cvd);
+  for (const auto& [cvd_type, severity] : cvd) {
+    if (severity == 0.0) {
+      throw std::invalid_argument("Severity of " + cvd_type +
+                                  " must be in (0, 1]");
+    }
+  }
+  const std::size_t n = rgb.size() / 3;
+  if (size < candidate_set_bytes(n, cvd.size())) {
+    throw std::invalid_argument("Buffer of " + std::to_string(size) +
+                                " bytes is too small for the candidate set");
+  }
+
+  auto* out = static_cast<char*>(data);
+  std::memset(out, 0, header_size);
+  const auto put = [&](std::size_t offset, auto value) {
+    std::memcpy(out + offset, &value, sizeof(value));
+  };
+  std::memcpy(out, "QPALCAND", 8);
+  put(8, version);
+  put(12, static_cast<std::uint32_t>(cvd.size() + 1));
+  put(16, static_cast<std::uint64_t>(n));
+
+  // Views, normal vision first
+  std::vector<std::pair<std::string, double>> views = { { "normal", 0.0 } };
+  views.insert(views.end(), cvd.begin(), cvd.end());
+  char* pos = out + header_size;
+  for (const auto& [name, severity] : views) {
+    std::memset(pos, 0, view_size);
+    std::memcpy(pos, name.data(), std::min(name.size(), name_size - 1));
+    std::memcpy(pos + name_size, &severity, sizeof(severity));
+    pos += view_size;
+  }
+
+  std::memcpy(pos, rgb.data(), sizeof(double) * rgb.size());
+  pos += sizeof(double) * rgb.size();
+  for (const auto& [name, severity] : views) {
+    const auto lab = simulated_lab(rgb, name, severity);
+    std::memcpy(pos, lab.data(), sizeof(double) * lab.size());
+    pos += sizeof(double) * lab.size();
+  }
+}
+
+CandidateSet::CandidateSet(std::shared_ptr<const void> owner,
+                           const void* data,
+                           std::size_t size)
+  : owner_(std::move(owner))
+{
+  const auto* in = static_cast<const char*>(data);
+  if (size < header_size || std::memcmp(in, "QPALCAND", 8) != 0) {
+    throw std::invalid_argument("Buffer does not hold a candidate set");
+  }
+  if (reinterpret_cast<std::uintptr_t>(in) % alignof(double) != 0) {
+    throw std::invalid_argument("Candidate set is not 8-byte aligned");
+  }
+
+  std::uint32_t set_version = 0;
+  std::uint32_t n_views = 0;
+  std::uint64_t n_colors = 0;
+  std::memcpy(&set_version, in + 8, sizeof(set_version));
+  std::memcpy(&n_views, in + 12, sizeof(n_views));
+  std::memcpy(&n_colors, in + 16, sizeof(n_colors));
+  if (set_version != version) {
+    throw std::invalid_argument("Unsupported candidate set version " +
+                                std::to_string(set_version));
+  }
+  if (n_views < 1 || n_colors > std::numeric_limits<std::size_t>::max() ||
+      size < candidate_set_bytes(static_cast<std::size_t>(n_colors),
+                                 n_views - 1)) {
+    throw std::invalid_argument("Candidate set is truncated");
+  }
+  n_colors_ = static_cast<std::size_t>(n_colors);
+
+  // Views as written by write_candidate_set(): normal vision, then distinct
+  // deficiencies of positive severity
+  const char* pos = in + header_size;
+  for (std::uint32_t k = 0; k < n_views; ++k) {
+    std::string name(pos, std::find(pos, pos + name_size, '\0'));
+    double severity = 0.0;
+    std::memcpy(&severity, pos + name_size, sizeof(severity));
+    if (k == 0) {
+      if (name != "normal" || severity != 0.0) {
+        throw std::invalid_argument("First view of a candidate set must be "
+                                    "'normal'");
+      }
+    } else {
+      validate_cvd(name, severity);
+      if (severity == 0.0 ||
+          std::find(views_.begin(), views_.end(), name) != views_.end()) {
+        throw std::invalid_argument("Candidate set has an invalid view '" +
+                                    name + "'");
+      }
+    }
+    views_.push_back(std::move(name));
+    severities_.push_back(severity);
+    pos += view_size;
+  }
+
+  rgb_ = reinterpret_cast<const double*>(pos);
+  for (std::uint32_t k = 0; k < n_views; ++k) {
+    lab_.push_back(rgb_ + 3 * n_colors_ * (k + 1));
+  }
+}
+
+Array<double>
+CandidateSet::rgb_array() const
+{
+  return Array<double>(owner_,
+                       rgb_,
+                       { static_cast<std::ptrdiff_t>(n_colors_), 3 },
+                       { 3, 1 });
+}
+
+Array<double>
+CandidateSet::lab_array(const std::string& view) const
+{
+  return Array<double>(owner_,
+                       lab_[view_index(view)],
+                       { static_cast<std::ptrdiff_t>(n_colors_), 3 },
+                       { 3, 1 });
+}
+
+std::size_t
+CandidateSet::view_index(const std::string& view) const
+{
+  const auto it = std::find(views_.begin(), views_.end(), view);
+  if (it == views_.end()) {
+    throw std::invalid_argument("Candidate set has no view '" + view + "'");
+  }
+  return static_cast<std::size_t>(it - views_.begin());
+}
+
+std::vector<double>
+CandidateSet::seen_lab(const std::vector<double>& rgb, std::size_t k) const
+{
+  return simulated_lab(rgb, views_[k], severities_[k]);
+}
+
+std::vector<std::string>
+CandidateSet::select(std::size_t n,
+                     Metric metric,
+                     const std::vector<std::string>& views,
+                     const std::map<std::string, double>& backgrounds) const
+{
+  std::vector<std::size_t> indices;
+  for (const auto& view : views) {
+    indices.push_back(view_index(view));
+  }
+  if (indices.empty()) {
+    for (std::size_t k = 0; k < views_.size(); ++k) {
+      indices.push_back(k);
+    }
+  }
+
+  std::vector<double> background_rgb;
+  std::vector<double> weights;
+  for (const auto& [hex, weight] : backgrounds) {
+    if (!(weight > 0.0) || !std::isfinite(weight)) {
+      throw std::invalid_argument("Weight of background " + hex +
+                                  " must be positive");
+    }
+    const auto c = hex_to_rgb(hex);
+    background_rgb.insert(background_rgb.end(), c.begin(), c.end());
+    weights.push_back(weight);
+  }
+
+  // The views are read in place
+  std::vector<const double*> lab;
+  std::vector<std::vector<double>> background_lab;
+  for (const std::size_t k : indices) {
+    lab.push_back(lab_[k]);
+    if (!weights.empty()) {
+      background_lab.push_back(seen_lab(background_rgb, k));
+    }
+  }
+
+  const auto selected =
+    farthest_points(lab, n_colors_, n, 0, metric, background_lab, weights);
+
+  std::vector<std::string> hex_colors;
+  hex_colors.reserve(selected.size());
+  for (const std::size_t i : selected) {
+    hex_colors.push_back(
+      rgb_to_hex(rgb_[3 * i], rgb_[3 * i + 1], rgb_[3 * i + 2]));
+  }
+  return hex_colors;
+}
+
+std::vector<double>
+CandidateSet::distances(const std::string& hex,
+                        Metric metric,
+                        const std::string& view) const
+{
+  const std::size_t k = view_index(view);
+  const auto c = hex_to_rgb(hex);
+  const auto query = seen_lab({ c[0], c[1], c[2] }, k);
+  return lab_distances(
+    { query[0], query[1], query[2] }, lab_[k], n_colors_, metric);
+}
@@ -0,0 +1,154 @@
+/**
+ * @file candidate_set.h
+ * @brief Precomputed candidate colors in a shared memory segment
+ *
+ * A candidate set holds the RGB values of candidate colors together with
+ * their Lab coordinates as seen with normal vision and with each of several
+ * color vision deficiencies. It is written once into a block of memory,
+ * typically a shared memory segment, and read in place by any number of
+ * processes, so workers neither re-sample nor re-convert the candidates.
+ *
+ * Layout, in native byte order with every array 8-byte aligned:
+ *
+ * | Offset | Size        | Content                                     |
+ * |--------|-------------|---------------------------------------------|
+ * | 0      | 8           | Magic "QPALCAND"                            |
+ * | 8      | 4           | Format version (uint32, currently 1)        |
+ * | 12     | 4           | Number of views v (uint32)                  |
+ * | 16     | 8           | Number of colors n (uint64)                 |
+ * | 24     | 40          | Reserved (zero)                             |
+ * | 64     | 24 v        | Per view: name (16 bytes, NUL-padded) and   |
+ * |        |             | CVD severity (float64)                      |
+ * |        | 24 n        | RGB values (float64, n x 3)                 |
+ * |        | 24 n v      | Lab coordinates of each view (float64)      |
+ *
+ * The first view is always "normal"; the others are named after their
+ * deficiency ("protan", "deutan" or "tritan").
+ */
+
+#pragma once
+
+#include "array.h"
+#include "color_distance.h"
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Number of bytes a candidate set needs
+ * @param n_colors Number of candidate colors
+ * @param n_conditions Number of CVD conditions, besides normal vision
+ * @throws std::invalid_argument If the size does not fit in std::size_t
+ */
+std::size_t
+candidate_set_bytes(std::size_t n_colors, std::size_t n_conditions);
+
+/**
+ * @brief Write a candidate set into @p data
+ *
+ * The candidates are converted to Lab, and simulated for each condition,
+ * here and only here.
+ *
+ * @param data Destination, 8-byte aligned, of at least
+ * candidate_set_bytes() bytes
+ * @param size Size of @p data in bytes
+ * @param rgb RGB values in range [0, 1], three consecutive values per color
+ * @param cvd CVD conditions, mapping "protan", "deutan" or "tritan" to a
+ * severity in (0, 1]; each becomes a view of its own
+ * @throws std::invalid_argument If @p data is too small or a condition is
+ * unknown
+ */
+void
+write_candidate_set(void* data,
+                    std::size_t size,
+                    const std::vector<double>& rgb,
+                    const std::map<std::string, double>& cvd);
+
+/**
+ * @brief Read-only view of a candidate set written by write_candidate_set()
+ */
+class CandidateSet
+{
+public:
+  /**
+   * @brief Attach to a candidate set in place
+   * @param owner Handle that keeps @p data valid for the lifetime of this
+   * set and of every array taken from it
+   * @param data Start of the candidate set
+   * @param size Size of @p data in bytes
+   * @throws std::invalid_argument If @p data does not hold a valid set,
+   * including one whose views are not those write_candidate_set() writes
+   */
+  CandidateSet(std::shared_ptr<const void> owner,
+               const void* data,
+               std::size_t size);
+
+  /// Number of candidate colors
+  std::size_t size() const { return n_colors_; }
+
+  /// Names of the views, "normal" first
+  const std::vector<std::string>& views() const { return views_; }
+
+  /// CVD severity of each view (0 for normal vision)
+  const std::vector<double>& severities() const { return severities_; }
+
+  /// RGB values as an n x 3 view into the set
+  Array<double> rgb_array() const;
+
+  /**
+   * @brief Lab values of one view as an n x 3 view into the set
+   * @throws std::invalid_argument If there is no such view
+   */
+  Array<double> lab_array(const std::string& view) const;
+
+  /**
+   * @brief Select the most distinct candidates
+   *
+   * The candidates are selected with farthest_points() from their stored
+   * Lab coordinates, so nothing is converted except the backgrounds. Each
+   * pair of colors counts with its smallest distance over @p views.
+   *
+   * @param n Number of colors to select
+   * @param metric Distance metric
+   * @param views Views to select under; empty for all of them
+   * @param backgrounds Background colors (hex strings) mapped to positive
+   * weights, see generate_palette_unified()
+   * @return Hex strings of the selected colors
+   * @throws std::invalid_argument If a view is unknown, a weight is not
+   * positive, or there are fewer than @p n candidates
+   */
+  std::vector<std::string> select(
+    std::size_t n,
+    Metric metric,
+    const std::vector<std::string>& views,
+    const std::map<std::string, double>& backgrounds) const;
+
+  /**
+   * @brief Distance from a color to every candidate in one view
+   * @param hex Query color; it is simulated like the view's candidates
+   * @param metric Distance metric
+   * @param view Name of the view
+   * @throws std::invalid_argument If there is no such view
+   */
+  std::vector<double> distances(const std::string& hex,
+                                Metric metric,
+                                const std::string& view) const;
+
+private:
+  std::size_t view_index(const std::string& view) const;
+
+  /// Lab coordinates of @p rgb as seen in view @p k
+  std::vector<double> seen_lab(const std::vector<double>& rgb,
+                               std::size_t k) const;
+
+  std::shared_ptr<const void> owner_;
+  std::size_t n_colors_ = 0;
+  std::vector<std::string> views_;
+  std::vector<double> severities_;
+  const double* rgb_ = nullptr;
+  std::vector<const double*> lab_;
+};
@@ -0,0 +1,227 @@
+/**
+ * @file cli.cpp
+ * @brief Command-line tool that runs palette jobs in batches
+ *
+ * Reads jobs as JSON Lines (one JSON object per line, see batch_jobs.h)
+ * from a file or standard input, runs them on a pool of threads, and writes
+ * one line of results per job to standard output, in the order of the
+ * jobs. Results are written as soon as all earlier jobs are done, so the
+ * output streams while the input is still being read.
+ */
+
+#include "batch_jobs.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr const char* usage =
+  "Usage: qualpal-batch [options] [FILE]\n"
+  "\n"
+  "Run palette jobs given as JSON Lines in FILE, or standard input if FILE\n"
+  "is omitted or '-', and write one JSON line per job to standard output.\n"
+  "\n"
+  "Options:\n"
+  "  -j, --jobs N   Number of worker threads (default: number of cores)\n"
+  "  -t, --timings  Add the time spent on each job as \"time_ms\"\n"
+  "  -h, --help     Show this help\n"
+  "\n"
+  "The exit status is 1 if any job failed, and 2 on usage errors.\n";
+
+struct Options
+{
+  std::string path = "-";
+  std::size_t threads = 0;
+  bool timings = false;
+};
+
+/**
+ * @brief Jobs in input order, with the results of those that are done
+ *
+ * Only a bounded window of jobs is held at a time, so memory use does not
+ * grow with the length of the input. Whichever worker finishes the first
+ * job of the window writes the results of all leading jobs that are done.
+ */
+class JobQueue
+{
+public:
+  JobQueue(std::size_t capacity, bool timings, std::ostream& out)
+    : capacity_(capacity)
+    , timings_(timings)
+    , out_(out)
+  {
+  }
+
+  /// Add a job, waiting while the window is full
+  void push(std::string line)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    space_.wait(lock, [&] { return slots_.size() < capacity_; });
+    slots_.push_back({ std::move(line), std::string(), false });
+    work_.notify_one();
+  }
+
+  /// Signal that no more jobs will be pushed
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    work_.notify_all();
+  }
+
+  /// Run jobs until the queue is closed and all jobs are taken
+  void work()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      work_.wait(lock,
+                 [&] { return next_ < first_ + slots_.size() || closed_; });
+      if (next_ == first_ + slots_.size()) {
+        return;
+      }
+      const std::size_t index = next_++;
+      const std::string line = std::move(slots_[index - first_].line);
+
+      lock.unlock();
+      bool ok = true;
+      std::string output = run_job_line(line, timings_, ok);
+      lock.lock();
+
+      auto& slot = slots_[index - first_];
+      slot.output = std::move(output);
+      slot.done = true;
+      failed_ = failed_ || !ok;
+
+      if (index == first_) {
+        while (!slots_.empty() && slots_.front().done) {
+          out_ << slots_.front().output << '\n';
+          slots_.pop_front();
+          ++first_;
+        }
+        out_.flush();
+        space_.notify_all();
+      }
+    }
+  }
+
+  bool failed() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+  }
+
+private:
+  struct Slot
+  {
+    std::string line;
+    std::string output;
+    bool done;
+  };
+
+  std::size_t capacity_;
+  bool timings_;
+  std::ostream& out_;
+  mutable std::mutex mutex_;
+  std::condition_variable work_;
+  std::condition_variable space_;
+  std::deque<Slot> slots_;
+  /// Input index of the first slot
+  std::size_t first_ = 0;
+  /// Input index of the next job to run
+  std::size_t next_ = 0;
+  bool closed_ = false;
+  bool failed_ = false;
+};
+
+bool
+parse_options(int argc, char** argv, Options& options)
+{
+  bool have_path = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      std::cout << usage;
+      std::exit(0);
+    } else if (arg == "-t" || arg == "--timings") {
+      options.timings = true;
+    } else if (arg == "-j" || arg == "--jobs") {
+      if (++i == argc) {
+        return false;
+      }
+      char* end = nullptr;
+      const long threads = std::strtol(argv[i], &end, 10);
+      if (*end != '\0' || threads < 1) {
+        return false;
+      }
+      options.threads = static_cast<std::size_t>(threads);
+    } else if (arg.size() > 1 && arg[0] == '-') {
+      return false;
+    } else if (!have_path) {
+      options.path = arg;
+      have_path = true;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  Options options;
+  if (!parse_options(argc, argv, options)) {
+    std::cerr << usage;
+    return 2;
+  }
+
+  std::ifstream file;
+  if (options.path != "-") {
+    file.open(options.path);
+    if (!file) {
+      std::cerr << "qualpal-batch: cannot open " << options.path << '\n';
+      return 2;
+    }
+  }
+  std::istream& in = options.path == "-" ? std::cin : file;
+
+  std::size_t threads = options.threads;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  std::ios::sync_with_stdio(false);
+  JobQueue queue(4 * threads, options.timings, std::cout);
+  std::vector<std::thread> workers;
+  for (std::size_t k = 0; k < threads; ++k) {
+    workers.emplace_back([&] { queue.work(); });
+  }
+
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+    queue.push(std::move(line));
+  }
+  queue.close();
+
+  // Workers exit once every job is taken, and the last one to finish a
+  // job has written all remaining results
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return queue.failed() ? 1 : 0;
+}
@@ -0,0 +1,433 @@
+/**
+ * @file color_assignment.cpp
+ * @brief Implementation of color assignment to graph nodes
+ */
+
+#include "color_assignment.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr double inf = std::numeric_limits<double>::infinity();
+
+/// Undirected adjacency lists in CSR form
+struct Adjacency
+{
+  std::vector<std::size_t> indptr;
+  std::vector<std::size_t> indices;
+
+  std::size_t degree(std::size_t u) const
+  {
+    return indptr[u + 1] - indptr[u];
+  }
+};
+
+/// Check the CSR arrays and add the reverse of every edge
+Adjacency
+symmetrize(const std::int64_t* indptr,
+           std::size_t n,
+           const std::int64_t* indices)
+{
+  if (indptr[0] != 0) {
+    throw std::invalid_argument("indptr must start at 0");
+  }
+  for (std::size_t u = 0; u < n; ++u) {
+    if (indptr[u + 1] < indptr[u]) {
+      throw std::invalid_argument("indptr must be non-decreasing");
+    }
+  }
+  const auto n_entries = static_cast<std::size_t>(indptr[n]);
+  for (std::size_t e = 0; e < n_entries; ++e) {
+    if (indices[e] < 0 || static_cast<std::size_t>(indices[e]) >= n) {
+      throw std::invalid_argument("Node index " + std::to_string(indices[e]) +
+                                  " out of range for " + std::to_string(n) +
+                                  " nodes");
+    }
+  }
+
+  Adjacency adj;
+  adj.indptr.assign(n + 1, 0);
+  for (std::size_t u = 0; u < n; ++u) {
+    for (auto e = indptr[u]; e < indptr[u + 1]; ++e) {
+      const auto v = static_cast<std::size_t>(indices[e]);
+      if (v != u) {
+        ++adj.indptr[u + 1];
+        ++adj.indptr[v + 1];
+      }
+    }
+  }
+  for (std::size_t u = 0; u < n; ++u) {
+    adj.indptr[u + 1] += adj.indptr[u];
+  }
+  adj.indices.resize(adj.indptr[n]);
+  std::vector<std::size_t> fill(adj.indptr.begin(), adj.indptr.end() - 1);
+  for (std::size_t u = 0; u < n; ++u) {
+    for (auto e = indptr[u]; e < indptr[u + 1]; ++e) {
+      const auto v = static_cast<std::size_t>(indices[e]);
+      if (v != u) {
+        adj.indices[fill[u]++] = v;
+        adj.indices[fill[v]++] = u;
+      }
+    }
+  }
+  return adj;
+}
+
+/// Distance from each color to the color farthest from it
+std::vector<double>
+color_reach(const std::vector<double>& d, std::size_t k)
+{
+  std::vector<double> reach(k, 0.0);
+  for (std::size_t a = 0; a < k; ++a) {
+    for (std::size_t b = 0; b < k; ++b) {
+      reach[a] = std::max(reach[a], d[a * k + b]);
+    }
+  }
+  return reach;
+}
+
+/**
+ * Color farthest from the neighbors' colors, given the distance from each
+ * color to the nearest of them. Without colored neighbors, the color that
+ * leaves the most room for the neighbors is taken, so that e.g. bipartite
+ * graphs get the two most distant colors. Other ties go to the least used
+ * color.
+ */
+std::size_t
+farthest_color(const double* score,
+               const std::vector<std::size_t>& usage,
+               const std::vector<double>& reach,
+               std::size_t k)
+{
+  std::size_t best = 0;
+  for (std::size_t c = 1; c < k; ++c) {
+    if (score[c] != score[best]) {
+      if (score[c] > score[best]) {
+        best = c;
+      }
+    } else if (score[c] == inf && reach[c] != reach[best]) {
+      if (reach[c] > reach[best]) {
+        best = c;
+      }
+    } else if (usage[c] < usage[best]) {
+      best = c;
+    }
+  }
+  return best;
+}
+
+/// Smallest distance between the colors of adjacent nodes
+double
+closest_edge(const Adjacency& adj,
+             const std::vector<double>& d,
+             std::size_t k,
+             const std::vector<std::size_t>& colors)
+{
+  double closest = inf;
+  for (std::size_t u = 0; u + 1 < adj.indptr.size(); ++u) {
+    for (auto e = adj.indptr[u]; e < adj.indptr[u + 1]; ++e) {
+      closest = std::min(closest, d[colors[u] * k + colors[adj.indices[e]]]);
+    }
+  }
+  return closest;
+}
+
+/**
+ * Greedy coloring in DSATUR order, aiming for all edges at @p target or
+ * more. Colors at least @p target from those of all colored neighbors are
+ * allowed; the next node is the one with the fewest allowed colors, then
+ * with the worst best color, then with the most uncolored neighbors.
+ */
+std::vector<std::size_t>
+dsatur(const Adjacency& adj,
+       std::size_t n,
+       const std::vector<double>& d,
+       std::size_t k,
+       double target)
+{
+  constexpr std::size_t uncolored = std::numeric_limits<std::size_t>::max();
+
+  // score[u * k + c]: distance from color c to the nearest color of a
+  // colored neighbor of u
+  std::vector<double> score(n * k, inf);
+  std::vector<std::size_t> open_degree(n);
+  std::vector<std::size_t> version(n, 0);
+  std::vector<std::size_t> usage(k, 0);
+  std::vector<std::size_t> colors(n, uncolored);
+  const auto reach = color_reach(d, k);
+
+  struct Entry
+  {
+    std::size_t allowed;
+    double best;
+    std::size_t open_degree;
+    std::size_t node;
+    std::size_t version;
+  };
+  const auto less_urgent = [](const Entry& a, const Entry& b) {
+    if (a.allowed != b.allowed) {
+      return a.allowed > b.allowed;
+    }
+    if (a.best != b.best) {
+      return a.best > b.best;
+    }
+    if (a.open_degree != b.open_degree) {
+      return a.open_degree < b.open_degree;
+    }
+    return a.node > b.node;
+  };
+  std::priority_queue<Entry, std::vector<Entry>, decltype(less_urgent)> queue(
+    less_urgent);
+
+  for (std::size_t u = 0; u < n; ++u) {
+    open_degree[u] = adj.degree(u);
+    queue.push({ k, inf, open_degree[u], u, 0 });
+  }
+
+  while (!queue.empty()) {
+    const Entry top = queue.top();
+    queue.pop();
+    const std::size_t u = top.node;
+    if (colors[u] != uncolored || top.version != version[u]) {
+      continue;
+    }
+
+    const std::size_t c = farthest_color(&score[u * k], usage, reach, k);
+    colors[u] = c;
+    ++usage[c];
+
+    const double* row = &d[c * k];
+    for (auto e = adj.indptr[u]; e < adj.indptr[u + 1]; ++e) {
+      const std::size_t v = adj.indices[e];
+      if (colors[v] != uncolored) {
+        continue;
+      }
+      double* s = &score[v * k];
+      double best = -inf;
+      std::size_t allowed = 0;
+      for (std::size_t x = 0; x < k; ++x) {
+        s[x] = std::min(s[x], row[x]);
+        best = std::max(best, s[x]);
+        allowed += s[x] >= target ? 1 : 0;
+      }
+      --open_degree[v];
+      queue.push({ allowed, best, open_degree[v], v, ++version[v] });
+    }
+  }
+  return colors;
+}
+
+/// Recolor nodes on the closest edges while that lifts all of their edges
+/// above the closest distance
+void
+repair(const Adjacency& adj,
+       std::size_t n,
+       const std::vector<double>& d,
+       std::size_t k,
+       std::vector<std::size_t>& colors)
+{
+  std::vector<std::size_t> usage(k, 0);
+  for (const std::size_t c : colors) {
+    ++usage[c];
+  }
+  const auto reach = color_reach(d, k);
+  std::vector<double> score(k);
+  std::vector<std::size_t> candidates;
+
+  while (true) {
+    const double closest = closest_edge(adj, d, k, colors);
+    if (closest == inf) {
+      return;
+    }
+
+    candidates.clear();
+    for (std::size_t u = 0; u < n; ++u) {
+      for (auto e = adj.indptr[u]; e < adj.indptr[u + 1]; ++e) {
+        if (d[colors[u] * k + colors[adj.indices[e]]] == closest) {
+          candidates.push_back(u);
+          break;
+        }
+      }
+    }
+
+    bool changed = false;
+    for (const std::size_t u : candidates) {
+      std::fill(score.begin(), score.end(), inf);
+      for (auto e = adj.indptr[u]; e < adj.indptr[u + 1]; ++e) {
+        const double* row = &d[colors[adj.indices[e]] * k];
+        for (std::size_t x = 0; x < k; ++x) {
+          score[x] = std::min(score[x], row[x]);
+        }
+      }
+      // Earlier recolorings may already have lifted this node
+      if (score[colors[u]] > closest) {
+        continue;
+      }
+      const std::size_t c = farthest_color(score.data(), usage, reach, k);
+      if (score[c] > closest) {
+        --usage[colors[u]];
+        ++usage[c];
+        colors[u] = c;
+        changed = true;
+      }
+    }
+    if (!changed) {
+      return;
+    }
+  }
+}
+
+/// Assignment for rows <= cols; cost(i, j) gives the cost of row i and
+/// column j
+template<typename Cost>
+std::vector<std::int64_t>
+shortest_augmenting_paths(const Cost& cost, std::size_t rows, std::size_t cols)
+{
+  // Potentials and matching are 1-based; column 0 is a virtual column that
+  // holds the row being inserted
+  std::vector<double> u(rows + 1, 0.0);
+  std::vector<double> v(cols + 1, 0.0);
+  std::vector<std::size_t> row_of(cols + 1, 0);
+  std::vector<std::size_t> way(cols + 1, 0);
+  std::vector<double> min_slack(cols + 1);
+  std::vector<char> used(cols + 1);
+
+  for (std::size_t i = 1; i <= rows; ++i) {
+    row_of[0] = i;
+    std::size_t j0 = 0;
+    std::fill(min_slack.begin(), min_slack.end(), inf);
+    std::fill(used.begin(), used.end(), 0);
+    do {
+      used[j0] = 1;
+      const std::size_t i0 = row_of[j0];
+      double delta = inf;
+      std::size_t j1 = 0;
+      for (std::size_t j = 1; j <= cols; ++j) {
+        if (used[j]) {
+          continue;
+        }
+        const double slack = cost(i0 - 1, j - 1) - u[i0] - v[j];
+        if (slack < min_slack[j]) {
+          min_slack[j] = slack;
+          way[j] = j0;
+        }
+        if (min_slack[j] < delta) {
+          delta = min_slack[j];
+          j1 = j;
+        }
+      }
+      for (std::size_t j = 0; j <= cols; ++j) {
+        if (used[j]) {
+          u[row_of[j]] += delta;
+          v[j] -= delta;
+        } else {
+          min_slack[j] -= delta;
+        }
+      }
+      j0 = j1;
+    } while (row_of[j0] != 0);
+
+    // Flip the augmenting path
+    do {
+      const std::size_t j1 = way[j0];
+      row_of[j0] = row_of[j1];
+      j0 = j1;
+    } while (j0 != 0);
+  }
+
+  std::vector<std::int64_t> match(rows, -1);
+  for (std::size_t j = 1; j <= cols; ++j) {
+    if (row_of[j] != 0) {
+      match[row_of[j] - 1] = static_cast<std::int64_t>(j - 1);
+    }
+  }
+  return match;
+}
+
+} // namespace
+
+std::vector<std::int64_t>
+assign_graph_colors(const std::int64_t* indptr,
+                    std::size_t n_nodes,
+                    const std::int64_t* indices,
+                    const std::vector<double>& distances,
+                    std::size_t n_colors)
+{
+  const Adjacency adj = symmetrize(indptr, n_nodes, indices);
+  if (n_nodes == 0) {
+    return {};
+  }
+  if (n_colors == 0) {
+    throw std::invalid_argument("Need at least one color to color a graph");
+  }
+
+  // Plain DSATUR, then the largest target distance it can be pushed to
+  // reach, by bisection over the distinct distances between colors
+  auto colors = dsatur(adj, n_nodes, distances, n_colors, -inf);
+  double closest = closest_edge(adj, distances, n_colors, colors);
+  std::vector<double> targets;
+  for (const double x : distances) {
+    if (x > closest && x != inf) {
+      targets.push_back(x);
+    }
+  }
+  std::sort(targets.begin(), targets.end());
+  targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+
+  std::size_t lo = 0;
+  std::size_t hi = targets.size();
+  while (lo < hi) {
+    const std::size_t mid = lo + (hi - lo) / 2;
+    auto attempt = dsatur(adj, n_nodes, distances, n_colors, targets[mid]);
+    const double reached = closest_edge(adj, distances, n_colors, attempt);
+    if (reached >= targets[mid]) {
+      colors = std::move(attempt);
+      closest = reached;
+      lo = static_cast<std::size_t>(
+             std::upper_bound(targets.begin(), targets.end(), reached) -
+             targets.begin());
+    } else {
+      hi = mid;
+    }
+  }
+
+  repair(adj, n_nodes, distances, n_colors, colors);
+  return std::vector<std::int64_t>(colors.begin(), colors.end());
+}
+
+std::vector<std::int64_t>
+solve_assignment(const std::vector<double>& cost,
+                 std::size_t rows,
+                 std::size_t cols)
+{
+  for (const double c : cost) {
+    if (!std::isfinite(c)) {
+      throw std::invalid_argument("Assignment costs must be finite");
+    }
+  }
+
+  if (rows <= cols) {
+    return shortest_augmenting_paths(
+      [&](std::size_t i, std::size_t j) { return cost[i * cols + j]; },
+      rows,
+      cols);
+  }
+
+  // More rows than columns: match the columns to rows instead
+  const auto col_match = shortest_augmenting_paths(
+    [&](std::size_t j, std::size_t i) { return cost[i * cols + j]; },
+    cols,
+    rows);
+  std::vector<std::int64_t> match(rows, -1);
+  for (std::size_t j = 0; j < cols; ++j) {
+    match[static_cast<std::size_t>(col_match[j])] =
+      static_cast<std::int64_t>(j);
+  }
+  return match;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file color_assignment.h
+ * @brief Assignment of palette colors to the nodes of a graph
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Color a graph so that adjacent nodes get distant colors
+ *
+ * Maximizes the smallest distance between the colors of adjacent nodes,
+ * e.g. neighboring regions of a choropleth map. Colors may be used any
+ * number of times.
+ *
+ * Nodes are colored greedily in DSATUR order: the next node is the most
+ * constrained one, with ties going to the node with the most uncolored
+ * neighbors, and it gets the color farthest from those of its colored
+ * neighbors. A target distance sharpens "constrained" to the number of
+ * colors still at least that far from all colored neighbors; the largest
+ * target the greedy coloring reaches is found by bisection over the
+ * distances between colors. The coloring is then repaired locally: nodes on
+ * the closest edges are recolored while that moves all of their edges above
+ * the current minimum.
+ *
+ * Each greedy pass takes O(E k + E log E) time for E edges and k colors,
+ * and O(log k) passes are made.
+ *
+ * @param indptr Row offsets of the adjacency matrix in CSR form, @p n_nodes
+ * + 1 non-decreasing values starting at 0
+ * @param n_nodes Number of nodes
+ * @param indices Column indices, <tt>indptr[n_nodes]</tt> values in
+ * [0, @p n_nodes). The graph is treated as undirected: an edge listed in
+ * either row counts for both nodes. Self-loops are ignored.
+ * @param distances Symmetric k x k distance matrix of the colors, row-major
+ * @param n_colors Number of colors k
+ * @return Color index of each node
+ * @throws std::invalid_argument If the CSR arrays are inconsistent, or the
+ * graph has nodes but there are no colors
+ */
+std::vector<std::int64_t>
+assign_graph_colors(const std::int64_t* indptr,
+                    std::size_t n_nodes,
+                    const std::int64_t* indices,
+                    const std::vector<double>& distances,
+                    std::size_t n_colors);
+
+/**
+ * @brief Solve the linear assignment problem
+ *
+ * Matches rows to columns one-to-one so that the total cost of the matched
+ * pairs is minimal, with min(rows, cols) pairs. Uses the shortest
+ * augmenting path method with dual potentials (Hungarian algorithm in the
+ * Jonker-Volgenant formulation), in O(r^2 c) time for r = min(rows, cols)
+ * and c = max(rows, cols).
+ *
+ * @param cost Cost matrix, @p rows x @p cols, row-major; all finite
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @return Column matched to each row, -1 for unmatched rows (only if
+ * @p rows > @p cols)
+ * @throws std::invalid_argument If a cost is not finite
+ */
+std::vector<std::int64_t>
+solve_assignment(const std::vector<double>& cost,
+                 std::size_t rows,
+                 std::size_t cols);
@@ -0,0 +1,97 @@
+/**
+ * @file color_contrast.cpp
+ * @brief Implementation of WCAG contrast kernels
+ */
+
+#include "color_contrast.h"
+
+#include <array>
+#include <cmath>
+
+namespace {
+
+/// Linear-light value of each 8-bit sRGB channel value
+const std::array<double, 256>&
+linearization_table()
+{
+  static const std::array<double, 256> table = [] {
+    std::array<double, 256> t{};
+    for (std::size_t i = 0; i < t.size(); ++i) {
+      const double c = static_cast<double>(i) / 255.0;
+      t[i] = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+    }
+    return t;
+  }();
+  return table;
+}
+
+double
+luminance(const std::array<double, 256>& lut, const std::uint8_t* c)
+{
+  return 0.2126 * lut[c[0]] + 0.7152 * lut[c[1]] + 0.0722 * lut[c[2]];
+}
+
+} // namespace
+
+std::vector<double>
+relative_luminance(const std::uint8_t* rgb, std::size_t n)
+{
+  const auto& lut = linearization_table();
+  const auto count = static_cast<std::ptrdiff_t>(n);
+  std::vector<double> out(n);
+
+#pragma omp parallel for if (count > 4096)
+  for (std::ptrdiff_t i = 0; i < count; ++i) {
+    out[i] = luminance(lut, rgb + 3 * i);
+  }
+
+  return out;
+}
+
+std::vector<double>
+contrast_matrix(const std::uint8_t* foreground,
+                std::size_t m,
+                const std::uint8_t* background,
+                std::size_t n)
+{
+  const auto fg = relative_luminance(foreground, m);
+  const auto bg = relative_luminance(background, n);
+  const auto rows = static_cast<std::ptrdiff_t>(m);
+  std::vector<double> out(m * n);
+
+#pragma omp parallel for if (m * n > 4096)
+  for (std::ptrdiff_t i = 0; i < rows; ++i) {
+    double* row = &out[i * n];
+    for (std::size_t j = 0; j < n; ++j) {
+      row[j] = contrast_ratio(fg[i], bg[j]);
+    }
+  }
+
+  return out;
+}
+
+void
+best_contrast(const std::uint8_t* colors,
+              std::size_t n,
+              const std::uint8_t* candidates,
+              std::size_t k,
+              std::vector<std::int64_t>& best,
+              std::vector<double>& ratios)
+{
+  const auto lum = relative_luminance(colors, n);
+  const auto cand = relative_luminance(candidates, k);
+  const auto count = static_cast<std::ptrdiff_t>(n);
+  best.assign(n, -1);
+  ratios.assign(n, 0.0);
+
+#pragma omp parallel for if (n * k > 4096)
+  for (std::ptrdiff_t i = 0; i < count; ++i) {
+    for (std::size_t j = 0; j < k; ++j) {
+      const double r = contrast_ratio(lum[i], cand[j]);
+      if (r > ratios[i]) {
+        ratios[i] = r;
+        best[i] = static_cast<std::int64_t>(j);
+      }
+    }
+  }
+}
@@ -0,0 +1,65 @@
+/**
+ * @file color_contrast.h
+ * @brief Batch WCAG relative luminance and contrast ratio kernels
+ *
+ * All kernels take 8-bit sRGB colors, three consecutive bytes per color,
+ * and linearize channels through a 256-entry lookup table.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Calculate the WCAG relative luminance of each color
+ * @param rgb 8-bit sRGB values, three per color
+ * @param n Number of colors
+ * @return Relative luminance in range [0, 1] for each color
+ */
+std::vector<double>
+relative_luminance(const std::uint8_t* rgb, std::size_t n);
+
+/**
+ * @brief Calculate the WCAG contrast ratio between two luminances
+ * @return Ratio in range [1, 21]
+ */
+inline double
+contrast_ratio(double l1, double l2)
+{
+  return l1 > l2 ? (l1 + 0.05) / (l2 + 0.05) : (l2 + 0.05) / (l1 + 0.05);
+}
+
+/**
+ * @brief Calculate the contrast ratio of every foreground/background pair
+ * @param foreground 8-bit sRGB values of the m foreground colors
+ * @param m Number of foreground colors
+ * @param background 8-bit sRGB values of the n background colors
+ * @param n Number of background colors
+ * @return Flattened m x n matrix (row-major order)
+ */
+std::vector<double>
+contrast_matrix(const std::uint8_t* foreground,
+                std::size_t m,
+                const std::uint8_t* background,
+                std::size_t n);
+
+/**
+ * @brief Find the candidate with the highest contrast for each color
+ * @param colors 8-bit sRGB values of the colors
+ * @param n Number of colors
+ * @param candidates 8-bit sRGB values of the candidates, e.g. text colors
+ * @param k Number of candidates
+ * @param best Output: index of the best candidate for each color (the
+ * lowest index among ties, -1 if there are no candidates)
+ * @param ratios Output: contrast ratio with the best candidate (0 if there
+ * are no candidates)
+ */
+void
+best_contrast(const std::uint8_t* colors,
+              std::size_t n,
+              const std::uint8_t* candidates,
+              std::size_t k,
+              std::vector<std::int64_t>& best,
+              std::vector<double>& ratios);
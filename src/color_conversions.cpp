@@ -1,7 +1,11 @@
 #include "color_conversions.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdio>
 #include <qualpal.h>
+#include <stdexcept>
 
 // Forward declare from cvd.cpp
 namespace qualpal {
@@ -11,6 +15,236 @@ simulateCvd(const colors::RGB& rgb,
             double cvd_severity);
 }
 
+namespace {
+
+/// Linear-light value of an sRGB component
+double
+srgb_to_linear(double c)
+{
+  return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+}
+
+/// sRGB component of a linear-light value
+double
+linear_to_srgb(double c)
+{
+  return c <= 0.0031308 ? 12.92 * c : 1.055 * std::pow(c, 1.0 / 2.4) - 0.055;
+}
+
+/// CIE XYZ (D65, Y in [0, 1]) of a Lab color
+std::array<double, 3>
+lab_to_xyz(double l, double a, double b)
+{
+  constexpr double delta = 6.0 / 29.0;
+  const auto f_inv = [](double t) {
+    return t > delta ? t * t * t : 3.0 * delta * delta * (t - 4.0 / 29.0);
+  };
+  const double fy = (l + 16.0) / 116.0;
+  return { 0.95047 * f_inv(fy + a / 500.0),
+           f_inv(fy),
+           1.08883 * f_inv(fy - b / 200.0) };
+}
+
+/// Linear sRGB of a CIE XYZ (D65) color
+std::array<double, 3>
+xyz_to_linear_rgb(const std::array<double, 3>& xyz)
+{
+  const auto [x, y, z] = xyz;
+  return { 3.2404542 * x - 1.5371385 * y - 0.4985314 * z,
+           -0.9692660 * x + 1.8760108 * y + 0.0415560 * z,
+           0.0556434 * x - 0.2040259 * y + 1.0572252 * z };
+}
+
+/// CIE XYZ (D65) of a linear sRGB color
+std::array<double, 3>
+linear_rgb_to_xyz(const std::array<double, 3>& rgb)
+{
+  const auto [r, g, b] = rgb;
+  return { 0.4124564 * r + 0.3575761 * g + 0.1804375 * b,
+           0.2126729 * r + 0.7151522 * g + 0.0721750 * b,
+           0.0193339 * r + 0.1191920 * g + 0.9503041 * b };
+}
+
+/// Lab of a CIE XYZ (D65, Y in [0, 1]) color
+std::array<double, 3>
+xyz_to_lab(const std::array<double, 3>& xyz)
+{
+  constexpr double delta = 6.0 / 29.0;
+  const auto f = [](double t) {
+    return t > delta * delta * delta ? std::cbrt(t)
+                                     : t / (3.0 * delta * delta) + 4.0 / 29.0;
+  };
+  const double fx = f(xyz[0] / 0.95047);
+  const double fy = f(xyz[1]);
+  const double fz = f(xyz[2] / 1.08883);
+  return { 116.0 * fy - 16.0, 500.0 * (fx - fy), 200.0 * (fy - fz) };
+}
+
+/// sRGB of a linear sRGB color, extended to components outside [0, 1]
+std::array<double, 3>
+linear_to_srgb_unclamped(const std::array<double, 3>& rgb)
+{
+  std::array<double, 3> out;
+  for (int k = 0; k < 3; ++k) {
+    out[k] = std::copysign(linear_to_srgb(std::abs(rgb[k])), rgb[k]);
+  }
+  return out;
+}
+
+std::array<double, 3>
+linear_rgb_to_oklab(const std::array<double, 3>& rgb)
+{
+  const auto [r, g, b] = rgb;
+  const double l =
+    std::cbrt(0.4122214708 * r + 0.5363325363 * g + 0.0514459929 * b);
+  const double m =
+    std::cbrt(0.2119034982 * r + 0.6806995451 * g + 0.1073969566 * b);
+  const double s =
+    std::cbrt(0.0883024619 * r + 0.2817188376 * g + 0.6299787005 * b);
+  return { 0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s,
+           1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s,
+           0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s };
+}
+
+/// CAM16 viewing-condition constants, see rgb_to_cam16ucs()
+struct Cam16Conditions
+{
+  std::array<double, 3> d_rgb;
+  double f_l;
+  double n;
+  double z;
+  double n_bb;
+  double a_w;
+
+  Cam16Conditions()
+  {
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double l_a = 64.0 / pi * 0.2;
+    constexpr double y_b = 20.0;
+    constexpr double f = 1.0;
+
+    const auto rgb_w = cone_response({ 95.047, 100.0, 108.883 });
+    const double d = std::clamp(
+      f * (1.0 - (1.0 / 3.6) * std::exp((-l_a - 42.0) / 92.0)), 0.0, 1.0);
+    for (int i = 0; i < 3; ++i) {
+      d_rgb[i] = d * 100.0 / rgb_w[i] + 1.0 - d;
+    }
+
+    const double k = 1.0 / (5.0 * l_a + 1.0);
+    const double k4 = k * k * k * k;
+    f_l = 0.2 * k4 * (5.0 * l_a) +
+          0.1 * (1.0 - k4) * (1.0 - k4) * std::cbrt(5.0 * l_a);
+    n = y_b / 100.0;
+    z = 1.48 + std::sqrt(n);
+    n_bb = 0.725 * std::pow(n, -0.2);
+
+    std::array<double, 3> rgb_aw;
+    for (int i = 0; i < 3; ++i) {
+      rgb_aw[i] = adapt(d_rgb[i] * rgb_w[i]);
+    }
+    a_w = achromatic(rgb_aw);
+  }
+
+  static std::array<double, 3> cone_response(const std::array<double, 3>& xyz)
+  {
+    const auto [x, y, z] = xyz;
+    return { 0.401288 * x + 0.650173 * y - 0.051461 * z,
+             -0.250268 * x + 1.204414 * y + 0.045854 * z,
+             -0.002079 * x + 0.048952 * y + 0.953127 * z };
+  }
+
+  double adapt(double c) const
+  {
+    const double t = std::pow(f_l * std::abs(c) / 100.0, 0.42);
+    return std::copysign(400.0 * t / (t + 27.13), c) + 0.1;
+  }
+
+  double achromatic(const std::array<double, 3>& rgb_a) const
+  {
+    return (2.0 * rgb_a[0] + rgb_a[1] + 0.05 * rgb_a[2] - 0.305) * n_bb;
+  }
+};
+
+std::array<double, 3>
+xyz_to_cam16ucs(const std::array<double, 3>& xyz)
+{
+  static const Cam16Conditions vc;
+  constexpr double c = 0.69;
+  constexpr double n_c = 1.0;
+
+  const auto rgb = Cam16Conditions::cone_response(
+    { 100.0 * xyz[0], 100.0 * xyz[1], 100.0 * xyz[2] });
+  std::array<double, 3> rgb_a;
+  for (int i = 0; i < 3; ++i) {
+    rgb_a[i] = vc.adapt(vc.d_rgb[i] * rgb[i]);
+  }
+
+  const double a = rgb_a[0] - 12.0 * rgb_a[1] / 11.0 + rgb_a[2] / 11.0;
+  const double b = (rgb_a[0] + rgb_a[1] - 2.0 * rgb_a[2]) / 9.0;
+  const double h = std::atan2(b, a);
+  const double e_t = 0.25 * (std::cos(h + 2.0) + 3.8);
+
+  const double ratio = std::max(vc.achromatic(rgb_a) / vc.a_w, 0.0);
+  const double j = 100.0 * std::pow(ratio, c * vc.z);
+  const double t = (50000.0 / 13.0 * n_c * vc.n_bb * e_t * std::hypot(a, b)) /
+                   (rgb_a[0] + rgb_a[1] + 1.05 * rgb_a[2]);
+  const double chroma = std::pow(t, 0.9) * std::sqrt(j / 100.0) *
+                        std::pow(1.64 - std::pow(0.29, vc.n), 0.73);
+  const double m = chroma * std::pow(vc.f_l, 0.25);
+
+  const double j_ucs = 1.7 * j / (1.0 + 0.007 * j);
+  const double m_ucs = std::log1p(0.0228 * m) / 0.0228;
+  return { j_ucs, m_ucs * std::cos(h), m_ucs * std::sin(h) };
+}
+
+int
+hex_digit(char c)
+{
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+int
+to_byte(double x)
+{
+  return static_cast<int>(std::lround(std::clamp(x, 0.0, 1.0) * 255.0));
+}
+
+} // namespace
+
+std::array<double, 3>
+hex_to_rgb(const std::string& hex)
+{
+  if (hex.size() != 7 || hex[0] != '#') {
+    throw std::invalid_argument("Invalid hex color format: " + hex);
+  }
+  std::array<double, 3> rgb;
+  for (int k = 0; k < 3; ++k) {
+    const int hi = hex_digit(hex[1 + 2 * k]);
+    const int lo = hex_digit(hex[2 + 2 * k]);
+    if (hi < 0 || lo < 0) {
+      throw std::invalid_argument("Invalid hex color format: " + hex);
+    }
+    rgb[k] = (hi * 16 + lo) / 255.0;
+  }
+  return rgb;
+}
+
+std::string
+rgb_to_hex(double r, double g, double b)
+{
+  char buf[8];
+  std::snprintf(
+    buf, sizeof(buf), "#%02x%02x%02x", to_byte(r), to_byte(g), to_byte(b));
+  return buf;
+}
+
 std::array<double, 3>
 rgb_to_hsl(double r, double g, double b)
 {
@@ -51,6 +285,70 @@ rgb_to_lch(double r, double g, double b)
   return { lch.l(), lch.c(), lch.h() };
 }
 
+std::array<double, 3>
+rgb_to_oklab(double r, double g, double b)
+{
+  return linear_rgb_to_oklab(
+    { srgb_to_linear(r), srgb_to_linear(g), srgb_to_linear(b) });
+}
+
+std::array<double, 3>
+oklab_to_rgb(double l, double a, double b)
+{
+  return linear_to_srgb_unclamped(oklab_to_linear_rgb(l, a, b));
+}
+
+std::array<double, 3>
+lab_to_rgb(double l, double a, double b)
+{
+  return linear_to_srgb_unclamped(lab_to_linear_rgb(l, a, b));
+}
+
+std::array<double, 3>
+lab_to_linear_rgb(double l, double a, double b)
+{
+  return xyz_to_linear_rgb(lab_to_xyz(l, a, b));
+}
+
+std::array<double, 3>
+oklab_to_linear_rgb(double l, double a, double b)
+{
+  const double lc = l + 0.3963377774 * a + 0.2158037573 * b;
+  const double mc = l - 0.1055613458 * a - 0.0638541728 * b;
+  const double sc = l - 0.0894841775 * a - 1.2914855480 * b;
+  const double l3 = lc * lc * lc;
+  const double m3 = mc * mc * mc;
+  const double s3 = sc * sc * sc;
+  return { 4.0767416621 * l3 - 3.3077115913 * m3 + 0.2309699292 * s3,
+           -1.2684380046 * l3 + 2.6097574011 * m3 - 0.3413193965 * s3,
+           -0.0041960863 * l3 - 0.7034186147 * m3 + 1.7076147010 * s3 };
+}
+
+std::array<double, 3>
+oklab_to_lab(double l, double a, double b)
+{
+  return xyz_to_lab(linear_rgb_to_xyz(oklab_to_linear_rgb(l, a, b)));
+}
+
+std::array<double, 3>
+rgb_to_cam16ucs(double r, double g, double b)
+{
+  return xyz_to_cam16ucs(linear_rgb_to_xyz(
+    { srgb_to_linear(r), srgb_to_linear(g), srgb_to_linear(b) }));
+}
+
+std::array<double, 3>
+lab_to_oklab(double l, double a, double b)
+{
+  return linear_rgb_to_oklab(xyz_to_linear_rgb(lab_to_xyz(l, a, b)));
+}
+
+std::array<double, 3>
+lab_to_cam16ucs(double l, double a, double b)
+{
+  return xyz_to_cam16ucs(lab_to_xyz(l, a, b));
+}
+
 std::array<double, 3>
 simulate_cvd(double r,
              double g,
@@ -63,3 +361,25 @@ simulate_cvd(double r,
     qualpal::simulateCvd(rgb, cvd_type, severity);
   return { simulated.r(), simulated.g(), simulated.b() };
 }
+
+void
+validate_cvd(const std::string& cvd_type, double severity)
+{
+  if (cvd_type != "protan" && cvd_type != "deutan" && cvd_type != "tritan") {
+    throw std::invalid_argument("Unknown CVD type: " + cvd_type +
+                                ". Must be 'protan', 'deutan' or 'tritan'");
+  }
+  if (!(severity >= 0.0 && severity <= 1.0)) {
+    throw std::invalid_argument("Severity of " + cvd_type +
+                                " must be in [0, 1], got " +
+                                std::to_string(severity));
+  }
+}
+
+void
+validate_cvd_conditions(const std::map<std::string, double>& cvd)
+{
+  for (const auto& [cvd_type, severity] : cvd) {
+    validate_cvd(cvd_type, severity);
+  }
+}
@@ -10,8 +10,29 @@
 #pragma once
 
 #include <array>
+#include <map>
 #include <string>
 
+/**
+ * @brief Parse a hex color string
+ * @param hex Hex color string in format #RRGGBB (case-insensitive)
+ * @return Array of [red, green, blue] in range [0, 1]
+ * @throws std::invalid_argument If the string is not a valid hex color
+ */
+std::array<double, 3>
+hex_to_rgb(const std::string& hex);
+
+/**
+ * @brief Format an RGB color as a hex string
+ * @param r Red component in range [0, 1]
+ * @param g Green component in range [0, 1]
+ * @param b Blue component in range [0, 1]
+ * @return Lowercase hex string in format #rrggbb, with each component
+ *         clamped to [0, 1] and rounded to 8 bits
+ */
+std::string
+rgb_to_hex(double r, double g, double b);
+
 /**
  * @brief Convert RGB to HSL color space
  * @param r Red component in range [0, 1]
@@ -71,6 +92,108 @@ rgb_to_lab(double r, double g, double b);
 std::array<double, 3>
 rgb_to_lch(double r, double g, double b);
 
+/**
+ * @brief Convert RGB to OKLab color space
+ * @param r Red component in range [0, 1]
+ * @param g Green component in range [0, 1]
+ * @param b Blue component in range [0, 1]
+ * @return Array of [L, a, b] where L is in range [0, 1]
+ */
+std::array<double, 3>
+rgb_to_oklab(double r, double g, double b);
+
+/**
+ * @brief Convert OKLab to RGB color space
+ * @param l Lightness in range [0, 1]
+ * @param a Green-red axis
+ * @param b Blue-yellow axis
+ * @return Array of [red, green, blue], not clamped, so components lie
+ *         outside [0, 1] for colors outside the sRGB gamut
+ */
+std::array<double, 3>
+oklab_to_rgb(double l, double a, double b);
+
+/**
+ * @brief Convert CIE Lab (D65) to RGB color space
+ * @param l L* in range [0, 100]
+ * @param a a* component
+ * @param b b* component
+ * @return Array of [red, green, blue], not clamped, so components lie
+ *         outside [0, 1] for colors outside the sRGB gamut
+ */
+std::array<double, 3>
+lab_to_rgb(double l, double a, double b);
+
+/**
+ * @brief Convert CIE Lab (D65) to linear-light sRGB
+ *
+ * The sRGB transfer function is monotonic, so a color is in the gamut
+ * exactly when its linear components are, and testing them skips the
+ * transfer function.
+ *
+ * @param l L* in range [0, 100]
+ * @param a a* component
+ * @param b b* component
+ * @return Array of linear [red, green, blue], not clamped
+ */
+std::array<double, 3>
+lab_to_linear_rgb(double l, double a, double b);
+
+/**
+ * @brief Convert OKLab to linear-light sRGB
+ * @param l Lightness in range [0, 1]
+ * @param a Green-red axis
+ * @param b Blue-yellow axis
+ * @return Array of linear [red, green, blue], not clamped
+ * @see lab_to_linear_rgb()
+ */
+std::array<double, 3>
+oklab_to_linear_rgb(double l, double a, double b);
+
+/**
+ * @brief Convert OKLab to CIE Lab (D65)
+ * @param l Lightness in range [0, 1]
+ * @param a Green-red axis
+ * @param b Blue-yellow axis
+ * @return Array of [L*, a*, b*]
+ */
+std::array<double, 3>
+oklab_to_lab(double l, double a, double b);
+
+/**
+ * @brief Convert RGB to CAM16-UCS color space
+ *
+ * Uses CAM16 with a D65 adopting white, an adapting luminance of
+ * 64 / pi / 5 cd/m^2, a background of Y = 20 and an average surround.
+ *
+ * @param r Red component in range [0, 1]
+ * @param g Green component in range [0, 1]
+ * @param b Blue component in range [0, 1]
+ * @return Array of [J', a', b'] where J' is in range [0, 100]
+ */
+std::array<double, 3>
+rgb_to_cam16ucs(double r, double g, double b);
+
+/**
+ * @brief Convert CIE Lab (D65) to OKLab
+ * @param l L* in range [0, 100]
+ * @param a a* component
+ * @param b b* component
+ * @return Array of [L, a, b]
+ */
+std::array<double, 3>
+lab_to_oklab(double l, double a, double b);
+
+/**
+ * @brief Convert CIE Lab (D65) to CAM16-UCS
+ * @param l L* in range [0, 100]
+ * @param a a* component
+ * @param b b* component
+ * @return Array of [J', a', b'], see rgb_to_cam16ucs()
+ */
+std::array<double, 3>
+lab_to_cam16ucs(double l, double a, double b);
+
 /**
  * @brief Simulate color vision deficiency on an RGB color
  * @param r Red component in range [0, 1]
@@ -87,3 +210,28 @@ simulate_cvd(double r,
              double b,
              const std::string& cvd_type,
              double severity);
+
+/**
+ * @brief Check a CVD type and severity, as simulate_cvd() does
+ * @param cvd_type Type of CVD: "protan", "deutan", or "tritan"
+ * @param severity Severity in range [0, 1]
+ * @throws std::invalid_argument If the type is unknown or the severity is
+ * out of range
+ */
+void
+validate_cvd(const std::string& cvd_type, double severity);
+
+/**
+ * @brief Check CVD conditions before simulating colors with them
+ *
+ * simulate_cvd() throws for invalid conditions, but an exception must not
+ * escape an OpenMP parallel region: it would terminate the process. Every
+ * function that simulates colors inside a parallel region therefore checks
+ * its conditions with this first, outside the region.
+ *
+ * @param cvd CVD types mapped to severities
+ * @throws std::invalid_argument If a type is unknown or a severity is out
+ * of range, see validate_cvd()
+ */
+void
+validate_cvd_conditions(const std::map<std::string, double>& cvd);
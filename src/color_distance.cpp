@@ -5,66 +5,271 @@
 
 #include "color_distance.h"
 
-#include <qualpal/color_difference.h>
-#include <qualpal/colors.h>
-#include <qualpal/metrics.h>
+#include "color_conversions.h"
+#include "metric_kernels.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief Record @p d as the nearest distance of @p k if it improves on the
+ * current one, breaking ties towards the smaller index
+ */
+void
+update_nearest(std::vector<std::int64_t>& nearest,
+               std::vector<double>& distances,
+               std::size_t k,
+               std::int64_t index,
+               double d)
+{
+  if (d < distances[k] || (d == distances[k] && index < nearest[k])) {
+    distances[k] = d;
+    nearest[k] = index;
+  }
+}
+
+} // namespace
+
+Metric
+parse_metric(const std::string& metric)
+{
+  if (metric == "ciede2000") {
+    return Metric::CIEDE2000;
+  } else if (metric == "din99d") {
+    return Metric::DIN99d;
+  } else if (metric == "cie76") {
+    return Metric::CIE76;
+  } else if (metric == "oklab") {
+    return Metric::OKLab;
+  } else if (metric == "cam16ucs") {
+    return Metric::CAM16UCS;
+  } else if (metric == "cie94") {
+    return Metric::CIE94;
+  } else if (metric == "cmc") {
+    return Metric::CMC;
+  }
+  throw std::invalid_argument(
+    "Unknown metric: " + metric +
+    ". Must be 'ciede2000', 'din99d', 'cie76', 'oklab', 'cam16ucs', 'cie94', "
+    "or 'cmc'");
+}
+
+std::string
+metric_name(Metric metric)
+{
+  switch (metric) {
+    case Metric::DIN99d:
+      return "din99d";
+    case Metric::CIE76:
+      return "cie76";
+    case Metric::OKLab:
+      return "oklab";
+    case Metric::CAM16UCS:
+      return "cam16ucs";
+    case Metric::CIE94:
+      return "cie94";
+    case Metric::CMC:
+      return "cmc";
+    case Metric::CIEDE2000:
+    default:
+      return "ciede2000";
+  }
+}
+
+bool
+is_qualpal_metric(Metric metric)
+{
+  return metric == Metric::CIEDE2000 || metric == Metric::DIN99d ||
+         metric == Metric::CIE76;
+}
 
 double
 color_difference(const std::string& hex1,
                  const std::string& hex2,
                  const std::string& metric)
 {
-  // Convert hex strings to RGB
-  qualpal::colors::RGB color1(hex1);
-  qualpal::colors::RGB color2(hex2);
+  // Convert hex strings to Lab
+  const auto rgb1 = hex_to_rgb(hex1);
+  const auto rgb2 = hex_to_rgb(hex2);
+  const auto lab1 = rgb_to_lab(rgb1[0], rgb1[1], rgb1[2]);
+  const auto lab2 = rgb_to_lab(rgb2[0], rgb2[1], rgb2[2]);
 
   // Calculate distance based on metric
-  if (metric == "ciede2000") {
-    return qualpal::metrics::CIEDE2000{}(color1, color2);
-  } else if (metric == "din99d") {
-    return qualpal::metrics::DIN99d{}(color1, color2);
-  } else if (metric == "cie76") {
-    return qualpal::metrics::CIE76{}(color1, color2);
-  } else {
-    throw std::invalid_argument("Unknown metric: " + metric +
-                                ". Must be 'ciede2000', 'din99d', or 'cie76'");
-  }
+  return visit_metric(parse_metric(metric), [&](auto dist) {
+    return dist(dist.point(lab1.data()), dist.point(lab2.data()));
+  });
 }
 
 std::vector<double>
 color_distance_matrix(const std::vector<std::string>& hex_colors,
                       const std::string& metric)
 {
-  // Convert hex strings to RGB
-  std::vector<qualpal::colors::RGB> colors;
-  colors.reserve(hex_colors.size());
-  for (const auto& hex : hex_colors) {
-    colors.emplace_back(hex);
+  // Convert hex strings to Lab
+  std::vector<double> lab(3 * hex_colors.size());
+  for (std::size_t i = 0; i < hex_colors.size(); ++i) {
+    const auto rgb = hex_to_rgb(hex_colors[i]);
+    const auto c = rgb_to_lab(rgb[0], rgb[1], rgb[2]);
+    std::copy(c.begin(), c.end(), &lab[3 * i]);
   }
 
-  // Compute distance matrix based on metric
-  qualpal::Matrix<double> matrix;
-  if (metric == "ciede2000") {
-    matrix =
-      qualpal::colorDifferenceMatrix(colors, qualpal::metrics::CIEDE2000{});
-  } else if (metric == "din99d") {
-    matrix = qualpal::colorDifferenceMatrix(colors, qualpal::metrics::DIN99d{});
-  } else if (metric == "cie76") {
-    matrix = qualpal::colorDifferenceMatrix(colors, qualpal::metrics::CIE76{});
-  } else {
-    throw std::invalid_argument("Unknown metric: " + metric +
-                                ". Must be 'ciede2000', 'din99d', or 'cie76'");
-  }
+  return lab_distance_matrix(lab, parse_metric(metric));
+}
+
+std::vector<double>
+lab_distance_matrix(const std::vector<double>& lab, Metric metric)
+{
+  const auto n = static_cast<std::ptrdiff_t>(lab.size() / 3);
+  std::vector<double> result(static_cast<std::size_t>(n * n), 0.0);
 
-  // Convert matrix to flat vector (row-major order)
-  std::vector<double> result;
-  const std::size_t n = matrix.nrow();
-  result.reserve(n * n);
-  for (std::size_t i = 0; i < n; ++i) {
-    for (std::size_t j = 0; j < n; ++j) {
-      result.push_back(matrix(i, j));
+  // Only the upper triangle is evaluated; mirroring keeps the result exactly
+  // symmetric
+  visit_metric(metric, [&](auto dist) {
+    const auto colors = to_points(dist, lab);
+
+#pragma omp parallel for schedule(dynamic)
+    for (std::ptrdiff_t i = 0; i < n; ++i) {
+      for (std::ptrdiff_t j = i + 1; j < n; ++j) {
+        const double d = dist(colors[i], colors[j]);
+        result[i * n + j] = d;
+        result[j * n + i] = d;
+      }
     }
-  }
+  });
+
+  return result;
+}
+
+std::vector<double>
+lab_cross_distance_matrix(const std::vector<double>& rows,
+                          const std::vector<double>& cols,
+                          Metric metric)
+{
+  const auto m = static_cast<std::ptrdiff_t>(rows.size() / 3);
+  const auto n = static_cast<std::ptrdiff_t>(cols.size() / 3);
+  std::vector<double> result(static_cast<std::size_t>(m * n));
+
+  visit_metric(metric, [&](auto dist) {
+    const auto a = to_points(dist, rows);
+    const auto b = to_points(dist, cols);
+
+#pragma omp parallel for if (m * n > 4096)
+    for (std::ptrdiff_t i = 0; i < m; ++i) {
+      for (std::ptrdiff_t j = 0; j < n; ++j) {
+        result[i * n + j] = dist(a[i], b[j]);
+      }
+    }
+  });
+
+  return result;
+}
+
+std::vector<double>
+lab_distances(const std::array<double, 3>& query,
+              const std::vector<double>& lab,
+              Metric metric)
+{
+  return lab_distances(query, lab.data(), lab.size() / 3, metric);
+}
+
+std::vector<double>
+lab_distances(const std::array<double, 3>& query,
+              const double* lab,
+              std::size_t n,
+              Metric metric)
+{
+  const auto count = static_cast<std::ptrdiff_t>(n);
+  std::vector<double> result(n);
+
+  visit_metric(metric, [&](auto dist) {
+    const auto q = dist.point(query.data());
+
+    // Each color is converted where it is used, so no copy of the
+    // coordinates or their points is made
+#pragma omp parallel for if (count > 4096)
+    for (std::ptrdiff_t i = 0; i < count; ++i) {
+      result[i] = dist(q, dist.point(&lab[3 * i]));
+    }
+  });
 
   return result;
 }
+
+void
+lab_nearest_neighbors(const std::vector<double>& lab,
+                      Metric metric,
+                      std::vector<std::int64_t>& nearest,
+                      std::vector<double>& distances)
+{
+  const std::size_t n = lab.size() / 3;
+  const double inf = std::numeric_limits<double>::infinity();
+
+  nearest.assign(n, -1);
+  distances.assign(n, inf);
+
+  // Each pair is evaluated once and credited to both colors. Threads keep
+  // private minima that are merged at the end, so no pair is computed twice.
+  visit_metric(metric, [&](auto dist) {
+    const auto colors = to_points(dist, lab);
+
+#pragma omp parallel
+    {
+      std::vector<std::int64_t> local_nearest(n, -1);
+      std::vector<double> local_distances(n, inf);
+
+#pragma omp for schedule(dynamic)
+      for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(n); ++i) {
+        for (std::size_t j = i + 1; j < n; ++j) {
+          const double d = dist(colors[i], colors[j]);
+          update_nearest(local_nearest, local_distances, i, j, d);
+          update_nearest(local_nearest, local_distances, j, i, d);
+        }
+      }
+
+#pragma omp critical
+      for (std::size_t k = 0; k < n; ++k) {
+        if (local_nearest[k] >= 0) {
+          update_nearest(
+            nearest, distances, k, local_nearest[k], local_distances[k]);
+        }
+      }
+    }
+  });
+}
+
+double
+lab_min_distance(const std::vector<double>& lab, Metric metric)
+{
+  const auto n = static_cast<std::ptrdiff_t>(lab.size() / 3);
+  double best = std::numeric_limits<double>::infinity();
+
+  // Zero distances (duplicate colors) are skipped
+  visit_metric(metric, [&](auto dist) {
+    const auto colors = to_points(dist, lab);
+
+#pragma omp parallel
+    {
+      double local = std::numeric_limits<double>::infinity();
+
+#pragma omp for schedule(dynamic)
+      for (std::ptrdiff_t i = 0; i < n; ++i) {
+        for (std::ptrdiff_t j = i + 1; j < n; ++j) {
+          const double d = dist(colors[i], colors[j]);
+          if (d > 0 && d < local) {
+            local = d;
+          }
+        }
+      }
+
+#pragma omp critical
+      if (local < best) {
+        best = local;
+      }
+    }
+  });
+
+  return best;
+}
@@ -5,15 +5,59 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
 
+/**
+ * @brief Distance metrics supported by the Lab-based kernels
+ */
+enum class Metric
+{
+  CIEDE2000,
+  DIN99d,
+  CIE76,
+  /// Euclidean distance in OKLab, scaled by 100
+  OKLab,
+  /// Euclidean distance in CAM16-UCS
+  CAM16UCS,
+  /// CIE94 (graphic arts), symmetrized
+  CIE94,
+  /// CMC 2:1, symmetrized
+  CMC
+};
+
+/**
+ * @brief Parse a metric name
+ * @param metric Distance metric: "ciede2000", "din99d", "cie76", "oklab",
+ * "cam16ucs", "cie94", or "cmc"
+ * @return Corresponding Metric value
+ * @throws std::invalid_argument If the metric is unknown
+ */
+Metric
+parse_metric(const std::string& metric);
+
+/**
+ * @brief Name of a metric, as accepted by parse_metric()
+ */
+std::string
+metric_name(Metric metric);
+
+/**
+ * @brief Whether @p metric is implemented by the qualpal library, and can
+ * therefore be used by its palette generator
+ */
+bool
+is_qualpal_metric(Metric metric);
+
 /**
  * @brief Calculate color difference between two colors
  * @param hex1 First color as hex string (e.g., "#ff0000")
  * @param hex2 Second color as hex string (e.g., "#00ff00")
- * @param metric Distance metric: "ciede2000", "din99d", or "cie76"
+ * @param metric Distance metric name, see parse_metric()
  * @return Perceptual color difference as a double
  */
 double
@@ -24,9 +68,81 @@ color_difference(const std::string& hex1,
 /**
  * @brief Calculate distance matrix for a list of colors
  * @param hex_colors Vector of hex color strings
- * @param metric Distance metric: "ciede2000", "din99d", or "cie76"
+ * @param metric Distance metric name, see parse_metric()
  * @return Flattened distance matrix (row-major order, symmetric)
  */
 std::vector<double>
 color_distance_matrix(const std::vector<std::string>& hex_colors,
                       const std::string& metric);
+
+/**
+ * @brief Calculate distance matrix for colors given in Lab space
+ * @param lab Lab coordinates, three consecutive values per color
+ * @param metric Distance metric
+ * @return Flattened distance matrix (row-major order, symmetric)
+ */
+std::vector<double>
+lab_distance_matrix(const std::vector<double>& lab, Metric metric);
+
+/**
+ * @brief Calculate the distances between two sets of colors in Lab space
+ * @param rows Lab coordinates of the first set, three values per color
+ * @param cols Lab coordinates of the second set, three values per color
+ * @param metric Distance metric
+ * @return Flattened m x n matrix (row-major order) of the distance from
+ * each of the m colors in @p rows to each of the n colors in @p cols
+ */
+std::vector<double>
+lab_cross_distance_matrix(const std::vector<double>& rows,
+                          const std::vector<double>& cols,
+                          Metric metric);
+
+/**
+ * @brief Calculate distances from one color to each of a set of colors
+ * @param query Lab coordinates of the query color
+ * @param lab Lab coordinates, three consecutive values per color
+ * @param metric Distance metric
+ * @return Distance from @p query to each color in @p lab
+ */
+std::vector<double>
+lab_distances(const std::array<double, 3>& query,
+              const std::vector<double>& lab,
+              Metric metric);
+
+/**
+ * @brief Calculate distances from one color to each of @p n colors
+ * @param query Lab coordinates of the query color
+ * @param lab Lab coordinates, three consecutive values per color, e.g. of a
+ * candidate set in shared memory
+ * @param n Number of colors in @p lab
+ * @param metric Distance metric
+ * @return Distance from @p query to each color in @p lab
+ */
+std::vector<double>
+lab_distances(const std::array<double, 3>& query,
+              const double* lab,
+              std::size_t n,
+              Metric metric);
+
+/**
+ * @brief Find the nearest other color for every color given in Lab space
+ * @param lab Lab coordinates, three consecutive values per color
+ * @param metric Distance metric
+ * @param nearest Output: index of the nearest other color (-1 if none)
+ * @param distances Output: distance to the nearest other color (infinity
+ * if none)
+ */
+void
+lab_nearest_neighbors(const std::vector<double>& lab,
+                      Metric metric,
+                      std::vector<std::int64_t>& nearest,
+                      std::vector<double>& distances);
+
+/**
+ * @brief Smallest non-zero pairwise distance among colors given in Lab space
+ * @param lab Lab coordinates, three consecutive values per color
+ * @param metric Distance metric
+ * @return Minimum distance, or infinity if there is no non-zero distance
+ */
+double
+lab_min_distance(const std::vector<double>& lab, Metric metric);
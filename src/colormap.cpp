@@ -0,0 +1,215 @@
+/**
+ * @file colormap.cpp
+ * @brief Implementation of continuous colormap construction
+ */
+
+#include "colormap.h"
+
+#include "color_conversions.h"
+#include "gamut.h"
+#include "metric_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+/// Chroma below which a color's hue is meaningless
+constexpr double achromatic_chroma = 1e-4;
+
+/// Piecewise-linear path through control colors in an interpolation space
+class ColorPath
+{
+public:
+  ColorPath(const std::vector<double>& control_lab, InterpolationSpace space)
+    : space_(space)
+  {
+    for (std::size_t i = 0; i + 2 < control_lab.size(); i += 3) {
+      const double l = control_lab[i];
+      const double a = control_lab[i + 1];
+      const double b = control_lab[i + 2];
+      switch (space) {
+        case InterpolationSpace::Lab:
+          points_.push_back({ l, a, b });
+          break;
+        case InterpolationSpace::LCH:
+          points_.push_back(
+            { l, std::hypot(a, b), std::atan2(b, a) * 180.0 / pi });
+          break;
+        case InterpolationSpace::OKLab:
+          points_.push_back(lab_to_oklab(l, a, b));
+          break;
+      }
+    }
+  }
+
+  /// Number of segments; the path is parameterized over [0, segments()]
+  std::size_t segments() const { return points_.size() - 1; }
+
+  /// Lab coordinates of the path at parameter @p t
+  std::array<double, 3> operator()(double t) const
+  {
+    const auto s = std::min(static_cast<std::size_t>(std::max(t, 0.0)),
+                            segments() - 1);
+    const double f = t - static_cast<double>(s);
+    const auto& p = points_[s];
+    const auto& q = points_[s + 1];
+    const auto lerp = [f](double x, double y) { return x + f * (y - x); };
+
+    switch (space_) {
+      case InterpolationSpace::LCH: {
+        // Hue of an achromatic end is taken from the other end
+        const double h0 = p[1] < achromatic_chroma ? q[2] : p[2];
+        const double h1 = q[1] < achromatic_chroma ? h0 : q[2];
+        const double dh = std::remainder(h1 - h0, 360.0);
+        const double h = (h0 + f * dh) * pi / 180.0;
+        const double c = lerp(p[1], q[1]);
+        return { lerp(p[0], q[0]), c * std::cos(h), c * std::sin(h) };
+      }
+      case InterpolationSpace::OKLab:
+        return oklab_to_lab(
+          lerp(p[0], q[0]), lerp(p[1], q[1]), lerp(p[2], q[2]));
+      case InterpolationSpace::Lab:
+        break;
+    }
+    return { lerp(p[0], q[0]), lerp(p[1], q[1]), lerp(p[2], q[2]) };
+  }
+
+private:
+  InterpolationSpace space_;
+  std::vector<std::array<double, 3>> points_;
+};
+
+} // namespace
+
+InterpolationSpace
+parse_interpolation_space(const std::string& space)
+{
+  if (space == "lab") {
+    return InterpolationSpace::Lab;
+  }
+  if (space == "lch") {
+    return InterpolationSpace::LCH;
+  }
+  if (space == "oklab") {
+    return InterpolationSpace::OKLab;
+  }
+  throw std::invalid_argument("Unknown interpolation space: " + space +
+                              ". Must be 'lab', 'lch' or 'oklab'");
+}
+
+std::vector<std::uint8_t>
+build_colormap(const std::vector<double>& control_lab,
+               InterpolationSpace space,
+               Metric metric,
+               std::size_t n_entries)
+{
+  if (control_lab.size() < 6) {
+    throw std::invalid_argument("A colormap needs at least two colors");
+  }
+  if (n_entries < 2) {
+    throw std::invalid_argument("A colormap needs at least two entries");
+  }
+
+  const ColorPath path(control_lab, space);
+
+  // Sample the path densely and map the samples into the gamut
+  const auto n_dense = static_cast<std::ptrdiff_t>(
+    std::max<std::size_t>(64 * path.segments(), 16 * n_entries) + 1);
+  const double t_step =
+    static_cast<double>(path.segments()) / static_cast<double>(n_dense - 1);
+  std::vector<double> dense(3 * static_cast<std::size_t>(n_dense));
+
+#pragma omp parallel for
+  for (std::ptrdiff_t i = 0; i < n_dense; ++i) {
+    const auto lab = path(static_cast<double>(i) * t_step);
+    const auto in_gamut = gamut_map_lab(lab[0], lab[1], lab[2]);
+    std::copy(in_gamut.begin(), in_gamut.end(), &dense[3 * i]);
+  }
+
+  // Measure the distance travelled up to each sample. Gamut mapping can
+  // bend the path sharply, e.g. around the narrow yellow cusp, so intervals
+  // longer than half an entry step are subdivided until they are resolved
+  std::vector<double> ts;
+  std::vector<double> arc;
+  visit_metric(metric, [&](auto dist) {
+    using Point = typename decltype(dist)::Point;
+    const auto point = [&](const std::array<double, 3>& lab) {
+      return dist.point(lab.data());
+    };
+
+    const auto points = to_points(dist, dense);
+    std::vector<double> steps(points.size(), 0.0);
+    double total = 0.0;
+    for (std::ptrdiff_t i = 1; i < n_dense; ++i) {
+      steps[i] = dist(points[i - 1], points[i]);
+      total += steps[i];
+    }
+    const double max_step = 0.5 * total / static_cast<double>(n_entries - 1);
+    constexpr int max_depth = 12;
+
+    ts.push_back(0.0);
+    arc.push_back(0.0);
+    const auto refine = [&](const auto& self,
+                            double t0,
+                            const Point& p0,
+                            double t1,
+                            const Point& p1,
+                            double length,
+                            int depth) -> void {
+      if (length > max_step && depth < max_depth) {
+        const double tm = 0.5 * (t0 + t1);
+        const auto lab = path(tm);
+        const Point pm = point(gamut_map_lab(lab[0], lab[1], lab[2]));
+        self(self, t0, p0, tm, pm, dist(p0, pm), depth + 1);
+        self(self, tm, pm, t1, p1, dist(pm, p1), depth + 1);
+        return;
+      }
+      ts.push_back(t1);
+      arc.push_back(arc.back() + length);
+    };
+    for (std::ptrdiff_t i = 1; i < n_dense; ++i) {
+      refine(refine,
+             static_cast<double>(i - 1) * t_step,
+             points[i - 1],
+             static_cast<double>(i) * t_step,
+             points[i],
+             steps[i],
+             0);
+    }
+  });
+  const double total = arc.back();
+  const auto n_samples = static_cast<std::ptrdiff_t>(arc.size());
+
+  // Place the entries at equal arc length
+  const auto n = static_cast<std::ptrdiff_t>(n_entries);
+  std::vector<std::uint8_t> lut(3 * n_entries);
+
+#pragma omp parallel for
+  for (std::ptrdiff_t k = 0; k < n; ++k) {
+    const double fraction =
+      static_cast<double>(k) / static_cast<double>(n - 1);
+    double t = fraction * static_cast<double>(path.segments());
+    if (total > 0.0) {
+      const double target = fraction * total;
+      const auto upper = std::upper_bound(arc.begin(), arc.end(), target);
+      const auto i = std::clamp<std::ptrdiff_t>(
+        (upper - arc.begin()) - 1, 0, n_samples - 2);
+      const double length = arc[i + 1] - arc[i];
+      const double f =
+        length > 0.0 ? std::clamp((target - arc[i]) / length, 0.0, 1.0) : 0.0;
+      t = ts[i] + f * (ts[i + 1] - ts[i]);
+    }
+
+    const auto lab = path(t);
+    const auto rgb = gamut_map_lab_to_rgb(lab[0], lab[1], lab[2]);
+    for (int c = 0; c < 3; ++c) {
+      lut[3 * k + c] = static_cast<std::uint8_t>(std::lround(rgb[c] * 255.0));
+    }
+  }
+  return lut;
+}
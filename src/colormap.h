@@ -0,0 +1,56 @@
+/**
+ * @file colormap.h
+ * @brief Perceptually uniform continuous colormaps
+ *
+ * A colormap is a path through color space along a sequence of control
+ * colors, sampled into a lookup table. Interpolating linearly between the
+ * control colors gives steps of uneven perceived size, so the path is
+ * reparameterized by arc length: the table entries are spaced at equal
+ * distances under the chosen metric, measured along the path after it has
+ * been mapped into the sRGB gamut.
+ */
+
+#pragma once
+
+#include "color_distance.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Color space in which control colors are interpolated
+ */
+enum class InterpolationSpace
+{
+  Lab,   ///< CIE Lab, straight lines
+  LCH,   ///< CIE LCh, along the shorter hue arc
+  OKLab, ///< OKLab, straight lines
+};
+
+/**
+ * @brief Parse an interpolation space name: "lab", "lch" or "oklab"
+ * @throws std::invalid_argument If the name is unknown
+ */
+InterpolationSpace
+parse_interpolation_space(const std::string& space);
+
+/**
+ * @brief Build a colormap lookup table
+ * @param control_lab Lab coordinates of the control colors, three values
+ * per color, at least two colors
+ * @param space Space in which consecutive control colors are interpolated
+ * @param metric Metric whose distances between consecutive entries are
+ * made equal
+ * @param n_entries Number of table entries, at least two
+ * @return 8-bit sRGB values, three per entry; the first and last entries
+ * are the (gamut-mapped) first and last control colors
+ * @throws std::invalid_argument If there are fewer than two control colors
+ * or entries
+ */
+std::vector<std::uint8_t>
+build_colormap(const std::vector<double>& control_lab,
+               InterpolationSpace space,
+               Metric metric,
+               std::size_t n_entries);
@@ -0,0 +1,138 @@
+/**
+ * @file cvd_distance.cpp
+ * @brief Implementation of CVD-aware distance matrices
+ */
+
+#include "cvd_distance.h"
+
+#include "color_conversions.h"
+#include "metric_kernels.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+/// Lab coordinates of the colors as seen under @p condition
+std::vector<double>
+simulated_lab(const std::vector<double>& rgb, const CvdCondition& condition)
+{
+  const auto n = static_cast<std::ptrdiff_t>(rgb.size() / 3);
+  std::vector<double> lab(rgb.size());
+
+#pragma omp parallel for
+  for (std::ptrdiff_t i = 0; i < n; ++i) {
+    const double* c = &rgb[3 * i];
+    const auto sim =
+      simulate_cvd(c[0], c[1], c[2], condition.type, condition.severity);
+    const auto q = hex_to_rgb(rgb_to_hex(sim[0], sim[1], sim[2]));
+    const auto l = rgb_to_lab(q[0], q[1], q[2]);
+    std::copy(l.begin(), l.end(), &lab[3 * i]);
+  }
+
+  return lab;
+}
+
+} // namespace
+
+CvdReduction
+parse_cvd_reduction(const std::string& reduction)
+{
+  if (reduction == "min") {
+    return CvdReduction::Min;
+  }
+  if (reduction == "mean") {
+    return CvdReduction::Mean;
+  }
+  throw std::invalid_argument("Unknown reduction: " + reduction +
+                              ". Must be 'min' or 'mean'");
+}
+
+std::vector<double>
+cvd_distance_matrix(const std::vector<double>& rgb,
+                    const std::vector<double>& lab,
+                    Metric metric,
+                    const std::vector<CvdCondition>& conditions,
+                    double normal_weight,
+                    CvdReduction reduction)
+{
+  if (normal_weight < 0.0) {
+    throw std::invalid_argument("weights must be non-negative");
+  }
+  for (const auto& condition : conditions) {
+    validate_cvd_conditions({ { condition.type, condition.severity } });
+  }
+
+  // One Lab set per distinct condition; repeated conditions only add weight
+  std::vector<std::pair<std::vector<double>, double>> sets;
+  if (normal_weight > 0.0) {
+    sets.emplace_back(lab, normal_weight);
+  }
+  std::vector<const CvdCondition*> seen;
+  std::vector<std::size_t> seen_set;
+  for (const auto& condition : conditions) {
+    if (condition.weight < 0.0) {
+      throw std::invalid_argument("weights must be non-negative");
+    }
+    if (condition.weight == 0.0) {
+      continue;
+    }
+    const auto match =
+      std::find_if(seen.begin(), seen.end(), [&](const CvdCondition* c) {
+        return c->type == condition.type && c->severity == condition.severity;
+      });
+    if (match != seen.end()) {
+      sets[seen_set[match - seen.begin()]].second += condition.weight;
+      continue;
+    }
+    seen.push_back(&condition);
+    seen_set.push_back(sets.size());
+    sets.emplace_back(simulated_lab(rgb, condition), condition.weight);
+  }
+  if (sets.empty()) {
+    throw std::invalid_argument("At least one condition must have a positive "
+                                "weight");
+  }
+
+  double total_weight = 0.0;
+  for (const auto& set : sets) {
+    total_weight += set.second;
+  }
+
+  const auto n = static_cast<std::ptrdiff_t>(lab.size() / 3);
+  std::vector<double> result(static_cast<std::size_t>(n * n), 0.0);
+
+  visit_metric(metric, [&](auto dist) {
+    std::vector<std::vector<typename decltype(dist)::Point>> points;
+    for (const auto& set : sets) {
+      points.push_back(to_points(dist, set.first));
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (std::ptrdiff_t i = 0; i < n; ++i) {
+      for (std::ptrdiff_t j = i + 1; j < n; ++j) {
+        double d = reduction == CvdReduction::Min
+                     ? std::numeric_limits<double>::infinity()
+                     : 0.0;
+        for (std::size_t k = 0; k < sets.size(); ++k) {
+          const double dk = dist(points[k][i], points[k][j]);
+          if (reduction == CvdReduction::Min) {
+            d = std::min(d, dk);
+          } else {
+            d += sets[k].second * dk;
+          }
+        }
+        if (reduction == CvdReduction::Mean) {
+          d /= total_weight;
+        }
+        result[i * n + j] = d;
+        result[j * n + i] = d;
+      }
+    }
+  });
+
+  return result;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file cvd_distance.h
+ * @brief Distance matrices combined over normal and deficient color vision
+ */
+
+#pragma once
+
+#include "color_distance.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief A simulated color vision deficiency and its weight
+ */
+struct CvdCondition
+{
+  /// Type of CVD: "protan", "deutan", or "tritan"
+  std::string type;
+  /// Severity in range [0, 1]
+  double severity = 1.0;
+  /// Weight of the condition; conditions with zero weight are ignored
+  double weight = 1.0;
+};
+
+/**
+ * @brief How distance matrices for different conditions are combined
+ */
+enum class CvdReduction
+{
+  /// Element-wise minimum, i.e. the worst case over all conditions
+  Min,
+  /// Element-wise weighted mean
+  Mean
+};
+
+/**
+ * @brief Parse a reduction name
+ * @param reduction "min" or "mean"
+ * @throws std::invalid_argument If the reduction is unknown
+ */
+CvdReduction
+parse_cvd_reduction(const std::string& reduction);
+
+/**
+ * @brief Combine distance matrices under normal vision and simulated CVD
+ *
+ * Each color is simulated and converted to Lab once per distinct condition;
+ * the per-condition distances of a pair are then reduced on the fly, so no
+ * intermediate matrices are stored. Simulated colors are rounded to 8-bit
+ * sRGB, matching the result of simulating a palette and computing its
+ * distance matrix.
+ *
+ * @param rgb RGB values in range [0, 1], three consecutive values per color
+ * @param lab Lab coordinates of the same colors
+ * @param metric Distance metric
+ * @param conditions CVD conditions to include
+ * @param normal_weight Weight of normal vision (0 to exclude it)
+ * @param reduction How the per-condition distances are combined
+ * @return Flattened n x n matrix (row-major order, symmetric)
+ * @throws std::invalid_argument If a weight is negative, all weights are
+ * zero, or a condition is invalid, see validate_cvd_conditions()
+ */
+std::vector<double>
+cvd_distance_matrix(const std::vector<double>& rgb,
+                    const std::vector<double>& lab,
+                    Metric metric,
+                    const std::vector<CvdCondition>& conditions,
+                    double normal_weight,
+                    CvdReduction reduction);
@@ -0,0 +1,157 @@
+/**
+ * @file distance_file.cpp
+ * @brief Implementation of on-disk distance matrices
+ */
+
+#include "distance_file.h"
+
+#include "metric_kernels.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t header_size = 64;
+
+/// Header as laid out on disk; see distance_file.h
+std::vector<char>
+make_header(std::size_t n,
+            Metric metric,
+            MatrixLayout layout,
+            std::uint32_t itemsize)
+{
+  std::vector<char> header(header_size, 0);
+  const auto put = [&](std::size_t offset, auto value) {
+    std::memcpy(header.data() + offset, &value, sizeof(value));
+  };
+
+  std::memcpy(header.data(), "QPALDIST", 8);
+  put(8, std::uint32_t{ 1 });
+  put(12, std::uint32_t{ 0x01020304 });
+  put(16, static_cast<std::uint32_t>(layout == MatrixLayout::Full ? 0 : 1));
+  put(20, itemsize);
+  put(24, static_cast<std::uint64_t>(n));
+  put(32, static_cast<std::uint64_t>(header_size));
+  const auto name = metric_name(metric);
+  std::memcpy(
+    header.data() + 40, name.data(), std::min(name.size(), std::size_t{ 15 }));
+  return header;
+}
+
+/**
+ * @brief Compute the matrix block by block as @p T and append it to @p out
+ */
+template<typename T, typename Kernel>
+void
+write_rows(std::ofstream& out,
+           const Kernel& dist,
+           const std::vector<typename Kernel::Point>& points,
+           MatrixLayout layout,
+           std::size_t tile_bytes)
+{
+  const auto n = static_cast<std::ptrdiff_t>(points.size());
+  const bool full = layout == MatrixLayout::Full;
+
+  // Number of entries stored for row i
+  const auto row_length = [&](std::ptrdiff_t i) {
+    return static_cast<std::size_t>(full ? n : n - i - 1);
+  };
+
+  std::vector<T> tile;
+  std::ptrdiff_t first = 0;
+  while (first < n) {
+    // Grow the block while it fits in the tile, always taking one row
+    std::ptrdiff_t last = first;
+    std::size_t size = 0;
+    do {
+      size += row_length(last);
+      ++last;
+    } while (last < n &&
+             (size + row_length(last)) * sizeof(T) <= tile_bytes);
+
+    tile.resize(size);
+    std::vector<std::size_t> starts(static_cast<std::size_t>(last - first));
+    for (std::ptrdiff_t i = first, start = 0; i < last; ++i) {
+      starts[i - first] = static_cast<std::size_t>(start);
+      start += static_cast<std::ptrdiff_t>(row_length(i));
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (std::ptrdiff_t i = first; i < last; ++i) {
+      T* row = tile.data() + starts[i - first];
+      if (full) {
+        for (std::ptrdiff_t j = 0; j < i; ++j) {
+          row[j] = static_cast<T>(dist(points[j], points[i]));
+        }
+        row[i] = T{ 0 };
+        for (std::ptrdiff_t j = i + 1; j < n; ++j) {
+          row[j] = static_cast<T>(dist(points[i], points[j]));
+        }
+      } else {
+        for (std::ptrdiff_t j = i + 1; j < n; ++j) {
+          row[j - i - 1] = static_cast<T>(dist(points[i], points[j]));
+        }
+      }
+    }
+
+    out.write(reinterpret_cast<const char*>(tile.data()),
+              static_cast<std::streamsize>(tile.size() * sizeof(T)));
+    if (!out) {
+      throw std::runtime_error("Failed to write distance matrix");
+    }
+    first = last;
+  }
+}
+
+} // namespace
+
+MatrixLayout
+parse_matrix_layout(const std::string& layout)
+{
+  if (layout == "full") {
+    return MatrixLayout::Full;
+  }
+  if (layout == "condensed") {
+    return MatrixLayout::Condensed;
+  }
+  throw std::invalid_argument("Unknown layout: " + layout +
+                              ". Must be 'full' or 'condensed'");
+}
+
+void
+write_lab_distance_matrix(const std::string& path,
+                          const std::vector<double>& lab,
+                          Metric metric,
+                          MatrixLayout layout,
+                          bool single_precision,
+                          std::size_t tile_bytes)
+{
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Cannot open '" + path + "' for writing");
+  }
+
+  const std::size_t n = lab.size() / 3;
+  const auto header =
+    make_header(n, metric, layout, single_precision ? 4u : 8u);
+  out.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+  visit_metric(metric, [&](auto dist) {
+    const auto points = to_points(dist, lab);
+    if (single_precision) {
+      write_rows<float>(out, dist, points, layout, tile_bytes);
+    } else {
+      write_rows<double>(out, dist, points, layout, tile_bytes);
+    }
+  });
+
+  out.close();
+  if (!out) {
+    throw std::runtime_error("Failed to write distance matrix to '" + path +
+                             "'");
+  }
+}
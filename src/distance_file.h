@@ -0,0 +1,72 @@
+/**
+ * @file distance_file.h
+ * @brief Distance matrices written to disk for memory mapping
+ *
+ * A distance file is a 64-byte header followed by the matrix as a flat array
+ * in native byte order, so that it can be memory-mapped without conversion:
+ *
+ * | Offset | Type       | Field                                        |
+ * |--------|------------|----------------------------------------------|
+ * | 0      | char[8]    | Magic, "QPALDIST"                            |
+ * | 8      | uint32     | Format version, currently 1                  |
+ * | 12     | uint32     | 0x01020304, to detect the byte order         |
+ * | 16     | uint32     | Layout: 0 = full, 1 = condensed              |
+ * | 20     | uint32     | Bytes per element: 4 (float32) or 8 (float64) |
+ * | 24     | uint64     | Number of colors                             |
+ * | 32     | uint64     | Offset of the data, currently 64             |
+ * | 40     | char[16]   | Metric name, zero-padded                     |
+ * | 56     | (reserved) | Zero                                         |
+ *
+ * The full layout is the row-major n x n matrix. The condensed layout holds
+ * the upper triangle row by row, n (n - 1) / 2 entries, in the order used by
+ * scipy.spatial.distance.pdist.
+ */
+
+#pragma once
+
+#include "color_distance.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Storage layout of a distance file
+ */
+enum class MatrixLayout
+{
+  Full,
+  Condensed
+};
+
+/**
+ * @brief Parse a layout name
+ * @param layout "full" or "condensed"
+ * @throws std::invalid_argument If the layout is unknown
+ */
+MatrixLayout
+parse_matrix_layout(const std::string& layout);
+
+/**
+ * @brief Write the distance matrix of colors given in Lab space to a file
+ * @param path Output file, replaced if it exists
+ * @param lab Lab coordinates, three consecutive values per color
+ * @param metric Distance metric
+ * @param layout Full or condensed storage
+ * @param single_precision Store float32 rather than float64
+ * @param tile_bytes Size of the buffer holding the rows being computed
+ * @throws std::runtime_error If the file cannot be written
+ *
+ * Rows are computed in blocks that fill at most @p tile_bytes (but at least
+ * one row), in parallel within each block, and appended to the file, so
+ * memory use does not grow with the size of the matrix. Every pair is
+ * evaluated with the lower index first, which keeps the full layout exactly
+ * symmetric.
+ */
+void
+write_lab_distance_matrix(const std::string& path,
+                          const std::vector<double>& lab,
+                          Metric metric,
+                          MatrixLayout layout,
+                          bool single_precision,
+                          std::size_t tile_bytes);
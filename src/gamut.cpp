@@ -0,0 +1,465 @@
+/**
+ * @file gamut.cpp
+ * @brief Implementation of sRGB gamut mapping
+ */
+
+#include "gamut.h"
+
+#include "color_conversions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+/// Slack for components that are only out of range by the rounding of
+/// conversions, far below an 8-bit step
+constexpr double gamut_tolerance = 1e-5;
+
+/// The same slack for linear-light components, at either end of the range
+const double linear_low = -gamut_tolerance / 12.92;
+const double linear_high = std::pow((1.0 + gamut_tolerance + 0.055) / 1.055,
+                                    2.4);
+
+/// Width of the chroma bracket at which the binary search stops
+constexpr double chroma_tolerance = 1e-5;
+
+/// First step when bracketing the boundary around a starting point; the
+/// table is usually closer than this to the boundary
+constexpr double bracket_step = 0.25;
+
+/// Whether linear-light sRGB components are displayable
+bool
+linear_in_gamut(const std::array<double, 3>& rgb)
+{
+  return std::all_of(rgb.begin(), rgb.end(), [](double x) {
+    return x >= linear_low && x <= linear_high;
+  });
+}
+
+/// Chroma of OKLab in table units, which puts the largest chroma in sRGB
+/// near that of CIE LCh
+constexpr double oklab_chroma_scale = 400.0;
+
+/**
+ * Ray of constant lightness and hue in table units: lightness in [0, 100]
+ * and chroma on a scale like that of CIE LCh
+ */
+struct Ray
+{
+  PolarSpace space;
+  double l;
+  double cos_h;
+  double sin_h;
+
+  /// Linear sRGB of the color on the ray at chroma @p c
+  std::array<double, 3> linear_rgb(double c) const
+  {
+    if (space == PolarSpace::OKLCH) {
+      const double ok = c / oklab_chroma_scale;
+      return oklab_to_linear_rgb(l / 100.0, ok * cos_h, ok * sin_h);
+    }
+    return lab_to_linear_rgb(l, c * cos_h, c * sin_h);
+  }
+
+  /// Whether the color on the ray at chroma @p c is in the sRGB gamut
+  bool inside(double c) const { return linear_in_gamut(linear_rgb(c)); }
+};
+
+/**
+ * Largest in-gamut chroma on @p ray, searched from @p guess. Chroma
+ * @p limit is known to be out of the gamut, and the result does not exceed
+ * it. Grays are in the gamut at every lightness, so the search can always
+ * step down to zero.
+ */
+double
+boundary_chroma(const Ray& ray, double guess, double limit)
+{
+  // Bracket the boundary, doubling the step away from the guess
+  double lo = 0.0;
+  double hi = 0.0;
+  double step = bracket_step;
+  guess = std::clamp(guess, 0.0, limit);
+  if (ray.inside(guess)) {
+    lo = guess;
+    for (;;) {
+      hi = std::min(lo + step, limit);
+      if (hi == limit || !ray.inside(hi)) {
+        break;
+      }
+      lo = hi;
+      step *= 2.0;
+    }
+  } else {
+    hi = guess;
+    for (;;) {
+      lo = std::max(hi - step, 0.0);
+      if (lo == 0.0 || ray.inside(lo)) {
+        break;
+      }
+      hi = lo;
+      step *= 2.0;
+    }
+  }
+
+  while (hi - lo > chroma_tolerance) {
+    const double mid = 0.5 * (lo + hi);
+    if (ray.inside(mid)) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/// Chroma above that of every sRGB color
+constexpr double max_chroma = 140.0;
+
+/// Step of the scans that look for the outermost gamut boundary when the
+/// table is built, and the finer one used for rays with gaps nearby, where
+/// the outermost in-gamut range of chroma can be narrow
+constexpr double scan_step = 1.0;
+constexpr double fine_scan_step = 0.05;
+
+/// Margin by which the largest chroma between two lightness levels of the
+/// table can exceed that at both levels, near the cusps of the gamut
+constexpr double row_max_slack = 5.0;
+
+/// Distance of a linear component from 1 within which a peak along a ray
+/// marks a gap on nearby rays, and the same from 0 for a dip
+constexpr double peak_margin = 0.02;
+constexpr double dip_margin = 1e-4;
+
+/// Chroma beyond the boundary of a ray up to which peaks and dips are
+/// looked for; a nearby ray can stay in the gamut further out
+constexpr double gap_scan_margin = 20.0;
+
+/**
+ * Largest in-gamut chroma not exceeding @p top on @p ray, found by scanning
+ * down from @p top in steps of @p step. A ray can leave the gamut and enter
+ * it again, and bracketing from a guess may then find an inner boundary.
+ */
+double
+scan_boundary_chroma(const Ray& ray, double top, double step)
+{
+  double c = top;
+  while (c > 0.0 && !ray.inside(c)) {
+    c -= step;
+  }
+  c = std::max(c, 0.0);
+  return boundary_chroma(ray, c, std::min(c + step, top));
+}
+
+/**
+ * Whether @p ray, or one near it, leaves the gamut below @p boundary and
+ * enters it again. In CIE LCh that happens near the yellow cusp, where the
+ * red component peaks just above 1 and falls back, and in OKLCh near blue,
+ * where it dips just below 0 and rises again. Peaks close to 1 and dips
+ * close to 0 count too, even just past the boundary.
+ */
+bool
+has_gap_nearby(const Ray& ray, double boundary)
+{
+  auto previous = ray.linear_rgb(0.0);
+  auto current = ray.linear_rgb(std::min(scan_step, boundary));
+  const double end = boundary + gap_scan_margin;
+  for (double c = 2.0 * scan_step; c < end; c += scan_step) {
+    const auto next = ray.linear_rgb(c);
+    for (int k = 0; k < 3; ++k) {
+      const bool peak = current[k] > previous[k] && current[k] >= next[k];
+      const bool dip = current[k] < previous[k] && current[k] <= next[k];
+      if ((peak && current[k] > linear_high - peak_margin) ||
+          (dip && current[k] < linear_low + dip_margin) ||
+          (c < boundary &&
+           (current[k] > linear_high || current[k] < linear_low))) {
+        return true;
+      }
+    }
+    previous = current;
+    current = next;
+  }
+  return false;
+}
+
+/// Largest in-gamut chroma of a polar space on a grid of lightness and hue
+class BoundaryTable
+{
+public:
+  /// Grid steps: lightness 0, 1, ..., 100 in table units and h = 0, 1, ...,
+  /// 359 degrees
+  static constexpr int l_steps = 100;
+  static constexpr int h_steps = 360;
+
+  explicit BoundaryTable(PolarSpace space)
+    : chroma_(static_cast<std::size_t>((l_steps + 1) * h_steps))
+    , irregular_(chroma_.size())
+    , row_max_(l_steps + 1)
+  {
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i <= l_steps; ++i) {
+      const double l = 100.0 * static_cast<double>(i) / l_steps;
+      for (int j = 0; j < h_steps; ++j) {
+        const double h = 2.0 * pi * j / h_steps;
+        const Ray ray{ space, l, std::cos(h), std::sin(h) };
+        const double boundary =
+          scan_boundary_chroma(ray, max_chroma, scan_step);
+        chroma_[i * h_steps + j] = boundary;
+        irregular_[i * h_steps + j] = has_gap_nearby(ray, boundary);
+      }
+      row_max_[i] = *std::max_element(chroma_.begin() + i * h_steps,
+                                      chroma_.begin() + (i + 1) * h_steps);
+    }
+  }
+
+  /**
+   * Largest in-gamut chroma not exceeding @p limit on @p ray, whose hue is
+   * @p h degrees
+   */
+  double boundary(const Ray& ray, double h, double limit) const
+  {
+    const double x = ray.l / 100.0 * l_steps;
+    const double y = (h - 360.0 * std::floor(h / 360.0)) / 360.0 * h_steps;
+    const int i = std::clamp(static_cast<int>(x), 0, l_steps - 1);
+    const int j = std::clamp(static_cast<int>(y), 0, h_steps - 1);
+    const std::size_t corners[] = { index(i, j),
+                                    index(i, (j + 1) % h_steps),
+                                    index(i + 1, j),
+                                    index(i + 1, (j + 1) % h_steps) };
+
+    // Rays that leave the gamut and enter it again are scanned, from just
+    // above the largest chroma at the neighboring lightness levels
+    if (std::any_of(std::begin(corners), std::end(corners), [this](auto k) {
+          return irregular_[k] != 0;
+        })) {
+      const double top =
+        std::max(row_max_[i], row_max_[i + 1]) + row_max_slack;
+      return scan_boundary_chroma(ray, std::min(limit, top), fine_scan_step);
+    }
+
+    // Elsewhere the table is interpolated bilinearly and the search starts
+    // from there
+    const double fx = x - i;
+    const double fy = y - j;
+    const double guess = (1.0 - fx) * (1.0 - fy) * chroma_[corners[0]] +
+                         (1.0 - fx) * fy * chroma_[corners[1]] +
+                         fx * (1.0 - fy) * chroma_[corners[2]] +
+                         fx * fy * chroma_[corners[3]];
+    return boundary_chroma(ray, guess, limit);
+  }
+
+private:
+  static std::size_t index(int i, int j)
+  {
+    return static_cast<std::size_t>(i * h_steps + j);
+  }
+
+  std::vector<double> chroma_;
+  std::vector<char> irregular_;
+  std::vector<double> row_max_;
+};
+
+/// The table of @p space, built on first use
+const BoundaryTable&
+boundary_table(PolarSpace space)
+{
+  if (space == PolarSpace::OKLCH) {
+    static const BoundaryTable oklch(PolarSpace::OKLCH);
+    return oklch;
+  }
+  static const BoundaryTable lch(PolarSpace::LCH);
+  return lch;
+}
+
+/// Lightness and chroma units of @p space per table unit
+std::array<double, 2>
+table_units(PolarSpace space)
+{
+  if (space == PolarSpace::OKLCH) {
+    return { 0.01, 1.0 / oklab_chroma_scale };
+  }
+  return { 1.0, 1.0 };
+}
+
+/// Hue angle in degrees in [0, 360) of Lab chromatic components
+double
+hue_degrees(double a, double b)
+{
+  const double h = std::atan2(b, a) * 180.0 / pi;
+  return h < 0.0 ? h + 360.0 : h;
+}
+
+/// Polar coordinates of Lab or OKLab coordinates
+std::array<double, 3>
+to_polar(const std::array<double, 3>& lab)
+{
+  return { lab[0], std::hypot(lab[1], lab[2]), hue_degrees(lab[1], lab[2]) };
+}
+
+/// Lab or OKLab coordinates of polar coordinates
+std::array<double, 3>
+to_cartesian(const std::array<double, 3>& lch)
+{
+  const double angle = lch[2] * pi / 180.0;
+  return { lch[0], lch[1] * std::cos(angle), lch[1] * std::sin(angle) };
+}
+
+} // namespace
+
+ColorCoordinates
+parse_color_coordinates(const std::string& name)
+{
+  if (name == "lab") {
+    return ColorCoordinates::Lab;
+  }
+  if (name == "lch") {
+    return ColorCoordinates::LCH;
+  }
+  if (name == "oklab") {
+    return ColorCoordinates::OKLab;
+  }
+  if (name == "oklch") {
+    return ColorCoordinates::OKLCH;
+  }
+  if (name == "rgb") {
+    return ColorCoordinates::RGB;
+  }
+  throw std::invalid_argument(
+    "Unknown color coordinates: " + name +
+    ". Must be 'lab', 'lch', 'oklab', 'oklch' or 'rgb'");
+}
+
+bool
+in_srgb_gamut(const std::array<double, 3>& rgb)
+{
+  return std::all_of(rgb.begin(), rgb.end(), [](double c) {
+    return c >= -gamut_tolerance && c <= 1.0 + gamut_tolerance;
+  });
+}
+
+double
+srgb_max_chroma(double l, double h, PolarSpace space)
+{
+  const auto [l_unit, c_unit] = table_units(space);
+  const double angle = h * pi / 180.0;
+  const Ray ray{
+    space, std::clamp(l / l_unit, 0.0, 100.0), std::cos(angle), std::sin(angle)
+  };
+  return c_unit * boundary_table(space).boundary(
+                    ray, h, std::numeric_limits<double>::infinity());
+}
+
+std::array<double, 3>
+gamut_map_lch(double l, double c, double h, PolarSpace space)
+{
+  const auto [l_unit, c_unit] = table_units(space);
+  const double angle = h * pi / 180.0;
+  const Ray ray{
+    space, std::clamp(l / l_unit, 0.0, 100.0), std::cos(angle), std::sin(angle)
+  };
+  const double chroma = std::max(c / c_unit, 0.0);
+  if (ray.inside(chroma)) {
+    return { l_unit * ray.l, c_unit * chroma, h };
+  }
+  return { l_unit * ray.l,
+           c_unit * boundary_table(space).boundary(ray, h, chroma),
+           h };
+}
+
+std::array<double, 3>
+gamut_map_lab(double l, double a, double b)
+{
+  l = std::clamp(l, 0.0, 100.0);
+  if (linear_in_gamut(lab_to_linear_rgb(l, a, b))) {
+    return { l, a, b };
+  }
+
+  // Grays are in the gamut, so the chroma here is positive
+  const double c = std::hypot(a, b);
+  const Ray ray{ PolarSpace::LCH, l, a / c, b / c };
+  const double scale =
+    boundary_table(PolarSpace::LCH).boundary(ray, hue_degrees(a, b), c) / c;
+  return { l, scale * a, scale * b };
+}
+
+std::array<double, 3>
+gamut_map_lab_to_rgb(double l, double a, double b)
+{
+  const auto lab = gamut_map_lab(l, a, b);
+  auto rgb = lab_to_rgb(lab[0], lab[1], lab[2]);
+  for (double& c : rgb) {
+    c = std::clamp(c, 0.0, 1.0);
+  }
+  return rgb;
+}
+
+std::vector<double>
+gamut_map_colors(const double* values,
+                 std::size_t n,
+                 ColorCoordinates input,
+                 ColorCoordinates output)
+{
+  if (input == ColorCoordinates::RGB) {
+    throw std::invalid_argument(
+      "Colors to map must be given as 'lab', 'lch', 'oklab' or 'oklch'");
+  }
+
+  // Colors are mapped in the polar form of their own space
+  const bool ok_input =
+    input == ColorCoordinates::OKLab || input == ColorCoordinates::OKLCH;
+  const bool polar_input =
+    input == ColorCoordinates::LCH || input == ColorCoordinates::OKLCH;
+  const PolarSpace space = ok_input ? PolarSpace::OKLCH : PolarSpace::LCH;
+
+  // Build the table before the threads need it
+  boundary_table(space);
+
+  std::vector<double> out(3 * n);
+  const auto count = static_cast<std::ptrdiff_t>(n);
+
+#pragma omp parallel for
+  for (std::ptrdiff_t i = 0; i < count; ++i) {
+    const double* v = values + 3 * i;
+    double* o = out.data() + 3 * i;
+    if (!std::isfinite(v[0]) || !std::isfinite(v[1]) || !std::isfinite(v[2])) {
+      std::fill(o, o + 3, std::numeric_limits<double>::quiet_NaN());
+      continue;
+    }
+
+    const std::array<double, 3> in = { v[0], v[1], v[2] };
+    const auto polar = polar_input ? in : to_polar(in);
+    const auto lch = gamut_map_lch(polar[0], polar[1], polar[2], space);
+    const auto lab = to_cartesian(lch);
+
+    std::array<double, 3> mapped;
+    switch (output) {
+      case ColorCoordinates::Lab:
+        mapped = ok_input ? oklab_to_lab(lab[0], lab[1], lab[2]) : lab;
+        break;
+      case ColorCoordinates::LCH:
+        mapped = ok_input ? to_polar(oklab_to_lab(lab[0], lab[1], lab[2]))
+                          : lch;
+        break;
+      case ColorCoordinates::OKLab:
+        mapped = ok_input ? lab : lab_to_oklab(lab[0], lab[1], lab[2]);
+        break;
+      case ColorCoordinates::OKLCH:
+        mapped =
+          ok_input ? lch : to_polar(lab_to_oklab(lab[0], lab[1], lab[2]));
+        break;
+      case ColorCoordinates::RGB:
+        mapped = ok_input ? oklab_to_rgb(lab[0], lab[1], lab[2])
+                          : lab_to_rgb(lab[0], lab[1], lab[2]);
+        for (double& c : mapped) {
+          c = std::clamp(c, 0.0, 1.0);
+        }
+        break;
+    }
+    std::copy(mapped.begin(), mapped.end(), o);
+  }
+  return out;
+}
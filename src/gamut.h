@@ -0,0 +1,126 @@
+/**
+ * @file gamut.h
+ * @brief Mapping of colors into the sRGB gamut
+ *
+ * Out-of-gamut colors are mapped by reducing their CIE LCh or OKLCh chroma
+ * at constant lightness and hue until they fit, which keeps the two
+ * attributes that matter most for reading a color.
+ *
+ * The largest in-gamut chroma of each space is tabulated once on a grid of
+ * lightness and hue, the first time it is needed. Interpolating the table
+ * gives a close starting point, so the exact boundary is found by a short
+ * bracketing and binary search instead of a bisection over the full chroma
+ * range.
+ *
+ * Near the yellow cusp in CIE LCh, and near blue in OKLCh, rays of constant
+ * lightness and hue can leave the gamut and enter it again at higher
+ * chroma. The table marks those rays, and there the boundary is found by a
+ * fine scan down from the outside, so mapping keeps the outermost in-gamut
+ * chroma.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Coordinates of colors passed to gamut_map_colors()
+ */
+enum class ColorCoordinates
+{
+  Lab,   ///< CIE Lab (D65): L*, a*, b*
+  LCH,   ///< CIE LCh (D65): L*, C*, h in degrees
+  OKLab, ///< OKLab: L in [0, 1], a, b
+  OKLCH, ///< OKLCh: L in [0, 1], C, h in degrees
+  RGB,   ///< sRGB components in [0, 1]
+};
+
+/**
+ * @brief Polar color space in which chroma is reduced
+ */
+enum class PolarSpace
+{
+  LCH,   ///< CIE LCh (D65), with L* in [0, 100]
+  OKLCH, ///< OKLCh, with L in [0, 1]
+};
+
+/**
+ * @brief Parse a coordinate name: "lab", "lch", "oklab", "oklch" or "rgb"
+ * @throws std::invalid_argument If the name is unknown
+ */
+ColorCoordinates
+parse_color_coordinates(const std::string& name);
+
+/**
+ * @brief Check whether sRGB components are displayable
+ * @param rgb Unclamped sRGB components
+ * @return True if every component lies in [0, 1], up to rounding errors
+ */
+bool
+in_srgb_gamut(const std::array<double, 3>& rgb);
+
+/**
+ * @brief Largest chroma in the sRGB gamut at a lightness and hue
+ * @param l Lightness (clamped to the range of @p space)
+ * @param h Hue angle in degrees
+ * @param space Space of @p l and of the result
+ * @return Chroma of the gamut boundary, to within 1e-5 in CIE LCh or its
+ * equivalent in OKLCh
+ */
+double
+srgb_max_chroma(double l, double h, PolarSpace space = PolarSpace::LCH);
+
+/**
+ * @brief Map an LCh or OKLCh color into the sRGB gamut
+ * @param l Lightness (clamped to the range of @p space)
+ * @param c Chroma (negative values are treated as zero)
+ * @param h Hue angle in degrees, returned unchanged
+ * @param space Space of the color
+ * @return Color with the same lightness and hue and the largest chroma
+ * not exceeding that of the input that lies in the gamut
+ */
+std::array<double, 3>
+gamut_map_lch(double l,
+              double c,
+              double h,
+              PolarSpace space = PolarSpace::LCH);
+
+/**
+ * @brief Map a Lab color into the sRGB gamut
+ * @param l L* (clamped to [0, 100])
+ * @param a a* component
+ * @param b b* component
+ * @return Lab color with the same lightness and hue and the largest chroma
+ * not exceeding that of the input that lies in the gamut
+ */
+std::array<double, 3>
+gamut_map_lab(double l, double a, double b);
+
+/**
+ * @brief Map a Lab color into the sRGB gamut and convert it to sRGB
+ * @return sRGB components in [0, 1]
+ * @see gamut_map_lab()
+ */
+std::array<double, 3>
+gamut_map_lab_to_rgb(double l, double a, double b);
+
+/**
+ * @brief Map many colors into the sRGB gamut, in parallel
+ * @param values Colors in @p input coordinates, three values per color
+ * @param n Number of colors
+ * @param input Coordinates of @p values: Lab, LCH, OKLab or OKLCH. Colors
+ * are mapped in CIE LCh or OKLCh, whichever family they are given in.
+ * @param output Coordinates of the result; hues of polar input in the same
+ * space are passed through, others lie in [0, 360)
+ * @return Mapped colors, three values per color; colors with a non-finite
+ * coordinate map to NaN
+ * @throws std::invalid_argument If @p input is RGB
+ */
+std::vector<double>
+gamut_map_colors(const double* values,
+                 std::size_t n,
+                 ColorCoordinates input,
+                 ColorCoordinates output);
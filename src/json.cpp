@@ -0,0 +1,473 @@
+/**
+ * @file json.cpp
+ * @brief Implementation of the minimal JSON values
+ */
+
+#include "json.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+class Parser
+{
+public:
+  explicit Parser(std::string_view text)
+    : text_(text)
+  {
+  }
+
+  Json document()
+  {
+    Json value = parse_value();
+    skip_whitespace();
+    if (pos_ != text_.size()) {
+      fail("unexpected trailing characters");
+    }
+    return value;
+  }
+
+private:
+  [[noreturn]] void fail(const std::string& message) const
+  {
+    throw std::invalid_argument("Invalid JSON at offset " +
+                                std::to_string(pos_) + ": " + message);
+  }
+
+  void skip_whitespace()
+  {
+    while (pos_ < text_.size() &&
+           (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+            text_[pos_] == '\r')) {
+      ++pos_;
+    }
+  }
+
+  char peek()
+  {
+    skip_whitespace();
+    if (pos_ == text_.size()) {
+      fail("unexpected end of input");
+    }
+    return text_[pos_];
+  }
+
+  void expect(char c)
+  {
+    if (peek() != c) {
+      fail(std::string("expected '") + c + "'");
+    }
+    ++pos_;
+  }
+
+  void literal(std::string_view word)
+  {
+    if (text_.substr(pos_, word.size()) != word) {
+      fail("unexpected character");
+    }
+    pos_ += word.size();
+  }
+
+  Json parse_value()
+  {
+    if (++depth_ > max_depth) {
+      fail("nesting too deep");
+    }
+
+    Json value;
+    switch (peek()) {
+      case '{':
+        value = parse_object();
+        break;
+      case '[':
+        value = parse_array();
+        break;
+      case '"':
+        value = parse_string();
+        break;
+      case 't':
+        literal("true");
+        value = true;
+        break;
+      case 'f':
+        literal("false");
+        value = false;
+        break;
+      case 'n':
+        literal("null");
+        break;
+      default:
+        value = parse_number();
+    }
+
+    --depth_;
+    return value;
+  }
+
+  Json parse_object()
+  {
+    Json::Object object;
+    expect('{');
+    if (peek() == '}') {
+      ++pos_;
+      return object;
+    }
+    while (true) {
+      if (peek() != '"') {
+        fail("expected a string key");
+      }
+      std::string key = parse_string();
+      expect(':');
+      Json value = parse_value();
+      object.emplace_back(std::move(key), std::move(value));
+      if (peek() == ',') {
+        ++pos_;
+        continue;
+      }
+      expect('}');
+      return object;
+    }
+  }
+
+  Json parse_array()
+  {
+    Json::Array array;
+    expect('[');
+    if (peek() == ']') {
+      ++pos_;
+      return array;
+    }
+    while (true) {
+      array.push_back(parse_value());
+      if (peek() == ',') {
+        ++pos_;
+        continue;
+      }
+      expect(']');
+      return array;
+    }
+  }
+
+  unsigned hex4()
+  {
+    if (pos_ + 4 > text_.size()) {
+      fail("truncated unicode escape");
+    }
+    unsigned code = 0;
+    for (int k = 0; k < 4; ++k) {
+      const char c = text_[pos_++];
+      code <<= 4;
+      if (c >= '0' && c <= '9') {
+        code |= static_cast<unsigned>(c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        code |= static_cast<unsigned>(c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        code |= static_cast<unsigned>(c - 'A' + 10);
+      } else {
+        fail("invalid unicode escape");
+      }
+    }
+    return code;
+  }
+
+  static void append_utf8(std::string& out, unsigned code)
+  {
+    if (code < 0x80) {
+      out += static_cast<char>(code);
+    } else if (code < 0x800) {
+      out += static_cast<char>(0xc0 | (code >> 6));
+      out += static_cast<char>(0x80 | (code & 0x3f));
+    } else if (code < 0x10000) {
+      out += static_cast<char>(0xe0 | (code >> 12));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+      out += static_cast<char>(0x80 | (code & 0x3f));
+    } else {
+      out += static_cast<char>(0xf0 | (code >> 18));
+      out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+      out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+  }
+
+  std::string parse_string()
+  {
+    expect('"');
+    std::string out;
+    while (true) {
+      if (pos_ == text_.size()) {
+        fail("unterminated string");
+      }
+      const char c = text_[pos_++];
+      if (c == '"') {
+        return out;
+      }
+      if (static_cast<unsigned char>(c) < 0x20) {
+        fail("control character in string");
+      }
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (pos_ == text_.size()) {
+        fail("unterminated string");
+      }
+      switch (text_[pos_++]) {
+        case '"':
+          out += '"';
+          break;
+        case '\\':
+          out += '\\';
+          break;
+        case '/':
+          out += '/';
+          break;
+        case 'b':
+          out += '\b';
+          break;
+        case 'f':
+          out += '\f';
+          break;
+        case 'n':
+          out += '\n';
+          break;
+        case 'r':
+          out += '\r';
+          break;
+        case 't':
+          out += '\t';
+          break;
+        case 'u': {
+          unsigned code = hex4();
+          if (code >= 0xd800 && code < 0xdc00) {
+            // High surrogate, which must be followed by a low one
+            if (text_.substr(pos_, 2) != "\\u") {
+              fail("unpaired surrogate");
+            }
+            pos_ += 2;
+            const unsigned low = hex4();
+            if (low < 0xdc00 || low >= 0xe000) {
+              fail("unpaired surrogate");
+            }
+            code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+          } else if (code >= 0xdc00 && code < 0xe000) {
+            fail("unpaired surrogate");
+          }
+          append_utf8(out, code);
+          break;
+        }
+        default:
+          fail("invalid escape");
+      }
+    }
+  }
+
+  Json parse_number()
+  {
+    const std::size_t start = pos_;
+    const auto digits = [&] {
+      const std::size_t first = pos_;
+      while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') {
+        ++pos_;
+      }
+      return pos_ > first;
+    };
+    const auto accept = [&](char c) {
+      if (pos_ < text_.size() && text_[pos_] == c) {
+        ++pos_;
+        return true;
+      }
+      return false;
+    };
+
+    accept('-');
+    if (!accept('0') && !digits()) {
+      fail("unexpected character");
+    }
+    if (accept('.') && !digits()) {
+      fail("expected digits after decimal point");
+    }
+    if (accept('e') || accept('E')) {
+      if (!accept('+')) {
+        accept('-');
+      }
+      if (!digits()) {
+        fail("expected digits in exponent");
+      }
+    }
+
+    // The grammar was checked above, so strtod consumes exactly this span
+    const std::string number(text_.substr(start, pos_ - start));
+    return std::strtod(number.c_str(), nullptr);
+  }
+
+  static constexpr int max_depth = 256;
+
+  std::string_view text_;
+  std::size_t pos_ = 0;
+  int depth_ = 0;
+};
+
+void
+dump_string(std::string& out, const std::string& s)
+{
+  out += '"';
+  for (const char c : s) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buffer[8];
+          std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+          out += buffer;
+        } else {
+          out += c;
+        }
+    }
+  }
+  out += '"';
+}
+
+void
+dump_number(std::string& out, double value)
+{
+  if (!std::isfinite(value)) {
+    out += "null";
+    return;
+  }
+  // Shortest of the usual precisions that reads back to the same value
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+  if (std::strtod(buffer, nullptr) != value) {
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+  }
+  out += buffer;
+}
+
+void
+dump_value(std::string& out, const Json& value)
+{
+  if (value.is_null()) {
+    out += "null";
+  } else if (value.is_bool()) {
+    out += value.as_bool() ? "true" : "false";
+  } else if (value.is_number()) {
+    dump_number(out, value.as_number());
+  } else if (value.is_string()) {
+    dump_string(out, value.as_string());
+  } else if (value.is_array()) {
+    out += '[';
+    bool first = true;
+    for (const auto& item : value.as_array()) {
+      if (!first) {
+        out += ',';
+      }
+      first = false;
+      dump_value(out, item);
+    }
+    out += ']';
+  } else {
+    out += '{';
+    bool first = true;
+    for (const auto& [key, item] : value.as_object()) {
+      if (!first) {
+        out += ',';
+      }
+      first = false;
+      dump_string(out, key);
+      out += ':';
+      dump_value(out, item);
+    }
+    out += '}';
+  }
+}
+
+} // namespace
+
+Json
+Json::parse(std::string_view text)
+{
+  return Parser(text).document();
+}
+
+std::string
+Json::dump() const
+{
+  std::string out;
+  dump_value(out, *this);
+  return out;
+}
+
+bool
+Json::as_bool() const
+{
+  if (const auto* value = std::get_if<bool>(&value_)) {
+    return *value;
+  }
+  throw std::invalid_argument("Expected a JSON boolean");
+}
+
+double
+Json::as_number() const
+{
+  if (const auto* value = std::get_if<double>(&value_)) {
+    return *value;
+  }
+  throw std::invalid_argument("Expected a JSON number");
+}
+
+const std::string&
+Json::as_string() const
+{
+  if (const auto* value = std::get_if<std::string>(&value_)) {
+    return *value;
+  }
+  throw std::invalid_argument("Expected a JSON string");
+}
+
+const Json::Array&
+Json::as_array() const
+{
+  if (const auto* value = std::get_if<Array>(&value_)) {
+    return *value;
+  }
+  throw std::invalid_argument("Expected a JSON array");
+}
+
+const Json::Object&
+Json::as_object() const
+{
+  if (const auto* value = std::get_if<Object>(&value_)) {
+    return *value;
+  }
+  throw std::invalid_argument("Expected a JSON object");
+}
+
+const Json*
+Json::find(std::string_view key) const
+{
+  if (const auto* object = std::get_if<Object>(&value_)) {
+    for (const auto& [name, value] : *object) {
+      if (name == key) {
+        return &value;
+      }
+    }
+  }
+  return nullptr;
+}
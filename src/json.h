@@ -0,0 +1,111 @@
+/**
+ * @file json.h
+ * @brief Minimal JSON values for the batch job protocol
+ *
+ * Only what the JSON Lines job protocol of the command-line tool needs:
+ * parsing one document per line and writing compact documents back.
+ * Objects keep the order of their keys.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief A JSON value: null, boolean, number, string, array or object
+ */
+class Json
+{
+public:
+  using Array = std::vector<Json>;
+  using Object = std::vector<std::pair<std::string, Json>>;
+
+  /// Null
+  Json() = default;
+  Json(std::nullptr_t) {}
+  Json(bool value)
+    : value_(value)
+  {
+  }
+  Json(double value)
+    : value_(value)
+  {
+  }
+  Json(int value)
+    : value_(static_cast<double>(value))
+  {
+  }
+  Json(std::size_t value)
+    : value_(static_cast<double>(value))
+  {
+  }
+  Json(std::string value)
+    : value_(std::move(value))
+  {
+  }
+  Json(const char* value)
+    : value_(std::string(value))
+  {
+  }
+  Json(Array value)
+    : value_(std::move(value))
+  {
+  }
+  Json(Object value)
+    : value_(std::move(value))
+  {
+  }
+
+  /**
+   * @brief Parse a JSON document
+   * @throws std::invalid_argument If @p text is not valid JSON
+   */
+  static Json parse(std::string_view text);
+
+  /**
+   * @brief Compact JSON text of the value, without newlines
+   *
+   * Non-finite numbers, which JSON cannot represent, are written as null.
+   */
+  std::string dump() const;
+
+  bool is_null() const
+  {
+    return std::holds_alternative<std::nullptr_t>(value_);
+  }
+  bool is_bool() const { return std::holds_alternative<bool>(value_); }
+  bool is_number() const { return std::holds_alternative<double>(value_); }
+  bool is_object() const { return std::holds_alternative<Object>(value_); }
+  bool is_array() const { return std::holds_alternative<Array>(value_); }
+  bool is_string() const
+  {
+    return std::holds_alternative<std::string>(value_);
+  }
+
+  /// @throws std::invalid_argument If the value is not a boolean
+  bool as_bool() const;
+  /// @throws std::invalid_argument If the value is not a number
+  double as_number() const;
+  /// @throws std::invalid_argument If the value is not a string
+  const std::string& as_string() const;
+  /// @throws std::invalid_argument If the value is not an array
+  const Array& as_array() const;
+  /// @throws std::invalid_argument If the value is not an object
+  const Object& as_object() const;
+
+  /**
+   * @brief Member of an object
+   * @return The member, or nullptr if the key is missing or this is not an
+   * object
+   */
+  const Json* find(std::string_view key) const;
+
+private:
+  std::variant<std::nullptr_t, bool, double, std::string, Array, Object>
+    value_;
+};
@@ -0,0 +1,103 @@
+/**
+ * @file lru_cache.h
+ * @brief Thread-safe least-recently-used cache
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+/**
+ * @brief Bounded map that evicts the least recently used entry when full
+ *
+ * All operations lock, so one cache can be shared by many threads. Values
+ * are returned by copy; use a shared pointer as the value type for large
+ * entries.
+ */
+template<typename Key, typename Value>
+class LruCache
+{
+public:
+  /// @param capacity Maximum number of entries; 0 disables the cache
+  explicit LruCache(std::size_t capacity)
+    : capacity_(capacity)
+  {
+  }
+
+  /// Value stored for @p key, if any, which becomes the most recent entry
+  std::optional<Value> get(const Key& key)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = index_.find(key);
+    if (it == index_.end()) {
+      ++misses_;
+      return std::nullopt;
+    }
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->second;
+  }
+
+  /// Store @p value for @p key as the most recent entry
+  void put(const Key& key, Value value)
+  {
+    if (capacity_ == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = index_.find(key);
+    if (it != index_.end()) {
+      it->second->second = std::move(value);
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return;
+    }
+    if (entries_.size() == capacity_) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+    entries_.emplace_front(key, std::move(value));
+    index_.emplace(key, entries_.begin());
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+  }
+
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+  /// Number of lookups that found an entry
+  std::size_t hits() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+  }
+
+  /// Number of lookups that found no entry
+  std::size_t misses() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+  }
+
+private:
+  using Entries = std::list<std::pair<Key, Value>>;
+
+  std::size_t capacity_;
+  mutable std::mutex mutex_;
+  Entries entries_;
+  std::map<Key, typename Entries::iterator> index_;
+  std::size_t hits_ = 0;
+  std::size_t misses_ = 0;
+};
@@ -1,11 +1,110 @@
+#include "array.h"
+#include "arrow_interface.h"
+#include "buffer_view.h"
+#include "candidate_set.h"
+#include "color_contrast.h"
 #include "color_conversions.h"
 #include "color_distance.h"
+#include "colormap.h"
+#include "cvd_distance.h"
+#include "gamut.h"
+#include "mutable_palette.h"
+#include "palette_data.h"
 #include "palette_generation.h"
+#include "palette_scoring.h"
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <tuple>
 
 namespace py = pybind11;
 
+namespace {
+
+void
+release_schema_capsule(PyObject* capsule)
+{
+  auto* schema =
+    static_cast<ArrowSchema*>(PyCapsule_GetPointer(capsule, "arrow_schema"));
+  if (schema->release != nullptr) {
+    schema->release(schema);
+  }
+  delete schema;
+}
+
+void
+release_array_capsule(PyObject* capsule)
+{
+  auto* array =
+    static_cast<ArrowArray*>(PyCapsule_GetPointer(capsule, "arrow_array"));
+  if (array->release != nullptr) {
+    array->release(array);
+  }
+  delete array;
+}
+
+/// Pointer held by an Arrow PyCapsule, checking the capsule name
+template<typename T>
+T*
+capsule_pointer(const py::capsule& capsule, const char* name)
+{
+  auto* ptr = static_cast<T*>(PyCapsule_GetPointer(capsule.ptr(), name));
+  if (ptr == nullptr) {
+    throw py::error_already_set();
+  }
+  return ptr;
+}
+
+/// Copy a buffer of element type T into an owned Array of the same shape
+template<typename T>
+ArrowColumn
+buffer_column(const py::buffer& buffer)
+{
+  const auto info = buffer.request();
+  const py::ssize_t columns = info.ndim == 2 ? info.shape[1] : 0;
+  const BufferView<T> view(buffer, "values", columns);
+  std::vector<std::ptrdiff_t> shape(info.shape.begin(), info.shape.end());
+  return ArrowColumn(Array<T>(
+    std::vector<T>(view.data(), view.data() + view.size()), std::move(shape)));
+}
+
+/// Size in bytes of a buffer that must be C-contiguous
+std::size_t
+contiguous_bytes(const py::buffer_info& info, const std::string& name)
+{
+  py::ssize_t stride = info.itemsize;
+  for (py::ssize_t d = info.ndim - 1; d >= 0; --d) {
+    if (info.strides[d] != stride) {
+      throw py::value_error(name + " must be a contiguous buffer");
+    }
+    stride *= info.shape[d];
+  }
+  return static_cast<std::size_t>(info.size * info.itemsize);
+}
+
+} // namespace
+
+/**
+ * @brief Bind a read-only Array type that supports the buffer protocol
+ */
+template<typename T>
+void
+bind_array(py::module_& m, const char* name)
+{
+  py::class_<Array<T>>(m, name, py::buffer_protocol())
+    .def_buffer([](const Array<T>& a) {
+      return py::buffer_info(const_cast<T*>(a.data()),
+                             sizeof(T),
+                             py::format_descriptor<T>::format(),
+                             static_cast<py::ssize_t>(a.ndim()),
+                             a.shape(),
+                             a.byte_strides(),
+                             true);
+    })
+    .def("__len__", [](const Array<T>& a) {
+      return a.ndim() > 0 ? a.shape()[0] : 0;
+    });
+}
+
 PYBIND11_MODULE(_qualpal,
                 m,
                 py::mod_gil_not_used(),
@@ -27,8 +126,31 @@ PYBIND11_MODULE(_qualpal,
         py::arg("metric") = py::none(),
         py::arg("max_memory") = py::none(),
         py::arg("white_point") = py::none(),
+        py::arg("space") = py::none(),
+        py::arg("colorspace_size") = py::none(),
+        py::arg("backgrounds") = py::none(),
+        py::arg("cvd_mode") = py::none(),
         "Generate palette with full configuration options");
 
+  m.def("generate_palette_grouped",
+        &generate_palette_grouped,
+        py::arg("n_groups"),
+        py::arg("group_size"),
+        py::arg("spread") = 0.5,
+        py::arg("h_range") = py::none(),
+        py::arg("c_range") = py::none(),
+        py::arg("l_range") = py::none(),
+        py::arg("colors") = py::none(),
+        py::arg("palette_name") = py::none(),
+        py::arg("cvd") = py::none(),
+        py::arg("background") = py::none(),
+        py::arg("metric") = py::none(),
+        py::arg("space") = py::none(),
+        py::arg("colorspace_size") = py::none(),
+        py::arg("backgrounds") = py::none(),
+        py::arg("cvd_mode") = py::none(),
+        "Generate groups of related colors, distinct between groups");
+
   // Convenience wrappers (backwards compatible)
   m.def("generate_palette",
         &generate_palette,
@@ -86,6 +208,27 @@ PYBIND11_MODULE(_qualpal,
         py::arg("b"),
         "Convert RGB to LCH");
 
+  m.def("rgb_to_oklab",
+        &rgb_to_oklab,
+        py::arg("r"),
+        py::arg("g"),
+        py::arg("b"),
+        "Convert RGB to OKLab");
+
+  m.def("oklab_to_rgb",
+        &oklab_to_rgb,
+        py::arg("l"),
+        py::arg("a"),
+        py::arg("b"),
+        "Convert OKLab to RGB");
+
+  m.def("rgb_to_cam16ucs",
+        &rgb_to_cam16ucs,
+        py::arg("r"),
+        py::arg("g"),
+        py::arg("b"),
+        "Convert RGB to CAM16-UCS");
+
   m.def("simulate_cvd",
         &simulate_cvd,
         py::arg("r"),
@@ -109,6 +252,564 @@ PYBIND11_MODULE(_qualpal,
         py::arg("metric"),
         "Calculate distance matrix for a list of colors");
 
+  // Native palette storage
+  bind_array<double>(m, "Float64Array");
+  bind_array<std::int64_t>(m, "Int64Array");
+  bind_array<std::uint8_t>(m, "UInt8Array");
+
+  // Arrow C data interface, exchanged as PyCapsules
+  py::class_<ArrowColumn>(m, "ArrowColumn")
+    .def("__len__", &ArrowColumn::length)
+    .def_property_readonly("format", &ArrowColumn::format)
+    .def("__arrow_c_schema__",
+         [](const ArrowColumn& c) {
+           auto* schema = new ArrowSchema;
+           c.export_schema(schema);
+           return py::reinterpret_steal<py::object>(
+             PyCapsule_New(schema, "arrow_schema", release_schema_capsule));
+         })
+    .def(
+      "__arrow_c_array__",
+      [](const ArrowColumn& c, const py::object& /* requested_schema */) {
+        // The requested schema is a hint; columns are always exported in
+        // their own type
+        auto* schema = new ArrowSchema;
+        c.export_schema(schema);
+        auto schema_capsule = py::reinterpret_steal<py::object>(
+          PyCapsule_New(schema, "arrow_schema", release_schema_capsule));
+        auto* array = new ArrowArray;
+        c.export_array(array);
+        auto array_capsule = py::reinterpret_steal<py::object>(
+          PyCapsule_New(array, "arrow_array", release_array_capsule));
+        return py::make_tuple(schema_capsule, array_capsule);
+      },
+      py::arg("requested_schema") = py::none());
+
+  m.def(
+    "arrow_colors",
+    [](const py::capsule& schema, const py::capsule& array) {
+      const auto* s = capsule_pointer<ArrowSchema>(schema, "arrow_schema");
+      const auto* a = capsule_pointer<ArrowArray>(array, "arrow_array");
+      std::vector<std::uint8_t> rgb8;
+      {
+        py::gil_scoped_release release;
+        import_arrow_colors(*s, *a, rgb8);
+      }
+      const auto n = static_cast<std::ptrdiff_t>(rgb8.size() / 3);
+      return Array<std::uint8_t>(std::move(rgb8), { n, 3 });
+    },
+    py::arg("schema"),
+    py::arg("array"),
+    "Read colors from Arrow schema and array capsules as 8-bit RGB");
+
+  m.def(
+    "arrow_color_stream",
+    [](const py::capsule& stream) {
+      auto* s = capsule_pointer<ArrowArrayStream>(stream, "arrow_array_stream");
+      std::vector<std::uint8_t> rgb8;
+      {
+        py::gil_scoped_release release;
+        rgb8 = import_arrow_color_stream(*s);
+      }
+      const auto n = static_cast<std::ptrdiff_t>(rgb8.size() / 3);
+      return Array<std::uint8_t>(std::move(rgb8), { n, 3 });
+    },
+    py::arg("stream"),
+    "Read colors from an Arrow array stream capsule as 8-bit RGB");
+
+  m.def(
+    "arrow_column",
+    [](const py::buffer& values) {
+      const auto info = values.request();
+      if (info.item_type_is_equivalent_to<double>()) {
+        return buffer_column<double>(values);
+      }
+      if (info.item_type_is_equivalent_to<std::int64_t>()) {
+        return buffer_column<std::int64_t>(values);
+      }
+      if (info.item_type_is_equivalent_to<std::uint8_t>()) {
+        return buffer_column<std::uint8_t>(values);
+      }
+      throw py::value_error("values has element format '" + info.format +
+                            "', expected float64, int64 or uint8");
+    },
+    py::arg("values"),
+    "Export a one- or two-dimensional buffer as an Arrow column");
+
+  py::class_<PaletteData>(m, "PaletteData")
+    .def(py::init<const std::vector<std::string>&>(), py::arg("hex_colors"))
+    .def("__len__", &PaletteData::size)
+    .def("__getitem__",
+         [](const PaletteData& p, py::ssize_t i) {
+           const auto n = static_cast<py::ssize_t>(p.size());
+           if (i < 0) {
+             i += n;
+           }
+           if (i < 0 || i >= n) {
+             throw py::index_error("palette index out of range");
+           }
+           return p.hex(static_cast<std::size_t>(i));
+         })
+    .def("__getitem__",
+         [](const PaletteData& p, const py::slice& s) {
+           py::ssize_t start, stop, step, length;
+           if (!s.compute(static_cast<py::ssize_t>(p.size()),
+                          &start,
+                          &stop,
+                          &step,
+                          &length)) {
+             throw py::error_already_set();
+           }
+           return p.slice(start, step, static_cast<std::size_t>(length));
+         })
+    .def_static(
+      "from_rgb8",
+      [](const py::buffer& rgb) {
+        const BufferView<std::uint8_t> view(rgb, "rgb", 3);
+        std::vector<double> values(view.size());
+        for (std::size_t k = 0; k < view.size(); ++k) {
+          values[k] = view.data()[k] / 255.0;
+        }
+        py::gil_scoped_release release;
+        return PaletteData(std::move(values));
+      },
+      py::arg("rgb"))
+    .def_static(
+      "from_bytes",
+      [](const py::buffer& data) {
+        const auto info = data.request();
+        const std::size_t size = contiguous_bytes(info, "data");
+        py::gil_scoped_release release;
+        return PaletteData::from_bytes(info.ptr, size);
+      },
+      py::arg("data"))
+    .def("to_bytes",
+         [](const PaletteData& p) {
+           std::string out;
+           {
+             py::gil_scoped_release release;
+             out = p.to_bytes();
+           }
+           return py::bytes(out);
+         })
+    .def("to_arrow", &PaletteData::to_arrow, py::arg("kind"))
+    .def("hex", py::overload_cast<>(&PaletteData::hex, py::const_))
+    .def("rgb_array", &PaletteData::rgb_array)
+    .def("lab_array", &PaletteData::lab_array)
+    .def("distance_matrix",
+         &PaletteData::distance_matrix,
+         py::arg("metric"),
+         py::call_guard<py::gil_scoped_release>())
+    .def(
+      "cvd_distance_matrix",
+      [](const PaletteData& p,
+         const std::string& metric,
+         const std::vector<std::tuple<std::string, double, double>>& cvd,
+         double normal_weight,
+         const std::string& reduction) {
+        std::vector<CvdCondition> conditions;
+        for (const auto& [type, severity, weight] : cvd) {
+          conditions.push_back({ type, severity, weight });
+        }
+        py::gil_scoped_release release;
+        return p.cvd_distance_matrix(
+          metric, conditions, normal_weight, reduction);
+      },
+      py::arg("metric"),
+      py::arg("cvd"),
+      py::arg("normal_weight"),
+      py::arg("reduction"))
+    .def("min_distance",
+         &PaletteData::min_distance,
+         py::arg("metric"),
+         py::call_guard<py::gil_scoped_release>())
+    .def("min_distances",
+         &PaletteData::min_distances,
+         py::arg("metric"),
+         py::call_guard<py::gil_scoped_release>())
+    .def("nearest_neighbors",
+         &PaletteData::nearest_neighbors,
+         py::arg("metric"),
+         py::call_guard<py::gil_scoped_release>())
+    .def(
+      "pairs_within",
+      [](const PaletteData& p, const std::string& metric, double threshold) {
+        std::vector<std::int64_t> first;
+        std::vector<std::int64_t> second;
+        std::vector<double> distances;
+        {
+          py::gil_scoped_release release;
+          p.pairs_within(metric, threshold, first, second, distances);
+        }
+        const std::vector<std::ptrdiff_t> shape = {
+          static_cast<std::ptrdiff_t>(distances.size())
+        };
+        return py::make_tuple(
+          first, second, Array<double>(std::move(distances), shape));
+      },
+      py::arg("metric"),
+      py::arg("threshold"))
+    .def(
+      "knn_graph",
+      [](const PaletteData& p, const std::string& metric, std::size_t k) {
+        std::vector<std::int64_t> indptr;
+        std::vector<std::int64_t> indices;
+        std::vector<double> distances;
+        {
+          py::gil_scoped_release release;
+          p.knn_graph(metric, k, indptr, indices, distances);
+        }
+        const auto n_rows = static_cast<std::ptrdiff_t>(indptr.size());
+        const auto n_edges = static_cast<std::ptrdiff_t>(indices.size());
+        return py::make_tuple(
+          Array<std::int64_t>(std::move(indptr), { n_rows }),
+          Array<std::int64_t>(std::move(indices), { n_edges }),
+          Array<double>(std::move(distances), { n_edges }));
+      },
+      py::arg("metric"),
+      py::arg("k"))
+    .def(
+      "assign_to_graph",
+      [](const PaletteData& p,
+         const py::buffer& indptr,
+         const py::buffer& indices,
+         const std::string& metric) {
+        const BufferView<std::int64_t> indptr_view(indptr, "indptr");
+        const BufferView<std::int64_t> indices_view(indices, "indices");
+        if (indptr_view.size() == 0) {
+          throw py::value_error("indptr must contain at least one value");
+        }
+        const std::size_t n = indptr_view.size() - 1;
+        if (indptr_view.data()[n] < 0 ||
+            static_cast<std::size_t>(indptr_view.data()[n]) !=
+              indices_view.size()) {
+          throw py::value_error(
+            "indptr must end at the length of indices, " +
+            std::to_string(indices_view.size()) + ", got " +
+            std::to_string(indptr_view.data()[n]));
+        }
+        std::vector<std::int64_t> colors;
+        {
+          py::gil_scoped_release release;
+          colors = p.assign_to_graph(
+            metric, indptr_view.data(), n, indices_view.data());
+        }
+        return Array<std::int64_t>(std::move(colors),
+                                   { static_cast<std::ptrdiff_t>(n) });
+      },
+      py::arg("indptr"),
+      py::arg("indices"),
+      py::arg("metric"))
+    .def("match",
+         &PaletteData::match,
+         py::arg("previous"),
+         py::arg("metric"),
+         py::call_guard<py::gil_scoped_release>())
+    .def("perceptual_order",
+         &PaletteData::perceptual_order,
+         py::arg("metric"),
+         py::call_guard<py::gil_scoped_release>())
+    .def("write_distance_matrix",
+         &PaletteData::write_distance_matrix,
+         py::arg("path"),
+         py::arg("metric"),
+         py::arg("layout"),
+         py::arg("single_precision"),
+         py::arg("tile_bytes"),
+         py::call_guard<py::gil_scoped_release>())
+    .def("simulate_cvd",
+         &PaletteData::simulate_cvd,
+         py::arg("cvd_type"),
+         py::arg("severity"));
+
+  py::class_<MutablePalette>(m, "MutablePalette")
+    .def(py::init<const std::vector<std::string>&, const std::string&>(),
+         py::arg("hex_colors"),
+         py::arg("metric"))
+    .def("__len__", &MutablePalette::size)
+    .def_property_readonly("metric", &MutablePalette::metric)
+    .def("hex", py::overload_cast<>(&MutablePalette::hex, py::const_))
+    .def("hex_at",
+         py::overload_cast<std::size_t>(&MutablePalette::hex, py::const_),
+         py::arg("index"))
+    .def("insert", &MutablePalette::insert, py::arg("index"), py::arg("hex"))
+    .def("append", &MutablePalette::append, py::arg("hex"))
+    .def("remove", &MutablePalette::remove, py::arg("index"))
+    .def("replace", &MutablePalette::replace, py::arg("index"), py::arg("hex"))
+    .def("distance", &MutablePalette::distance, py::arg("i"), py::arg("j"))
+    .def("distance_matrix", &MutablePalette::distance_matrix)
+    .def("min_distances", &MutablePalette::min_distances)
+    .def("nearest_neighbors", &MutablePalette::nearest_neighbors)
+    .def("min_distance", &MutablePalette::min_distance)
+    .def("min_distance_if_added",
+         &MutablePalette::min_distance_if_added,
+         py::arg("hex"))
+    .def("min_distance_if_removed",
+         &MutablePalette::min_distance_if_removed,
+         py::arg("index"))
+    .def("min_distance_if_replaced",
+         &MutablePalette::min_distance_if_replaced,
+         py::arg("index"),
+         py::arg("hex"))
+    .def("palette", &MutablePalette::palette);
+
+  // Batched analysis
+  m.def(
+    "score_palettes",
+    [](const py::buffer& offsets,
+       const py::buffer& rgb,
+       const std::string& metric,
+       const std::optional<std::string>& background,
+       const std::optional<std::map<std::string, double>>& cvd) {
+      const BufferView<std::int64_t> offsets_view(offsets, "offsets");
+      const BufferView<std::uint8_t> rgb_view(rgb, "rgb", 3);
+      if (offsets_view.size() == 0) {
+        throw py::value_error("offsets must contain at least one value");
+      }
+      const std::size_t n = offsets_view.size() - 1;
+      const Metric m = parse_metric(metric);
+
+      PaletteScores scores;
+      {
+        py::gil_scoped_release release;
+        scores = score_palettes(offsets_view.data(),
+                                n,
+                                rgb_view.data(),
+                                rgb_view.size() / 3,
+                                m,
+                                background,
+                                cvd.value_or(std::map<std::string, double>{}));
+      }
+
+      const std::vector<std::ptrdiff_t> shape = {
+        static_cast<std::ptrdiff_t>(n)
+      };
+      py::dict out;
+      out["min_distance"] =
+        Array<double>(std::move(scores.min_distance), shape);
+      if (background.has_value()) {
+        out["background_distance"] =
+          Array<double>(std::move(scores.background_distance), shape);
+      }
+      if (cvd.has_value() && !cvd->empty()) {
+        out["cvd_min_distance"] =
+          Array<double>(std::move(scores.cvd_min_distance), shape);
+      }
+      return out;
+    },
+    py::arg("offsets"),
+    py::arg("rgb"),
+    py::arg("metric"),
+    py::arg("background") = py::none(),
+    py::arg("cvd") = py::none(),
+    "Score a ragged batch of palettes given as offsets and packed RGB");
+
+  m.def(
+    "relative_luminance",
+    [](const py::buffer& rgb) {
+      const BufferView<std::uint8_t> view(rgb, "rgb", 3);
+      const std::size_t n = view.size() / 3;
+      std::vector<double> out;
+      {
+        py::gil_scoped_release release;
+        out = relative_luminance(view.data(), n);
+      }
+      return Array<double>(std::move(out),
+                           { static_cast<std::ptrdiff_t>(n) });
+    },
+    py::arg("rgb"),
+    "WCAG relative luminance of packed 8-bit RGB colors");
+
+  m.def(
+    "contrast_matrix",
+    [](const py::buffer& foreground, const py::buffer& background) {
+      const BufferView<std::uint8_t> fg(foreground, "foreground", 3);
+      const BufferView<std::uint8_t> bg(background, "background", 3);
+      const std::size_t rows = fg.size() / 3;
+      const std::size_t cols = bg.size() / 3;
+      std::vector<double> out;
+      {
+        py::gil_scoped_release release;
+        out = contrast_matrix(fg.data(), rows, bg.data(), cols);
+      }
+      return Array<double>(std::move(out),
+                           { static_cast<std::ptrdiff_t>(rows),
+                             static_cast<std::ptrdiff_t>(cols) });
+    },
+    py::arg("foreground"),
+    py::arg("background"),
+    "WCAG contrast ratio of every foreground/background pair");
+
+  m.def(
+    "best_contrast",
+    [](const py::buffer& colors, const py::buffer& candidates) {
+      const BufferView<std::uint8_t> c(colors, "colors", 3);
+      const BufferView<std::uint8_t> k(candidates, "candidates", 3);
+      const std::size_t n = c.size() / 3;
+      std::vector<std::int64_t> best;
+      std::vector<double> ratios;
+      {
+        py::gil_scoped_release release;
+        best_contrast(c.data(), n, k.data(), k.size() / 3, best, ratios);
+      }
+      return py::make_tuple(
+        best,
+        Array<double>(std::move(ratios), { static_cast<std::ptrdiff_t>(n) }));
+    },
+    py::arg("colors"),
+    py::arg("candidates"),
+    "Highest-contrast candidate for each color and its contrast ratio");
+
+  m.def(
+    "build_colormap",
+    [](const PaletteData& colors,
+       const std::string& space,
+       const std::string& metric,
+       std::size_t n) {
+      const InterpolationSpace s = parse_interpolation_space(space);
+      const Metric m = parse_metric(metric);
+      std::vector<std::uint8_t> lut;
+      {
+        py::gil_scoped_release release;
+        lut = build_colormap(colors.lab(), s, m, n);
+      }
+      return Array<std::uint8_t>(std::move(lut),
+                                 { static_cast<std::ptrdiff_t>(n), 3 });
+    },
+    py::arg("colors"),
+    py::arg("space"),
+    py::arg("metric"),
+    py::arg("n"),
+    "Colormap lookup table with entries at equal distances");
+
+  m.def(
+    "gamut_map",
+    [](const py::buffer& values,
+       const std::string& space,
+       const std::string& output) {
+      const BufferView<double> view(values, "values", 3);
+      const ColorCoordinates input = parse_color_coordinates(space);
+      const ColorCoordinates out = parse_color_coordinates(output);
+      const std::size_t n = view.size() / 3;
+      std::vector<double> mapped;
+      {
+        py::gil_scoped_release release;
+        mapped = gamut_map_colors(view.data(), n, input, out);
+      }
+      return Array<double>(std::move(mapped),
+                           { static_cast<std::ptrdiff_t>(n), 3 });
+    },
+    py::arg("values"),
+    py::arg("space"),
+    py::arg("output"),
+    "Map Lab or LCh colors into the sRGB gamut by reducing chroma");
+
+  // Candidate sets shared between processes
+  m.def(
+    "candidate_colors",
+    [](const std::optional<std::vector<double>>& h_range,
+       const std::optional<std::vector<double>>& c_range,
+       const std::optional<std::vector<double>>& l_range,
+       const std::optional<std::vector<std::string>>& colors,
+       const std::optional<std::string>& palette_name,
+       const std::optional<std::string>& space,
+       const std::optional<std::size_t>& colorspace_size) {
+      std::vector<double> rgb;
+      {
+        py::gil_scoped_release release;
+        rgb = candidate_colors(h_range,
+                               c_range,
+                               l_range,
+                               colors,
+                               palette_name,
+                               space,
+                               colorspace_size);
+      }
+      const auto n = static_cast<std::ptrdiff_t>(rgb.size() / 3);
+      return Array<double>(std::move(rgb), { n, 3 });
+    },
+    py::arg("h_range") = py::none(),
+    py::arg("c_range") = py::none(),
+    py::arg("l_range") = py::none(),
+    py::arg("colors") = py::none(),
+    py::arg("palette_name") = py::none(),
+    py::arg("space") = py::none(),
+    py::arg("colorspace_size") = py::none(),
+    "Candidate colors of a generation source as RGB");
+
+  m.def("candidate_set_bytes",
+        &candidate_set_bytes,
+        py::arg("n_colors"),
+        py::arg("n_conditions"),
+        "Number of bytes a candidate set needs");
+
+  m.def(
+    "write_candidate_set",
+    [](const py::buffer& out,
+       const py::buffer& rgb,
+       const std::map<std::string, double>& cvd) {
+      const BufferView<double> rgb_view(rgb, "rgb", 3);
+      std::vector<double> values(rgb_view.data(),
+                                 rgb_view.data() + rgb_view.size());
+      const auto info = out.request(true);
+      const std::size_t size = contiguous_bytes(info, "out");
+      py::gil_scoped_release release;
+      write_candidate_set(info.ptr, size, values, cvd);
+    },
+    py::arg("out"),
+    py::arg("rgb"),
+    py::arg("cvd"),
+    "Write a candidate set into a writable buffer, converting it once");
+
+  py::class_<CandidateSet>(m, "CandidateSet")
+    .def(py::init([](const py::buffer& data) {
+           // The buffer stays exported, and its memory valid, for as long as
+           // the set or any array taken from it is alive
+           auto info = std::make_shared<py::buffer_info>(data.request());
+           const std::size_t size = contiguous_bytes(*info, "data");
+           const void* ptr = info->ptr;
+           return CandidateSet(std::move(info), ptr, size);
+         }),
+         py::arg("data"))
+    .def("__len__", &CandidateSet::size)
+    .def_property_readonly("views", &CandidateSet::views)
+    .def_property_readonly("severities", &CandidateSet::severities)
+    .def("rgb_array", &CandidateSet::rgb_array)
+    .def("lab_array", &CandidateSet::lab_array, py::arg("view"))
+    .def(
+      "select",
+      [](const CandidateSet& s,
+         std::size_t n,
+         const std::string& metric,
+         const std::vector<std::string>& views,
+         const std::map<std::string, double>& backgrounds) {
+        const Metric m = parse_metric(metric);
+        py::gil_scoped_release release;
+        return s.select(n, m, views, backgrounds);
+      },
+      py::arg("n"),
+      py::arg("metric"),
+      py::arg("views"),
+      py::arg("backgrounds"))
+    .def(
+      "distances",
+      [](const CandidateSet& s,
+         const std::string& hex,
+         const std::string& metric,
+         const std::string& view) {
+        const Metric m = parse_metric(metric);
+        std::vector<double> out;
+        {
+          py::gil_scoped_release release;
+          out = s.distances(hex, m, view);
+        }
+        const auto n = static_cast<std::ptrdiff_t>(out.size());
+        return Array<double>(std::move(out), { n });
+      },
+      py::arg("hex"),
+      py::arg("metric"),
+      py::arg("view"));
+
   m.def("list_palettes", &list_palettes, "List all available named palettes");
 
   m.def("get_palette",
@@ -0,0 +1,255 @@
+/**
+ * @file metric_kernels.h
+ * @brief Internal helpers shared by the Lab-based distance kernels
+ *
+ * Every metric is exposed as a kernel with two operations: point(), which
+ * maps the Lab coordinates of one color to the representation the metric
+ * works on (computed once per color), and the call operator, which returns
+ * the distance between two such points (evaluated once per pair). Moving
+ * conversions out of the pairwise loop is what makes OKLab and CAM16-UCS
+ * distances plain Euclidean norms.
+ */
+
+#pragma once
+
+#include "color_conversions.h"
+#include "color_distance.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <qualpal/colors.h>
+#include <qualpal/metrics.h>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Metric provided by the qualpal library, evaluated on Lab colors
+ */
+template<typename Functor>
+struct QualpalMetric
+{
+  using Point = qualpal::colors::Lab;
+
+  Point point(const double* lab) const { return Point(lab[0], lab[1], lab[2]); }
+
+  double operator()(const Point& x, const Point& y) const
+  {
+    return Functor{}(x, y);
+  }
+};
+
+/**
+ * @brief Euclidean distance in a space derived from Lab by @p Convert
+ */
+template<std::array<double, 3> (*Convert)(double, double, double)>
+struct EuclideanMetric
+{
+  using Point = std::array<double, 3>;
+
+  Point point(const double* lab) const
+  {
+    return Convert(lab[0], lab[1], lab[2]);
+  }
+
+  double operator()(const Point& x, const Point& y) const
+  {
+    const double d0 = x[0] - y[0];
+    const double d1 = x[1] - y[1];
+    const double d2 = x[2] - y[2];
+    return std::sqrt(d0 * d0 + d1 * d1 + d2 * d2);
+  }
+};
+
+/// OKLab coordinates scaled by 100, so that distances are comparable in
+/// magnitude to the Lab-based metrics
+inline std::array<double, 3>
+lab_to_oklab_scaled(double l, double a, double b)
+{
+  const auto c = lab_to_oklab(l, a, b);
+  return { 100.0 * c[0], 100.0 * c[1], 100.0 * c[2] };
+}
+
+using OKLabMetric = EuclideanMetric<lab_to_oklab_scaled>;
+using CAM16UCSMetric = EuclideanMetric<lab_to_cam16ucs>;
+
+/**
+ * @brief Lab color with its chroma, as used by CIE94 and CMC
+ */
+struct LabChroma
+{
+  double l;
+  double a;
+  double b;
+  double c;
+};
+
+/// Squared lightness, chroma and hue differences of two colors
+inline std::array<double, 3>
+lch_differences(const LabChroma& x, const LabChroma& y)
+{
+  const double dl = x.l - y.l;
+  const double dc = x.c - y.c;
+  const double da = x.a - y.a;
+  const double db = x.b - y.b;
+  const double dh2 = std::max(da * da + db * db - dc * dc, 0.0);
+  return { dl * dl, dc * dc, dh2 };
+}
+
+/**
+ * @brief CIE94 color difference (graphic arts weights)
+ *
+ * The chroma-dependent weights use the geometric mean chroma of the pair,
+ * as recommended by CIE 116 when neither color is a reference, which makes
+ * the metric symmetric.
+ */
+struct CIE94Metric
+{
+  using Point = LabChroma;
+
+  Point point(const double* lab) const
+  {
+    return { lab[0], lab[1], lab[2], std::hypot(lab[1], lab[2]) };
+  }
+
+  double operator()(const Point& x, const Point& y) const
+  {
+    const auto d = lch_differences(x, y);
+    const double c = std::sqrt(x.c * y.c);
+    const double sc = 1.0 + 0.045 * c;
+    const double sh = 1.0 + 0.015 * c;
+    return std::sqrt(d[0] + d[1] / (sc * sc) + d[2] / (sh * sh));
+  }
+};
+
+/**
+ * @brief Lab color with its CMC weighting functions
+ */
+struct CMCPoint
+{
+  LabChroma lab;
+  /// Squared lightness, chroma and hue weights with this color as reference
+  std::array<double, 3> s2;
+};
+
+/**
+ * @brief CMC l:c color difference with l = 2 and c = 1
+ *
+ * CMC weights the differences by functions of the reference color. To make
+ * the metric symmetric, the result is the mean of the two differences
+ * obtained with either color as reference; the weights are computed once
+ * per color.
+ */
+struct CMCMetric
+{
+  using Point = CMCPoint;
+
+  static constexpr double lightness = 2.0;
+  static constexpr double chroma = 1.0;
+
+  Point point(const double* lab) const
+  {
+    constexpr double pi = 3.14159265358979323846;
+    const double l = lab[0];
+    const double c = std::hypot(lab[1], lab[2]);
+    double h = std::atan2(lab[2], lab[1]) * 180.0 / pi;
+    if (h < 0.0) {
+      h += 360.0;
+    }
+
+    const double sl = l < 16.0 ? 0.511 : 0.040975 * l / (1.0 + 0.01765 * l);
+    const double sc = 0.0638 * c / (1.0 + 0.0131 * c) + 0.638;
+    const double c4 = c * c * c * c;
+    const double f = std::sqrt(c4 / (c4 + 1900.0));
+    const double t =
+      (h >= 164.0 && h <= 345.0)
+        ? 0.56 + std::abs(0.2 * std::cos((h + 168.0) * pi / 180.0))
+        : 0.36 + std::abs(0.4 * std::cos((h + 35.0) * pi / 180.0));
+    const double sh = sc * (f * t + 1.0 - f);
+
+    const double wl = lightness * sl;
+    const double wc = chroma * sc;
+    return { { l, lab[1], lab[2], c }, { wl * wl, wc * wc, sh * sh } };
+  }
+
+  double operator()(const Point& x, const Point& y) const
+  {
+    const auto d = lch_differences(x.lab, y.lab);
+    const auto delta = [&d](const std::array<double, 3>& s2) {
+      return std::sqrt(d[0] / s2[0] + d[1] / s2[1] + d[2] / s2[2]);
+    };
+    return 0.5 * (delta(x.s2) + delta(y.s2));
+  }
+};
+
+/**
+ * @brief Invoke @p f with the kernel for @p metric
+ *
+ * Dispatching once per kernel, rather than once per pair, lets the
+ * compiler inline the metric into the inner loops.
+ */
+template<typename F>
+decltype(auto)
+visit_metric(Metric metric, F&& f)
+{
+  switch (metric) {
+    case Metric::DIN99d:
+      return f(QualpalMetric<qualpal::metrics::DIN99d>{});
+    case Metric::CIE76:
+      return f(QualpalMetric<qualpal::metrics::CIE76>{});
+    case Metric::OKLab:
+      return f(OKLabMetric{});
+    case Metric::CAM16UCS:
+      return f(CAM16UCSMetric{});
+    case Metric::CIE94:
+      return f(CIE94Metric{});
+    case Metric::CMC:
+      return f(CMCMetric{});
+    case Metric::CIEDE2000:
+    default:
+      return f(QualpalMetric<qualpal::metrics::CIEDE2000>{});
+  }
+}
+
+/**
+ * @brief Convert Lab coordinates to the points a metric kernel works on
+ * @param dist Metric kernel
+ * @param lab Lab coordinates, three consecutive values per color
+ * @param n Number of colors
+ */
+template<typename Kernel>
+std::vector<typename Kernel::Point>
+to_points(const Kernel& dist, const double* lab, std::size_t n)
+{
+  using Point = typename Kernel::Point;
+  const auto count = static_cast<std::ptrdiff_t>(n);
+  std::vector<Point> points;
+
+  if constexpr (std::is_default_constructible_v<Point>) {
+    points.resize(n);
+#pragma omp parallel for if (count > 4096)
+    for (std::ptrdiff_t i = 0; i < count; ++i) {
+      points[i] = dist.point(&lab[3 * i]);
+    }
+  } else {
+    points.reserve(n);
+    for (std::ptrdiff_t i = 0; i < count; ++i) {
+      points.push_back(dist.point(&lab[3 * i]));
+    }
+  }
+
+  return points;
+}
+
+/**
+ * @brief Convert Lab coordinates to the points a metric kernel works on
+ * @param dist Metric kernel
+ * @param lab Lab coordinates, three consecutive values per color
+ */
+template<typename Kernel>
+std::vector<typename Kernel::Point>
+to_points(const Kernel& dist, const std::vector<double>& lab)
+{
+  return to_points(dist, lab.data(), lab.size() / 3);
+}
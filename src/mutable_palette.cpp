@@ -0,0 +1,436 @@
+/**
+ * @file mutable_palette.cpp
+ * @brief Implementation of the palette with incrementally maintained distances
+ */
+
+#include "mutable_palette.h"
+
+#include "color_conversions.h"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+
+constexpr double inf = std::numeric_limits<double>::infinity();
+
+} // namespace
+
+MutablePalette::MutablePalette(const std::vector<std::string>& hex_colors,
+                               const std::string& metric)
+  : metric_(parse_metric(metric))
+  , metric_name_(metric)
+{
+  const std::size_t n = hex_colors.size();
+  capacity_ = std::max<std::size_t>(n, 8);
+  rgb_.resize(3 * capacity_);
+  lab_.resize(3 * capacity_);
+  dist_.assign(capacity_ * capacity_, 0.0);
+  nearest_.assign(capacity_, npos);
+  nearest_dist_.assign(capacity_, inf);
+  position_.assign(capacity_, npos);
+
+  for (std::size_t slot = capacity_; slot-- > n;) {
+    free_.push_back(slot);
+  }
+
+  std::vector<double> lab(3 * n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto c = assign(i, hex_colors[i]);
+    std::copy(c.begin(), c.end(), &lab[3 * i]);
+    order_.push_back(i);
+    position_[i] = i;
+  }
+
+  // Build the initial cache with the parallel matrix kernel
+  const auto matrix = lab_distance_matrix(lab, metric_);
+  for (std::size_t i = 0; i < n; ++i) {
+    std::copy_n(&matrix[i * n], n, &dist_[i * capacity_]);
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    std::tie(nearest_[i], nearest_dist_[i]) = scan(i);
+  }
+}
+
+std::size_t
+MutablePalette::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return order_.size();
+}
+
+void
+MutablePalette::check_index(std::size_t i) const
+{
+  if (i >= order_.size()) {
+    throw std::out_of_range("palette index out of range");
+  }
+}
+
+std::string
+MutablePalette::slot_hex(std::size_t slot) const
+{
+  const double* c = &rgb_[3 * slot];
+  return rgb_to_hex(c[0], c[1], c[2]);
+}
+
+std::string
+MutablePalette::hex(std::size_t i) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  check_index(i);
+  return slot_hex(order_[i]);
+}
+
+std::vector<std::string>
+MutablePalette::hex() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::string> out;
+  out.reserve(order_.size());
+  for (const std::size_t slot : order_) {
+    out.push_back(slot_hex(slot));
+  }
+  return out;
+}
+
+void
+MutablePalette::grow()
+{
+  const std::size_t old_capacity = capacity_;
+  const std::size_t new_capacity = std::max<std::size_t>(8, 2 * capacity_);
+
+  std::vector<double> dist(new_capacity * new_capacity, 0.0);
+  for (std::size_t a = 0; a < old_capacity; ++a) {
+    std::copy_n(
+      &dist_[a * old_capacity], old_capacity, &dist[a * new_capacity]);
+  }
+  dist_ = std::move(dist);
+
+  rgb_.resize(3 * new_capacity);
+  lab_.resize(3 * new_capacity);
+  nearest_.resize(new_capacity, npos);
+  nearest_dist_.resize(new_capacity, inf);
+  position_.resize(new_capacity, npos);
+  for (std::size_t slot = new_capacity; slot-- > old_capacity;) {
+    free_.push_back(slot);
+  }
+  capacity_ = new_capacity;
+}
+
+std::size_t
+MutablePalette::allocate_slot()
+{
+  if (free_.empty()) {
+    grow();
+  }
+  const std::size_t slot = free_.back();
+  free_.pop_back();
+  return slot;
+}
+
+std::array<double, 3>
+MutablePalette::assign(std::size_t slot, const std::string& hex)
+{
+  const auto rgb = hex_to_rgb(hex);
+  const auto lab = rgb_to_lab(rgb[0], rgb[1], rgb[2]);
+  std::copy(rgb.begin(), rgb.end(), &rgb_[3 * slot]);
+  std::copy(lab.begin(), lab.end(), &lab_[3 * slot]);
+  return lab;
+}
+
+void
+MutablePalette::renumber(std::size_t first)
+{
+  for (std::size_t i = first; i < order_.size(); ++i) {
+    position_[order_[i]] = i;
+  }
+}
+
+std::vector<double>
+MutablePalette::distances_to(const std::array<double, 3>& lab) const
+{
+  std::vector<double> others(3 * order_.size());
+  for (std::size_t i = 0; i < order_.size(); ++i) {
+    std::copy_n(&lab_[3 * order_[i]], 3, &others[3 * i]);
+  }
+  return lab_distances(lab, others, metric_);
+}
+
+std::pair<std::size_t, double>
+MutablePalette::scan(std::size_t slot, std::size_t exclude) const
+{
+  // Scanning in position order with a strict comparison resolves ties in
+  // favor of the lower position
+  std::size_t best = npos;
+  double best_dist = inf;
+  for (const std::size_t other : order_) {
+    if (other != slot && other != exclude && dist(slot, other) < best_dist) {
+      best = other;
+      best_dist = dist(slot, other);
+    }
+  }
+  return { best, best_dist };
+}
+
+double
+MutablePalette::nonzero_min(std::size_t slot, std::size_t exclude) const
+{
+  double best = inf;
+  for (const std::size_t other : order_) {
+    const double d = dist(slot, other);
+    if (other != slot && other != exclude && d > 0 && d < best) {
+      best = d;
+    }
+  }
+  return best;
+}
+
+void
+MutablePalette::update_row(std::size_t slot, const std::vector<double>& row)
+{
+  for (std::size_t i = 0; i < order_.size(); ++i) {
+    const std::size_t other = order_[i];
+    const double d = other == slot ? 0.0 : row[i];
+    dist(slot, other) = d;
+    dist(other, slot) = d;
+  }
+
+  for (const std::size_t other : order_) {
+    if (other == slot) {
+      continue;
+    }
+    const double d = dist(slot, other);
+    const std::size_t current = nearest_[other];
+    if (current == slot) {
+      // The edited color was the nearest neighbor and may have moved away
+      std::tie(nearest_[other], nearest_dist_[other]) = scan(other);
+    } else if (d < nearest_dist_[other] ||
+               (d == nearest_dist_[other] &&
+                position_[slot] < position_[current])) {
+      nearest_[other] = slot;
+      nearest_dist_[other] = d;
+    }
+  }
+
+  std::tie(nearest_[slot], nearest_dist_[slot]) = scan(slot);
+}
+
+void
+MutablePalette::insert(std::size_t i, const std::string& hex)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  insert_at(i, hex);
+}
+
+void
+MutablePalette::append(const std::string& hex)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  insert_at(order_.size(), hex);
+}
+
+void
+MutablePalette::insert_at(std::size_t i, const std::string& hex)
+{
+  if (i > order_.size()) {
+    throw std::out_of_range("palette index out of range");
+  }
+
+  // Validate before touching any state
+  const auto rgb = hex_to_rgb(hex);
+  const auto lab = rgb_to_lab(rgb[0], rgb[1], rgb[2]);
+  std::vector<double> row = distances_to(lab);
+  row.insert(row.begin() + static_cast<std::ptrdiff_t>(i), 0.0);
+
+  const std::size_t slot = allocate_slot();
+  assign(slot, hex);
+  nearest_[slot] = npos;
+  nearest_dist_[slot] = inf;
+  order_.insert(order_.begin() + static_cast<std::ptrdiff_t>(i), slot);
+  renumber(i);
+
+  update_row(slot, row);
+}
+
+void
+MutablePalette::remove(std::size_t i)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  check_index(i);
+
+  const std::size_t slot = order_[i];
+  order_.erase(order_.begin() + static_cast<std::ptrdiff_t>(i));
+  position_[slot] = npos;
+  nearest_[slot] = npos;
+  nearest_dist_[slot] = inf;
+  free_.push_back(slot);
+  renumber(i);
+
+  for (const std::size_t other : order_) {
+    if (nearest_[other] == slot) {
+      std::tie(nearest_[other], nearest_dist_[other]) = scan(other);
+    }
+  }
+}
+
+void
+MutablePalette::replace(std::size_t i, const std::string& hex)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  check_index(i);
+
+  const auto rgb = hex_to_rgb(hex);
+  const auto lab = rgb_to_lab(rgb[0], rgb[1], rgb[2]);
+  const std::vector<double> row = distances_to(lab);
+
+  const std::size_t slot = order_[i];
+  assign(slot, hex);
+  update_row(slot, row);
+}
+
+double
+MutablePalette::distance(std::size_t i, std::size_t j) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  check_index(i);
+  check_index(j);
+  return dist(order_[i], order_[j]);
+}
+
+Array<double>
+MutablePalette::distance_matrix() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::size_t n = order_.size();
+  std::vector<double> out(n * n);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      out[i * n + j] = dist(order_[i], order_[j]);
+    }
+  }
+  const auto extent = static_cast<std::ptrdiff_t>(n);
+  return Array<double>(std::move(out), { extent, extent });
+}
+
+std::vector<double>
+MutablePalette::min_distances() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<double> out;
+  out.reserve(order_.size());
+  for (const std::size_t slot : order_) {
+    out.push_back(nearest_dist_[slot]);
+  }
+  return out;
+}
+
+std::vector<std::int64_t>
+MutablePalette::nearest_neighbors() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::int64_t> out;
+  out.reserve(order_.size());
+  for (const std::size_t slot : order_) {
+    const std::size_t nearest = nearest_[slot];
+    out.push_back(
+      nearest == npos ? -1 : static_cast<std::int64_t>(position_[nearest]));
+  }
+  return out;
+}
+
+double
+MutablePalette::min_distance() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return current_min_distance();
+}
+
+double
+MutablePalette::current_min_distance() const
+{
+  // Zero distances (duplicate colors) are skipped, as in lab_min_distance()
+  double best = inf;
+  for (const std::size_t slot : order_) {
+    const double d =
+      nearest_dist_[slot] > 0 ? nearest_dist_[slot] : nonzero_min(slot);
+    best = std::min(best, d);
+  }
+  return best;
+}
+
+double
+MutablePalette::min_distance_if_added(const std::string& hex) const
+{
+  const auto rgb = hex_to_rgb(hex);
+  const auto lab = rgb_to_lab(rgb[0], rgb[1], rgb[2]);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto row = distances_to(lab);
+  double best = current_min_distance();
+  for (const double d : row) {
+    if (d > 0) {
+      best = std::min(best, d);
+    }
+  }
+  return best;
+}
+
+double
+MutablePalette::min_distance_if_removed(std::size_t i) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return min_distance_without(i);
+}
+
+double
+MutablePalette::min_distance_without(std::size_t i) const
+{
+  check_index(i);
+
+  const std::size_t removed = order_[i];
+  double best = inf;
+  for (const std::size_t other : order_) {
+    if (other == removed) {
+      continue;
+    }
+    if (nearest_[other] != removed && nearest_dist_[other] > 0) {
+      best = std::min(best, nearest_dist_[other]);
+    } else {
+      best = std::min(best, nonzero_min(other, removed));
+    }
+  }
+  return best;
+}
+
+double
+MutablePalette::min_distance_if_replaced(std::size_t i,
+                                         const std::string& hex) const
+{
+  const auto rgb = hex_to_rgb(hex);
+  const auto lab = rgb_to_lab(rgb[0], rgb[1], rgb[2]);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto row = distances_to(lab);
+  double best = min_distance_without(i);
+  for (std::size_t j = 0; j < row.size(); ++j) {
+    if (j != i && row[j] > 0) {
+      best = std::min(best, row[j]);
+    }
+  }
+  return best;
+}
+
+PaletteData
+MutablePalette::palette() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<double> rgb(3 * order_.size());
+  for (std::size_t i = 0; i < order_.size(); ++i) {
+    std::copy_n(&rgb_[3 * order_[i]], 3, &rgb[3 * i]);
+  }
+  return PaletteData(std::move(rgb));
+}
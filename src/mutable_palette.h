@@ -0,0 +1,175 @@
+/**
+ * @file mutable_palette.h
+ * @brief Palette with incrementally maintained distances
+ *
+ * MutablePalette caches the pairwise distance matrix and each color's
+ * nearest neighbor under a fixed metric. Inserting, removing or replacing a
+ * color evaluates the metric only against the other n - 1 colors; colors
+ * whose nearest neighbor was affected are updated by rescanning their cached
+ * rows, which needs no metric evaluations. An edit is O(n) metric
+ * evaluations plus an O(n) rescan per affected color, so O(n^2) in the worst
+ * case, when the edited color is the nearest neighbor of most others.
+ * min_distance() rescans the row of every duplicated color in the same way.
+ * What-if queries use the same caches without modifying the palette.
+ *
+ * Every public member function locks the palette, so one palette can be
+ * edited and queried from several threads, e.g. on free-threaded Python.
+ */
+
+#pragma once
+
+#include "array.h"
+#include "color_distance.h"
+#include "palette_data.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class MutablePalette
+{
+public:
+  /**
+   * @brief Create a palette from hex colors
+   * @param hex_colors Hex color strings in format #RRGGBB
+   * @param metric Distance metric name, see parse_metric()
+   * @throws std::invalid_argument If a color or the metric is invalid
+   */
+  MutablePalette(const std::vector<std::string>& hex_colors,
+                 const std::string& metric);
+
+  /// Number of colors in the palette
+  std::size_t size() const;
+
+  /// Name of the distance metric
+  const std::string& metric() const { return metric_name_; }
+
+  /// Hex string of the color at position @p i
+  std::string hex(std::size_t i) const;
+
+  /// Hex strings of all colors
+  std::vector<std::string> hex() const;
+
+  /**
+   * @brief Insert a color before position @p i
+   * @throws std::out_of_range If @p i is greater than size()
+   */
+  void insert(std::size_t i, const std::string& hex);
+
+  /// Append a color to the end of the palette
+  void append(const std::string& hex);
+
+  /**
+   * @brief Remove the color at position @p i
+   * @throws std::out_of_range If @p i is out of range
+   */
+  void remove(std::size_t i);
+
+  /**
+   * @brief Replace the color at position @p i
+   * @throws std::out_of_range If @p i is out of range
+   */
+  void replace(std::size_t i, const std::string& hex);
+
+  /// Cached distance between the colors at positions @p i and @p j
+  double distance(std::size_t i, std::size_t j) const;
+
+  /// n x n distance matrix, copied from the cache
+  Array<double> distance_matrix() const;
+
+  /// Distance from each color to its nearest neighbor
+  std::vector<double> min_distances() const;
+
+  /// Position of each color's nearest neighbor
+  std::vector<std::int64_t> nearest_neighbors() const;
+
+  /// Smallest non-zero pairwise distance, skipping duplicates like
+  /// PaletteData::min_distance()
+  double min_distance() const;
+
+  /// Minimum distance the palette would have if @p hex were appended
+  double min_distance_if_added(const std::string& hex) const;
+
+  /// Minimum distance the palette would have without the color at @p i
+  double min_distance_if_removed(std::size_t i) const;
+
+  /// Minimum distance the palette would have if color @p i became @p hex
+  double min_distance_if_replaced(std::size_t i, const std::string& hex) const;
+
+  /// Snapshot of the current colors as an immutable palette
+  PaletteData palette() const;
+
+private:
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  double& dist(std::size_t a, std::size_t b)
+  {
+    return dist_[a * capacity_ + b];
+  }
+
+  double dist(std::size_t a, std::size_t b) const
+  {
+    return dist_[a * capacity_ + b];
+  }
+
+  void check_index(std::size_t i) const;
+
+  /// Hex string of the color in @p slot
+  std::string slot_hex(std::size_t slot) const;
+
+  // Unlocked implementations of the public members of the same names
+  void insert_at(std::size_t i, const std::string& hex);
+  double current_min_distance() const;
+  double min_distance_without(std::size_t i) const;
+
+  /// Double the slot capacity, keeping cached distances
+  void grow();
+
+  /// Take a free slot, growing the storage if there is none
+  std::size_t allocate_slot();
+
+  /// Store @p hex in @p slot and return its Lab coordinates
+  std::array<double, 3> assign(std::size_t slot, const std::string& hex);
+
+  /// Renumber positions from @p first onwards after an insert or removal
+  void renumber(std::size_t first);
+
+  /// Distances from @p lab to every color, in position order
+  std::vector<double> distances_to(const std::array<double, 3>& lab) const;
+
+  /**
+   * @brief Store @p row as the distances of @p slot and update the nearest
+   * neighbors of all colors accordingly
+   */
+  void update_row(std::size_t slot, const std::vector<double>& row);
+
+  /// Smallest non-zero distance in the cached row of @p slot, ignoring
+  /// @p exclude
+  double nonzero_min(std::size_t slot, std::size_t exclude = npos) const;
+
+  /// Nearest neighbor of @p slot from its cached row, ignoring @p exclude
+  std::pair<std::size_t, double> scan(std::size_t slot,
+                                      std::size_t exclude = npos) const;
+
+  Metric metric_;
+  std::string metric_name_;
+
+  mutable std::mutex mutex_;
+
+  // Per-slot storage. Slots are reused after removals, so the order of the
+  // palette is kept separately in order_ and position_.
+  std::size_t capacity_ = 0;
+  std::vector<double> rgb_;
+  std::vector<double> lab_;
+  std::vector<double> dist_;
+  std::vector<std::size_t> nearest_;
+  std::vector<double> nearest_dist_;
+  std::vector<std::size_t> position_;
+  std::vector<std::size_t> free_;
+
+  std::vector<std::size_t> order_;
+};
@@ -0,0 +1,377 @@
+/**
+ * @file palette_data.cpp
+ * @brief Implementation of native palette storage
+ */
+
+#include "palette_data.h"
+
+#include "color_assignment.h"
+#include "color_conversions.h"
+#include "color_distance.h"
+#include "distance_file.h"
+#include "palette_ordering.h"
+#include "spatial_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <qualpal/colors.h>
+#include <stdexcept>
+
+namespace {
+
+std::vector<double>
+parse_hex_colors(const std::vector<std::string>& hex_colors)
+{
+  std::vector<double> rgb(3 * hex_colors.size());
+  for (std::size_t i = 0; i < hex_colors.size(); ++i) {
+    const auto c = hex_to_rgb(hex_colors[i]);
+    std::copy(c.begin(), c.end(), &rgb[3 * i]);
+  }
+  return rgb;
+}
+
+std::vector<double>
+rgb_to_lab_array(const std::vector<double>& rgb)
+{
+  const auto n = static_cast<std::ptrdiff_t>(rgb.size() / 3);
+  std::vector<double> lab(rgb.size());
+
+#pragma omp parallel for
+  for (std::ptrdiff_t i = 0; i < n; ++i) {
+    const qualpal::colors::Lab c(
+      qualpal::colors::RGB(rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2]));
+    lab[3 * i] = c.l();
+    lab[3 * i + 1] = c.a();
+    lab[3 * i + 2] = c.b();
+  }
+
+  return lab;
+}
+
+constexpr std::size_t bytes_header_size = 24;
+constexpr std::uint32_t bytes_version = 1;
+
+} // namespace
+
+PaletteData::PaletteData(const std::vector<std::string>& hex_colors)
+  : PaletteData(parse_hex_colors(hex_colors))
+{
+}
+
+PaletteData::PaletteData(std::vector<double> rgb)
+{
+  if (rgb.size() % 3 != 0) {
+    throw std::invalid_argument("RGB values must come in triples");
+  }
+  auto storage = std::make_shared<Storage>();
+  storage->lab = rgb_to_lab_array(rgb);
+  storage->rgb = std::move(rgb);
+  size_ = storage->rgb.size() / 3;
+  storage_ = std::move(storage);
+}
+
+PaletteData::PaletteData(std::shared_ptr<const Storage> storage,
+                         std::ptrdiff_t offset,
+                         std::ptrdiff_t step,
+                         std::size_t size)
+  : storage_(std::move(storage))
+  , offset_(offset)
+  , step_(step)
+  , size_(size)
+{
+}
+
+PaletteData
+PaletteData::slice(std::ptrdiff_t start,
+                   std::ptrdiff_t step,
+                   std::size_t length) const
+{
+  if (length == 0) {
+    return PaletteData(storage_, offset_, step_, 0);
+  }
+  return PaletteData(storage_, position(start), step_ * step, length);
+}
+
+std::string
+PaletteData::hex(std::size_t i) const
+{
+  const double* rgb = &storage_->rgb[3 * position(i)];
+  return rgb_to_hex(rgb[0], rgb[1], rgb[2]);
+}
+
+std::vector<std::string>
+PaletteData::hex() const
+{
+  std::vector<std::string> out;
+  out.reserve(size_);
+  for (std::size_t i = 0; i < size_; ++i) {
+    out.push_back(hex(i));
+  }
+  return out;
+}
+
+Array<double>
+PaletteData::view(const std::vector<double>& values) const
+{
+  const double* first = size_ > 0 ? &values[3 * position(0)] : values.data();
+  return Array<double>(storage_,
+                       first,
+                       { static_cast<std::ptrdiff_t>(size_), 3 },
+                       { 3 * step_, 1 });
+}
+
+Array<double>
+PaletteData::rgb_array() const
+{
+  return view(storage_->rgb);
+}
+
+Array<double>
+PaletteData::lab_array() const
+{
+  return view(storage_->lab);
+}
+
+std::vector<double>
+PaletteData::rgb() const
+{
+  return gather(storage_->rgb);
+}
+
+std::vector<double>
+PaletteData::lab() const
+{
+  return gather(storage_->lab);
+}
+
+std::vector<double>
+PaletteData::gather(const std::vector<double>& values) const
+{
+  if (step_ == 1) {
+    const auto first = values.begin() + 3 * offset_;
+    return std::vector<double>(first, first + 3 * size_);
+  }
+  std::vector<double> out(3 * size_);
+  for (std::size_t i = 0; i < size_; ++i) {
+    std::copy_n(&values[3 * position(i)], 3, &out[3 * i]);
+  }
+  return out;
+}
+
+std::vector<std::uint8_t>
+PaletteData::rgb8() const
+{
+  const auto rgb_values = rgb();
+  std::vector<std::uint8_t> out(rgb_values.size());
+  for (std::size_t k = 0; k < rgb_values.size(); ++k) {
+    const double c = std::clamp(rgb_values[k], 0.0, 1.0);
+    out[k] = static_cast<std::uint8_t>(std::lround(c * 255.0));
+  }
+  return out;
+}
+
+std::string
+PaletteData::to_bytes() const
+{
+  const std::uint64_t n = size_;
+  const std::size_t values_size = sizeof(double) * 3 * size_;
+  std::string out(bytes_header_size + 2 * values_size, '\0');
+  char* pos = out.data();
+  std::memcpy(pos, "QPALDATA", 8);
+  std::memcpy(pos + 8, &bytes_version, sizeof(bytes_version));
+  std::memcpy(pos + 16, &n, sizeof(n));
+  pos += bytes_header_size;
+  for (const auto* values : { &storage_->rgb, &storage_->lab }) {
+    if (size_ == 0) {
+      break;
+    }
+    if (step_ == 1) {
+      std::memcpy(pos, values->data() + 3 * offset_, values_size);
+    } else {
+      const auto rows = gather(*values);
+      std::memcpy(pos, rows.data(), values_size);
+    }
+    pos += values_size;
+  }
+  return out;
+}
+
+PaletteData
+PaletteData::from_bytes(const void* data, std::size_t size)
+{
+  const auto* in = static_cast<const char*>(data);
+  if (size < bytes_header_size || std::memcmp(in, "QPALDATA", 8) != 0) {
+    throw std::invalid_argument("Data does not hold a serialized palette");
+  }
+  std::uint32_t version = 0;
+  std::uint64_t n = 0;
+  std::memcpy(&version, in + 8, sizeof(version));
+  std::memcpy(&n, in + 16, sizeof(n));
+  if (version != bytes_version) {
+    // A palette from a machine of the other byte order reads as a
+    // byte-swapped version number
+    throw std::invalid_argument(
+      "Unsupported palette format version " + std::to_string(version) +
+      "; the data may have been written with a different byte order");
+  }
+  if ((size - bytes_header_size) / (2 * 3 * sizeof(double)) != n ||
+      (size - bytes_header_size) % (2 * 3 * sizeof(double)) != 0) {
+    throw std::invalid_argument("Serialized palette has the wrong size");
+  }
+
+  const auto count = static_cast<std::size_t>(3 * n);
+  const auto* values = in + bytes_header_size;
+  auto storage = std::make_shared<Storage>();
+  storage->rgb.resize(count);
+  storage->lab.resize(count);
+  std::memcpy(storage->rgb.data(), values, sizeof(double) * count);
+  std::memcpy(storage->lab.data(),
+              values + sizeof(double) * count,
+              sizeof(double) * count);
+  return PaletteData(std::move(storage), 0, 1, static_cast<std::size_t>(n));
+}
+
+ArrowColumn
+PaletteData::to_arrow(const std::string& kind) const
+{
+  if (kind == "hex") {
+    return ArrowColumn(hex());
+  }
+  if (kind == "rgb") {
+    return ArrowColumn(Array<std::uint8_t>(
+      rgb8(), { static_cast<std::ptrdiff_t>(size_), 3 }));
+  }
+  if (kind == "lab") {
+    return ArrowColumn(lab_array());
+  }
+  throw std::invalid_argument("Unknown kind: " + kind +
+                              ". Must be 'hex', 'rgb' or 'lab'");
+}
+
+Array<double>
+PaletteData::distance_matrix(const std::string& metric) const
+{
+  const auto n = static_cast<std::ptrdiff_t>(size_);
+  return Array<double>(lab_distance_matrix(lab(), parse_metric(metric)),
+                       { n, n });
+}
+
+Array<double>
+PaletteData::cvd_distance_matrix(const std::string& metric,
+                                 const std::vector<CvdCondition>& conditions,
+                                 double normal_weight,
+                                 const std::string& reduction) const
+{
+  const auto n = static_cast<std::ptrdiff_t>(size_);
+  return Array<double>(::cvd_distance_matrix(rgb(),
+                                             lab(),
+                                             parse_metric(metric),
+                                             conditions,
+                                             normal_weight,
+                                             parse_cvd_reduction(reduction)),
+                       { n, n });
+}
+
+double
+PaletteData::min_distance(const std::string& metric) const
+{
+  return lab_min_distance(lab(), parse_metric(metric));
+}
+
+std::vector<double>
+PaletteData::min_distances(const std::string& metric) const
+{
+  std::vector<std::int64_t> nearest;
+  std::vector<double> distances;
+  lab_nearest_neighbors(lab(), parse_metric(metric), nearest, distances);
+  return distances;
+}
+
+std::vector<std::int64_t>
+PaletteData::nearest_neighbors(const std::string& metric) const
+{
+  std::vector<std::int64_t> nearest;
+  std::vector<double> distances;
+  lab_nearest_neighbors(lab(), parse_metric(metric), nearest, distances);
+  return nearest;
+}
+
+void
+PaletteData::pairs_within(const std::string& metric,
+                          double threshold,
+                          std::vector<std::int64_t>& first,
+                          std::vector<std::int64_t>& second,
+                          std::vector<double>& distances) const
+{
+  lab_pairs_within(
+    lab(), parse_metric(metric), threshold, first, second, distances);
+}
+
+void
+PaletteData::knn_graph(const std::string& metric,
+                       std::size_t k,
+                       std::vector<std::int64_t>& indptr,
+                       std::vector<std::int64_t>& indices,
+                       std::vector<double>& distances) const
+{
+  lab_knn_graph(lab(), parse_metric(metric), k, indptr, indices, distances);
+}
+
+std::vector<std::int64_t>
+PaletteData::assign_to_graph(const std::string& metric,
+                             const std::int64_t* indptr,
+                             std::size_t n_nodes,
+                             const std::int64_t* indices) const
+{
+  return assign_graph_colors(indptr,
+                             n_nodes,
+                             indices,
+                             lab_distance_matrix(lab(), parse_metric(metric)),
+                             size_);
+}
+
+std::vector<std::int64_t>
+PaletteData::match(const PaletteData& previous, const std::string& metric) const
+{
+  return solve_assignment(
+    lab_cross_distance_matrix(previous.lab(), lab(), parse_metric(metric)),
+    previous.size(),
+    size_);
+}
+
+std::vector<std::int64_t>
+PaletteData::perceptual_order(const std::string& metric) const
+{
+  const auto order = max_min_adjacent_order(
+    lab_distance_matrix(lab(), parse_metric(metric)), size_);
+  return std::vector<std::int64_t>(order.begin(), order.end());
+}
+
+void
+PaletteData::write_distance_matrix(const std::string& path,
+                                   const std::string& metric,
+                                   const std::string& layout,
+                                   bool single_precision,
+                                   std::size_t tile_bytes) const
+{
+  write_lab_distance_matrix(path,
+                            lab(),
+                            parse_metric(metric),
+                            parse_matrix_layout(layout),
+                            single_precision,
+                            tile_bytes);
+}
+
+PaletteData
+PaletteData::simulate_cvd(const std::string& cvd_type, double severity) const
+{
+  std::vector<double> rgb(3 * size_);
+  for (std::size_t i = 0; i < size_; ++i) {
+    const double* c = &storage_->rgb[3 * position(i)];
+    const auto sim = ::simulate_cvd(c[0], c[1], c[2], cvd_type, severity);
+    const auto quantized = hex_to_rgb(rgb_to_hex(sim[0], sim[1], sim[2]));
+    std::copy(quantized.begin(), quantized.end(), &rgb[3 * i]);
+  }
+  return PaletteData(std::move(rgb));
+}
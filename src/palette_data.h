@@ -0,0 +1,259 @@
+/**
+ * @file palette_data.h
+ * @brief Native palette storage with contiguous RGB and Lab arrays
+ *
+ * PaletteData keeps the sRGB and CIE Lab coordinates of a palette in two
+ * contiguous row-major arrays, converting each color to Lab exactly once.
+ * Slices are views that share storage with the palette they were taken from,
+ * so slicing and iteration never copy or reconvert colors.
+ */
+
+#pragma once
+
+#include "array.h"
+#include "arrow_interface.h"
+#include "cvd_distance.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class PaletteData
+{
+public:
+  /**
+   * @brief Create a palette from hex colors
+   * @param hex_colors Hex color strings in format #RRGGBB
+   * @throws std::invalid_argument If a hex string is malformed
+   */
+  explicit PaletteData(const std::vector<std::string>& hex_colors);
+
+  /**
+   * @brief Create a palette from RGB values
+   * @param rgb RGB values in range [0, 1], three consecutive values per
+   * color
+   */
+  explicit PaletteData(std::vector<double> rgb);
+
+  /// Number of colors in the palette
+  std::size_t size() const { return size_; }
+
+  /**
+   * @brief Take a view of the palette
+   * @param start Index of the first color
+   * @param step Distance between consecutive colors (may be negative)
+   * @param length Number of colors in the view
+   * @return View sharing storage with this palette
+   */
+  PaletteData slice(std::ptrdiff_t start,
+                    std::ptrdiff_t step,
+                    std::size_t length) const;
+
+  /// Hex string of color @p i
+  std::string hex(std::size_t i) const;
+
+  /// Hex strings of all colors
+  std::vector<std::string> hex() const;
+
+  /// RGB values as an n x 3 view into the palette's storage
+  Array<double> rgb_array() const;
+
+  /// Lab values as an n x 3 view into the palette's storage
+  Array<double> lab_array() const;
+
+  /// Contiguous copy of the RGB values, three consecutive values per color
+  std::vector<double> rgb() const;
+
+  /// Contiguous copy of the Lab values, three consecutive values per color
+  std::vector<double> lab() const;
+
+  /// RGB values as 8-bit integers, three consecutive values per color
+  std::vector<std::uint8_t> rgb8() const;
+
+  /**
+   * @brief Export the colors as an Arrow column
+   * @param kind "hex" for utf8 hex strings, "rgb" for
+   * fixed_size_list<uint8, 3>, or "lab" for fixed_size_list<double, 3>
+   * (shares the palette's storage unless the palette is a strided view)
+   * @throws std::invalid_argument If @p kind is unknown
+   */
+  ArrowColumn to_arrow(const std::string& kind) const;
+
+  /**
+   * @brief Serialize the stored RGB and Lab values
+   *
+   * The layout is a 24-byte header, made up of the magic "QPALDATA", the
+   * format version (uint32, currently 1), 4 reserved bytes and the number
+   * of colors n (uint64), followed by n x 3 RGB and n x 3 Lab values, all
+   * float64 in native byte order. A view is written as the colors it
+   * covers.
+   */
+  std::string to_bytes() const;
+
+  /**
+   * @brief Restore a palette written by to_bytes()
+   *
+   * The values are copied as they are, without converting any color.
+   *
+   * @throws std::invalid_argument If @p data does not hold a palette, or
+   * was written with a different byte order
+   */
+  static PaletteData from_bytes(const void* data, std::size_t size);
+
+  /**
+   * @brief Calculate the pairwise distance matrix
+   * @param metric Distance metric name, see parse_metric()
+   * @return n x n symmetric distance matrix
+   */
+  Array<double> distance_matrix(const std::string& metric) const;
+
+  /**
+   * @brief Calculate a distance matrix combined over vision conditions
+   * @param metric Distance metric name, see parse_metric()
+   * @param conditions CVD conditions to include
+   * @param normal_weight Weight of normal vision (0 to exclude it)
+   * @param reduction "min" for the worst case, "mean" for the weighted mean
+   * @return n x n symmetric distance matrix
+   */
+  Array<double> cvd_distance_matrix(const std::string& metric,
+                                    const std::vector<CvdCondition>& conditions,
+                                    double normal_weight,
+                                    const std::string& reduction) const;
+
+  /**
+   * @brief Smallest non-zero distance between any two colors
+   * @param metric Distance metric name, see parse_metric()
+   */
+  double min_distance(const std::string& metric) const;
+
+  /**
+   * @brief Distance from each color to its nearest neighbor
+   * @param metric Distance metric name, see parse_metric()
+   */
+  std::vector<double> min_distances(const std::string& metric) const;
+
+  /**
+   * @brief Index of each color's nearest neighbor
+   * @param metric Distance metric name, see parse_metric()
+   */
+  std::vector<std::int64_t> nearest_neighbors(const std::string& metric) const;
+
+  /**
+   * @brief Find all pairs of colors closer than a threshold
+   * @param metric Distance metric name, see parse_metric()
+   * @param threshold Pairs with distance strictly below this are returned
+   * @param first Output: index of the first color of each pair
+   * @param second Output: index of the second color, greater than the first
+   * @param distances Output: distance of each pair
+   */
+  void pairs_within(const std::string& metric,
+                    double threshold,
+                    std::vector<std::int64_t>& first,
+                    std::vector<std::int64_t>& second,
+                    std::vector<double>& distances) const;
+
+  /**
+   * @brief Build the k-nearest-neighbor graph of the colors
+   * @param metric Distance metric name, see parse_metric()
+   * @param k Number of neighbors per color
+   * @param indptr Output: row offsets, one more than the number of colors
+   * @param indices Output: neighbor indices, nearest first
+   * @param distances Output: distance to each neighbor
+   * @see lab_knn_graph()
+   */
+  void knn_graph(const std::string& metric,
+                 std::size_t k,
+                 std::vector<std::int64_t>& indptr,
+                 std::vector<std::int64_t>& indices,
+                 std::vector<double>& distances) const;
+
+  /**
+   * @brief Assign the colors to the nodes of a graph so that adjacent nodes
+   * get distant colors
+   * @param metric Distance metric name, see parse_metric()
+   * @param indptr Row offsets of the adjacency matrix in CSR form
+   * @param n_nodes Number of nodes
+   * @param indices Column indices of the adjacency matrix
+   * @return Color index of each node
+   * @see assign_graph_colors()
+   */
+  std::vector<std::int64_t> assign_to_graph(const std::string& metric,
+                                            const std::int64_t* indptr,
+                                            std::size_t n_nodes,
+                                            const std::int64_t* indices) const;
+
+  /**
+   * @brief Match the colors of another palette to colors of this one
+   * @param previous Palette to match, e.g. an earlier version of this one
+   * @param metric Distance metric name, see parse_metric()
+   * @return Index of the color of this palette matched to each color of
+   * @p previous, -1 if unmatched; the total distance of the matched pairs is
+   * minimal
+   * @see solve_assignment()
+   */
+  std::vector<std::int64_t> match(const PaletteData& previous,
+                                  const std::string& metric) const;
+
+  /**
+   * @brief Order the colors so that neighbors in the order are distinct
+   * @param metric Distance metric name, see parse_metric()
+   * @return Permutation of the color indices
+   * @see max_min_adjacent_order()
+   */
+  std::vector<std::int64_t> perceptual_order(const std::string& metric) const;
+
+  /**
+   * @brief Write the distance matrix to a memory-mappable file
+   * @param path Output file
+   * @param metric Distance metric name, see parse_metric()
+   * @param layout "full" or "condensed"
+   * @param single_precision Store float32 rather than float64
+   * @param tile_bytes Size of the buffer holding the rows being computed
+   * @see write_lab_distance_matrix()
+   */
+  void write_distance_matrix(const std::string& path,
+                             const std::string& metric,
+                             const std::string& layout,
+                             bool single_precision,
+                             std::size_t tile_bytes) const;
+
+  /**
+   * @brief Simulate color vision deficiency on every color
+   * @param cvd_type Type of CVD: "protan", "deutan", or "tritan"
+   * @param severity Severity in range [0, 1]
+   * @return New palette with simulated colors, rounded to 8-bit sRGB
+   */
+  PaletteData simulate_cvd(const std::string& cvd_type, double severity) const;
+
+private:
+  struct Storage
+  {
+    std::vector<double> rgb;
+    std::vector<double> lab;
+  };
+
+  PaletteData(std::shared_ptr<const Storage> storage,
+              std::ptrdiff_t offset,
+              std::ptrdiff_t step,
+              std::size_t size);
+
+  /// Position of color @p i in the underlying storage
+  std::ptrdiff_t position(std::size_t i) const
+  {
+    return offset_ + static_cast<std::ptrdiff_t>(i) * step_;
+  }
+
+  Array<double> view(const std::vector<double>& values) const;
+
+  /// Contiguous copy of the rows of @p values covered by this view
+  std::vector<double> gather(const std::vector<double>& values) const;
+
+  std::shared_ptr<const Storage> storage_;
+  std::ptrdiff_t offset_ = 0;
+  std::ptrdiff_t step_ = 1;
+  std::size_t size_ = 0;
+};
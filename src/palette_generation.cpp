@@ -5,7 +5,326 @@
 
 #include "palette_generation.h"
 
+#include "color_conversions.h"
+#include "color_distance.h"
+#include "lru_cache.h"
+#include "palette_selection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
 #include <qualpal/metrics.h>
+#include <stdexcept>
+
+// Forward declare from qualpal library
+namespace qualpal {
+std::map<std::string, std::vector<std::string>>
+listAvailablePalettes();
+std::vector<std::string>
+getPalette(const std::string& palette);
+}
+
+namespace {
+
+/// Number of colors sampled from a colorspace, as in the qualpal library
+constexpr std::size_t colorspace_points = 1000;
+
+/// Smallest CIE LCh chroma of candidates for grouped palettes; grays have
+/// no meaningful hue
+constexpr double min_group_chroma = 15.0;
+
+/**
+ * @brief Lab coordinates of colors as seen with color vision deficiencies
+ * @param rgb Colors, three consecutive RGB values per color
+ * @param cvd CVD simulation parameters, applied in turn
+ */
+std::vector<double>
+seen_lab(const std::vector<double>& rgb,
+         const std::map<std::string, double>& cvd)
+{
+  const auto n = static_cast<std::ptrdiff_t>(rgb.size() / 3);
+  std::vector<double> lab(rgb.size());
+#pragma omp parallel for if (n > 4096)
+  for (std::ptrdiff_t i = 0; i < n; ++i) {
+    std::array<double, 3> c = { rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2] };
+    for (const auto& [cvd_type, severity] : cvd) {
+      if (severity > 0) {
+        c = simulate_cvd(c[0], c[1], c[2], cvd_type, severity);
+      }
+    }
+    const auto l = rgb_to_lab(c[0], c[1], c[2]);
+    std::copy(l.begin(), l.end(), &lab[3 * i]);
+  }
+  return lab;
+}
+
+/**
+ * @brief Conditions that palettes are selected under
+ * @param cvd Optional CVD simulation parameters
+ * @param cvd_mode "combined" (default) to apply the deficiencies in turn,
+ * as the qualpal library does, or "worst_case" for normal vision and each
+ * deficiency on its own
+ * @return One set of deficiencies to apply in turn per condition
+ * @throws std::invalid_argument If the mode or a CVD type is unknown, or a
+ * severity is outside [0, 1]
+ */
+std::vector<std::map<std::string, double>>
+cvd_conditions(const std::optional<std::map<std::string, double>>& cvd,
+               const std::optional<std::string>& cvd_mode)
+{
+  if (cvd.has_value()) {
+    validate_cvd_conditions(cvd.value());
+  }
+
+  const std::string mode = cvd_mode.value_or("combined");
+  if (mode == "combined") {
+    return { cvd.value_or(std::map<std::string, double>{}) };
+  }
+  if (mode != "worst_case") {
+    throw std::invalid_argument("Unknown CVD mode: " + mode +
+                                ". Must be 'combined' or 'worst_case'");
+  }
+
+  std::vector<std::map<std::string, double>> conditions = { {} };
+  if (cvd.has_value()) {
+    for (const auto& [cvd_type, severity] : cvd.value()) {
+      if (severity > 0) {
+        conditions.push_back({ { cvd_type, severity } });
+      }
+    }
+  }
+  return conditions;
+}
+
+/**
+ * @brief Select colors with the native selection
+ *
+ * Used for metrics the qualpal library lacks, for several backgrounds,
+ * which the library cannot weigh against each other, and for the worst
+ * case over several CVD conditions.
+ *
+ * @param n Number of colors to select, including the fixed ones
+ * @param n_fixed The first @p n_fixed candidates are always selected
+ * @param rgb Candidate colors, three consecutive RGB values per color
+ * @param conditions CVD conditions to select under, see cvd_conditions();
+ * each pair of colors counts with its smallest distance over them
+ * @param backgrounds Background colors to stand out from, with weights
+ * @param metric Distance metric
+ * @return Indices of the selected candidates, fixed ones first
+ * @throws std::invalid_argument If a weight is not positive
+ */
+std::vector<std::size_t>
+select_native(std::size_t n,
+              std::size_t n_fixed,
+              const std::vector<double>& rgb,
+              const std::vector<std::map<std::string, double>>& conditions,
+              const std::map<std::string, double>& backgrounds,
+              Metric metric)
+{
+  std::vector<double> background_rgb;
+  std::vector<double> weights;
+  for (const auto& [hex, weight] : backgrounds) {
+    if (!(weight > 0.0) || !std::isfinite(weight)) {
+      throw std::invalid_argument("Weight of background " + hex +
+                                  " must be positive");
+    }
+    const auto c = hex_to_rgb(hex);
+    background_rgb.insert(background_rgb.end(), c.begin(), c.end());
+    weights.push_back(weight);
+  }
+
+  // The candidates and backgrounds as seen under each condition, simulated
+  // once for the whole selection
+  std::vector<std::vector<double>> lab;
+  std::vector<std::vector<double>> background_lab;
+  for (const auto& condition : conditions) {
+    lab.push_back(seen_lab(rgb, condition));
+    if (!weights.empty()) {
+      background_lab.push_back(seen_lab(background_rgb, condition));
+    }
+  }
+
+  return farthest_points(lab, n, n_fixed, metric, background_lab, weights);
+}
+
+/// Hex strings of the colors at @p indices in @p rgb
+std::vector<std::string>
+indices_to_hex(const std::vector<double>& rgb,
+               const std::vector<std::size_t>& indices)
+{
+  std::vector<std::string> hex_colors;
+  hex_colors.reserve(indices.size());
+  for (const std::size_t k : indices) {
+    const double* c = &rgb[3 * k];
+    hex_colors.push_back(rgb_to_hex(c[0], c[1], c[2]));
+  }
+  return hex_colors;
+}
+
+/// Lower-case form of a hex color, so that each color has a single key
+std::string
+normalize_hex(const std::string& hex)
+{
+  const auto c = hex_to_rgb(hex);
+  return rgb_to_hex(c[0], c[1], c[2]);
+}
+
+/**
+ * @brief @p backgrounds, joined by @p background with weight 1 unless it is
+ * among them already
+ * @throws std::invalid_argument If a color is invalid, or is given twice, in
+ * different case, with different weights
+ */
+std::map<std::string, double>
+merge_backgrounds(
+  const std::optional<std::string>& background,
+  const std::optional<std::map<std::string, double>>& backgrounds)
+{
+  std::map<std::string, double> merged;
+  if (backgrounds.has_value()) {
+    for (const auto& [hex, weight] : backgrounds.value()) {
+      const auto [it, inserted] = merged.emplace(normalize_hex(hex), weight);
+      if (!inserted && it->second != weight) {
+        throw std::invalid_argument("Background " + it->first +
+                                    " is given twice with different weights");
+      }
+    }
+  }
+  if (background.has_value()) {
+    merged.emplace(normalize_hex(background.value()), 1.0);
+  }
+  return merged;
+}
+
+/// Candidate sets sampled from colorspace regions, by region and size
+LruCache<std::string, std::shared_ptr<const std::vector<double>>>&
+candidate_cache()
+{
+  static LruCache<std::string, std::shared_ptr<const std::vector<double>>>
+    cache(32);
+  return cache;
+}
+
+/// Named palettes from the qualpal library, by name
+LruCache<std::string, std::shared_ptr<const std::vector<std::string>>>&
+palette_cache()
+{
+  static LruCache<std::string,
+                  std::shared_ptr<const std::vector<std::string>>>
+    cache(64);
+  return cache;
+}
+
+/// Colors of a named palette, looked up once per name
+std::vector<std::string>
+cached_palette(const std::string& palette_name)
+{
+  if (const auto hit = palette_cache().get(palette_name)) {
+    return **hit;
+  }
+  auto palette = std::make_shared<const std::vector<std::string>>(
+    qualpal::getPalette(palette_name));
+  palette_cache().put(palette_name, palette);
+  return *palette;
+}
+
+/**
+ * @brief Sample candidate colors from a region of a colorspace
+ *
+ * Sampling is deterministic, so the candidates of recently used regions
+ * are cached and shared by later calls.
+ *
+ * @param space "hsl", or "lchab" for CIE LCh or "oklch" for OKLCh with the
+ * region clipped to the sRGB gamut
+ * @throws std::invalid_argument If the space is unknown, or an LCh region
+ * holds no sRGB colors
+ */
+std::vector<double>
+sample_colorspace(const std::string& space,
+                  const std::vector<double>& h_range,
+                  const std::vector<double>& c_range,
+                  const std::vector<double>& l_range,
+                  std::size_t n_points)
+{
+  if (space != "hsl" && space != "lchab" && space != "oklch") {
+    throw std::invalid_argument("Unknown colorspace type: " + space +
+                                ". Must be 'hsl', 'lchab' or 'oklch'");
+  }
+
+  char key[256];
+  std::snprintf(key,
+                sizeof(key),
+                "%s %.17g %.17g %.17g %.17g %.17g %.17g %zu",
+                space.c_str(),
+                h_range[0],
+                h_range[1],
+                c_range[0],
+                c_range[1],
+                l_range[0],
+                l_range[1],
+                n_points);
+  if (const auto hit = candidate_cache().get(key)) {
+    return **hit;
+  }
+
+  std::vector<double> rgb;
+  if (space == "hsl") {
+    rgb = sample_hsl({ h_range[0], h_range[1] },
+                     { c_range[0], c_range[1] },
+                     { l_range[0], l_range[1] },
+                     n_points);
+  } else {
+    rgb = sample_lch({ h_range[0], h_range[1] },
+                     { c_range[0], c_range[1] },
+                     { l_range[0], l_range[1] },
+                     n_points,
+                     space == "oklch" ? PolarSpace::OKLCH : PolarSpace::LCH);
+  }
+  candidate_cache().put(key,
+                        std::make_shared<const std::vector<double>>(rgb));
+  return rgb;
+}
+
+std::vector<double>
+hex_to_rgb_array(const std::vector<std::string>& hex_colors)
+{
+  std::vector<double> rgb;
+  rgb.reserve(3 * hex_colors.size());
+  for (const auto& hex : hex_colors) {
+    const auto c = hex_to_rgb(hex);
+    rgb.insert(rgb.end(), c.begin(), c.end());
+  }
+  return rgb;
+}
+
+/**
+ * @brief Candidate colors from whichever input source is given
+ * @return RGB values, three consecutive values per color
+ */
+std::vector<double>
+candidate_rgb(const std::optional<std::vector<double>>& h_range,
+              const std::optional<std::vector<double>>& c_range,
+              const std::optional<std::vector<double>>& l_range,
+              const std::optional<std::vector<std::string>>& colors,
+              const std::optional<std::string>& palette_name,
+              const std::string& space,
+              std::size_t n_points)
+{
+  if (h_range.has_value() && c_range.has_value() && l_range.has_value()) {
+    return sample_colorspace(
+      space, h_range.value(), c_range.value(), l_range.value(), n_points);
+  }
+  if (colors.has_value()) {
+    return hex_to_rgb_array(colors.value());
+  }
+  if (palette_name.has_value()) {
+    return hex_to_rgb_array(cached_palette(palette_name.value()));
+  }
+  return {};
+}
+
+} // namespace
 
 std::vector<std::string>
 rgb_palette_to_hex(const std::vector<qualpal::colors::RGB>& pal)
@@ -34,13 +353,19 @@ apply_optional_config(qualpal::Qualpal& qp,
   }
   if (metric.has_value()) {
     // Map string to MetricType enum
-    const auto& m = metric.value();
-    if (m == "ciede2000") {
-      qp.setMetric(qualpal::metrics::MetricType::CIEDE2000);
-    } else if (m == "din99d") {
-      qp.setMetric(qualpal::metrics::MetricType::DIN99d);
-    } else if (m == "cie76") {
-      qp.setMetric(qualpal::metrics::MetricType::CIE76);
+    switch (parse_metric(metric.value())) {
+      case Metric::CIEDE2000:
+        qp.setMetric(qualpal::metrics::MetricType::CIEDE2000);
+        break;
+      case Metric::DIN99d:
+        qp.setMetric(qualpal::metrics::MetricType::DIN99d);
+        break;
+      case Metric::CIE76:
+        qp.setMetric(qualpal::metrics::MetricType::CIE76);
+        break;
+      default:
+        throw std::invalid_argument("Metric '" + metric.value() +
+                                    "' is not supported by qualpal::Qualpal");
     }
   }
   if (max_memory.has_value()) {
@@ -75,19 +400,72 @@ generate_palette_unified(
   const std::optional<std::string>& background,
   const std::optional<std::string>& metric,
   const std::optional<double>& max_memory,
-  const std::optional<std::string>& white_point)
+  const std::optional<std::string>& white_point,
+  const std::optional<std::string>& space,
+  const std::optional<std::size_t>& colorspace_size,
+  const std::optional<std::map<std::string, double>>& backgrounds,
+  const std::optional<std::string>& cvd_mode)
 {
+  const bool from_colorspace =
+    h_range.has_value() && c_range.has_value() && l_range.has_value();
+  const std::string colorspace = space.value_or("hsl");
+  const std::size_t n_points = colorspace_size.value_or(colorspace_points);
+  const Metric selection_metric =
+    metric.has_value() ? parse_metric(metric.value()) : Metric::CIEDE2000;
+
+  const auto conditions = cvd_conditions(cvd, cvd_mode);
+
+  // Metrics the qualpal library lacks, weighted backgrounds and the worst
+  // case over CVD conditions use the native selection instead
+  if (!is_qualpal_metric(selection_metric) ||
+      (backgrounds.has_value() && !backgrounds->empty()) ||
+      conditions.size() > 1) {
+    if (n < 0) {
+      throw std::invalid_argument("n must be non-negative");
+    }
+    const auto rgb = candidate_rgb(h_range,
+                                   c_range,
+                                   l_range,
+                                   colors,
+                                   palette_name,
+                                   colorspace,
+                                   n_points);
+    const auto selected = select_native(static_cast<std::size_t>(n),
+                                        0,
+                                        rgb,
+                                        conditions,
+                                        merge_backgrounds(background,
+                                                          backgrounds),
+                                        selection_metric);
+    return indices_to_hex(rgb, selected);
+  }
+
   qualpal::Qualpal qp;
 
-  // Set input source (exactly one must be provided)
-  if (h_range.has_value() && c_range.has_value() && l_range.has_value()) {
+  // Set input source (exactly one must be provided). LCh regions are
+  // sampled here, inside the gamut, so that every one of the requested
+  // points is a candidate
+  if (from_colorspace && colorspace == "hsl") {
     qp.setInputColorspace({ h_range.value()[0], h_range.value()[1] },
                           { c_range.value()[0], c_range.value()[1] },
                           { l_range.value()[0], l_range.value()[1] });
+    qp.setColorspaceSize(n_points);
+  } else if (from_colorspace) {
+    const auto rgb = sample_colorspace(colorspace,
+                                       h_range.value(),
+                                       c_range.value(),
+                                       l_range.value(),
+                                       n_points);
+    std::vector<qualpal::colors::RGB> candidates;
+    candidates.reserve(n_points);
+    for (std::size_t i = 0; i + 2 < rgb.size(); i += 3) {
+      candidates.emplace_back(rgb[i], rgb[i + 1], rgb[i + 2]);
+    }
+    qp.setInputRGB(candidates);
   } else if (colors.has_value()) {
     qp.setInputHex(colors.value());
   } else if (palette_name.has_value()) {
-    qp.setInputPalette(palette_name.value());
+    qp.setInputHex(cached_palette(palette_name.value()));
   }
 
   // Apply optional configuration
@@ -97,6 +475,129 @@ generate_palette_unified(
   return rgb_palette_to_hex(qp.generate(n));
 }
 
+std::vector<std::vector<std::string>>
+generate_palette_grouped(
+  int n_groups,
+  int group_size,
+  double spread,
+  const std::optional<std::vector<double>>& h_range,
+  const std::optional<std::vector<double>>& c_range,
+  const std::optional<std::vector<double>>& l_range,
+  const std::optional<std::vector<std::string>>& colors,
+  const std::optional<std::string>& palette_name,
+  const std::optional<std::map<std::string, double>>& cvd,
+  const std::optional<std::string>& background,
+  const std::optional<std::string>& metric,
+  const std::optional<std::string>& space,
+  const std::optional<std::size_t>& colorspace_size,
+  const std::optional<std::map<std::string, double>>& backgrounds,
+  const std::optional<std::string>& cvd_mode)
+{
+  if (n_groups <= 0 || group_size <= 0) {
+    throw std::invalid_argument("n_groups and group_size must be positive");
+  }
+  if (!(spread > 0.0 && spread <= 1.0)) {
+    throw std::invalid_argument("spread must be in (0, 1]");
+  }
+  const Metric selection_metric =
+    metric.has_value() ? parse_metric(metric.value()) : Metric::CIEDE2000;
+  const auto conditions = cvd_conditions(cvd, cvd_mode);
+  const auto all_backgrounds = merge_backgrounds(background, backgrounds);
+  const auto rgb = candidate_rgb(h_range,
+                                 c_range,
+                                 l_range,
+                                 colors,
+                                 palette_name,
+                                 space.value_or("hsl"),
+                                 colorspace_size.value_or(colorspace_points));
+
+  // Only chromatic candidates have a hue to be grouped by
+  std::vector<double> chromatic;
+  std::vector<double> hues;
+  for (std::size_t i = 0; i < rgb.size() / 3; ++i) {
+    const auto lch = rgb_to_lch(rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2]);
+    if (lch[1] >= min_group_chroma) {
+      chromatic.insert(chromatic.end(), &rgb[3 * i], &rgb[3 * i + 3]);
+      hues.push_back(lch[2]);
+    }
+  }
+
+  // One anchor per group, as distinct from each other as possible, in
+  // order of hue
+  auto anchors = select_native(static_cast<std::size_t>(n_groups),
+                               0,
+                               chromatic,
+                               conditions,
+                               all_backgrounds,
+                               selection_metric);
+  std::sort(anchors.begin(), anchors.end(), [&](auto a, auto b) {
+    return hues[a] < hues[b];
+  });
+
+  // Each group draws from the middle part of the hue sector between the
+  // midpoints to its neighboring anchors, so the groups keep a gap in hue
+  // and the search runs on a small subset of the candidates. A single anchor
+  // is its own neighbor all the way around; anchors of the same hue leave no
+  // gap between them.
+  const bool single = anchors.size() == 1;
+  const auto hue_gap = [single](double from, double to) {
+    return single ? 360.0 : std::fmod(to - from + 360.0, 360.0);
+  };
+  std::vector<std::vector<std::string>> groups;
+  groups.reserve(anchors.size());
+  for (std::size_t g = 0; g < anchors.size(); ++g) {
+    const std::size_t prev = anchors[(g + anchors.size() - 1) % anchors.size()];
+    const std::size_t next = anchors[(g + 1) % anchors.size()];
+    const double center = hues[anchors[g]];
+    const double below = 0.5 * spread * hue_gap(hues[prev], center);
+    const double above = 0.5 * spread * hue_gap(center, hues[next]);
+
+    // The anchor is the first, fixed candidate of its group
+    std::vector<double> members(&chromatic[3 * anchors[g]],
+                                &chromatic[3 * anchors[g] + 3]);
+    for (std::size_t i = 0; i < hues.size(); ++i) {
+      const double offset = std::remainder(hues[i] - center, 360.0);
+      if (i != anchors[g] && offset >= -below && offset < above) {
+        members.insert(members.end(), &chromatic[3 * i], &chromatic[3 * i + 3]);
+      }
+    }
+    if (members.size() / 3 < static_cast<std::size_t>(group_size)) {
+      throw std::invalid_argument(
+        "The group around hue " + std::to_string(std::lround(center)) +
+        " has " + std::to_string(members.size() / 3) + " candidates for " +
+        std::to_string(group_size) +
+        " colors; increase spread or the number of candidates");
+    }
+
+    const auto selected = select_native(static_cast<std::size_t>(group_size),
+                                        1,
+                                        members,
+                                        conditions,
+                                        all_backgrounds,
+                                        selection_metric);
+    groups.push_back(indices_to_hex(members, selected));
+  }
+  return groups;
+}
+
+std::vector<double>
+candidate_colors(const std::optional<std::vector<double>>& h_range,
+                 const std::optional<std::vector<double>>& c_range,
+                 const std::optional<std::vector<double>>& l_range,
+                 const std::optional<std::vector<std::string>>& colors,
+                 const std::optional<std::string>& palette_name,
+                 const std::optional<std::string>& space,
+                 const std::optional<std::size_t>& colorspace_size)
+{
+  return candidate_rgb(h_range,
+                       c_range,
+                       l_range,
+                       colors,
+                       palette_name,
+                       space.value_or("hsl"),
+                       colorspace_size.value_or(colorspace_points));
+}
+
 std::vector<std::string>
 generate_palette(int n,
                  const std::vector<double>& h_range,
@@ -113,6 +614,10 @@ generate_palette(int n,
                                   std::nullopt,
                                   std::nullopt,
                                   std::nullopt,
+                                  std::nullopt,
+                                  std::nullopt,
+                                  std::nullopt,
+                                  std::nullopt,
                                   std::nullopt);
 }
 
@@ -129,6 +634,10 @@ generate_palette_from_colors(int n, const std::vector<std::string>& colors)
                                   std::nullopt,
                                   std::nullopt,
                                   std::nullopt,
+                                  std::nullopt,
+                                  std::nullopt,
+                                  std::nullopt,
+                                  std::nullopt,
                                   std::nullopt);
 }
 
@@ -145,17 +654,13 @@ generate_palette_from_palette(int n, const std::string& palette_name)
                                   std::nullopt,
                                   std::nullopt,
                                   std::nullopt,
+                                  std::nullopt,
+                                  std::nullopt,
+                                  std::nullopt,
+                                  std::nullopt,
                                   std::nullopt);
 }
 
-// Forward declare from qualpal library
-namespace qualpal {
-std::map<std::string, std::vector<std::string>>
-listAvailablePalettes();
-std::vector<std::string>
-getPalette(const std::string& palette);
-}
-
 std::map<std::string, std::vector<std::string>>
 list_palettes()
 {
@@ -165,5 +670,25 @@ list_palettes()
 std::vector<std::string>
 get_palette(const std::string& palette_name)
 {
-  return qualpal::getPalette(palette_name);
+  return cached_palette(palette_name);
+}
+
+GenerationCacheStats
+generation_cache_stats()
+{
+  GenerationCacheStats stats;
+  stats.candidate_sets = candidate_cache().size();
+  stats.candidate_hits = candidate_cache().hits();
+  stats.candidate_misses = candidate_cache().misses();
+  stats.palettes = palette_cache().size();
+  stats.palette_hits = palette_cache().hits();
+  stats.palette_misses = palette_cache().misses();
+  return stats;
+}
+
+void
+clear_generation_caches()
+{
+  candidate_cache().clear();
+  palette_cache().clear();
 }
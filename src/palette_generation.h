@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <map>
 #include <optional>
 #include <qualpal.h>
@@ -24,9 +25,13 @@ rgb_palette_to_hex(const std::vector<qualpal::colors::RGB>& pal);
  * @param qp Qualpal object to configure
  * @param cvd Optional CVD simulation parameters
  * @param background Optional background color (hex string)
- * @param metric Optional distance metric ("ciede2000", "din99d", "cie76")
+ * @param metric Optional distance metric ("ciede2000", "din99d", "cie76");
+ * other metrics are handled by the native selection in
+ * generate_palette_unified()
  * @param max_memory Optional memory limit in GB
  * @param white_point Optional white point ("d65", "d50", "d55", "a", "e")
+ * @throws std::invalid_argument If the metric is unknown or not implemented
+ * by the qualpal library
  */
 void
 apply_optional_config(qualpal::Qualpal& qp,
@@ -38,10 +43,30 @@ apply_optional_config(qualpal::Qualpal& qp,
 
 /**
  * @brief Unified palette generation function with full configuration
+ *
+ * Metrics implemented by the qualpal library are handled by
+ * qualpal::Qualpal. For the others ("oklab", "cam16ucs", "cie94", "cmc"),
+ * the same candidates are selected from natively with farthest_points();
+ * max_memory and white_point do not apply to them. The same holds for
+ * several weighted @p backgrounds, which the library cannot take: each
+ * candidate's distance to them is computed once, and the palette is
+ * selected to stand out from all of them at once, e.g. for light and dark
+ * themes. "worst_case" CVD handling also selects natively: the candidates
+ * are simulated once per condition, and all conditions are compared in the
+ * same pass.
+ *
+ * Colorspace regions in CIE LCh ("lchab") or OKLCh ("oklch") are sampled
+ * natively with sample_lch(), inside the sRGB gamut only, and handed to the
+ * selection as candidate colors, so there are exactly @p colorspace_size of
+ * them. With "oklch", the "oklab" metric measures distances in the same
+ * space, as plain Euclidean distances.
+ *
  * @param n Number of colors to generate
  * @param h_range Optional hue range [min, max] in degrees
- * @param c_range Optional chroma/saturation range [min, max] in [0, 1]
- * @param l_range Optional lightness range [min, max] in [0, 1]
+ * @param c_range Optional saturation range [min, max] in [0, 1], or chroma
+ * range for "lchab" and "oklch"
+ * @param l_range Optional lightness range [min, max] in [0, 1], or in
+ * [0, 100] for "lchab"
  * @param colors Optional list of input hex colors
  * @param palette_name Optional named palette (e.g., "ColorBrewer:Set2")
  * @param cvd Optional CVD simulation parameters
@@ -49,7 +74,23 @@ apply_optional_config(qualpal::Qualpal& qp,
  * @param metric Optional distance metric
  * @param max_memory Optional memory limit
  * @param white_point Optional white point
+ * @param space Optional colorspace type of the ranges, "hsl" (default),
+ * "lchab" or "oklch"
+ * @param colorspace_size Optional number of colors to sample from the
+ * colorspace (default: 1000)
+ * @param backgrounds Optional background colors (hex strings) mapped to
+ * positive weights. Distances to a background are divided by its weight,
+ * so a weight of 2 asks for twice the distance. @p background, if also
+ * given, joins them with weight 1.
+ * @param cvd_mode Optional handling of several deficiencies in @p cvd:
+ * "combined" (default) applies them in turn to every color; "worst_case"
+ * selects for normal vision and each deficiency on its own at the same
+ * time, counting every pair of colors with its smallest distance over
+ * them
  * @return Vector of hex color strings
+ * @throws std::invalid_argument If the colorspace type or CVD mode is
+ * unknown, an LCh region holds no sRGB colors, or a background weight is
+ * not positive
  */
 std::vector<std::string>
 generate_palette_unified(
@@ -63,7 +104,71 @@ generate_palette_unified(
   const std::optional<std::string>& background,
   const std::optional<std::string>& metric,
   const std::optional<double>& max_memory,
-  const std::optional<std::string>& white_point);
+  const std::optional<std::string>& white_point,
+  const std::optional<std::string>& space,
+  const std::optional<std::size_t>& colorspace_size,
+  const std::optional<std::map<std::string, double>>& backgrounds,
+  const std::optional<std::string>& cvd_mode);
+
+/**
+ * @brief Generate a grouped palette: @p n_groups groups of @p group_size
+ * related colors each
+ *
+ * Candidates come from the same sources as in generate_palette_unified().
+ * First, one anchor color per group is selected from the chromatic
+ * candidates so that the anchors are as distinct as possible. The hue
+ * circle is then split at the midpoints between neighboring anchors, and
+ * each group draws from the middle @p spread of its sector, which leaves a
+ * gap in hue between groups. Within a group, the colors are selected to be
+ * as distinct as possible, starting from its anchor. Every search runs on
+ * the native selection, the group searches on their sectors only.
+ *
+ * @param n_groups Number of groups
+ * @param group_size Number of colors per group
+ * @param spread Fraction of each hue sector that the group may use, in
+ * (0, 1]; smaller values give more closely related groups
+ * @return Groups in order of hue, each starting with its anchor
+ * @throws std::invalid_argument If a count or @p spread is out of range,
+ * or a group's sector holds too few candidates
+ * @see generate_palette_unified() for the other parameters
+ */
+std::vector<std::vector<std::string>>
+generate_palette_grouped(
+  int n_groups,
+  int group_size,
+  double spread,
+  const std::optional<std::vector<double>>& h_range,
+  const std::optional<std::vector<double>>& c_range,
+  const std::optional<std::vector<double>>& l_range,
+  const std::optional<std::vector<std::string>>& colors,
+  const std::optional<std::string>& palette_name,
+  const std::optional<std::map<std::string, double>>& cvd,
+  const std::optional<std::string>& background,
+  const std::optional<std::string>& metric,
+  const std::optional<std::string>& space,
+  const std::optional<std::size_t>& colorspace_size,
+  const std::optional<std::map<std::string, double>>& backgrounds,
+  const std::optional<std::string>& cvd_mode);
+
+/**
+ * @brief Candidate colors that the native selection chooses from
+ *
+ * Colorspace regions are sampled natively, also in HSL, where
+ * qualpal::Qualpal would otherwise sample them itself.
+ *
+ * @return RGB values in range [0, 1], three consecutive values per color
+ * @throws std::invalid_argument If the colorspace type is unknown, or an
+ * LCh region holds no sRGB colors
+ * @see generate_palette_unified() for the parameters
+ */
+std::vector<double>
+candidate_colors(const std::optional<std::vector<double>>& h_range,
+                 const std::optional<std::vector<double>>& c_range,
+                 const std::optional<std::vector<double>>& l_range,
+                 const std::optional<std::vector<std::string>>& colors,
+                 const std::optional<std::string>& palette_name,
+                 const std::optional<std::string>& space,
+                 const std::optional<std::size_t>& colorspace_size);
 
 /**
  * @brief Generate palette using colorspace input
@@ -112,3 +217,28 @@ list_palettes();
  */
 std::vector<std::string>
 get_palette(const std::string& palette_name);
+
+/**
+ * @brief Sizes and lookup counts of the caches behind palette generation
+ *
+ * Candidate sets sampled from colorspace regions (HSL regions handed to
+ * qualpal::Qualpal are sampled by the library and not cached) and named
+ * palettes are kept for reuse by later calls in the same process.
+ */
+struct GenerationCacheStats
+{
+  std::size_t candidate_sets = 0;
+  std::size_t candidate_hits = 0;
+  std::size_t candidate_misses = 0;
+  std::size_t palettes = 0;
+  std::size_t palette_hits = 0;
+  std::size_t palette_misses = 0;
+};
+
+/// Current state of the generation caches
+GenerationCacheStats
+generation_cache_stats();
+
+/// Empty the generation caches
+void
+clear_generation_caches();
@@ -0,0 +1,379 @@
+/**
+ * @file palette_ordering.cpp
+ * @brief Implementation of max-min adjacent distance ordering
+ */
+
+#include "palette_ordering.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+constexpr double inf = std::numeric_limits<double>::infinity();
+
+/// Quality of an order: its shortest edge, then its total length
+struct Score
+{
+  double min;
+  double sum;
+};
+
+bool
+better(const Score& a, const Score& b)
+{
+  return a.min > b.min ||
+         (a.min == b.min && a.sum > b.sum + 1e-12 * (1.0 + std::abs(b.sum)));
+}
+
+/// Optimal order by dynamic programming over subsets of colors
+std::vector<std::size_t>
+exact_order(const std::vector<double>& d, std::size_t n)
+{
+  const std::size_t n_masks = std::size_t{ 1 } << n;
+  const std::size_t full = n_masks - 1;
+
+  // Largest shortest edge over paths through mask that end at j
+  std::vector<double> bottleneck(n_masks * n, -inf);
+  for (std::size_t j = 0; j < n; ++j) {
+    bottleneck[(std::size_t{ 1 } << j) * n + j] = inf;
+  }
+  for (std::size_t mask = 1; mask < n_masks; ++mask) {
+    for (std::size_t j = 0; j < n; ++j) {
+      const double b = bottleneck[mask * n + j];
+      if (b == -inf) {
+        continue;
+      }
+      for (std::size_t k = 0; k < n; ++k) {
+        if (mask & (std::size_t{ 1 } << k)) {
+          continue;
+        }
+        const std::size_t next = mask | (std::size_t{ 1 } << k);
+        double& target = bottleneck[next * n + k];
+        target = std::max(target, std::min(b, d[j * n + k]));
+      }
+    }
+  }
+  double best_min = -inf;
+  for (std::size_t j = 0; j < n; ++j) {
+    best_min = std::max(best_min, bottleneck[full * n + j]);
+  }
+
+  // Longest path using only edges at least as long as the optimum
+  std::vector<double> length(n_masks * n, -inf);
+  std::vector<std::int8_t> parent(n_masks * n, -1);
+  for (std::size_t j = 0; j < n; ++j) {
+    length[(std::size_t{ 1 } << j) * n + j] = 0.0;
+  }
+  for (std::size_t mask = 1; mask < n_masks; ++mask) {
+    for (std::size_t j = 0; j < n; ++j) {
+      const double s = length[mask * n + j];
+      if (s == -inf) {
+        continue;
+      }
+      for (std::size_t k = 0; k < n; ++k) {
+        if ((mask & (std::size_t{ 1 } << k)) || d[j * n + k] < best_min) {
+          continue;
+        }
+        const std::size_t next = mask | (std::size_t{ 1 } << k);
+        if (s + d[j * n + k] > length[next * n + k]) {
+          length[next * n + k] = s + d[j * n + k];
+          parent[next * n + k] = static_cast<std::int8_t>(j);
+        }
+      }
+    }
+  }
+
+  std::size_t last = 0;
+  for (std::size_t j = 1; j < n; ++j) {
+    if (length[full * n + j] > length[full * n + last]) {
+      last = j;
+    }
+  }
+  std::vector<std::size_t> order;
+  for (std::size_t mask = full; mask != 0;) {
+    order.push_back(last);
+    const auto prev = parent[mask * n + last];
+    mask &= ~(std::size_t{ 1 } << last);
+    last = static_cast<std::size_t>(prev);
+  }
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+/// Build an order by repeatedly inserting the color nearest to those
+/// already placed where it lowers the score least
+std::vector<std::size_t>
+insertion_order(const std::vector<double>& d, std::size_t n)
+{
+  // Start from the farthest pair
+  std::size_t a = 0;
+  std::size_t b = 1;
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = i + 1; j < n; ++j) {
+      if (d[i * n + j] > d[a * n + b]) {
+        a = i;
+        b = j;
+      }
+    }
+  }
+
+  std::vector<std::size_t> path = { a, b };
+  std::vector<char> placed(n, 0);
+  placed[a] = placed[b] = 1;
+  std::vector<double> nearest(n);
+  for (std::size_t c = 0; c < n; ++c) {
+    nearest[c] = std::min(d[c * n + a], d[c * n + b]);
+  }
+
+  std::vector<double> prefix;
+  std::vector<double> suffix;
+  while (path.size() < n) {
+    std::size_t c = n;
+    for (std::size_t k = 0; k < n; ++k) {
+      if (!placed[k] && (c == n || nearest[k] < nearest[c])) {
+        c = k;
+      }
+    }
+
+    // prefix[k] / suffix[k]: shortest edge before / from edge k
+    const std::size_t m = path.size();
+    prefix.assign(m, inf);
+    suffix.assign(m, inf);
+    double total = 0.0;
+    for (std::size_t k = 0; k + 1 < m; ++k) {
+      const double e = d[path[k] * n + path[k + 1]];
+      prefix[k + 1] = std::min(prefix[k], e);
+      total += e;
+    }
+    for (std::size_t k = m - 1; k-- > 0;) {
+      suffix[k] = std::min(suffix[k + 1], d[path[k] * n + path[k + 1]]);
+    }
+
+    // Position p inserts c before path[p]
+    std::size_t best_pos = 0;
+    Score best = { -inf, -inf };
+    for (std::size_t p = 0; p <= m; ++p) {
+      Score s;
+      if (p == 0 || p == m) {
+        const double e = d[c * n + path[p == 0 ? 0 : m - 1]];
+        s = { std::min(prefix[m - 1], e), total + e };
+      } else {
+        const double e1 = d[path[p - 1] * n + c];
+        const double e2 = d[c * n + path[p]];
+        const double removed = d[path[p - 1] * n + path[p]];
+        const double rest = std::min(prefix[p - 1], suffix[p]);
+        s = { std::min({ rest, e1, e2 }), total - removed + e1 + e2 };
+      }
+      if (better(s, best)) {
+        best = s;
+        best_pos = p;
+      }
+    }
+
+    path.insert(path.begin() + static_cast<std::ptrdiff_t>(best_pos), c);
+    placed[c] = 1;
+    for (std::size_t k = 0; k < n; ++k) {
+      nearest[k] = std::min(nearest[k], d[k * n + c]);
+    }
+  }
+  return path;
+}
+
+/// Sparse table answering range-minimum queries over the edges of a path
+class EdgeMinimum
+{
+public:
+  explicit EdgeMinimum(const std::vector<double>& edges)
+  {
+    const std::size_t m = edges.size();
+    table_.push_back(edges);
+    for (std::size_t width = 1; 2 * width <= m; width *= 2) {
+      const auto& prev = table_.back();
+      std::vector<double> next(m - 2 * width + 1);
+      for (std::size_t k = 0; k < next.size(); ++k) {
+        next[k] = std::min(prev[k], prev[k + width]);
+      }
+      table_.push_back(std::move(next));
+    }
+  }
+
+  /// Shortest edge in [first, last), infinity if empty
+  double operator()(std::size_t first, std::size_t last) const
+  {
+    if (first >= last) {
+      return inf;
+    }
+    std::size_t level = 0;
+    while ((std::size_t{ 2 } << level) <= last - first) {
+      ++level;
+    }
+    const auto& row = table_[level];
+    return std::min(row[first], row[last - (std::size_t{ 1 } << level)]);
+  }
+
+private:
+  std::vector<std::vector<double>> table_;
+};
+
+/// Improve @p path with 2-opt and Or-opt moves until none helps
+void
+local_search(const std::vector<double>& d,
+             std::size_t n,
+             std::vector<std::size_t>& path)
+{
+  constexpr std::size_t max_passes = 100000;
+  std::vector<double> edges(n - 1);
+
+  for (std::size_t pass = 0; pass < max_passes; ++pass) {
+    double total = 0.0;
+    for (std::size_t k = 0; k + 1 < n; ++k) {
+      edges[k] = d[path[k] * n + path[k + 1]];
+      total += edges[k];
+    }
+    const EdgeMinimum range_min(edges);
+    const Score current = { range_min(0, n - 1), total };
+
+    // Score after replacing the edges at the given (distinct) positions by
+    // edges of the given lengths; all other edges are kept
+    const auto evaluate = [&](std::array<std::ptrdiff_t, 3> removed,
+                              std::array<double, 3> added) {
+      std::sort(removed.begin(), removed.end());
+      Score s = { std::min({ added[0], added[1], added[2] }), total };
+      std::size_t first = 0;
+      for (const auto r : removed) {
+        if (r < 0) {
+          continue;
+        }
+        s.min = std::min(s.min, range_min(first, static_cast<std::size_t>(r)));
+        s.sum -= edges[r];
+        first = static_cast<std::size_t>(r) + 1;
+      }
+      s.min = std::min(s.min, range_min(first, n - 1));
+      for (const double a : added) {
+        if (a != inf) {
+          s.sum += a;
+        }
+      }
+      return s;
+    };
+
+    const auto at = [&](std::size_t x, std::size_t y) {
+      return d[path[x] * n + path[y]];
+    };
+
+    // Move kind (0: none, 1: 2-opt, 2: Or-opt) and its parameters; the
+    // first improving move is taken, which converges much faster than
+    // searching for the best one
+    int kind = 0;
+    std::size_t move_i = 0;
+    std::size_t move_j = 0;
+    std::ptrdiff_t move_a = 0;
+    bool move_reversed = false;
+
+    // 2-opt: reverse path[i..j]
+    for (std::size_t i = 0; i < n && kind == 0; ++i) {
+      for (std::size_t j = i + 1; j < n; ++j) {
+        if (i == 0 && j == n - 1) {
+          continue;
+        }
+        const Score s =
+          evaluate({ i > 0 ? static_cast<std::ptrdiff_t>(i) - 1 : -1,
+                     j < n - 1 ? static_cast<std::ptrdiff_t>(j) : -1,
+                     -1 },
+                   { i > 0 ? at(i - 1, j) : inf,
+                     j < n - 1 ? at(i, j + 1) : inf,
+                     inf });
+        if (better(s, current)) {
+          kind = 1;
+          move_i = i;
+          move_j = j;
+          break;
+        }
+      }
+    }
+
+    // Or-opt: move path[i..e] to after path[a] (a = -1: to the front)
+    for (std::size_t length = 1; length <= 3 && length < n && kind == 0;
+         ++length) {
+      for (std::size_t i = 0; i + length <= n && kind == 0; ++i) {
+        const std::size_t e = i + length - 1;
+        const double bridge = (i > 0 && e < n - 1) ? at(i - 1, e + 1) : inf;
+        for (auto a = std::ptrdiff_t{ -1 };
+             a < static_cast<std::ptrdiff_t>(n) && kind == 0;
+             ++a) {
+          if (a >= static_cast<std::ptrdiff_t>(i) - 1 &&
+              a <= static_cast<std::ptrdiff_t>(e)) {
+            continue;
+          }
+          for (const bool reversed : { false, true }) {
+            if (reversed && length == 1) {
+              continue;
+            }
+            const std::size_t head = reversed ? e : i;
+            const std::size_t tail = reversed ? i : e;
+            const auto ua = static_cast<std::size_t>(a);
+            const Score s = evaluate(
+              { i > 0 ? static_cast<std::ptrdiff_t>(i) - 1 : -1,
+                e < n - 1 ? static_cast<std::ptrdiff_t>(e) : -1,
+                a >= 0 && ua < n - 1 ? a : -1 },
+              { bridge,
+                a >= 0 ? at(ua, head) : inf,
+                a < static_cast<std::ptrdiff_t>(n) - 1 ? at(tail, ua + 1)
+                                                       : inf });
+            if (better(s, current)) {
+              kind = 2;
+              move_i = i;
+              move_j = e;
+              move_a = a;
+              move_reversed = reversed;
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    if (kind == 0) {
+      return;
+    }
+    if (kind == 1) {
+      std::reverse(path.begin() + static_cast<std::ptrdiff_t>(move_i),
+                   path.begin() + static_cast<std::ptrdiff_t>(move_j) + 1);
+    } else {
+      std::vector<std::size_t> segment(path.begin() + move_i,
+                                       path.begin() + move_j + 1);
+      if (move_reversed) {
+        std::reverse(segment.begin(), segment.end());
+      }
+      path.erase(path.begin() + move_i, path.begin() + move_j + 1);
+      const std::ptrdiff_t pos =
+        move_a < static_cast<std::ptrdiff_t>(move_i)
+          ? move_a + 1
+          : move_a + 1 - static_cast<std::ptrdiff_t>(segment.size());
+      path.insert(path.begin() + pos, segment.begin(), segment.end());
+    }
+  }
+}
+
+} // namespace
+
+std::vector<std::size_t>
+max_min_adjacent_order(const std::vector<double>& distances, std::size_t n)
+{
+  if (n <= 2) {
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), std::size_t{ 0 });
+    return order;
+  }
+  if (n <= max_exact_ordering) {
+    return exact_order(distances, n);
+  }
+  auto order = insertion_order(distances, n);
+  local_search(distances, n, order);
+  return order;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file palette_ordering.h
+ * @brief Ordering of palettes so that neighboring colors are distinct
+ *
+ * Stacked areas and ordered legends show each color next to its
+ * neighbors in the order, so the order should keep adjacent colors as far
+ * apart as possible. This is a bottleneck Hamiltonian path problem: find
+ * the path through all colors whose shortest edge is longest. Among paths
+ * with the same shortest edge, the one with the largest total length is
+ * preferred.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/// Largest palette that is ordered exactly rather than heuristically
+constexpr std::size_t max_exact_ordering = 12;
+
+/**
+ * @brief Order colors to maximize the minimum distance between neighbors
+ * @param distances Symmetric n x n distance matrix, row-major
+ * @param n Number of colors
+ * @return Permutation of 0, ..., n - 1
+ *
+ * Up to max_exact_ordering colors, the order is optimal: a dynamic program
+ * over subsets first finds the largest achievable minimum, then the longest
+ * path that attains it. Larger palettes are ordered by insertion, placing
+ * the color nearest to those already placed in the best position, followed
+ * by 2-opt (segment reversal) and Or-opt (moving segments of up to three
+ * colors, possibly reversed) until no move improves the order.
+ */
+std::vector<std::size_t>
+max_min_adjacent_order(const std::vector<double>& distances, std::size_t n);
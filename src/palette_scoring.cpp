@@ -0,0 +1,173 @@
+/**
+ * @file palette_scoring.cpp
+ * @brief Implementation of batched palette scoring
+ */
+
+#include "palette_scoring.h"
+
+#include "color_conversions.h"
+#include "metric_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr double inf = std::numeric_limits<double>::infinity();
+
+std::uint32_t
+pack_rgb(const std::uint8_t* c)
+{
+  return (std::uint32_t(c[0]) << 16) | (std::uint32_t(c[1]) << 8) | c[2];
+}
+
+std::array<double, 3>
+unpack_rgb(std::uint32_t key)
+{
+  return { ((key >> 16) & 0xff) / 255.0,
+           ((key >> 8) & 0xff) / 255.0,
+           (key & 0xff) / 255.0 };
+}
+
+/// Lab coordinates of the unique keys, optionally after CVD simulation
+std::vector<double>
+unique_lab(const std::vector<std::uint32_t>& keys,
+           const std::string* cvd_type,
+           double severity)
+{
+  const auto n = static_cast<std::ptrdiff_t>(keys.size());
+  std::vector<double> lab(3 * keys.size());
+
+#pragma omp parallel for
+  for (std::ptrdiff_t i = 0; i < n; ++i) {
+    auto rgb = unpack_rgb(keys[i]);
+    if (cvd_type != nullptr) {
+      rgb = simulate_cvd(rgb[0], rgb[1], rgb[2], *cvd_type, severity);
+    }
+    const auto c = rgb_to_lab(rgb[0], rgb[1], rgb[2]);
+    std::copy(c.begin(), c.end(), &lab[3 * i]);
+  }
+
+  return lab;
+}
+
+template<typename Dist>
+double
+min_pairwise(const Dist& dist,
+             const std::vector<typename Dist::Point>& lab,
+             const std::uint32_t* index,
+             std::size_t k)
+{
+  double best = inf;
+  for (std::size_t a = 0; a < k; ++a) {
+    for (std::size_t b = a + 1; b < k; ++b) {
+      // Duplicates map to the same unique color
+      const double d =
+        index[a] == index[b] ? 0.0 : dist(lab[index[a]], lab[index[b]]);
+      best = std::min(best, d);
+    }
+  }
+  return best;
+}
+
+} // namespace
+
+PaletteScores
+score_palettes(const std::int64_t* offsets,
+               std::size_t n_palettes,
+               const std::uint8_t* rgb,
+               std::size_t n_colors,
+               Metric metric,
+               const std::optional<std::string>& background,
+               const std::map<std::string, double>& cvd)
+{
+  if (offsets[0] < 0 ||
+      static_cast<std::size_t>(offsets[n_palettes]) > n_colors) {
+    throw std::invalid_argument("offsets must lie within the color buffer");
+  }
+  for (std::size_t p = 0; p < n_palettes; ++p) {
+    if (offsets[p + 1] < offsets[p]) {
+      throw std::invalid_argument("offsets must be non-decreasing");
+    }
+  }
+  validate_cvd_conditions(cvd);
+
+  // Map every color to its index among the distinct colors of the batch
+  std::vector<std::uint32_t> keys(n_colors);
+  for (std::size_t i = 0; i < n_colors; ++i) {
+    keys[i] = pack_rgb(&rgb[3 * i]);
+  }
+  std::vector<std::uint32_t> unique = keys;
+  std::sort(unique.begin(), unique.end());
+  unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+  std::vector<std::uint32_t> index(n_colors);
+  for (std::size_t i = 0; i < n_colors; ++i) {
+    index[i] = static_cast<std::uint32_t>(
+      std::lower_bound(unique.begin(), unique.end(), keys[i]) -
+      unique.begin());
+  }
+
+  const auto lab = unique_lab(unique, nullptr, 0.0);
+
+  std::vector<std::vector<double>> cvd_lab;
+  for (const auto& [cvd_type, severity] : cvd) {
+    cvd_lab.push_back(unique_lab(unique, &cvd_type, severity));
+  }
+
+  std::optional<std::array<double, 3>> bg_lab;
+  if (background.has_value()) {
+    const auto c = hex_to_rgb(background.value());
+    bg_lab = rgb_to_lab(c[0], c[1], c[2]);
+  }
+
+  PaletteScores scores;
+  scores.min_distance.resize(n_palettes);
+  if (bg_lab.has_value()) {
+    scores.background_distance.resize(n_palettes);
+  }
+  if (!cvd_lab.empty()) {
+    scores.cvd_min_distance.resize(n_palettes);
+  }
+
+  visit_metric(metric, [&](auto dist) {
+    const auto n = static_cast<std::ptrdiff_t>(n_palettes);
+    const auto points = to_points(dist, lab);
+    std::vector<std::vector<typename decltype(dist)::Point>> cvd_points;
+    for (const auto& sim : cvd_lab) {
+      cvd_points.push_back(to_points(dist, sim));
+    }
+    std::optional<typename decltype(dist)::Point> bg_point;
+    if (bg_lab.has_value()) {
+      bg_point.emplace(dist.point(bg_lab->data()));
+    }
+
+#pragma omp parallel for schedule(dynamic, 16)
+    for (std::ptrdiff_t p = 0; p < n; ++p) {
+      const std::uint32_t* idx = index.data() + offsets[p];
+      const auto k = static_cast<std::size_t>(offsets[p + 1] - offsets[p]);
+
+      scores.min_distance[p] = min_pairwise(dist, points, idx, k);
+
+      if (bg_point.has_value()) {
+        double best = inf;
+        for (std::size_t a = 0; a < k; ++a) {
+          best = std::min(best, dist(points[idx[a]], bg_point.value()));
+        }
+        scores.background_distance[p] = best;
+      }
+
+      if (!cvd_points.empty()) {
+        double best = inf;
+        for (const auto& sim : cvd_points) {
+          best = std::min(best, min_pairwise(dist, sim, idx, k));
+        }
+        scores.cvd_min_distance[p] = best;
+      }
+    }
+  });
+
+  return scores;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file palette_scoring.h
+ * @brief Batched scoring of many candidate palettes
+ */
+
+#pragma once
+
+#include "color_distance.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Scores of a batch of palettes, one entry per palette
+ */
+struct PaletteScores
+{
+  /// Minimum pairwise distance (infinity for palettes with < 2 colors)
+  std::vector<double> min_distance;
+
+  /// Minimum distance to the background (empty if no background was given)
+  std::vector<double> background_distance;
+
+  /// Minimum pairwise distance under the worst of the CVD conditions (empty
+  /// if no CVD conditions were given)
+  std::vector<double> cvd_min_distance;
+};
+
+/**
+ * @brief Score a ragged batch of palettes in one pass
+ *
+ * Palette @c p consists of the colors in rows
+ * <tt>[offsets[p], offsets[p + 1])</tt> of @p rgb. Every distinct color in
+ * the batch is converted to Lab (and simulated for each CVD condition) only
+ * once; the palettes are then scored in parallel.
+ *
+ * @param offsets Palette boundaries, @p n_palettes + 1 non-decreasing values
+ * @param n_palettes Number of palettes
+ * @param rgb Packed 8-bit RGB values, three consecutive values per color
+ * @param n_colors Number of colors in @p rgb
+ * @param metric Distance metric
+ * @param background Optional background color (hex string)
+ * @param cvd CVD conditions, mapping "protan", "deutan" or "tritan" to a
+ * severity in [0, 1]
+ * @return Scores for each palette
+ * @throws std::invalid_argument If the offsets are inconsistent
+ */
+PaletteScores
+score_palettes(const std::int64_t* offsets,
+               std::size_t n_palettes,
+               const std::uint8_t* rgb,
+               std::size_t n_colors,
+               Metric metric,
+               const std::optional<std::string>& background,
+               const std::map<std::string, double>& cvd);
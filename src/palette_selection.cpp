@@ -0,0 +1,343 @@
+/**
+ * @file palette_selection.cpp
+ * @brief Implementation of native candidate sampling and selection
+ */
+
+#include "palette_selection.h"
+
+#include "color_conversions.h"
+#include "gamut.h"
+#include "metric_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+/// Element @p i of the van der Corput sequence in base @p base
+double
+halton(std::size_t i, std::size_t base)
+{
+  double f = 1.0;
+  double r = 0.0;
+  while (i > 0) {
+    f /= static_cast<double>(base);
+    r += f * static_cast<double>(i % base);
+    i /= base;
+  }
+  return r;
+}
+
+constexpr double pi = 3.14159265358979323846;
+
+/// Cells per side of the grid over lightness and hue used by sample_lch()
+constexpr std::size_t lch_grid = 64;
+
+} // namespace
+
+std::vector<double>
+sample_hsl(const std::array<double, 2>& h_range,
+           const std::array<double, 2>& s_range,
+           const std::array<double, 2>& l_range,
+           std::size_t n_points)
+{
+  std::vector<double> rgb(3 * n_points);
+  for (std::size_t i = 0; i < n_points; ++i) {
+    double h = h_range[0] + (h_range[1] - h_range[0]) * halton(i + 1, 2);
+    h = std::fmod(h + 360.0, 360.0);
+    const double s = s_range[0] + (s_range[1] - s_range[0]) * halton(i + 1, 3);
+    const double l = l_range[0] + (l_range[1] - l_range[0]) * halton(i + 1, 5);
+    const auto c = hsl_to_rgb(h, s, l);
+    std::copy(c.begin(), c.end(), &rgb[3 * i]);
+  }
+  return rgb;
+}
+
+std::vector<double>
+sample_lch(const std::array<double, 2>& h_range,
+           const std::array<double, 2>& c_range,
+           const std::array<double, 2>& l_range,
+           std::size_t n_points,
+           PolarSpace space)
+{
+  const double l_max = space == PolarSpace::OKLCH ? 1.0 : 100.0;
+  const double l0 = std::clamp(l_range[0], 0.0, l_max);
+  const double dl = (std::clamp(l_range[1], 0.0, l_max) - l0) / lch_grid;
+  const double dh = (h_range[1] - h_range[0]) / lch_grid;
+  const double c0 = std::max(c_range[0], 0.0);
+  const auto extent = [&](double l, double h) {
+    return std::min(c_range[1], srgb_max_chroma(l, h, space)) - c0;
+  };
+
+  // Chroma extent at the center of each cell, as sampling weights
+  const auto n_cells = static_cast<std::ptrdiff_t>(lch_grid * lch_grid);
+  std::vector<double> weights(lch_grid * lch_grid);
+#pragma omp parallel for
+  for (std::ptrdiff_t k = 0; k < n_cells; ++k) {
+    const auto i = static_cast<std::size_t>(k) / lch_grid;
+    const auto j = static_cast<std::size_t>(k) % lch_grid;
+    const double l = l0 + (static_cast<double>(i) + 0.5) * dl;
+    const double h = h_range[0] + (static_cast<double>(j) + 0.5) * dh;
+    weights[k] = std::max(extent(l, h), 0.0);
+  }
+  std::vector<double> cumulative(weights.size());
+  std::partial_sum(weights.begin(), weights.end(), cumulative.begin());
+  const double total = cumulative.back();
+  if (!(total > 0.0)) {
+    throw std::invalid_argument(
+      "The LCh ranges contain no colors in the sRGB gamut");
+  }
+
+  std::vector<double> rgb(3 * n_points);
+  const auto n = static_cast<std::ptrdiff_t>(n_points);
+#pragma omp parallel for
+  for (std::ptrdiff_t k = 0; k < n; ++k) {
+    const auto index = static_cast<std::size_t>(k) + 1;
+
+    // Cells without in-gamut colors have no weight and are never drawn
+    const double u = halton(index, 2) * total;
+    const auto cell = static_cast<std::size_t>(
+      std::min<std::ptrdiff_t>(
+        std::upper_bound(cumulative.begin(), cumulative.end(), u) -
+          cumulative.begin(),
+        n_cells - 1));
+    const auto i = cell / lch_grid;
+    const auto j = cell % lch_grid;
+    double l = l0 + (static_cast<double>(i) + halton(index, 3)) * dl;
+    double h = h_range[0] + (static_cast<double>(j) + halton(index, 5)) * dh;
+    double e = extent(l, h);
+    if (e < 0.0) {
+      // The region's edge crosses the cell; its center is inside
+      l = l0 + (static_cast<double>(i) + 0.5) * dl;
+      h = h_range[0] + (static_cast<double>(j) + 0.5) * dh;
+      e = weights[cell];
+    }
+
+    const double c = c0 + halton(index, 7) * e;
+    const double angle = h * pi / 180.0;
+    const double a = c * std::cos(angle);
+    const double b = c * std::sin(angle);
+    auto color = space == PolarSpace::OKLCH ? oklab_to_rgb(l, a, b)
+                                            : lab_to_rgb(l, a, b);
+    for (double& x : color) {
+      x = std::clamp(x, 0.0, 1.0);
+    }
+    std::copy(color.begin(), color.end(), &rgb[3 * k]);
+  }
+  return rgb;
+}
+
+std::vector<std::size_t>
+farthest_points(const std::vector<std::vector<double>>& lab,
+                std::size_t n,
+                std::size_t n_fixed,
+                Metric metric,
+                const std::vector<std::vector<double>>& background_lab,
+                const std::vector<double>& background_weights)
+{
+  if (lab.empty()) {
+    throw std::invalid_argument("At least one view of the candidates is "
+                                "required");
+  }
+  const std::size_t n_candidates = lab[0].size() / 3;
+  std::vector<const double*> views;
+  for (const auto& view : lab) {
+    if (view.size() != 3 * n_candidates) {
+      throw std::invalid_argument("Every view must hold the same colors");
+    }
+    views.push_back(view.data());
+  }
+  return farthest_points(views,
+                         n_candidates,
+                         n,
+                         n_fixed,
+                         metric,
+                         background_lab,
+                         background_weights);
+}
+
+std::vector<std::size_t>
+farthest_points(const std::vector<const double*>& lab,
+                std::size_t n_candidates,
+                std::size_t n,
+                std::size_t n_fixed,
+                Metric metric,
+                const std::vector<std::vector<double>>& background_lab,
+                const std::vector<double>& background_weights)
+{
+  if (lab.empty()) {
+    throw std::invalid_argument("At least one view of the candidates is "
+                                "required");
+  }
+  const std::size_t n_views = lab.size();
+  const std::size_t n_backgrounds = background_weights.size();
+  if (background_lab.size() != (n_backgrounds > 0 ? n_views : 0)) {
+    throw std::invalid_argument("Expected one background view per view of "
+                                "the candidates");
+  }
+  for (std::size_t v = 0; v < n_views; ++v) {
+    if (n_backgrounds > 0 && background_lab[v].size() != 3 * n_backgrounds) {
+      throw std::invalid_argument("Expected one weight per background");
+    }
+  }
+  if (n > n_candidates) {
+    throw std::invalid_argument(
+      "Cannot select " + std::to_string(n) + " colors from " +
+      std::to_string(n_candidates) + " candidates");
+  }
+  if (n_fixed > n) {
+    throw std::invalid_argument("More fixed colors than colors to select");
+  }
+
+  const double inf = std::numeric_limits<double>::infinity();
+  const auto n_cand = static_cast<std::ptrdiff_t>(n_candidates);
+
+  std::vector<std::size_t> selected;
+  selected.reserve(n);
+  std::vector<char> is_selected(n_candidates, 0);
+
+  visit_metric(metric, [&](auto dist) {
+    using Point = typename decltype(dist)::Point;
+    std::vector<std::vector<Point>> points;
+    std::vector<std::vector<Point>> backgrounds;
+    for (std::size_t v = 0; v < n_views; ++v) {
+      points.push_back(to_points(dist, lab[v], n_candidates));
+      if (n_backgrounds > 0) {
+        backgrounds.push_back(to_points(dist, background_lab[v]));
+      }
+    }
+
+    // Distance of a pair of candidates: the smallest over all views
+    const auto pair_dist = [&](std::size_t i, std::size_t j) {
+      double d = dist(points[0][i], points[0][j]);
+      for (std::size_t v = 1; v < n_views; ++v) {
+        d = std::min(d, dist(points[v][i], points[v][j]));
+      }
+      return d;
+    };
+
+    // Weighted distance from each candidate to the nearest background. It
+    // is computed once and caps the candidate's distance to the selection,
+    // so the backgrounds add nothing to the cost of later steps.
+    std::vector<double> to_background(n_candidates, inf);
+    if (n_backgrounds > 0) {
+#pragma omp parallel for if (n_cand > 4096)
+      for (std::ptrdiff_t c = 0; c < n_cand; ++c) {
+        double d = inf;
+        for (std::size_t v = 0; v < n_views; ++v) {
+          for (std::size_t b = 0; b < n_backgrounds; ++b) {
+            d = std::min(d,
+                         dist(backgrounds[v][b], points[v][c]) /
+                           background_weights[b]);
+          }
+        }
+        to_background[c] = d;
+      }
+    }
+
+    // dist_to[k * N + c]: distance from candidate c to selected color k
+    std::vector<double> dist_to(n * n_candidates);
+    const auto fill_column = [&](std::size_t k) {
+      const std::size_t p = selected[k];
+      double* col = &dist_to[k * n_candidates];
+#pragma omp parallel for if (n_cand > 4096)
+      for (std::ptrdiff_t c = 0; c < n_cand; ++c) {
+        col[c] = pair_dist(p, static_cast<std::size_t>(c));
+      }
+    };
+
+    const auto select = [&](std::size_t c) {
+      selected.push_back(c);
+      is_selected[c] = 1;
+      fill_column(selected.size() - 1);
+    };
+
+    // Greedy initialization: fixed colors, then repeatedly the candidate
+    // farthest from everything selected so far
+    for (std::size_t c = 0; c < n_fixed; ++c) {
+      select(c);
+    }
+    std::vector<double> nearest = to_background;
+    for (std::size_t k = 0; k < selected.size(); ++k) {
+      for (std::size_t c = 0; c < n_candidates; ++c) {
+        nearest[c] = std::min(nearest[c], dist_to[k * n_candidates + c]);
+      }
+    }
+    if (selected.empty() && n_backgrounds == 0 && n > 0) {
+      // Seed with the candidate farthest from the first one, which lies on
+      // the boundary of the candidate set
+      std::size_t seed = 0;
+      double seed_dist = 0.0;
+      for (std::size_t c = 1; c < n_candidates; ++c) {
+        const double d = pair_dist(0, c);
+        if (d > seed_dist) {
+          seed = c;
+          seed_dist = d;
+        }
+      }
+      select(seed);
+      for (std::size_t c = 0; c < n_candidates; ++c) {
+        nearest[c] = dist_to[c];
+      }
+    }
+    while (selected.size() < n) {
+      std::size_t best = n_candidates;
+      double best_dist = -1.0;
+      for (std::size_t c = 0; c < n_candidates; ++c) {
+        if (!is_selected[c] && nearest[c] > best_dist) {
+          best = c;
+          best_dist = nearest[c];
+        }
+      }
+      select(best);
+      const double* col = &dist_to[(selected.size() - 1) * n_candidates];
+      for (std::size_t c = 0; c < n_candidates; ++c) {
+        nearest[c] = std::min(nearest[c], col[c]);
+      }
+    }
+
+    // Swap refinement. Replacing selected color k by a candidate that is
+    // strictly farther from the other selected colors never decreases the
+    // minimum pairwise distance; the pass limit guards against plateaus.
+    std::vector<double> others(n_candidates);
+    constexpr int max_passes = 100;
+    for (int pass = 0; pass < max_passes; ++pass) {
+      bool improved = false;
+      for (std::size_t k = n_fixed; k < n; ++k) {
+#pragma omp parallel for if (n_cand > 4096)
+        for (std::ptrdiff_t c = 0; c < n_cand; ++c) {
+          double d = to_background[c];
+          for (std::size_t j = 0; j < n; ++j) {
+            if (j != k) {
+              d = std::min(d, dist_to[j * n_candidates + c]);
+            }
+          }
+          others[c] = d;
+        }
+
+        const double current = others[selected[k]];
+        std::size_t best = selected[k];
+        for (std::size_t c = 0; c < n_candidates; ++c) {
+          if (!is_selected[c] && others[c] > others[best]) {
+            best = c;
+          }
+        }
+        if (best != selected[k] && others[best] > current) {
+          is_selected[selected[k]] = 0;
+          is_selected[best] = 1;
+          selected[k] = best;
+          fill_column(k);
+          improved = true;
+        }
+      }
+      if (!improved) {
+        break;
+      }
+    }
+  });
+
+  return selected;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file palette_selection.h
+ * @brief Native candidate sampling and max-min color selection
+ *
+ * Used for palette generation with metrics that the qualpal library does
+ * not implement. The selection works on Lab coordinates through the same
+ * metric kernels as the distance functions.
+ */
+
+#pragma once
+
+#include "color_distance.h"
+#include "gamut.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Sample colors from a region of HSL space
+ *
+ * Points are taken from a Halton sequence (bases 2, 3 and 5), so the
+ * region is covered evenly and the result is deterministic.
+ *
+ * @param h_range Hue range [min, max] in degrees; may extend below 0 to
+ * wrap around red
+ * @param s_range Saturation range [min, max] in [0, 1]
+ * @param l_range Lightness range [min, max] in [0, 1]
+ * @param n_points Number of colors to sample
+ * @return RGB values in range [0, 1], three consecutive values per color
+ */
+std::vector<double>
+sample_hsl(const std::array<double, 2>& h_range,
+           const std::array<double, 2>& s_range,
+           const std::array<double, 2>& l_range,
+           std::size_t n_points);
+
+/**
+ * @brief Sample colors from the part of a region of CIE LCh or OKLCh space
+ * that lies in the sRGB gamut
+ *
+ * Every sample is displayable, so exactly @p n_points colors are produced
+ * without rejecting any. Lightness and hue are drawn cell by cell from a
+ * grid over the region, weighted by the in-gamut chroma extent at each
+ * cell's center, which is read from the cached gamut boundary table. Chroma
+ * is then drawn uniformly within the extent at the sampled lightness and
+ * hue. Points come from a Halton sequence (bases 2, 3, 5 and 7), so the
+ * result is deterministic.
+ *
+ * @param h_range Hue range [min, max] in degrees; may extend below 0 to
+ * wrap around
+ * @param c_range Chroma range [min, max]
+ * @param l_range Lightness range [min, max], in [0, 100] for CIE LCh and
+ * in [0, 1] for OKLCh
+ * @param n_points Number of colors to sample
+ * @param space Space of the region
+ * @return RGB values in range [0, 1], three consecutive values per color
+ * @throws std::invalid_argument If no color in the region is in the gamut
+ */
+std::vector<double>
+sample_lch(const std::array<double, 2>& h_range,
+           const std::array<double, 2>& c_range,
+           const std::array<double, 2>& l_range,
+           std::size_t n_points,
+           PolarSpace space = PolarSpace::LCH);
+
+/**
+ * @brief Select the candidates that maximize the minimum pairwise distance
+ *
+ * Colors are chosen greedily, each one farthest from those already chosen,
+ * and then improved by swapping selected colors for candidates that are
+ * farther from the rest of the selection until no swap helps.
+ *
+ * The candidates can be given in several views, e.g. as seen with normal
+ * vision and with each of several color vision deficiencies. The distance
+ * of a pair is then the smallest over all views, so the selection
+ * maximizes the worst case. Each view is converted once up front, and all
+ * views are compared in the same pass over the candidates.
+ *
+ * @param lab Lab coordinates of the candidates in each view, three values
+ * per color and the same colors in every view
+ * @param n Number of colors to select, including the fixed ones
+ * @param n_fixed The first @p n_fixed candidates are always selected, e.g.
+ * colors the palette must extend
+ * @param metric Distance metric
+ * @param background_lab Lab coordinates of backgrounds that the palette
+ * must stand out from in each view, or empty for none. They count like
+ * selected colors, but their distances are divided by their weights.
+ * @param background_weights Positive weight of each background; a weight
+ * of 2 asks for twice the distance from that background
+ * @return Indices of the selected candidates, fixed ones first
+ * @throws std::invalid_argument If there are no views, the views differ in
+ * size, there are fewer than @p n candidates, or @p n_fixed exceeds @p n
+ */
+std::vector<std::size_t>
+farthest_points(const std::vector<std::vector<double>>& lab,
+                std::size_t n,
+                std::size_t n_fixed,
+                Metric metric,
+                const std::vector<std::vector<double>>& background_lab = {},
+                const std::vector<double>& background_weights = {});
+
+/**
+ * @brief Select the candidates that maximize the minimum pairwise distance,
+ * from views that live elsewhere
+ *
+ * As farthest_points() above, for views that are not held in vectors, such
+ * as those of a candidate set in shared memory, without copying them.
+ *
+ * @param lab Start of the Lab coordinates of the candidates in each view,
+ * three values per color
+ * @param n_candidates Number of candidates in every view
+ * @throws std::invalid_argument If there are no views, there are fewer
+ * than @p n candidates, or @p n_fixed exceeds @p n
+ */
+std::vector<std::size_t>
+farthest_points(const std::vector<const double*>& lab,
+                std::size_t n_candidates,
+                std::size_t n,
+                std::size_t n_fixed,
+                Metric metric,
+                const std::vector<std::vector<double>>& background_lab = {},
+                const std::vector<double>& background_weights = {});
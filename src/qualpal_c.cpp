@@ -0,0 +1,438 @@
+/**
+ * @file qualpal_c.cpp
+ * @brief Implementation of the C interface
+ */
+
+#include "qualpal_c.h"
+
+#include "color_conversions.h"
+#include "color_distance.h"
+#include "metric_kernels.h"
+#include "palette_generation.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Size of the message buffer; longer messages are truncated
+constexpr std::size_t error_size = 256;
+
+thread_local char last_error[error_size] = "";
+
+qp_status
+fail(qp_status status, const char* message)
+{
+  std::strncpy(last_error, message, error_size - 1);
+  last_error[error_size - 1] = '\0';
+  return status;
+}
+
+/**
+ * @brief Call @p f, turning exceptions into status codes
+ */
+template<typename F>
+qp_status
+guarded(F&& f)
+{
+  try {
+    last_error[0] = '\0';
+    return f();
+  } catch (const std::invalid_argument& e) {
+    return fail(QP_ERROR_ARGUMENT, e.what());
+  } catch (const std::bad_alloc&) {
+    return fail(QP_ERROR_INTERNAL, "Out of memory");
+  } catch (const std::exception& e) {
+    return fail(QP_ERROR_INTERNAL, e.what());
+  } catch (...) {
+    return fail(QP_ERROR_INTERNAL, "Unknown error");
+  }
+}
+
+bool
+valid_metric(qp_metric metric)
+{
+  return metric >= QP_METRIC_CIEDE2000 && metric <= QP_METRIC_CMC;
+}
+
+/// The enumerators of qp_metric follow the order of Metric
+Metric
+to_metric(qp_metric metric)
+{
+  return static_cast<Metric>(metric);
+}
+
+const char*
+cvd_name(int cvd)
+{
+  switch (cvd) {
+    case QP_CVD_PROTAN:
+      return "protan";
+    case QP_CVD_DEUTAN:
+      return "deutan";
+    case QP_CVD_TRITAN:
+      return "tritan";
+    default:
+      return nullptr;
+  }
+}
+
+std::array<double, 3>
+to_rgb(qp_space space, const double* c)
+{
+  switch (space) {
+    case QP_SPACE_RGB:
+      return { c[0], c[1], c[2] };
+    case QP_SPACE_HSL:
+      return hsl_to_rgb(c[0], c[1], c[2]);
+    case QP_SPACE_LAB:
+      return lab_to_rgb(c[0], c[1], c[2]);
+    case QP_SPACE_LCH: {
+      constexpr double deg = 3.14159265358979323846 / 180.0;
+      return lab_to_rgb(
+        c[0], c[1] * std::cos(c[2] * deg), c[1] * std::sin(c[2] * deg));
+    }
+    case QP_SPACE_OKLAB:
+      return oklab_to_rgb(c[0], c[1], c[2]);
+    default:
+      throw std::invalid_argument("Conversion from this space is not "
+                                  "supported");
+  }
+}
+
+std::array<double, 3>
+from_rgb(qp_space space, const std::array<double, 3>& c)
+{
+  switch (space) {
+    case QP_SPACE_RGB:
+      return c;
+    case QP_SPACE_HSL:
+      return rgb_to_hsl(c[0], c[1], c[2]);
+    case QP_SPACE_XYZ:
+      return rgb_to_xyz(c[0], c[1], c[2]);
+    case QP_SPACE_LAB:
+      return rgb_to_lab(c[0], c[1], c[2]);
+    case QP_SPACE_LCH:
+      return rgb_to_lch(c[0], c[1], c[2]);
+    case QP_SPACE_OKLAB:
+      return rgb_to_oklab(c[0], c[1], c[2]);
+    case QP_SPACE_CAM16UCS:
+      return rgb_to_cam16ucs(c[0], c[1], c[2]);
+    default:
+      throw std::invalid_argument("Unknown color space");
+  }
+}
+
+/// Number of columns whose points are kept at once by the matrix kernels
+constexpr std::ptrdiff_t block_size = 64;
+
+/**
+ * @brief Fill a distance matrix block of columns by block of columns
+ *
+ * Instead of converting all colors to metric points up front, which would
+ * need a buffer, the points of one block of columns are kept on the stack
+ * and each row's point is recomputed once per block.
+ *
+ * @param symmetric Whether the rows and columns are the same colors, in
+ * which case only pairs with the row before the column are evaluated and
+ * mirrored
+ */
+template<typename Kernel>
+void
+fill_matrix(const Kernel& dist,
+            const double* rows,
+            std::ptrdiff_t m,
+            const double* cols,
+            std::ptrdiff_t n,
+            bool symmetric,
+            double* out)
+{
+  using Point = typename Kernel::Point;
+  const std::ptrdiff_t n_blocks = (n + block_size - 1) / block_size;
+
+#pragma omp parallel for schedule(dynamic) if (m * n > 4096)
+  for (std::ptrdiff_t block = 0; block < n_blocks; ++block) {
+    const std::ptrdiff_t j0 = block * block_size;
+    const std::ptrdiff_t j1 = std::min(n, j0 + block_size);
+    std::optional<Point> points[block_size];
+    for (std::ptrdiff_t j = j0; j < j1; ++j) {
+      points[j - j0].emplace(dist.point(&cols[3 * j]));
+    }
+
+    const std::ptrdiff_t i1 = symmetric ? j1 : m;
+    for (std::ptrdiff_t i = 0; i < i1; ++i) {
+      const Point p = dist.point(&rows[3 * i]);
+      for (std::ptrdiff_t j = symmetric ? std::max(j0, i + 1) : j0; j < j1;
+           ++j) {
+        const double d = dist(p, *points[j - j0]);
+        out[i * n + j] = d;
+        if (symmetric) {
+          out[j * n + i] = d;
+        }
+      }
+    }
+  }
+
+  if (symmetric) {
+    for (std::ptrdiff_t i = 0; i < n; ++i) {
+      out[i * n + i] = 0.0;
+    }
+  }
+}
+
+std::string
+rgb_hex(const double* c)
+{
+  return rgb_to_hex(std::clamp(c[0], 0.0, 1.0),
+                    std::clamp(c[1], 0.0, 1.0),
+                    std::clamp(c[2], 0.0, 1.0));
+}
+
+} // namespace
+
+const char*
+qp_last_error(void)
+{
+  return last_error;
+}
+
+qp_status
+qp_convert(qp_space from,
+           qp_space to,
+           const double* in,
+           size_t n,
+           double* out)
+{
+  return guarded([&] {
+    if (n > 0 && (in == nullptr || out == nullptr)) {
+      return fail(QP_ERROR_ARGUMENT, "Buffers must not be NULL");
+    }
+    if (from < QP_SPACE_RGB || from > QP_SPACE_CAM16UCS ||
+        to < QP_SPACE_RGB || to > QP_SPACE_CAM16UCS) {
+      return fail(QP_ERROR_ARGUMENT, "Unknown color space");
+    }
+    if (from == QP_SPACE_XYZ || from == QP_SPACE_CAM16UCS) {
+      return fail(QP_ERROR_ARGUMENT,
+                  "Conversion from XYZ or CAM16-UCS is not supported");
+    }
+
+    const auto count = static_cast<std::ptrdiff_t>(n);
+#pragma omp parallel for if (count > 4096)
+    for (std::ptrdiff_t i = 0; i < count; ++i) {
+      const auto c = from_rgb(to, to_rgb(from, &in[3 * i]));
+      std::copy(c.begin(), c.end(), &out[3 * i]);
+    }
+    return QP_OK;
+  });
+}
+
+qp_status
+qp_simulate_cvd(const double* rgb,
+                size_t n,
+                qp_cvd cvd,
+                double severity,
+                double* out)
+{
+  return guarded([&] {
+    if (n > 0 && (rgb == nullptr || out == nullptr)) {
+      return fail(QP_ERROR_ARGUMENT, "Buffers must not be NULL");
+    }
+    const char* name = cvd_name(cvd);
+    if (name == nullptr) {
+      return fail(QP_ERROR_ARGUMENT, "Unknown CVD type");
+    }
+    if (!(severity >= 0.0 && severity <= 1.0)) {
+      return fail(QP_ERROR_ARGUMENT, "Severity must be in [0, 1]");
+    }
+
+    const std::string type = name;
+    const auto count = static_cast<std::ptrdiff_t>(n);
+#pragma omp parallel for if (count > 4096)
+    for (std::ptrdiff_t i = 0; i < count; ++i) {
+      const auto c = simulate_cvd(
+        rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2], type, severity);
+      std::copy(c.begin(), c.end(), &out[3 * i]);
+    }
+    return QP_OK;
+  });
+}
+
+qp_status
+qp_distance_matrix(const double* lab,
+                   size_t n,
+                   qp_metric metric,
+                   double* out,
+                   size_t out_size)
+{
+  return guarded([&] {
+    if (n > 0 && (lab == nullptr || out == nullptr)) {
+      return fail(QP_ERROR_ARGUMENT, "Buffers must not be NULL");
+    }
+    if (!valid_metric(metric)) {
+      return fail(QP_ERROR_ARGUMENT, "Unknown metric");
+    }
+    if (out_size / std::max<size_t>(n, 1) < n) {
+      return fail(QP_ERROR_BUFFER, "Output buffer is too small");
+    }
+
+    const auto count = static_cast<std::ptrdiff_t>(n);
+    visit_metric(to_metric(metric), [&](auto dist) {
+      fill_matrix(dist, lab, count, lab, count, true, out);
+    });
+    return QP_OK;
+  });
+}
+
+qp_status
+qp_cross_distance_matrix(const double* lab_rows,
+                         size_t m,
+                         const double* lab_cols,
+                         size_t n,
+                         qp_metric metric,
+                         double* out,
+                         size_t out_size)
+{
+  return guarded([&] {
+    if ((m > 0 && lab_rows == nullptr) || (n > 0 && lab_cols == nullptr) ||
+        (m > 0 && n > 0 && out == nullptr)) {
+      return fail(QP_ERROR_ARGUMENT, "Buffers must not be NULL");
+    }
+    if (!valid_metric(metric)) {
+      return fail(QP_ERROR_ARGUMENT, "Unknown metric");
+    }
+    if (n > 0 && out_size / n < m) {
+      return fail(QP_ERROR_BUFFER, "Output buffer is too small");
+    }
+
+    visit_metric(to_metric(metric), [&](auto dist) {
+      fill_matrix(dist,
+                  lab_rows,
+                  static_cast<std::ptrdiff_t>(m),
+                  lab_cols,
+                  static_cast<std::ptrdiff_t>(n),
+                  false,
+                  out);
+    });
+    return QP_OK;
+  });
+}
+
+void
+qp_generate_options_init(qp_generate_options* options)
+{
+  if (options == nullptr) {
+    return;
+  }
+  *options = qp_generate_options{};
+  options->region = QP_REGION_HSL;
+  options->h_range[1] = 360.0;
+  options->c_range[1] = 1.0;
+  options->l_range[1] = 1.0;
+  options->colorspace_size = 1000;
+  options->metric = QP_METRIC_CIEDE2000;
+}
+
+qp_status
+qp_generate(const qp_generate_options* options,
+            size_t n,
+            double* out,
+            size_t out_size)
+{
+  return guarded([&] {
+    if (options == nullptr || (n > 0 && out == nullptr)) {
+      return fail(QP_ERROR_ARGUMENT, "Arguments must not be NULL");
+    }
+    if (!valid_metric(options->metric)) {
+      return fail(QP_ERROR_ARGUMENT, "Unknown metric");
+    }
+    for (const double severity : options->cvd) {
+      if (!(severity >= 0.0 && severity <= 1.0)) {
+        return fail(QP_ERROR_ARGUMENT, "Severity must be in [0, 1]");
+      }
+    }
+    if (out_size / 3 < n) {
+      return fail(QP_ERROR_BUFFER, "Output buffer is too small");
+    }
+
+    std::optional<std::vector<double>> h_range;
+    std::optional<std::vector<double>> c_range;
+    std::optional<std::vector<double>> l_range;
+    std::optional<std::vector<std::string>> colors;
+    std::optional<std::string> palette_name;
+    std::optional<std::string> space;
+    if (options->candidates != nullptr) {
+      colors.emplace();
+      for (size_t i = 0; i < options->n_candidates; ++i) {
+        colors->push_back(rgb_hex(&options->candidates[3 * i]));
+      }
+    } else if (options->palette_name != nullptr) {
+      palette_name = options->palette_name;
+    } else {
+      h_range = { options->h_range[0], options->h_range[1] };
+      c_range = { options->c_range[0], options->c_range[1] };
+      l_range = { options->l_range[0], options->l_range[1] };
+      switch (options->region) {
+        case QP_REGION_HSL:
+          space = "hsl";
+          break;
+        case QP_REGION_LCHAB:
+          space = "lchab";
+          break;
+        case QP_REGION_OKLCH:
+          space = "oklch";
+          break;
+        default:
+          return fail(QP_ERROR_ARGUMENT, "Unknown region space");
+      }
+    }
+
+    std::optional<std::map<std::string, double>> cvd;
+    for (int k = QP_CVD_PROTAN; k <= QP_CVD_TRITAN; ++k) {
+      if (options->cvd[k] > 0.0) {
+        if (!cvd.has_value()) {
+          cvd.emplace();
+        }
+        (*cvd)[cvd_name(k)] = options->cvd[k];
+      }
+    }
+
+    std::optional<std::string> background;
+    if (options->background != nullptr) {
+      background = rgb_hex(options->background);
+    }
+
+    const auto palette =
+      generate_palette_unified(static_cast<int>(n),
+                               h_range,
+                               c_range,
+                               l_range,
+                               colors,
+                               palette_name,
+                               cvd,
+                               background,
+                               metric_name(to_metric(options->metric)),
+                               std::nullopt,
+                               std::nullopt,
+                               space,
+                               options->colorspace_size,
+                               std::nullopt,
+                               std::nullopt);
+    if (palette.size() != n) {
+      return fail(QP_ERROR_INTERNAL, "Generated palette has the wrong size");
+    }
+    for (size_t i = 0; i < n; ++i) {
+      const auto c = hex_to_rgb(palette[i]);
+      std::copy(c.begin(), c.end(), &out[3 * i]);
+    }
+    return QP_OK;
+  });
+}
@@ -0,0 +1,188 @@
+/**
+ * @file qualpal_c.h
+ * @brief C interface to the palette engine
+ *
+ * Plain C functions around the same native code as the Python bindings,
+ * for callers in other languages. Colors are passed in caller-provided
+ * buffers of doubles, three consecutive values per color, and results are
+ * written to caller-provided buffers of the documented size. Conversions,
+ * CVD simulation and distance matrices do not allocate; generation does,
+ * inside the engine.
+ *
+ * Functions return a status code. On failure, qp_last_error() describes the
+ * problem; the message is kept per thread, so the functions may be called
+ * from several threads at once.
+ */
+
+#ifndef QUALPAL_C_H
+#define QUALPAL_C_H
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#if defined(QUALPAL_C_BUILDING)
+#define QP_API __declspec(dllexport)
+#else
+#define QP_API __declspec(dllimport)
+#endif
+#else
+#define QP_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  typedef enum qp_status
+  {
+    QP_OK = 0,
+    /// An argument is out of range or a combination is not supported
+    QP_ERROR_ARGUMENT = 1,
+    /// An output buffer is too small; nothing was written
+    QP_ERROR_BUFFER = 2,
+    /// Any other failure, such as running out of memory
+    QP_ERROR_INTERNAL = 3
+  } qp_status;
+
+  typedef enum qp_metric
+  {
+    QP_METRIC_CIEDE2000 = 0,
+    QP_METRIC_DIN99D = 1,
+    QP_METRIC_CIE76 = 2,
+    QP_METRIC_OKLAB = 3,
+    QP_METRIC_CAM16UCS = 4,
+    QP_METRIC_CIE94 = 5,
+    QP_METRIC_CMC = 6
+  } qp_metric;
+
+  /**
+   * Color spaces of qp_convert(). RGB is sRGB in [0, 1], HSL has hue in
+   * degrees and saturation and lightness in [0, 1], and LAB, LCH and XYZ
+   * use the D65 white point.
+   */
+  typedef enum qp_space
+  {
+    QP_SPACE_RGB = 0,
+    QP_SPACE_HSL = 1,
+    QP_SPACE_XYZ = 2,
+    QP_SPACE_LAB = 3,
+    QP_SPACE_LCH = 4,
+    QP_SPACE_OKLAB = 5,
+    QP_SPACE_CAM16UCS = 6
+  } qp_space;
+
+  typedef enum qp_cvd
+  {
+    QP_CVD_PROTAN = 0,
+    QP_CVD_DEUTAN = 1,
+    QP_CVD_TRITAN = 2
+  } qp_cvd;
+
+  /// Space of the region that qp_generate() samples candidates from
+  typedef enum qp_region
+  {
+    QP_REGION_HSL = 0,
+    QP_REGION_LCHAB = 1,
+    QP_REGION_OKLCH = 2
+  } qp_region;
+
+  /**
+   * Options of qp_generate(). Initialize with qp_generate_options_init()
+   * and set the fields of one candidate source: a colorspace region (the
+   * default), candidate colors, or a named palette.
+   */
+  typedef struct qp_generate_options
+  {
+    /// Region to sample candidates from, used if no other source is set
+    qp_region region;
+    double h_range[2];
+    double c_range[2];
+    double l_range[2];
+    /// Number of candidates sampled from the region
+    size_t colorspace_size;
+
+    /// Candidate colors in RGB, three values each, or NULL
+    const double* candidates;
+    size_t n_candidates;
+
+    /// Named palette such as "ColorBrewer:Set2", or NULL
+    const char* palette_name;
+
+    qp_metric metric;
+    /// Severity of each deficiency in [0, 1], indexed by qp_cvd
+    double cvd[3];
+    /// Background color in RGB, three values, or NULL
+    const double* background;
+  } qp_generate_options;
+
+  /// Message of the last failure on the calling thread, or ""
+  QP_API const char* qp_last_error(void);
+
+  /**
+   * Convert @p n colors from one space to another
+   *
+   * Conversions go through RGB. XYZ and CAM16-UCS can only be converted
+   * to, not from.
+   *
+   * @param in Input values, three per color
+   * @param out Output values, three per color; may be the same as @p in
+   */
+  QP_API qp_status qp_convert(qp_space from,
+                              qp_space to,
+                              const double* in,
+                              size_t n,
+                              double* out);
+
+  /**
+   * Simulate a color vision deficiency on @p n RGB colors
+   * @param severity Severity in [0, 1]
+   * @param out Simulated RGB values; may be the same as @p rgb
+   */
+  QP_API qp_status qp_simulate_cvd(const double* rgb,
+                                   size_t n,
+                                   qp_cvd cvd,
+                                   double severity,
+                                   double* out);
+
+  /**
+   * Pairwise distances between @p n colors given in Lab
+   * @param out Row-major n x n matrix, @p out_size values or more
+   */
+  QP_API qp_status qp_distance_matrix(const double* lab,
+                                      size_t n,
+                                      qp_metric metric,
+                                      double* out,
+                                      size_t out_size);
+
+  /**
+   * Distances from each of @p m colors to each of @p n colors, in Lab
+   * @param out Row-major m x n matrix, @p out_size values or more
+   */
+  QP_API qp_status qp_cross_distance_matrix(const double* lab_rows,
+                                            size_t m,
+                                            const double* lab_cols,
+                                            size_t n,
+                                            qp_metric metric,
+                                            double* out,
+                                            size_t out_size);
+
+  /// Set @p options to the defaults: the full HSL region, 1000 candidates,
+  /// CIEDE2000, normal vision and no background
+  QP_API void qp_generate_options_init(qp_generate_options* options);
+
+  /**
+   * Generate a palette of @p n distinct colors
+   * @param out RGB values of the palette, @p out_size values or more, which
+   * must hold 3 * @p n
+   */
+  QP_API qp_status qp_generate(const qp_generate_options* options,
+                               size_t n,
+                               double* out,
+                               size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,524 @@
+/**
+ * @file server.cpp
+ * @brief Palette server on a Unix domain socket
+ *
+ * One long-lived process per host serves the jobs of many clients, so the
+ * caches of sampled candidate sets, named palettes and job results stay
+ * warm across them.
+ *
+ * Messages in both directions are frames: a 4-byte big-endian length
+ * followed by that many bytes of JSON. A request is a job (see
+ * batch_jobs.h), an array of jobs, or {"type": "stats"}; the response is
+ * the output of the job as from run_job_output(), an array of outputs in
+ * the order of the jobs, or the cache statistics. The jobs of all requests
+ * that are in flight, from all connections, share one pool of threads.
+ * Requests on one connection are answered in order.
+ *
+ * Oversized requests, and connections beyond the limit, get an error frame
+ * like that of a failed job before the server closes the connection.
+ */
+
+#include "batch_jobs.h"
+#include "palette_generation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr const char* usage =
+  "Usage: qualpal-server [options]\n"
+  "\n"
+  "Serve palette jobs on a Unix domain socket. Frames are a 4-byte\n"
+  "big-endian length followed by a JSON job, array of jobs, or\n"
+  "{\"type\": \"stats\"}.\n"
+  "\n"
+  "Options:\n"
+  "  -s, --socket PATH  Socket path (default: $XDG_RUNTIME_DIR/qualpal.sock,\n"
+  "                     or /tmp/qualpal-UID.sock)\n"
+  "  -j, --jobs N       Number of worker threads (default: number of cores)\n"
+  "  -c, --cache N      Number of job results to cache (default: 4096)\n"
+  "  -m, --max-connections N\n"
+  "                     Number of open connections (default: 64)\n"
+  "  -t, --timings      Add the time spent on each job as \"time_ms\"\n"
+  "  -h, --help         Show this help\n";
+
+/// Largest accepted request, in bytes
+constexpr std::uint32_t max_frame = 64u << 20;
+
+std::atomic<bool> stopping{ false };
+
+void
+handle_signal(int)
+{
+  stopping = true;
+}
+
+struct Options
+{
+  std::string path;
+  std::size_t threads = 0;
+  std::size_t cache = 4096;
+  std::size_t max_connections = 64;
+  bool timings = false;
+};
+
+/**
+ * @brief Fixed set of threads running tasks in the order they were queued
+ */
+class ThreadPool
+{
+public:
+  explicit ThreadPool(std::size_t threads)
+  {
+    for (std::size_t k = 0; k < threads; ++k) {
+      workers_.emplace_back([this] { work(); });
+    }
+  }
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    ready_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  void submit(std::function<void()> task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    ready_.notify_one();
+  }
+
+private:
+  void work()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      ready_.wait(lock, [&] { return closed_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      auto task = std::move(tasks_.front());
+      tasks_.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<std::function<void()>> tasks_;
+  bool closed_ = false;
+};
+
+struct Server
+{
+  ThreadPool& pool;
+  ResultCache& results;
+  bool timings;
+};
+
+bool
+read_all(int fd, char* data, std::size_t size)
+{
+  while (size > 0) {
+    const ssize_t got = ::read(fd, data, size);
+    if (got <= 0) {
+      return false;
+    }
+    data += got;
+    size -= static_cast<std::size_t>(got);
+  }
+  return true;
+}
+
+bool
+write_all(int fd, const char* data, std::size_t size)
+{
+  while (size > 0) {
+    const ssize_t put = ::write(fd, data, size);
+    if (put <= 0) {
+      return false;
+    }
+    data += put;
+    size -= static_cast<std::size_t>(put);
+  }
+  return true;
+}
+
+enum class FrameStatus
+{
+  Ok,
+  Closed,
+  TooLarge
+};
+
+FrameStatus
+read_frame(int fd, std::string& payload)
+{
+  unsigned char header[4];
+  if (!read_all(fd, reinterpret_cast<char*>(header), 4)) {
+    return FrameStatus::Closed;
+  }
+  const std::uint32_t size = (std::uint32_t{ header[0] } << 24) |
+                             (std::uint32_t{ header[1] } << 16) |
+                             (std::uint32_t{ header[2] } << 8) | header[3];
+  if (size > max_frame) {
+    return FrameStatus::TooLarge;
+  }
+  payload.resize(size);
+  return read_all(fd, payload.data(), size) ? FrameStatus::Ok
+                                            : FrameStatus::Closed;
+}
+
+bool
+write_frame(int fd, const std::string& payload)
+{
+  const auto size = static_cast<std::uint32_t>(payload.size());
+  const char header[4] = { static_cast<char>(size >> 24),
+                           static_cast<char>(size >> 16),
+                           static_cast<char>(size >> 8),
+                           static_cast<char>(size) };
+  return write_all(fd, header, 4) &&
+         write_all(fd, payload.data(), payload.size());
+}
+
+/// Error frame in the shape of a failed job's output
+bool
+write_error(int fd, const std::string& message)
+{
+  const Json output = Json::Object{ { "id", Json() }, { "error", message } };
+  return write_frame(fd, output.dump());
+}
+
+Json
+stats(const Server& server)
+{
+  const auto generation = generation_cache_stats();
+  return Json::Object{
+    { "results", server.results.size() },
+    { "result_hits", server.results.hits() },
+    { "result_misses", server.results.misses() },
+    { "candidate_sets", generation.candidate_sets },
+    { "candidate_hits", generation.candidate_hits },
+    { "candidate_misses", generation.candidate_misses },
+    { "palettes", generation.palettes },
+    { "palette_hits", generation.palette_hits },
+    { "palette_misses", generation.palette_misses },
+  };
+}
+
+/// Run the jobs of a request on the pool and wait for all of them
+Json::Array
+run_jobs(Server& server, const Json::Array& jobs)
+{
+  Json::Array outputs(jobs.size());
+  std::mutex mutex;
+  std::condition_variable done;
+  std::size_t remaining = jobs.size();
+
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    server.pool.submit([&, i] {
+      bool ok = true;
+      Json output =
+        run_job_output(jobs[i], server.timings, ok, &server.results);
+      std::lock_guard<std::mutex> lock(mutex);
+      outputs[i] = std::move(output);
+      if (--remaining == 0) {
+        done.notify_one();
+      }
+    });
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&] { return remaining == 0; });
+  return outputs;
+}
+
+Json
+handle_request(Server& server, const std::string& payload)
+{
+  Json request;
+  try {
+    request = Json::parse(payload);
+  } catch (const std::exception& e) {
+    return Json::Object{ { "id", Json() }, { "error", e.what() } };
+  }
+
+  if (request.is_array()) {
+    return run_jobs(server, request.as_array());
+  }
+  if (const Json* type = request.find("type");
+      type != nullptr && type->is_string() && type->as_string() == "stats") {
+    return stats(server);
+  }
+  return std::move(run_jobs(server, Json::Array{ std::move(request) })[0]);
+}
+
+void
+serve_connection(Server& server, int fd)
+{
+  std::string payload;
+  while (true) {
+    const FrameStatus status = read_frame(fd, payload);
+    if (status == FrameStatus::TooLarge) {
+      // The rest of the frame is not read, so the stream cannot go on
+      write_error(fd,
+                  "Request exceeds the limit of " + std::to_string(max_frame) +
+                    " bytes");
+      return;
+    }
+    if (status == FrameStatus::Closed ||
+        !write_frame(fd, handle_request(server, payload).dump())) {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Threads serving the open connections, up to a fixed number
+ *
+ * Each connection is closed by its own thread once it is served, and the
+ * threads of closed connections are joined when the next one is opened.
+ */
+class Connections
+{
+public:
+  explicit Connections(std::size_t limit)
+    : limit_(limit)
+  {
+  }
+
+  ~Connections() { close_all(); }
+
+  /**
+   * @brief Serve a connection on a new thread
+   * @return Whether it was taken; if not, the caller still owns @p fd
+   */
+  bool open(Server& server, int fd)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = open_.begin(); it != open_.end();) {
+      if (it->done) {
+        it->thread.join();
+        it = open_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (open_.size() >= limit_) {
+      return false;
+    }
+
+    open_.push_back({ fd, std::thread(), false });
+    const auto it = std::prev(open_.end());
+    it->thread = std::thread([this, &server, it] {
+      serve_connection(server, it->fd);
+      std::lock_guard<std::mutex> lock(mutex_);
+      ::close(it->fd);
+      it->done = true;
+    });
+    return true;
+  }
+
+  /// Wake connections that wait for requests and join all threads
+  void close_all()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto& connection : open_) {
+        if (!connection.done) {
+          ::shutdown(connection.fd, SHUT_RDWR);
+        }
+      }
+    }
+    // Requests in flight are finished, but their responses go nowhere
+    for (auto& connection : open_) {
+      connection.thread.join();
+    }
+    open_.clear();
+  }
+
+private:
+  struct Connection
+  {
+    int fd;
+    std::thread thread;
+    bool done;
+  };
+
+  std::size_t limit_;
+  std::mutex mutex_;
+  std::list<Connection> open_;
+};
+
+std::string
+default_socket_path()
+{
+  if (const char* runtime = std::getenv("XDG_RUNTIME_DIR")) {
+    return std::string(runtime) + "/qualpal.sock";
+  }
+  return "/tmp/qualpal-" + std::to_string(::getuid()) + ".sock";
+}
+
+bool
+parse_count(const char* text, std::size_t& out, long min)
+{
+  char* end = nullptr;
+  const long value = std::strtol(text, &end, 10);
+  if (*end != '\0' || value < min) {
+    return false;
+  }
+  out = static_cast<std::size_t>(value);
+  return true;
+}
+
+bool
+parse_options(int argc, char** argv, Options& options)
+{
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (arg == "-h" || arg == "--help") {
+      std::cout << usage;
+      std::exit(0);
+    } else if (arg == "-t" || arg == "--timings") {
+      options.timings = true;
+    } else if ((arg == "-s" || arg == "--socket") && has_value) {
+      options.path = argv[++i];
+    } else if ((arg == "-j" || arg == "--jobs") && has_value) {
+      if (!parse_count(argv[++i], options.threads, 1)) {
+        return false;
+      }
+    } else if ((arg == "-c" || arg == "--cache") && has_value) {
+      if (!parse_count(argv[++i], options.cache, 0)) {
+        return false;
+      }
+    } else if ((arg == "-m" || arg == "--max-connections") && has_value) {
+      if (!parse_count(argv[++i], options.max_connections, 1)) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Listening socket bound to @p path, or -1 with a message on failure
+int
+listen_on(const std::string& path)
+{
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "qualpal-server: socket path too long: " << path << '\n';
+    return -1;
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    std::perror("qualpal-server: socket");
+    return -1;
+  }
+
+  // A stale socket from a server that did not exit cleanly is replaced,
+  // but one that still accepts connections is left to its server
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) ==
+      0) {
+    std::cerr << "qualpal-server: already running on " << path << '\n';
+    ::close(fd);
+    return -1;
+  }
+  ::unlink(path.c_str());
+
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) !=
+        0 ||
+      ::listen(fd, SOMAXCONN) != 0) {
+    std::perror("qualpal-server: bind");
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  Options options;
+  if (!parse_options(argc, argv, options)) {
+    std::cerr << usage;
+    return 2;
+  }
+  if (options.path.empty()) {
+    options.path = default_socket_path();
+  }
+  if (options.threads == 0) {
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // Clients that hang up show up as failed writes instead
+  std::signal(SIGPIPE, SIG_IGN);
+  std::signal(SIGINT, handle_signal);
+  std::signal(SIGTERM, handle_signal);
+
+  const int listener = listen_on(options.path);
+  if (listener < 0) {
+    return 1;
+  }
+
+  ThreadPool pool(options.threads);
+  ResultCache results(options.cache);
+  Server server{ pool, results, options.timings };
+  Connections connections(options.max_connections);
+
+  while (!stopping) {
+    pollfd ready{ listener, POLLIN, 0 };
+    if (::poll(&ready, 1, 200) <= 0) {
+      continue;
+    }
+    const int fd = ::accept(listener, nullptr, nullptr);
+    if (fd >= 0 && !connections.open(server, fd)) {
+      write_error(fd, "Too many connections");
+      ::close(fd);
+    }
+  }
+
+  ::close(listener);
+  ::unlink(options.path.c_str());
+  connections.close_all();
+  return 0;
+}
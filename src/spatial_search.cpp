@@ -0,0 +1,433 @@
+/**
+ * @file spatial_search.cpp
+ * @brief Implementation of spatially pruned distance queries
+ */
+
+#include "spatial_search.h"
+
+#include "metric_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+namespace {
+
+constexpr double inf = std::numeric_limits<double>::infinity();
+
+/// Relative slack for comparisons against bounds, covering rounding in the
+/// embedded coordinates
+constexpr double slack = 1e-9;
+
+/// Scale Lab so that Euclidean distance bounds a weighted Lab metric
+std::vector<std::array<double, 3>>
+scaled_lab(const std::vector<double>& lab, double k_l, double k_ab)
+{
+  std::vector<std::array<double, 3>> coords(lab.size() / 3);
+  for (std::size_t i = 0; i < coords.size(); ++i) {
+    coords[i] = { lab[3 * i] / k_l,
+                  lab[3 * i + 1] / k_ab,
+                  lab[3 * i + 2] / k_ab };
+  }
+  return coords;
+}
+
+double
+max_chroma(const std::vector<double>& lab)
+{
+  double c = 0.0;
+  for (std::size_t i = 0; i + 2 < lab.size(); i += 3) {
+    c = std::max(c, std::hypot(lab[i + 1], lab[i + 2]));
+  }
+  return c;
+}
+
+} // namespace
+
+MetricEmbedding::MetricEmbedding(const std::vector<double>& lab, Metric metric)
+{
+  const std::size_t n = lab.size() / 3;
+
+  switch (metric) {
+    case Metric::CIE76:
+      coords_ = scaled_lab(lab, 1.0, 1.0);
+      break;
+
+    case Metric::OKLab:
+      coords_ = to_points(OKLabMetric{}, lab);
+      break;
+
+    case Metric::CAM16UCS:
+      coords_ = to_points(CAM16UCSMetric{}, lab);
+      break;
+
+    case Metric::DIN99d: {
+      coords_.resize(n);
+      for (std::size_t i = 0; i < n; ++i) {
+        const qualpal::colors::DIN99d c(
+          qualpal::colors::Lab(lab[3 * i], lab[3 * i + 1], lab[3 * i + 2]));
+        coords_[i] = { c.l(), c.a(), c.b() };
+      }
+
+      // Sample the metric as a function of DIN99d distance along the
+      // neutral axis
+      const qualpal::colors::Lab black(0.0, 0.0, 0.0);
+      const qualpal::colors::DIN99d black99(black);
+      const qualpal::metrics::DIN99d dist;
+      std::vector<std::pair<double, double>> samples;
+      for (int k = 0; k <= 1000; ++k) {
+        const qualpal::colors::Lab gray(0.1 * k, 0.0, 0.0);
+        const qualpal::colors::DIN99d gray99(gray);
+        const double e = std::sqrt(std::pow(gray99.l() - black99.l(), 2) +
+                                   std::pow(gray99.a() - black99.a(), 2) +
+                                   std::pow(gray99.b() - black99.b(), 2));
+        samples.emplace_back(e, dist(black, gray));
+      }
+      std::sort(samples.begin(), samples.end());
+      for (const auto& [e, d] : samples) {
+        steps_.push_back(e);
+        values_.push_back(d);
+      }
+      break;
+    }
+
+    case Metric::CIE94:
+      coords_ = scaled_lab(lab, 1.0, 1.0 + 0.045 * max_chroma(lab));
+      break;
+
+    case Metric::CMC: {
+      // S_L and S_C increase with L and C, and S_H <= S_C
+      const CMCMetric cmc;
+      double s_l = 0.0;
+      double s_c = 0.0;
+      for (std::size_t i = 0; i < n; ++i) {
+        const auto p = cmc.point(&lab[3 * i]);
+        s_l = std::max(s_l, std::sqrt(p.s2[0]));
+        s_c = std::max(s_c, std::sqrt(p.s2[1]));
+      }
+      coords_ = scaled_lab(lab, std::max(s_l, 1e-12), std::max(s_c, 1e-12));
+      break;
+    }
+
+    case Metric::CIEDE2000:
+    default: {
+      double l_dev = 0.0;
+      for (std::size_t i = 0; i < n; ++i) {
+        l_dev = std::max(l_dev, std::abs(lab[3 * i] - 50.0));
+      }
+      const double s_l =
+        1.0 + 0.015 * l_dev * l_dev / std::sqrt(20.0 + l_dev * l_dev);
+      // C' <= 1.5 C, and 1 - |R_T| / 2 >= 1 - sin(60 deg)
+      const double s_c = 1.0 + 0.045 * 1.5 * max_chroma(lab);
+      const double k_ab = s_c / std::sqrt(1.0 - std::sqrt(3.0) / 2.0);
+      coords_ = scaled_lab(lab, s_l, k_ab);
+
+      lab_chroma_.resize(n);
+      for (std::size_t i = 0; i < n; ++i) {
+        lab_chroma_[i] = { lab[3 * i],
+                           lab[3 * i + 1],
+                           lab[3 * i + 2],
+                           std::hypot(lab[3 * i + 1], lab[3 * i + 2]) };
+      }
+      break;
+    }
+  }
+}
+
+double
+MetricEmbedding::lower_bound(double e) const
+{
+  if (steps_.empty()) {
+    return e;
+  }
+  const auto it = std::upper_bound(steps_.begin(), steps_.end(), e);
+  return it == steps_.begin() ? 0.0 : values_[it - steps_.begin() - 1];
+}
+
+double
+MetricEmbedding::pair_bound(std::size_t i, std::size_t j, double e) const
+{
+  if (lab_chroma_.empty()) {
+    return lower_bound(e);
+  }
+
+  // The CIEDE2000 bound of the constructor, with S_L at the mean lightness
+  // and S_C at the mean of the (at most 1.5 times larger) primed chromas
+  const auto& x = lab_chroma_[i];
+  const auto& y = lab_chroma_[j];
+  const double l_dev = 0.5 * (x[0] + y[0]) - 50.0;
+  const double s_l =
+    1.0 + 0.015 * l_dev * l_dev / std::sqrt(20.0 + l_dev * l_dev);
+  const double s_c = 1.0 + 0.045 * 1.5 * 0.5 * (x[3] + y[3]);
+  const double dl = (x[0] - y[0]) / s_l;
+  const double da = x[1] - y[1];
+  const double db = x[2] - y[2];
+  const double kappa = 1.0 - std::sqrt(3.0) / 2.0;
+  return std::sqrt(dl * dl + kappa * (da * da + db * db) / (s_c * s_c));
+}
+
+double
+MetricEmbedding::radius(double threshold) const
+{
+  if (steps_.empty()) {
+    return threshold;
+  }
+  const auto it = std::find_if(
+    values_.begin(), values_.end(), [&](double v) { return v >= threshold; });
+  return it == values_.end() ? inf : steps_[it - values_.begin()];
+}
+
+SpatialGrid::SpatialGrid(const std::vector<std::array<double, 3>>& coords,
+                         double cell_size)
+  : cell_size_(cell_size)
+{
+  std::vector<Cell> point_cells(coords.size());
+  for (std::size_t i = 0; i < coords.size(); ++i) {
+    point_cells[i] = cell(coords[i]);
+  }
+
+  order_.resize(coords.size());
+  std::iota(order_.begin(), order_.end(), std::size_t{ 0 });
+  std::stable_sort(
+    order_.begin(), order_.end(), [&](std::size_t a, std::size_t b) {
+      return point_cells[a] < point_cells[b];
+    });
+
+  for (std::size_t k = 0; k < order_.size(); ++k) {
+    const auto& c = point_cells[order_[k]];
+    if (cells_.empty() || cells_.back() != c) {
+      cells_.push_back(c);
+      starts_.push_back(k);
+    }
+  }
+  starts_.push_back(order_.size());
+
+  if (!cells_.empty()) {
+    lo_ = hi_ = cells_.front();
+    for (const auto& c : cells_) {
+      for (int d = 0; d < 3; ++d) {
+        lo_[d] = std::min(lo_[d], c[d]);
+        hi_[d] = std::max(hi_[d], c[d]);
+      }
+    }
+  }
+}
+
+std::int64_t
+SpatialGrid::max_reach(const std::array<double, 3>& p) const
+{
+  const auto c = cell(p);
+  std::int64_t reach = 0;
+  for (int d = 0; d < 3; ++d) {
+    reach = std::max({ reach, c[d] - lo_[d], hi_[d] - c[d] });
+  }
+  return reach;
+}
+
+SpatialGrid::Cell
+SpatialGrid::cell(const std::array<double, 3>& p) const
+{
+  // Clamping keeps the conversion defined for tiny cells or huge values;
+  // clamped points share a cell, which only costs extra exact checks
+  constexpr double limit = 1e15;
+  Cell c;
+  for (int k = 0; k < 3; ++k) {
+    const double q =
+      std::isfinite(cell_size_) ? std::floor(p[k] / cell_size_) : 0.0;
+    c[k] = static_cast<std::int64_t>(std::clamp(q, -limit, limit));
+  }
+  return c;
+}
+
+std::pair<std::size_t, std::size_t>
+SpatialGrid::find(const Cell& c) const
+{
+  const auto it = std::lower_bound(cells_.begin(), cells_.end(), c);
+  if (it == cells_.end() || *it != c) {
+    return { 0, 0 };
+  }
+  const auto k = static_cast<std::size_t>(it - cells_.begin());
+  return { starts_[k], starts_[k + 1] };
+}
+
+void
+lab_pairs_within(const std::vector<double>& lab,
+                 Metric metric,
+                 double threshold,
+                 std::vector<std::int64_t>& first,
+                 std::vector<std::int64_t>& second,
+                 std::vector<double>& distances)
+{
+  first.clear();
+  second.clear();
+  distances.clear();
+  if (!(threshold > 0.0)) {
+    return;
+  }
+
+  const MetricEmbedding embedding(lab, metric);
+  const auto& coords = embedding.coords();
+  const double radius = embedding.radius(threshold) * (1.0 + slack);
+  const double radius2 = radius * radius;
+  const SpatialGrid grid(coords, radius);
+  const auto n = static_cast<std::ptrdiff_t>(coords.size());
+
+  std::vector<std::tuple<std::int64_t, std::int64_t, double>> pairs;
+
+  visit_metric(metric, [&](auto dist) {
+    const auto points = to_points(dist, lab);
+
+#pragma omp parallel
+    {
+      std::vector<std::tuple<std::int64_t, std::int64_t, double>> local;
+
+#pragma omp for schedule(dynamic, 256)
+      for (std::ptrdiff_t i = 0; i < n; ++i) {
+        const auto& p = coords[i];
+        grid.for_each_near(p, 1, [&](std::size_t j) {
+          if (static_cast<std::ptrdiff_t>(j) <= i) {
+            return;
+          }
+          const double d0 = p[0] - coords[j][0];
+          const double d1 = p[1] - coords[j][1];
+          const double d2 = p[2] - coords[j][2];
+          const double e2 = d0 * d0 + d1 * d1 + d2 * d2;
+          if (e2 >= radius2 ||
+              embedding.pair_bound(i, j, std::sqrt(e2)) * (1.0 - slack) >=
+                threshold) {
+            return;
+          }
+          const double d = dist(points[i], points[j]);
+          if (d < threshold) {
+            local.emplace_back(i, static_cast<std::int64_t>(j), d);
+          }
+        });
+      }
+
+#pragma omp critical
+      pairs.insert(pairs.end(), local.begin(), local.end());
+    }
+  });
+
+  std::sort(pairs.begin(), pairs.end());
+  first.reserve(pairs.size());
+  second.reserve(pairs.size());
+  distances.reserve(pairs.size());
+  for (const auto& [i, j, d] : pairs) {
+    first.push_back(i);
+    second.push_back(j);
+    distances.push_back(d);
+  }
+}
+
+void
+lab_knn_graph(const std::vector<double>& lab,
+              Metric metric,
+              std::size_t k,
+              std::vector<std::int64_t>& indptr,
+              std::vector<std::int64_t>& indices,
+              std::vector<double>& distances)
+{
+  const std::size_t n = lab.size() / 3;
+  k = n > 0 ? std::min(k, n - 1) : 0;
+  indptr.resize(n + 1);
+  for (std::size_t i = 0; i <= n; ++i) {
+    indptr[i] = static_cast<std::int64_t>(i * k);
+  }
+  indices.assign(n * k, 0);
+  distances.assign(n * k, 0.0);
+  if (k == 0) {
+    return;
+  }
+
+  const MetricEmbedding embedding(lab, metric);
+  const auto& coords = embedding.coords();
+
+  // Size cells for about k points each over the bounding box, then refine
+  // for data concentrated on lower-dimensional sets (such as grays)
+  std::array<double, 3> lo = coords[0];
+  std::array<double, 3> hi = coords[0];
+  for (const auto& p : coords) {
+    for (int d = 0; d < 3; ++d) {
+      lo[d] = std::min(lo[d], p[d]);
+      hi[d] = std::max(hi[d], p[d]);
+    }
+  }
+  const double per_axis = std::cbrt(static_cast<double>(n) / k);
+  const double extent =
+    std::max({ hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2] });
+  double volume = 1.0;
+  for (int d = 0; d < 3; ++d) {
+    volume *= std::max(hi[d] - lo[d], extent / per_axis);
+  }
+  double cell_size = extent > 0.0 ? std::cbrt(volume * k / n) : 1.0;
+  SpatialGrid grid(coords, cell_size);
+  for (int refine = 0; refine < 16 && 4 * k * grid.size() < n; ++refine) {
+    cell_size /= 2.0;
+    grid = SpatialGrid(coords, cell_size);
+  }
+
+  visit_metric(metric, [&](auto dist) {
+    const auto points = to_points(dist, lab);
+
+#pragma omp parallel
+    {
+      // Max-heap of the k best (distance, index) pairs found so far
+      std::vector<std::pair<double, std::size_t>> best;
+      best.reserve(k + 1);
+
+#pragma omp for schedule(dynamic, 256)
+      for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(n); ++i) {
+        const auto& p = coords[i];
+        const auto last_reach = grid.max_reach(p);
+        best.clear();
+
+        for (std::int64_t reach = 0; reach <= last_reach; ++reach) {
+          if (best.size() == k) {
+            // Points outside the cells scanned so far are at least
+            // reach - 1 cells away from p in embedded space
+            const double e = (reach - 1) * grid.cell_size();
+            if (best.front().first < embedding.lower_bound(e) * (1.0 - slack)) {
+              break;
+            }
+          }
+
+          const auto visit = [&](std::size_t j) {
+            if (static_cast<std::ptrdiff_t>(j) == i) {
+              return;
+            }
+            if (best.size() == k) {
+              const double d0 = p[0] - coords[j][0];
+              const double d1 = p[1] - coords[j][1];
+              const double d2 = p[2] - coords[j][2];
+              const double e = std::sqrt(d0 * d0 + d1 * d1 + d2 * d2);
+              const double bound = embedding.pair_bound(i, j, e);
+              if (bound * (1.0 - slack) > best.front().first) {
+                return;
+              }
+            }
+            const std::pair<double, std::size_t> candidate(
+              dist(points[i], points[j]), j);
+            if (best.size() < k) {
+              best.push_back(candidate);
+              std::push_heap(best.begin(), best.end());
+            } else if (candidate < best.front()) {
+              std::pop_heap(best.begin(), best.end());
+              best.back() = candidate;
+              std::push_heap(best.begin(), best.end());
+            }
+          };
+          grid.for_each_in_shell(p, static_cast<int>(reach), visit);
+        }
+
+        std::sort_heap(best.begin(), best.end());
+        for (std::size_t r = 0; r < k; ++r) {
+          indices[i * k + r] = static_cast<std::int64_t>(best[r].second);
+          distances[i * k + r] = best[r].first;
+        }
+      }
+    }
+  });
+}
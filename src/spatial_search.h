@@ -0,0 +1,215 @@
+/**
+ * @file spatial_search.h
+ * @brief Spatial indexing of colors for pruned distance queries
+ *
+ * Colors are embedded in a three-dimensional space in which Euclidean
+ * distance gives a valid lower bound on the target metric. A uniform grid
+ * over that space then rules out most pairs without evaluating the metric.
+ */
+
+#pragma once
+
+#include "color_distance.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Embedding of colors whose Euclidean distances bound a metric
+ *
+ * For every pair of colors, metric distance >= lower_bound(e), where e is
+ * the Euclidean distance between their embedded coordinates and
+ * lower_bound is non-decreasing.
+ *
+ * - CIE76, OKLab and CAM16-UCS are Euclidean in their own coordinates.
+ * - DIN99d is a non-decreasing function of Euclidean distance in DIN99d
+ *   coordinates, tabulated along the neutral axis.
+ * - CIEDE2000, CIE94 and CMC use Lab with L and (a, b) divided by the
+ *   largest weights the metric can apply to the colors at hand. For
+ *   CIEDE2000 these are S_L at the extreme lightness, and
+ *   S_C / sqrt(1 - |R_T| / 2) with |R_T| <= 2 sin(60 deg), since
+ *   dC'^2 + dH'^2 >= da^2 + db^2 and S_H <= S_C.
+ */
+class MetricEmbedding
+{
+public:
+  /**
+   * @brief Embed colors for @p metric
+   * @param lab Lab coordinates, three consecutive values per color
+   * @param metric Distance metric
+   */
+  MetricEmbedding(const std::vector<double>& lab, Metric metric);
+
+  /// Embedded coordinates of each color
+  const std::vector<std::array<double, 3>>& coords() const { return coords_; }
+
+  /// Lower bound on the metric distance of a pair at embedded distance @p e
+  double lower_bound(double e) const;
+
+  /**
+   * @brief Lower bound on the metric distance between colors @p i and @p j
+   * @param e Embedded distance between the two colors
+   *
+   * At least lower_bound(e). For CIEDE2000, the weights of the pair itself
+   * replace the global maxima, which rules out far more pairs at a fraction
+   * of the cost of the exact distance.
+   */
+  double pair_bound(std::size_t i, std::size_t j, double e) const;
+
+  /**
+   * @brief Search radius for a threshold
+   * @return Embedded distance that every pair with metric distance below
+   * @p threshold is closer than (infinity if there is no such bound)
+   */
+  double radius(double threshold) const;
+
+private:
+  std::vector<std::array<double, 3>> coords_;
+  /// Tabulated lower bound: lower_bound(e) = values_[k] for
+  /// steps_[k] <= e < steps_[k + 1]; empty for the identity
+  std::vector<double> steps_;
+  std::vector<double> values_;
+  /// Lab coordinates and chroma of each color, for pair_bound(); empty if
+  /// the metric has no tighter pairwise bound
+  std::vector<std::array<double, 4>> lab_chroma_;
+};
+
+/**
+ * @brief Uniform grid over embedded coordinates
+ */
+class SpatialGrid
+{
+public:
+  /**
+   * @brief Bucket points into cubic cells
+   * @param coords Points to index
+   * @param cell_size Edge length of a cell
+   */
+  SpatialGrid(const std::vector<std::array<double, 3>>& coords,
+              double cell_size);
+
+  /**
+   * @brief Call @p f with the index of every point in the cells within
+   * @p reach cells of the cell containing @p p, along each axis
+   */
+  template<typename F>
+  void for_each_near(const std::array<double, 3>& p, int reach, F&& f) const
+  {
+    const auto c = cell(p);
+    for (std::int64_t dx = -reach; dx <= reach; ++dx) {
+      for (std::int64_t dy = -reach; dy <= reach; ++dy) {
+        for (std::int64_t dz = -reach; dz <= reach; ++dz) {
+          const auto [first, last] = find({ c[0] + dx, c[1] + dy, c[2] + dz });
+          for (std::size_t k = first; k < last; ++k) {
+            f(order_[k]);
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Call @p f with the index of every point in the cells exactly
+   * @p reach cells away from the cell containing @p p, along some axis
+   *
+   * Visiting the shells of reach 0, 1, 2, ... enumerates every point once,
+   * nearest cells first.
+   */
+  template<typename F>
+  void for_each_in_shell(const std::array<double, 3>& p, int reach, F&& f) const
+  {
+    const auto c = cell(p);
+    const auto visit = [&](std::int64_t dx, std::int64_t dy, std::int64_t dz) {
+      const auto [first, last] = find({ c[0] + dx, c[1] + dy, c[2] + dz });
+      for (std::size_t k = first; k < last; ++k) {
+        f(order_[k]);
+      }
+    };
+    for (std::int64_t dx = -reach; dx <= reach; ++dx) {
+      for (std::int64_t dy = -reach; dy <= reach; ++dy) {
+        if (dx == -reach || dx == reach || dy == -reach || dy == reach) {
+          for (std::int64_t dz = -reach; dz <= reach; ++dz) {
+            visit(dx, dy, dz);
+          }
+        } else {
+          visit(dx, dy, -reach);
+          visit(dx, dy, reach);
+        }
+      }
+    }
+  }
+
+  /// Smallest reach whose neighborhood of @p p covers every occupied cell
+  std::int64_t max_reach(const std::array<double, 3>& p) const;
+
+  /// Number of occupied cells
+  std::size_t size() const { return cells_.size(); }
+
+  double cell_size() const { return cell_size_; }
+
+private:
+  using Cell = std::array<std::int64_t, 3>;
+
+  Cell cell(const std::array<double, 3>& p) const;
+
+  /// Range of order_ holding the points in cell @p c
+  std::pair<std::size_t, std::size_t> find(const Cell& c) const;
+
+  double cell_size_;
+  /// Distinct occupied cells, sorted
+  std::vector<Cell> cells_;
+  /// Start of each cell's points in order_, plus a final end marker
+  std::vector<std::size_t> starts_;
+  /// Point indices grouped by cell
+  std::vector<std::size_t> order_;
+  /// Bounding box of the occupied cells
+  Cell lo_{};
+  Cell hi_{};
+};
+
+/**
+ * @brief Find all pairs of colors closer than a threshold
+ * @param lab Lab coordinates, three consecutive values per color
+ * @param metric Distance metric
+ * @param threshold Pairs with distance strictly below this are returned
+ * @param first Output: index of the first color of each pair
+ * @param second Output: index of the second color, greater than the first
+ * @param distances Output: distance of each pair
+ *
+ * Pairs are sorted by first and then second index. Only pairs that share or
+ * neighbor a grid cell, and pass the embedded lower bound, are evaluated
+ * exactly.
+ */
+void
+lab_pairs_within(const std::vector<double>& lab,
+                 Metric metric,
+                 double threshold,
+                 std::vector<std::int64_t>& first,
+                 std::vector<std::int64_t>& second,
+                 std::vector<double>& distances);
+
+/**
+ * @brief Build the k-nearest-neighbor graph of a set of colors
+ * @param lab Lab coordinates, three consecutive values per color
+ * @param metric Distance metric
+ * @param k Number of neighbors per color; capped at the number of other
+ * colors
+ * @param indptr Output: row i spans indptr[i] to indptr[i + 1]
+ * @param indices Output: neighbor indices, nearest first
+ * @param distances Output: distance to each neighbor
+ *
+ * The graph is stored in compressed sparse row form. Neighbors are ordered
+ * by distance, ties by index. Each color scans grid cells in shells of
+ * increasing reach and stops once the embedded lower bound for the next
+ * shell exceeds its k-th smallest exact distance, so the result is exact.
+ */
+void
+lab_knn_graph(const std::vector<double>& lab,
+              Metric metric,
+              std::size_t k,
+              std::vector<std::int64_t>& indptr,
+              std::vector<std::int64_t>& indices,
+              std::vector<double>& distances);
@@ -0,0 +1,303 @@
+/**
+ * @file test_batch_jobs.cpp
+ * @brief Tests of the JSON parser and the palette jobs of the command-line
+ * tool and the server
+ *
+ * Runs without a test framework: every failed check is reported on
+ * standard error and the exit status is the number of failures.
+ */
+
+#include "batch_jobs.h"
+#include "json.h"
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": " #condition "\n";        \
+      ++failures;                                                              \
+    }                                                                          \
+  } while (false)
+
+/// Whether parsing @p text fails with a message that contains @p message
+bool
+rejects(const std::string& text, const std::string& message = "")
+{
+  try {
+    Json::parse(text);
+  } catch (const std::invalid_argument& e) {
+    return std::string(e.what()).find(message) != std::string::npos;
+  }
+  return false;
+}
+
+/// Output of a job line, which must fail with a message containing @p error
+bool
+fails(const std::string& line, const std::string& error)
+{
+  bool ok = true;
+  const Json out = Json::parse(run_job_line(line, false, ok));
+  const Json* message = out.find("error");
+  return !ok && message != nullptr &&
+         message->as_string().find(error) != std::string::npos;
+}
+
+/// Result of a job line, which must succeed
+Json
+result(const std::string& line)
+{
+  bool ok = false;
+  const Json out = Json::parse(run_job_line(line, false, ok));
+  const Json* value = out.find("result");
+  if (!ok || value == nullptr) {
+    throw std::invalid_argument("job failed: " + line);
+  }
+  return *value;
+}
+
+void
+test_parse_values()
+{
+  const Json value = Json::parse(
+    R"( {"a": [1, -2.5e2, 0], "b": {"c": null}, "d": true, "e": false} )");
+  CHECK(value.is_object());
+  CHECK(value.as_object().size() == 4);
+  CHECK(value.as_object()[0].first == "a");
+  CHECK(value.find("a")->as_array()[1].as_number() == -250.0);
+  CHECK(value.find("b")->find("c")->is_null());
+  CHECK(value.find("d")->as_bool());
+  CHECK(!value.find("e")->as_bool());
+  CHECK(value.find("f") == nullptr);
+  CHECK(Json::parse("[]").as_array().empty());
+  CHECK(Json::parse("{}").as_object().empty());
+}
+
+void
+test_parse_escapes()
+{
+  CHECK(Json::parse(R"("a\"b\\c\/d\b\f\n\r\t")").as_string() ==
+        "a\"b\\c/d\b\f\n\r\t");
+  CHECK(Json::parse(R"("\u0041\u00e9\u20ac")").as_string() ==
+        "A\xc3\xa9\xe2\x82\xac");
+  CHECK(rejects(R"("\x")", "invalid escape"));
+  CHECK(rejects(R"("\u12")", "unicode escape"));
+  CHECK(rejects(R"("\u12g4")", "invalid unicode escape"));
+  CHECK(rejects("\"a\x01\"", "control character"));
+}
+
+void
+test_parse_surrogates()
+{
+  CHECK(Json::parse(R"("\ud83d\ude00")").as_string() ==
+        "\xf0\x9f\x98\x80");
+  CHECK(rejects(R"("\ud83d")", "unpaired surrogate"));
+  CHECK(rejects(R"("\ud83dx")", "unpaired surrogate"));
+  CHECK(rejects(R"("\ud83d\u0041")", "unpaired surrogate"));
+  CHECK(rejects(R"("\ude00")", "unpaired surrogate"));
+}
+
+void
+test_parse_depth()
+{
+  const auto nested = [](int depth) {
+    return std::string(depth, '[') + std::string(depth, ']');
+  };
+  CHECK(Json::parse(nested(256)).is_array());
+  CHECK(rejects(nested(257), "nesting too deep"));
+  CHECK(rejects(std::string(100000, '['), "nesting too deep"));
+}
+
+void
+test_parse_malformed()
+{
+  for (const char* text : { "",
+                            "   ",
+                            "{",
+                            "[1,]",
+                            "[1 2]",
+                            "{\"a\" 1}",
+                            "{\"a\":1,}",
+                            "{1:2}",
+                            "\"abc",
+                            "tru",
+                            "nul",
+                            "-",
+                            "1.",
+                            "1e",
+                            ".5",
+                            "+1",
+                            "01",
+                            "[1] x" }) {
+    if (!rejects(text, "Invalid JSON")) {
+      std::cerr << "accepted malformed JSON: " << text << '\n';
+      ++failures;
+    }
+  }
+}
+
+void
+test_dump()
+{
+  const std::string text =
+    R"({"b":[1,0.1,-2.5,true,null],"a":"x\"\\\n\u0001"})";
+  CHECK(Json::parse(text).dump() == text);
+  CHECK(Json(1.0 / 3.0).dump() == "0.33333333333333331");
+  const double inf = std::numeric_limits<double>::infinity();
+  CHECK(Json(Json::Array{ inf, -inf, std::nan("") }).dump() ==
+        "[null,null,null]");
+}
+
+void
+test_jobs()
+{
+  const Json palette =
+    result(R"({"type":"generate","n":2,"colors":["#ff0000","#00ff00",)"
+           R"("#0000ff"],"cvd":{"deutan":0.5}})");
+  CHECK(palette.find("palette")->as_array().size() == 2);
+
+  const Json matrix = result(
+    R"({"type":"distance","colors":["#ff0000","#00ff00"],"metric":"cie76"})");
+  CHECK(matrix.find("matrix")->as_array().size() == 2);
+  CHECK(matrix.find("matrix")->as_array()[0].as_array()[0].as_number() ==
+        0.0);
+
+  const Json scores = result(
+    R"({"type":"analyze","colors":["#ff0000","#00ff00","#0000ff"],)"
+    R"("cvd":{"protan":1.0}})");
+  CHECK(scores.find("nearest")->as_array().size() == 3);
+  CHECK(scores.find("cvd_min_distance") != nullptr);
+
+  CHECK(fails(R"({"type":"shuffle"})", "Unknown job type"));
+  CHECK(fails(R"({"n":2})", "Missing 'type'"));
+  CHECK(fails(R"({"type":"generate","n":-1})", "non-negative integer"));
+  CHECK(fails("[1,2]", "JSON object"));
+  CHECK(fails("{\"type\":", "Invalid JSON"));
+}
+
+void
+test_job_ids()
+{
+  bool ok = false;
+  const Json out = Json::parse(
+    run_job_line(R"({"id":[7],"type":"get_palette","name":"x"})", false, ok));
+  CHECK(!ok);
+  CHECK(out.find("id")->as_array()[0].as_number() == 7.0);
+
+  const Json malformed = Json::parse(run_job_line("{", true, ok));
+  CHECK(malformed.find("id")->is_null());
+  CHECK(malformed.find("time_ms") != nullptr);
+}
+
+void
+test_invalid_cvd()
+{
+  // Simulation runs in parallel regions, so bad conditions must be reported
+  // as job errors rather than terminate the process
+  const std::string colors = R"("colors":["#ff0000","#00ff00","#0000ff"])";
+  for (const std::string type :
+       { "generate", "generate_grouped", "analyze", "distance" }) {
+    const std::string job = R"({"type":")" + type +
+                            R"(","n":2,"n_groups":1,"group_size":2,)" + colors;
+    CHECK(fails(job + R"(,"cvd":{"green":1}})", "Unknown CVD type"));
+    CHECK(fails(job + R"(,"cvd":{"deutan":2}})", "Severity"));
+    CHECK(fails(job + R"(,"cvd":{"deutan":-0.5}})", "Severity"));
+  }
+}
+
+void
+test_ranges()
+{
+  const std::string job = R"({"type":"generate","n":2,"colorspace_size":50,)"
+                          R"("c_range":[0,1],"l_range":[0.3,0.8],)";
+  CHECK(result(job + R"("h_range":[0,360]})").find("palette") != nullptr);
+  for (const char* range : { "[0]", "[0,180,360]", "[0,1e999]", "[]" }) {
+    if (!fails(job + R"("h_range":)" + range + "}", "two finite numbers")) {
+      std::cerr << "accepted h_range " << range << '\n';
+      ++failures;
+    }
+  }
+  for (const std::string type : { "generate", "generate_grouped" }) {
+    CHECK(fails(R"({"type":")" + type +
+                  R"(","n":2,"n_groups":1,"group_size":2,)"
+                  R"("h_range":[0,360],"c_range":[0],"l_range":[0,1]})",
+                "'c_range' must be an array of two finite numbers"));
+  }
+}
+
+void
+test_backgrounds()
+{
+  const std::string job = R"({"type":"generate","n":2,"colorspace_size":50,)"
+                          R"("background":"#FFFFFF",)";
+  const Json same = result(job + R"("backgrounds":{"#ffffff":3}})");
+  const Json lower =
+    result(R"({"type":"generate","n":2,"colorspace_size":50,)"
+           R"("backgrounds":{"#ffffff":3}})");
+  CHECK(same.dump() == lower.dump());
+  CHECK(fails(job + R"("backgrounds":{"#FFFFFF":1,"#ffffff":2}})",
+              "different weights"));
+}
+
+void
+test_result_cache()
+{
+  ResultCache cache(4);
+  bool ok = false;
+  const Json job = Json::parse(
+    R"({"id":1,"type":"distance","colors":["#ff0000","#00ff00"]})");
+  const Json first = run_job_output(job, false, ok, &cache);
+  CHECK(ok);
+
+  const Json again = Json::parse(
+    R"({"id":2,"type":"distance","colors":["#ff0000","#00ff00"]})");
+  const Json second = run_job_output(again, false, ok, &cache);
+  CHECK(ok);
+  CHECK(second.find("id")->as_number() == 2.0);
+  CHECK(second.find("result")->dump() == first.find("result")->dump());
+}
+
+/// Run a test, counting an exception that escapes it as a failure
+void
+run(void (*test)(), const char* name)
+{
+  try {
+    test();
+  } catch (const std::exception& e) {
+    std::cerr << name << ": " << e.what() << '\n';
+    ++failures;
+  }
+}
+
+} // namespace
+
+int
+main()
+{
+  run(test_parse_values, "test_parse_values");
+  run(test_parse_escapes, "test_parse_escapes");
+  run(test_parse_surrogates, "test_parse_surrogates");
+  run(test_parse_depth, "test_parse_depth");
+  run(test_parse_malformed, "test_parse_malformed");
+  run(test_dump, "test_dump");
+  run(test_jobs, "test_jobs");
+  run(test_job_ids, "test_job_ids");
+  run(test_invalid_cvd, "test_invalid_cvd");
+  run(test_ranges, "test_ranges");
+  run(test_backgrounds, "test_backgrounds");
+  run(test_result_cache, "test_result_cache");
+
+  if (failures > 0) {
+    std::cerr << failures << " check(s) failed\n";
+  }
+  return failures;
+}
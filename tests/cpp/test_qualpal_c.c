@@ -0,0 +1,204 @@
+/**
+ * @file test_qualpal_c.c
+ * @brief Tests of the C interface, compiled as C
+ *
+ * Covers the success and error codes of every qp_* function. Every failed
+ * check is reported on standard error and the exit status is the number
+ * of failures.
+ */
+
+#include "qualpal_c.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition);          \
+      ++failures;                                                              \
+    }                                                                          \
+  } while (0)
+
+/// Whether the last call failed with @p status and set a message
+#define CHECK_FAILS(call, status)                                              \
+  do {                                                                         \
+    CHECK((call) == (status));                                                 \
+    CHECK(qp_last_error()[0] != '\0');                                         \
+  } while (0)
+
+static const double candidates[] = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0,
+                                     0.0, 0.0, 1.0, 1.0, 1.0, 0.0 };
+
+static void
+test_convert(void)
+{
+  const double white[3] = { 1.0, 1.0, 1.0 };
+  const double rgb[3] = { 0.2, 0.4, 0.6 };
+  double out[3];
+  double hsl[3];
+
+  CHECK(qp_convert(QP_SPACE_RGB, QP_SPACE_LAB, white, 1, out) == QP_OK);
+  CHECK(fabs(out[0] - 100.0) < 1e-6);
+  CHECK(qp_last_error()[0] == '\0');
+
+  CHECK(qp_convert(QP_SPACE_RGB, QP_SPACE_HSL, rgb, 1, hsl) == QP_OK);
+  CHECK(qp_convert(QP_SPACE_HSL, QP_SPACE_RGB, hsl, 1, hsl) == QP_OK);
+  for (int k = 0; k < 3; ++k) {
+    CHECK(fabs(hsl[k] - rgb[k]) < 1e-9);
+  }
+  CHECK(qp_convert(QP_SPACE_RGB, QP_SPACE_CAM16UCS, rgb, 1, out) == QP_OK);
+  CHECK(qp_convert(QP_SPACE_RGB, QP_SPACE_LAB, NULL, 0, NULL) == QP_OK);
+
+  CHECK_FAILS(qp_convert(QP_SPACE_XYZ, QP_SPACE_RGB, rgb, 1, out),
+              QP_ERROR_ARGUMENT);
+  CHECK_FAILS(qp_convert(QP_SPACE_CAM16UCS, QP_SPACE_RGB, rgb, 1, out),
+              QP_ERROR_ARGUMENT);
+  CHECK_FAILS(qp_convert((qp_space)99, QP_SPACE_RGB, rgb, 1, out),
+              QP_ERROR_ARGUMENT);
+  CHECK_FAILS(qp_convert(QP_SPACE_RGB, QP_SPACE_LAB, NULL, 1, out),
+              QP_ERROR_ARGUMENT);
+
+  // A successful call clears the message
+  CHECK(qp_convert(QP_SPACE_RGB, QP_SPACE_LAB, white, 1, out) == QP_OK);
+  CHECK(qp_last_error()[0] == '\0');
+}
+
+static void
+test_simulate_cvd(void)
+{
+  const double rgb[6] = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0 };
+  double out[6];
+
+  CHECK(qp_simulate_cvd(rgb, 2, QP_CVD_DEUTAN, 1.0, out) == QP_OK);
+  CHECK(fabs(out[0] - rgb[0]) > 0.1);
+  CHECK(qp_simulate_cvd(rgb, 2, QP_CVD_TRITAN, 0.0, out) == QP_OK);
+  for (int k = 0; k < 6; ++k) {
+    CHECK(fabs(out[k] - rgb[k]) < 1e-6);
+  }
+
+  CHECK_FAILS(qp_simulate_cvd(rgb, 2, (qp_cvd)3, 1.0, out),
+              QP_ERROR_ARGUMENT);
+  CHECK_FAILS(qp_simulate_cvd(rgb, 2, QP_CVD_PROTAN, 1.5, out),
+              QP_ERROR_ARGUMENT);
+  CHECK_FAILS(qp_simulate_cvd(rgb, 2, QP_CVD_PROTAN, -0.1, out),
+              QP_ERROR_ARGUMENT);
+  CHECK_FAILS(qp_simulate_cvd(rgb, 2, QP_CVD_PROTAN, NAN, out),
+              QP_ERROR_ARGUMENT);
+  CHECK_FAILS(qp_simulate_cvd(rgb, 2, QP_CVD_PROTAN, 1.0, NULL),
+              QP_ERROR_ARGUMENT);
+}
+
+static void
+test_distance_matrix(void)
+{
+  double lab[9];
+  double matrix[9];
+  double row[3];
+  CHECK(qp_convert(QP_SPACE_RGB, QP_SPACE_LAB, candidates, 3, lab) == QP_OK);
+
+  CHECK(qp_distance_matrix(lab, 3, QP_METRIC_CIEDE2000, matrix, 9) == QP_OK);
+  for (int i = 0; i < 3; ++i) {
+    CHECK(matrix[4 * i] == 0.0);
+    for (int j = 0; j < 3; ++j) {
+      CHECK(matrix[3 * i + j] == matrix[3 * j + i]);
+      CHECK(i == j || matrix[3 * i + j] > 0.0);
+    }
+  }
+
+  CHECK(qp_cross_distance_matrix(
+          lab, 1, lab, 3, QP_METRIC_CIEDE2000, row, 3) == QP_OK);
+  for (int j = 0; j < 3; ++j) {
+    CHECK(fabs(row[j] - matrix[j]) < 1e-9);
+  }
+
+  // Too small buffers are left untouched
+  row[0] = -1.0;
+  CHECK_FAILS(qp_distance_matrix(lab, 3, QP_METRIC_CIE76, matrix, 8),
+              QP_ERROR_BUFFER);
+  CHECK_FAILS(
+    qp_cross_distance_matrix(lab, 1, lab, 3, QP_METRIC_CIE76, row, 2),
+    QP_ERROR_BUFFER);
+  CHECK(row[0] == -1.0);
+
+  CHECK_FAILS(qp_distance_matrix(lab, 3, (qp_metric)99, matrix, 9),
+              QP_ERROR_ARGUMENT);
+  CHECK_FAILS(
+    qp_cross_distance_matrix(lab, 1, lab, 3, (qp_metric)-1, row, 3),
+    QP_ERROR_ARGUMENT);
+  CHECK_FAILS(qp_distance_matrix(NULL, 3, QP_METRIC_CIE76, matrix, 9),
+              QP_ERROR_ARGUMENT);
+  CHECK_FAILS(
+    qp_cross_distance_matrix(lab, 1, NULL, 3, QP_METRIC_CIE76, row, 3),
+    QP_ERROR_ARGUMENT);
+}
+
+static void
+test_generate(void)
+{
+  qp_generate_options options;
+  double out[9];
+
+  qp_generate_options_init(&options);
+  CHECK(options.metric == QP_METRIC_CIEDE2000);
+  CHECK(options.h_range[1] == 360.0);
+  options.colorspace_size = 100;
+  options.cvd[QP_CVD_DEUTAN] = 0.5;
+  CHECK(qp_generate(&options, 3, out, 9) == QP_OK);
+  for (int k = 0; k < 9; ++k) {
+    CHECK(out[k] >= 0.0 && out[k] <= 1.0);
+  }
+
+  qp_generate_options_init(&options);
+  options.candidates = candidates;
+  options.n_candidates = 4;
+  CHECK(qp_generate(&options, 3, out, 9) == QP_OK);
+  for (int i = 0; i < 3; ++i) {
+    int found = 0;
+    for (int j = 0; j < 4; ++j) {
+      found = found || memcmp(&out[3 * i], &candidates[3 * j],
+                              3 * sizeof(double)) == 0;
+    }
+    CHECK(found);
+  }
+
+  CHECK_FAILS(qp_generate(&options, 3, out, 8), QP_ERROR_BUFFER);
+  CHECK_FAILS(qp_generate(NULL, 3, out, 9), QP_ERROR_ARGUMENT);
+  CHECK_FAILS(qp_generate(&options, 3, NULL, 9), QP_ERROR_ARGUMENT);
+
+  options.cvd[QP_CVD_PROTAN] = 1.5;
+  CHECK_FAILS(qp_generate(&options, 3, out, 9), QP_ERROR_ARGUMENT);
+  options.cvd[QP_CVD_PROTAN] = -0.5;
+  CHECK_FAILS(qp_generate(&options, 3, out, 9), QP_ERROR_ARGUMENT);
+  options.cvd[QP_CVD_PROTAN] = NAN;
+  CHECK_FAILS(qp_generate(&options, 3, out, 9), QP_ERROR_ARGUMENT);
+  options.cvd[QP_CVD_PROTAN] = 0.0;
+
+  options.metric = (qp_metric)99;
+  CHECK_FAILS(qp_generate(&options, 3, out, 9), QP_ERROR_ARGUMENT);
+
+  qp_generate_options_init(&options);
+  options.palette_name = "NoSuch:Palette";
+  CHECK_FAILS(qp_generate(&options, 3, out, 9), QP_ERROR_ARGUMENT);
+
+  qp_generate_options_init(&options);
+  options.region = (qp_region)7;
+  CHECK_FAILS(qp_generate(&options, 3, out, 9), QP_ERROR_ARGUMENT);
+}
+
+int
+main(void)
+{
+  test_convert();
+  test_simulate_cvd();
+  test_distance_matrix();
+  test_generate();
+
+  if (failures > 0) {
+    fprintf(stderr, "%d check(s) failed\n", failures);
+  }
+  return failures;
+}
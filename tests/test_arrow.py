@@ -0,0 +1,189 @@
+"""Tests for the Arrow C data interface."""
+
+from __future__ import annotations
+
+import ctypes
+import platform
+
+import pytest
+
+from qualpal import Palette, Qualpal
+from qualpal.arrow import colors_from_arrow, is_arrow_column, to_arrow
+from qualpal.contrast import relative_luminance
+
+COLORS = ["#ff0000", "#00ff00", "#0000ff", "#123456"]
+
+
+class _ArrowSchema(ctypes.Structure):
+    pass
+
+
+_ArrowSchema._fields_ = [
+    ("format", ctypes.c_char_p),
+    ("name", ctypes.c_char_p),
+    ("metadata", ctypes.c_char_p),
+    ("flags", ctypes.c_int64),
+    ("n_children", ctypes.c_int64),
+    ("children", ctypes.POINTER(ctypes.POINTER(_ArrowSchema))),
+    ("dictionary", ctypes.POINTER(_ArrowSchema)),
+    ("release", ctypes.c_void_p),
+    ("private_data", ctypes.c_void_p),
+]
+
+
+class _ArrowArray(ctypes.Structure):
+    pass
+
+
+_ArrowArray._fields_ = [
+    ("length", ctypes.c_int64),
+    ("null_count", ctypes.c_int64),
+    ("offset", ctypes.c_int64),
+    ("n_buffers", ctypes.c_int64),
+    ("n_children", ctypes.c_int64),
+    ("buffers", ctypes.POINTER(ctypes.c_void_p)),
+    ("children", ctypes.POINTER(ctypes.POINTER(_ArrowArray))),
+    ("dictionary", ctypes.POINTER(_ArrowArray)),
+    ("release", ctypes.c_void_p),
+    ("private_data", ctypes.c_void_p),
+]
+
+
+def _capsule_struct(capsule, name: bytes, struct):
+    """Read the Arrow C struct held by a PyCapsule."""
+    get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+    get_pointer.restype = ctypes.c_void_p
+    get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+    return ctypes.cast(get_pointer(capsule, name), ctypes.POINTER(struct)).contents
+
+
+class TestArrowExport:
+    """Test exporting palettes and results as Arrow columns."""
+
+    def test_palette_round_trip(self):
+        """Test that every export kind of a palette can be read back."""
+        pal = Palette(COLORS)
+
+        for kind, fmt in (("hex", "u"), ("rgb", "+w:3")):
+            column = pal.to_arrow(kind)
+
+            assert is_arrow_column(column)
+            assert len(column) == len(COLORS)
+            assert column.format == fmt
+            assert Palette.from_arrow(column).hex() == COLORS
+
+    def test_lab_export_format(self):
+        """Test that Lab coordinates export as fixed-size lists of doubles."""
+        column = Palette(COLORS).to_arrow("lab")
+
+        assert column.format == "+w:3"
+        assert len(column) == len(COLORS)
+        if platform.python_implementation() != "CPython":
+            pytest.skip("reading capsules needs ctypes.pythonapi")
+
+        schema_capsule, array_capsule = column.__arrow_c_array__()
+        schema = _capsule_struct(schema_capsule, b"arrow_schema", _ArrowSchema)
+        array = _capsule_struct(array_capsule, b"arrow_array", _ArrowArray)
+
+        assert schema.format == b"+w:3"
+        assert schema.n_children == 1
+        assert schema.children[0].contents.format == b"g"
+
+        assert array.length == len(COLORS)
+        assert array.null_count == 0
+        assert array.n_children == 1
+        values = array.children[0].contents
+        assert values.length == 3 * len(COLORS)
+        data = ctypes.cast(values.buffers[1], ctypes.POINTER(ctypes.c_double))
+        expected = [x for row in Palette(COLORS).array("lab").tolist() for x in row]
+        assert data[: values.length] == pytest.approx(expected)
+
+    def test_to_arrow_buffers(self):
+        """Test exporting result buffers of each supported type."""
+        pal = Palette(COLORS)
+        indptr, indices, distances = pal.knn_graph(2)
+
+        assert to_arrow(distances).format == "g"
+        assert to_arrow(indices).format == "l"
+        assert len(to_arrow(indptr)) == len(COLORS) + 1
+        assert to_arrow(pal.array("lab")).format == "+w:3"
+
+    def test_invalid_exports(self):
+        """Test that unsupported kinds and buffers raise errors."""
+        with pytest.raises(ValueError, match="Unknown kind"):
+            Palette(COLORS).to_arrow("hsl")
+        with pytest.raises(ValueError, match="element format"):
+            to_arrow(memoryview(b"abc").cast("b"))
+
+
+class TestArrowImport:
+    """Test reading Arrow color columns."""
+
+    def test_colors_from_arrow(self):
+        """Test decoding hex strings to RGB bytes."""
+        rgb = colors_from_arrow(Palette(["#ff0000", "#00ff80"]).to_arrow())
+
+        assert rgb.tolist() == [[255, 0, 0], [0, 255, 128]]
+
+    def test_contrast_accepts_arrow(self):
+        """Test that contrast functions accept Arrow columns."""
+        column = Palette(["#000000", "#ffffff"]).to_arrow("rgb")
+
+        assert relative_luminance(column).tolist() == [0.0, 1.0]
+
+    def test_qualpal_accepts_arrow(self):
+        """Test generating a palette from an Arrow color column."""
+        column = Palette(COLORS).to_arrow()
+
+        pal = Qualpal(colors=column).generate(2)
+
+        assert len(pal) == 2
+        assert all(c in COLORS for c in pal.hex())
+
+    def test_not_arrow_raises(self):
+        """Test that non-Arrow objects are rejected."""
+        with pytest.raises(TypeError, match="Arrow array or stream"):
+            Palette.from_arrow(["#ff0000"])
+
+    def test_pyarrow_interop(self):
+        """Test exchanging columns with pyarrow, when it is installed."""
+        pa = pytest.importorskip("pyarrow")
+
+        strings = pa.chunked_array([["#FF0000", "#00ff00"], ["#0000ff"]])
+        assert Palette.from_arrow(strings).hex() == COLORS[:3]
+
+        large = pa.array(["#ff0000", "#123456"], type=pa.large_utf8())
+        assert Palette.from_arrow(large).hex() == ["#ff0000", "#123456"]
+
+        dictionary = pa.array(["#ff0000", "#0000ff", "#ff0000"]).dictionary_encode()
+        assert Palette.from_arrow(dictionary).hex() == [
+            "#ff0000",
+            "#0000ff",
+            "#ff0000",
+        ]
+
+        with pytest.raises(ValueError, match="nulls"):
+            Palette.from_arrow(pa.array(["#ff0000", None]))
+
+        exported = pa.array(Palette(COLORS).to_arrow("rgb"))
+        assert exported.type == pa.list_(pa.uint8(), 3)
+        assert exported.to_pylist()[0] == [255, 0, 0]
+
+    def test_pyarrow_slices(self):
+        """Test reading sliced pyarrow columns and lists on sliced values."""
+        pa = pytest.importorskip("pyarrow")
+
+        strings = pa.array(COLORS).slice(1, 2)
+        assert Palette.from_arrow(strings).hex() == COLORS[1:3]
+
+        lists = pa.array(Palette(COLORS).to_arrow("rgb")).slice(1, 2)
+        assert Palette.from_arrow(lists).hex() == COLORS[1:3]
+
+        values = pa.array([0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255], pa.uint8())
+        built = pa.FixedSizeListArray.from_arrays(values.slice(3), 3)
+        assert Palette.from_arrow(built).hex() == COLORS[:3]
+        assert Palette.from_arrow(built.slice(1)).hex() == COLORS[1:3]
+
+        with_null = pa.array([255, None, 0, 0, 0, 255], pa.uint8())
+        with pytest.raises(ValueError, match="nulls"):
+            Palette.from_arrow(pa.FixedSizeListArray.from_arrays(with_null, 3))
@@ -0,0 +1,257 @@
+"""Tests for the qualpal-server client."""
+
+from __future__ import annotations
+
+import json
+import os
+import shutil
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+from pathlib import Path
+
+import pytest
+
+from qualpal.client import JobError, PaletteClient, default_socket_path
+
+pytestmark = pytest.mark.skipif(
+    not hasattr(socket, "AF_UNIX") or sys.platform in {"win32", "emscripten"},
+    reason="Unix domain sockets are not available",
+)
+
+
+def _serve(listener, handle):
+    """Answer framed requests on one connection, like qualpal-server."""
+    conn, _ = listener.accept()
+    with conn:
+        while True:
+            header = conn.recv(4, socket.MSG_WAITALL)
+            if len(header) < 4:
+                return
+            (size,) = struct.unpack(">I", header)
+            request = json.loads(conn.recv(size, socket.MSG_WAITALL))
+            payload = json.dumps(handle(request)).encode()
+            conn.sendall(struct.pack(">I", len(payload)) + payload)
+
+
+def _run_job(job):
+    if job.get("type") != "generate":
+        return {"id": job.get("id"), "error": "Unknown job type"}
+    return {"id": job.get("id"), "result": {"palette": ["#ff0000"] * job["n"]}}
+
+
+def _handle(request):
+    if isinstance(request, list):
+        return [_run_job(job) for job in request]
+    if request.get("type") == "stats":
+        return {"results": 0}
+    return _run_job(request)
+
+
+@pytest.fixture
+def socket_dir():
+    """Short-lived directory for sockets.
+
+    Socket paths are limited to about 100 bytes, which pytest's temporary
+    directories can exceed, so the directory is made directly in /tmp where
+    there is one.
+    """
+    short = "/tmp" if Path("/tmp").is_dir() else None
+    path = tempfile.mkdtemp(prefix="qp-", dir=short)
+    yield Path(path)
+    shutil.rmtree(path, ignore_errors=True)
+
+
+@pytest.fixture
+def server_path(socket_dir):
+    """Path of a fake server socket that answers one connection."""
+    path = str(socket_dir / "qualpal.sock")
+    listener = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    listener.bind(path)
+    listener.listen(1)
+    thread = threading.Thread(target=_serve, args=(listener, _handle))
+    thread.start()
+    yield path
+    thread.join(timeout=5)
+    listener.close()
+
+
+@pytest.fixture
+def start_server(socket_dir):
+    """Start qualpal-server processes on sockets in socket_dir.
+
+    The server is found through ``QUALPAL_SERVER`` or on the ``PATH``; the
+    tests that need it are skipped if it has not been built. Every server
+    must exit cleanly when it is terminated.
+    """
+    binary = os.environ.get("QUALPAL_SERVER") or shutil.which("qualpal-server")
+    if binary is None:
+        pytest.skip("qualpal-server is not built")
+    processes = []
+
+    def start(*args: str) -> str:
+        path = str(socket_dir / f"server-{len(processes)}.sock")
+        process = subprocess.Popen([binary, "--socket", path, *args])
+        processes.append(process)
+        deadline = time.monotonic() + 30
+        while process.poll() is None and time.monotonic() < deadline:
+            with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as probe:
+                if probe.connect_ex(path) == 0:
+                    return path
+            time.sleep(0.05)
+        msg = f"qualpal-server did not start on {path}"
+        raise RuntimeError(msg)
+
+    yield start
+    for process in processes:
+        process.terminate()
+        assert process.wait(timeout=30) == 0
+
+
+def _read_frame(conn):
+    header = conn.recv(4, socket.MSG_WAITALL)
+    if len(header) < 4:
+        return None
+    (size,) = struct.unpack(">I", header)
+    return json.loads(conn.recv(size, socket.MSG_WAITALL))
+
+
+def _client_with_slot(path):
+    """Connect to a server once it has a free slot for the connection.
+
+    Slots are freed when the server has seen a client leave, which can lag
+    behind the client closing its socket.
+    """
+    deadline = time.monotonic() + 30
+    while True:
+        client = PaletteClient(path, timeout=30)
+        try:
+            if "error" not in client.stats():
+                return client
+        except ConnectionError:
+            pass
+        client.close()
+        if time.monotonic() > deadline:
+            msg = "qualpal-server has no free connection slot"
+            raise RuntimeError(msg)
+        time.sleep(0.05)
+
+
+class TestPaletteClient:
+    """Test PaletteClient against a server speaking the frame protocol."""
+
+    def test_generate(self, server_path):
+        """Test that a job's result is unwrapped."""
+        with PaletteClient(server_path, timeout=5) as client:
+            assert client.generate(3) == ["#ff0000"] * 3
+
+    def test_run_many_keeps_order_and_errors(self, server_path):
+        """Test that batched jobs return one output per job, in order."""
+        jobs = [
+            {"type": "generate", "n": 1, "id": "a"},
+            {"type": "bogus", "id": "b"},
+            {"type": "generate", "n": 2, "id": "c"},
+        ]
+        with PaletteClient(server_path, timeout=5) as client:
+            outputs = client.run_many(jobs)
+
+        assert [out["id"] for out in outputs] == ["a", "b", "c"]
+        assert "error" in outputs[1]
+        assert outputs[2]["result"]["palette"] == ["#ff0000"] * 2
+
+    def test_failed_job_raises(self, server_path):
+        """Test that run() raises JobError with the server's message."""
+        client = PaletteClient(server_path, timeout=5)
+        with client, pytest.raises(JobError, match="Unknown job type"):
+            client.run({"type": "bogus"})
+
+    def test_stats(self, server_path):
+        """Test that stats requests are passed through."""
+        with PaletteClient(server_path, timeout=5) as client:
+            assert client.stats() == {"results": 0}
+
+    def test_missing_server(self, socket_dir):
+        """Test that connecting without a server fails."""
+        with pytest.raises(OSError):
+            PaletteClient(socket_dir / "missing.sock")
+
+    def test_default_socket_path(self, monkeypatch):
+        """Test that the runtime directory is preferred for the socket."""
+        monkeypatch.setenv("XDG_RUNTIME_DIR", "/run/user/1000")
+        assert default_socket_path() == "/run/user/1000/qualpal.sock"
+
+
+COLORS = ["#ff0000", "#00ff00", "#0000ff", "#ffff00"]
+
+
+class TestServer:
+    """Test the built qualpal-server."""
+
+    def test_jobs_and_stats(self, start_server):
+        """Test that results are returned and repeated jobs are cached."""
+        with PaletteClient(start_server(), timeout=30) as client:
+            first = client.generate(3, colors=COLORS)
+            assert len(first) == 3
+            assert client.generate(3, colors=COLORS) == first
+            stats = client.stats()
+
+        assert stats["results"] == 1
+        assert stats["result_hits"] == 1
+
+    def test_batch_keeps_order(self, start_server):
+        """Test that a batch is answered in order, with failed jobs in place."""
+        jobs = [
+            {"id": i, "type": "get_palette", "name": name}
+            for i, name in enumerate(["ColorBrewer:Set2", "bogus", "ColorBrewer:Set1"])
+        ]
+        with PaletteClient(start_server(), timeout=30) as client:
+            outputs = client.run_many(jobs)
+
+        assert [out["id"] for out in outputs] == [0, 1, 2]
+        assert "result" in outputs[0]
+        assert "error" in outputs[1]
+        assert "result" in outputs[2]
+
+    @pytest.mark.parametrize(
+        ("cvd", "match"),
+        [({"green": 1.0}, "Unknown CVD type"), ({"deutan": 2.0}, "Severity")],
+    )
+    def test_invalid_cvd(self, start_server, cvd, match):
+        """Test that bad conditions fail their job, not the server."""
+        jobs = [
+            {"type": "generate", "n": 2},
+            {"type": "generate_grouped", "n_groups": 1, "group_size": 2},
+            {"type": "analyze"},
+            {"type": "distance"},
+        ]
+        with PaletteClient(start_server(), timeout=30) as client:
+            for job in jobs:
+                with pytest.raises(JobError, match=match):
+                    client.run({**job, "colors": COLORS, "cvd": cvd})
+            assert len(client.generate(2, colors=COLORS)) == 2
+
+    def test_oversized_frame(self, start_server):
+        """Test that an oversized request gets an error before the close."""
+        with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as conn:
+            conn.settimeout(30)
+            conn.connect(start_server())
+            conn.sendall(struct.pack(">I", (64 << 20) + 1))
+            output = _read_frame(conn)
+            assert output["id"] is None
+            assert "exceeds" in output["error"]
+            assert _read_frame(conn) is None
+
+    def test_connection_limit(self, start_server):
+        """Test that connections beyond the limit are refused with an error."""
+        path = start_server("--max-connections", "1")
+        with _client_with_slot(path):
+            with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as conn:
+                conn.settimeout(30)
+                conn.connect(path)
+                assert _read_frame(conn)["error"] == "Too many connections"
+        with _client_with_slot(path) as client:
+            assert "results" in client.stats()
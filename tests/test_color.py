@@ -211,3 +211,21 @@ class TestColorSpaceConversions:
         assert c >= 0.0
         # H (hue) should be in [0, 360)
         assert 0.0 <= h < 360.0
+
+    def test_oklab_conversion(self):
+        """Test OKLab conversion against reference values."""
+        l, a, b = Color("#ffffff").oklab()
+        assert l == pytest.approx(1.0, abs=1e-6)
+        assert a == pytest.approx(0.0, abs=1e-6)
+        assert b == pytest.approx(0.0, abs=1e-6)
+
+        l, a, b = Color("#ff0000").oklab()
+        assert (l, a, b) == pytest.approx((0.62796, 0.22486, 0.12585), abs=1e-4)
+
+    def test_cam16ucs_conversion(self):
+        """Test CAM16-UCS conversion."""
+        j, _, _ = Color("#ffffff").cam16ucs()
+        assert j == pytest.approx(100.0, abs=1e-6)
+
+        j, a, b = Color("#000000").cam16ucs()
+        assert (j, a, b) == pytest.approx((0.0, 0.0, 0.0), abs=1e-6)
@@ -6,9 +6,11 @@ Tests the color distance functionality.
 
 from __future__ import annotations
 
+import math
+
 import pytest
 
-from qualpal import Color
+from qualpal import Color, Palette
 
 
 class TestColorDistanceBasic:
@@ -95,6 +97,63 @@ class TestColorDistanceMetrics:
         # CIE76 typically gives larger values
         assert 165 < result < 175
 
+    def test_oklab_metric(self):
+        """Test OKLab metric against Euclidean distance of OKLab coordinates."""
+        red = Color("#ff0000")
+        green = Color("#00ff00")
+
+        result = red.distance(green, metric="oklab")
+
+        expected = 100 * math.dist(red.oklab(), green.oklab())
+        assert result == pytest.approx(expected, rel=1e-4)
+
+    def test_cam16ucs_metric(self):
+        """Test CAM16-UCS metric against Euclidean distance of coordinates."""
+        red = Color("#ff0000")
+        green = Color("#00ff00")
+
+        result = red.distance(green, metric="cam16ucs")
+
+        expected = math.dist(red.cam16ucs(), green.cam16ucs())
+        assert result == pytest.approx(expected, rel=1e-4)
+
+    def test_cie94_metric(self):
+        """Test CIE94 metric with geometric mean chroma weights."""
+        c1 = Color("#336699")
+        c2 = Color("#3a6f90")
+        (l1, a1, b1), (l2, a2, b2) = c1.lab(), c2.lab()
+        ch1, ch2 = math.hypot(a1, b1), math.hypot(a2, b2)
+        dh2 = max((a1 - a2) ** 2 + (b1 - b2) ** 2 - (ch1 - ch2) ** 2, 0)
+        c = math.sqrt(ch1 * ch2)
+        expected = math.sqrt(
+            (l1 - l2) ** 2
+            + ((ch1 - ch2) / (1 + 0.045 * c)) ** 2
+            + dh2 / (1 + 0.015 * c) ** 2
+        )
+
+        assert c1.distance(c2, metric="cie94") == pytest.approx(expected)
+
+    @pytest.mark.parametrize("metric", ["oklab", "cam16ucs", "cie94", "cmc"])
+    def test_new_metrics_symmetric(self, metric):
+        """Test that the additional metrics are symmetric and zero on self."""
+        c1 = Color("#1b9e77")
+        c2 = Color("#d95f02")
+
+        assert c1.distance(c2, metric=metric) > 0
+        assert c1.distance(c2, metric=metric) == c2.distance(c1, metric=metric)
+        assert c1.distance(c1, metric=metric) == 0.0
+
+    @pytest.mark.parametrize("metric", ["oklab", "cam16ucs", "cie94", "cmc"])
+    def test_new_metrics_batch_kernels(self, metric):
+        """Test that the matrix kernels agree with pairwise distances."""
+        pal = Palette(["#1b9e77", "#d95f02", "#7570b3", "#e7298a"])
+
+        matrix = pal.distance_matrix(metric=metric)
+
+        for i, ci in enumerate(pal):
+            for j, cj in enumerate(pal):
+                assert matrix[i][j] == pytest.approx(ci.distance(cj, metric=metric))
+
     def test_default_metric_is_ciede2000(self):
         """Test that default metric is CIEDE2000."""
         color1 = Color("#ff0000")
@@ -0,0 +1,74 @@
+"""Tests for continuous colormap construction."""
+
+from __future__ import annotations
+
+import pytest
+
+from qualpal import Color
+from qualpal.colormap import build_colormap
+
+
+def _hex(lut: memoryview) -> list[str]:
+    return ["#{:02x}{:02x}{:02x}".format(*row) for row in lut.tolist()]
+
+
+def _steps(lut: memoryview, metric: str = "ciede2000") -> list[float]:
+    colors = [Color(h) for h in _hex(lut)]
+    return [a.distance(b, metric=metric) for a, b in zip(colors, colors[1:])]
+
+
+class TestBuildColormap:
+    """Test qualpal.colormap.build_colormap()."""
+
+    def test_shape_and_endpoints(self):
+        """Test the table layout and that it starts and ends at the controls."""
+        lut = build_colormap(["#000080", "#ffff00"])
+
+        assert lut.shape == (256, 3)
+        assert lut.format == "B"
+        assert _hex(lut)[0] == "#000080"
+        assert _hex(lut)[-1] == "#ffff00"
+
+    @pytest.mark.parametrize("space", ["lab", "oklab"])
+    def test_steps_are_uniform(self, space):
+        """Test that consecutive entries are equally far apart."""
+        steps = _steps(build_colormap(["#000080", "#ffff00"], n=16, space=space))
+
+        assert max(steps) < 1.15 * min(steps)
+
+    def test_uniform_under_chosen_metric(self):
+        """Test that uniformity follows the metric argument."""
+        lut = build_colormap(["#ffffcc", "#800026"], n=12, metric="cie76")
+        steps = _steps(lut, metric="cie76")
+
+        assert max(steps) < 1.15 * min(steps)
+
+    def test_lch_follows_hue_arc(self):
+        """Test that LCH interpolation keeps chroma between distant hues."""
+        colors = ["#0000ff", "#ffff00"]
+        lch_middle = Color(_hex(build_colormap(colors, n=9, space="lch"))[4])
+        lab_middle = Color(_hex(build_colormap(colors, n=9, space="lab"))[4])
+
+        # The straight Lab line between opposite hues passes close to gray
+        assert lch_middle.lch()[1] > 2 * lab_middle.lch()[1]
+
+    def test_out_of_gamut_paths_are_mapped(self):
+        """Test a path that leaves the gamut still gives valid colors."""
+        lut = build_colormap(["#00ff00", "#ff00ff"], n=4096, space="lch")
+
+        assert lut.shape == (4096, 3)
+        assert _hex(lut)[0] == "#00ff00"
+        assert _hex(lut)[-1] == "#ff00ff"
+
+    def test_invalid_arguments(self):
+        """Test that invalid arguments raise errors."""
+        with pytest.raises(ValueError, match="at least two colors"):
+            build_colormap(["#000000"])
+        with pytest.raises(ValueError, match="at least 2"):
+            build_colormap(["#000000", "#ffffff"], n=1)
+        with pytest.raises(TypeError, match="integer"):
+            build_colormap(["#000000", "#ffffff"], n=2.5)
+        with pytest.raises(ValueError, match="Unknown interpolation space"):
+            build_colormap(["#000000", "#ffffff"], space="hsl")
+        with pytest.raises(ValueError, match="Unknown metric"):
+            build_colormap(["#000000", "#ffffff"], metric="invalid")
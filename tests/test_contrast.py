@@ -0,0 +1,81 @@
+"""Tests for WCAG luminance and contrast kernels."""
+
+from __future__ import annotations
+
+import pytest
+
+from qualpal import Palette
+from qualpal.contrast import best_contrast, contrast_matrix, relative_luminance
+
+
+def _luminance(hex_color: str) -> float:
+    """Reference WCAG relative luminance."""
+
+    def linear(c: float) -> float:
+        return c / 12.92 if c <= 0.04045 else ((c + 0.055) / 1.055) ** 2.4
+
+    r, g, b = (int(hex_color[i : i + 2], 16) / 255 for i in (1, 3, 5))
+    return 0.2126 * linear(r) + 0.7152 * linear(g) + 0.0722 * linear(b)
+
+
+def _ratio(a: str, b: str) -> float:
+    la, lb = sorted([_luminance(a), _luminance(b)], reverse=True)
+    return (la + 0.05) / (lb + 0.05)
+
+
+COLORS = ["#000000", "#ffffff", "#ff0000", "#1b9e77", "#7570b3", "#e6ab02"]
+
+
+class TestRelativeLuminance:
+    def test_matches_reference(self):
+        """Luminance matches the WCAG definition."""
+        result = relative_luminance(COLORS).tolist()
+        assert result == pytest.approx([_luminance(c) for c in COLORS])
+
+    def test_accepts_palette_and_buffer(self):
+        """Palettes and packed RGB buffers give the same result."""
+        rgb = bytes.fromhex("".join(c[1:] for c in COLORS))
+        expected = relative_luminance(COLORS).tolist()
+        assert relative_luminance(Palette(COLORS)).tolist() == expected
+        assert relative_luminance(rgb).tolist() == expected
+
+    def test_invalid_buffer(self):
+        """Buffers with a length not divisible by 3 are rejected."""
+        with pytest.raises(ValueError, match="multiple of 3"):
+            relative_luminance(bytes(4))
+
+
+class TestContrastMatrix:
+    def test_matches_reference(self):
+        """Every element is the WCAG contrast ratio of the pair."""
+        backgrounds = ["#ffffff", "#202020"]
+        result = contrast_matrix(COLORS, backgrounds)
+        assert result.shape == (len(COLORS), len(backgrounds))
+        for i, fg in enumerate(COLORS):
+            for j, bg in enumerate(backgrounds):
+                assert result[i, j] == pytest.approx(_ratio(fg, bg))
+
+    def test_black_on_white(self):
+        """Black on white has the maximum ratio of 21."""
+        assert contrast_matrix(["#000000"], ["#ffffff"])[0, 0] == pytest.approx(21.0)
+
+
+class TestBestContrast:
+    def test_default_candidates(self):
+        """The default candidates are black and white."""
+        best, ratios = best_contrast(COLORS)
+        for color, index, ratio in zip(COLORS, best, ratios.tolist()):
+            candidates = ["#000000", "#ffffff"]
+            expected = max(_ratio(color, c) for c in candidates)
+            assert ratio == pytest.approx(expected)
+            assert _ratio(color, candidates[index]) == pytest.approx(expected)
+
+    def test_ties_prefer_first_candidate(self):
+        """Among equal candidates the first one wins."""
+        best, _ = best_contrast(["#808080"], ["#000000", "#000000"])
+        assert best == [0]
+
+    def test_no_candidates(self):
+        """An empty candidate set is rejected."""
+        with pytest.raises(ValueError, match="at least 1 candidate"):
+            best_contrast(COLORS, [])
@@ -0,0 +1,102 @@
+"""Tests for distance matrices written to disk."""
+
+from __future__ import annotations
+
+from array import array
+
+import pytest
+
+from qualpal import Palette
+from qualpal.distance_file import open_distance_matrix, read_distance_header
+
+COLORS = ["#ff0000", "#00ff00", "#0000ff", "#ffff00", "#808080", "#123456"]
+
+
+def _read_values(path, header):
+    """Read the matrix entries of a distance file without NumPy."""
+    values = array("f" if header["dtype"].endswith("f4") else "d")
+    values.frombytes(path.read_bytes()[header["offset"] :])
+    return values.tolist()
+
+
+class TestWriteDistanceMatrix:
+    """Test Palette.write_distance_matrix()."""
+
+    def test_full_layout_matches_distance_matrix(self, tmp_path):
+        """Test that the full layout stores the distance matrix."""
+        pal = Palette(COLORS)
+        path = tmp_path / "full.qpd"
+
+        pal.write_distance_matrix(path, metric="din99d")
+
+        header = read_distance_header(path)
+        assert header["n"] == len(COLORS)
+        assert header["layout"] == "full"
+        assert header["metric"] == "din99d"
+        assert header["shape"] == (len(COLORS), len(COLORS))
+        expected = [d for row in pal.distance_matrix("din99d") for d in row]
+        assert _read_values(path, header) == expected
+
+    def test_condensed_layout_float32(self, tmp_path):
+        """Test the condensed layout in single precision."""
+        pal = Palette(COLORS)
+        path = tmp_path / "condensed.qpd"
+
+        pal.write_distance_matrix(path, layout="condensed", dtype="float32")
+
+        header = read_distance_header(path)
+        assert header["dtype"].endswith("f4")
+        assert header["shape"] == (len(COLORS) * (len(COLORS) - 1) // 2,)
+        matrix = pal.distance_matrix()
+        expected = [
+            matrix[i][j]
+            for i in range(len(COLORS))
+            for j in range(i + 1, len(COLORS))
+        ]
+        assert _read_values(path, header) == pytest.approx(expected, rel=1e-6)
+
+    def test_small_tiles_give_same_result(self, tmp_path):
+        """Test that the tile size does not change the file contents."""
+        pal = Palette(COLORS)
+        small = tmp_path / "small.qpd"
+        large = tmp_path / "large.qpd"
+
+        pal.write_distance_matrix(small, layout="condensed", tile_bytes=1)
+        pal.write_distance_matrix(large, layout="condensed")
+
+        assert small.read_bytes() == large.read_bytes()
+
+    def test_open_as_memmap(self, tmp_path):
+        """Test reopening the file as a NumPy memmap."""
+        np = pytest.importorskip("numpy")
+        pal = Palette(COLORS)
+        path = tmp_path / "full.qpd"
+        pal.write_distance_matrix(path)
+
+        matrix = open_distance_matrix(path)
+
+        assert isinstance(matrix, np.memmap)
+        assert matrix.shape == (len(COLORS), len(COLORS))
+        np.testing.assert_array_equal(matrix, np.array(pal.distance_matrix()))
+
+    def test_invalid_arguments(self, tmp_path):
+        """Test that invalid arguments raise errors."""
+        pal = Palette(COLORS)
+        path = tmp_path / "bad.qpd"
+
+        with pytest.raises(ValueError, match="dtype"):
+            pal.write_distance_matrix(path, dtype="float16")
+        with pytest.raises(ValueError, match="Unknown layout"):
+            pal.write_distance_matrix(path, layout="triangle")
+        with pytest.raises(ValueError, match="tile_bytes"):
+            pal.write_distance_matrix(path, tile_bytes=0)
+        with pytest.raises(RuntimeError, match="Cannot open"):
+            pal.write_distance_matrix(tmp_path / "missing" / "dir.qpd")
+
+    def test_read_header_rejects_other_files(self, tmp_path):
+        """Test that files without the header are rejected."""
+        path = tmp_path / "other.bin"
+        path.write_bytes(b"\0" * 100)
+
+        with pytest.raises(ValueError, match="not a qualpal distance matrix"):
+            read_distance_header(path)
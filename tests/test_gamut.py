@@ -0,0 +1,97 @@
+"""Tests for sRGB gamut mapping."""
+
+from __future__ import annotations
+
+import math
+from array import array
+
+import pytest
+
+from qualpal import Color
+from qualpal.gamut import gamut_map
+
+
+def _values(rows: list[tuple[float, float, float]]) -> array:
+    return array("d", [x for row in rows for x in row])
+
+
+class TestGamutMap:
+    """Test qualpal.gamut.gamut_map()."""
+
+    def test_in_gamut_colors_unchanged(self):
+        """Test that displayable colors are returned as they are."""
+        rows = [Color(h).lch() for h in ["#3366cc", "#ffff00", "#000000"]]
+
+        mapped = gamut_map(_values(rows))
+
+        assert mapped.shape == (3, 3)
+        assert mapped.format == "d"
+        for got, expected in zip(mapped.tolist(), rows):
+            assert got == pytest.approx(list(expected))
+
+    def test_reduces_chroma_to_boundary(self):
+        """Test that only chroma changes, and only down to the boundary."""
+        rows = [(60.0, 120.0, 40.0), (30.0, 150.0, 300.0), (90.0, 90.0, 200.0)]
+
+        mapped = gamut_map(_values(rows)).tolist()
+
+        for (l, c, h), (ml, mc, mh) in zip(rows, mapped):
+            assert (ml, mh) == (l, h)
+            assert 0.0 < mc < c
+            # Slightly more chroma is out of the gamut again
+            again = gamut_map(_values([(l, mc, h), (l, mc + 0.01, h)]))
+            assert again.tolist()[0][1] == pytest.approx(mc)
+            assert again.tolist()[1][1] == pytest.approx(mc, abs=1e-4)
+        assert mapped[0][1] == pytest.approx(81.87, abs=0.01)
+
+    def test_lab_input_and_outputs(self):
+        """Test that Lab input and each output agree with LCh input."""
+        l, c, h = 60.0, 120.0, 40.0
+        lab = (l, c * math.cos(math.radians(h)), c * math.sin(math.radians(h)))
+
+        from_lch = gamut_map(_values([(l, c, h)]), output="lab").tolist()[0]
+        from_lab = gamut_map(_values([lab]), space="lab").tolist()[0]
+        as_lch = gamut_map(_values([lab]), space="lab", output="lch").tolist()[0]
+        rgb = gamut_map(_values([(l, c, h)]), output="rgb").tolist()[0]
+
+        assert from_lab == pytest.approx(from_lch)
+        assert as_lch == pytest.approx([60.0, 81.87, 40.0], abs=0.01)
+        assert all(0.0 <= x <= 1.0 for x in rgb)
+        assert Color.from_rgb(*rgb).lch()[2] == pytest.approx(h, abs=1.0)
+
+    def test_oklch_input(self):
+        """Test mapping in OKLCh and converting to the other families."""
+        rows = [(0.7, 0.4, 30.0), (0.5, 0.05, 200.0)]
+
+        mapped = gamut_map(_values(rows), space="oklch").tolist()
+        rgb = gamut_map(_values(rows), space="oklch", output="rgb").tolist()
+        oklab = gamut_map(_values(rows), space="oklch", output="oklab").tolist()
+
+        assert mapped[0][0] == 0.7
+        assert mapped[0][2] == 30.0
+        assert 0.0 < mapped[0][1] < 0.4
+        assert mapped[1] == pytest.approx(list(rows[1]))
+        for row, got in zip(rgb, oklab):
+            assert all(0.0 <= x <= 1.0 for x in row)
+            assert list(Color.from_rgb(*row).oklab()) == pytest.approx(got, abs=1e-3)
+
+    def test_lightness_clamped_and_nan(self):
+        """Test out-of-range lightness and non-finite values."""
+        mapped = gamut_map(
+            _values([(110.0, 10.0, 30.0), (float("nan"), 10.0, 30.0)])
+        ).tolist()
+
+        assert mapped[0][0] == 100.0
+        assert mapped[0][1] == pytest.approx(0.0, abs=0.01)
+        assert all(math.isnan(x) for x in mapped[1])
+
+    def test_invalid_input(self):
+        """Test that bad buffers and coordinate names raise errors."""
+        with pytest.raises(ValueError, match="element format"):
+            gamut_map(array("f", [50.0, 10.0, 30.0]))
+        with pytest.raises(ValueError, match="multiple of 3"):
+            gamut_map(array("d", [50.0, 10.0]))
+        with pytest.raises(ValueError, match="Unknown color coordinates"):
+            gamut_map(array("d", [50.0, 10.0, 30.0]), space="hsl")
+        with pytest.raises(ValueError, match="'oklab' or 'oklch'"):
+            gamut_map(array("d", [0.5, 0.5, 0.5]), space="rgb")
@@ -6,6 +6,8 @@ Tests the integration of Python Qualpal class with C++ algorithm.
 
 from __future__ import annotations
 
+import math
+
 import pytest
 
 from qualpal import Color, Palette, Qualpal
@@ -117,6 +119,53 @@ class TestGenerateWithColorspace:
         assert len(result) == 5
         assert isinstance(result, Palette)
 
+    @pytest.mark.parametrize("metric", ["ciede2000", "oklab"])
+    def test_lchab_samples_inside_gamut_and_region(self, metric):
+        """Test an LCHab region that lies mostly outside the sRGB gamut."""
+        qp = Qualpal(
+            colorspace={"h": (60, 120), "c": (60, 100), "l": (85, 100)},
+            space="lchab",
+            metric=metric,
+            colorspace_size=200,
+        )
+        result = qp.generate(4)
+
+        assert len(result) == 4
+        for color in result:
+            l, c, h = color.lch()
+            # Allow for rounding to 8-bit sRGB
+            assert 84 <= l <= 100
+            assert 59 <= c <= 101
+            assert 59 <= h <= 121
+
+    def test_lchab_region_outside_gamut(self):
+        """Test that an LCHab region without sRGB colors raises an error."""
+        qp = Qualpal(
+            colorspace={"h": (0, 360), "c": (150, 200), "l": (0, 100)},
+            space="lchab",
+        )
+        with pytest.raises(RuntimeError, match="no colors in the sRGB gamut"):
+            qp.generate(3)
+
+    def test_oklch_samples_inside_region(self):
+        """Test an OKLCh region with the OKLab metric."""
+        qp = Qualpal(
+            colorspace={"h": (200, 280), "c": (0.1, 0.3), "l": (0.4, 0.7)},
+            space="oklch",
+            metric="oklab",
+            colorspace_size=300,
+        )
+        result = qp.generate(4)
+
+        assert len(result) == 4
+        for color in result:
+            l, a, b = color.oklab()
+            h = math.degrees(math.atan2(b, a)) % 360
+            # Allow for rounding to 8-bit sRGB
+            assert 0.39 <= l <= 0.71
+            assert 0.09 <= math.hypot(a, b) <= 0.31
+            assert 199 <= h <= 281
+
 
 class TestGenerateWithColors:
     """Test generate() with colors input mode."""
@@ -306,6 +355,39 @@ class TestGenerateWithConfiguration:
         result = qp.generate(5)
         assert len(result) == 5
 
+    @pytest.mark.parametrize("metric", ["ciede2000", "oklab"])
+    def test_generate_with_light_and_dark_backgrounds(self, metric):
+        """Test that one palette stands out from both weighted backgrounds."""
+        backgrounds = {"#ffffff": 1.0, "#000000": 1.0}
+        both = Qualpal(backgrounds=backgrounds, metric=metric).generate(6)
+        light = Qualpal(background="#ffffff", metric=metric).generate(6)
+
+        def nearest(palette: Palette, background: str) -> float:
+            return min(c.distance(background, metric) for c in palette)
+
+        assert len(both) == 6
+        assert nearest(both, "#000000") > nearest(light, "#000000")
+        assert min(nearest(both, bg) for bg in backgrounds) > 10.0
+
+    def test_generate_with_heavier_background_weight(self):
+        """Test that a heavier weight keeps colors farther from a background."""
+        even = Qualpal(backgrounds={"#ffffff": 1.0, "#000000": 1.0})
+        heavy = Qualpal(backgrounds={"#ffffff": 3.0, "#000000": 1.0})
+
+        def nearest_white(palette: Palette) -> float:
+            return min(c.distance("#ffffff") for c in palette)
+
+        assert nearest_white(heavy.generate(5)) > nearest_white(even.generate(5))
+
+    def test_background_case_keeps_explicit_weight(self):
+        """Test that background joins backgrounds whatever the case of its hex."""
+        backgrounds = {"#ffffff": 3.0, "#000000": 1.0}
+        expected = Qualpal(backgrounds=backgrounds).generate(5)
+
+        for background in ["#ffffff", "#FFFFFF"]:
+            qp = Qualpal(background=background, backgrounds=backgrounds)
+            assert qp.generate(5) == expected
+
     def test_generate_after_changing_max_memory(self):
         """Test that generate() works after changing max_memory."""
         qp = Qualpal()
@@ -476,3 +558,161 @@ class TestGenerateIntegration:
 
         with pytest.raises(ValueError, match="n must be positive"):
             qp.generate(0)
+
+
+class TestGenerateNativeMetrics:
+    """Test generate() with metrics that are selected natively."""
+
+    @pytest.mark.parametrize("metric", ["oklab", "cam16ucs", "cie94", "cmc"])
+    def test_generate_from_colorspace(self, metric):
+        """Test colorspace generation with each native metric."""
+        qp = Qualpal(metric=metric, background="#ffffff")
+
+        result = qp.generate(6)
+
+        assert len(result) == 6
+        assert len(set(result.hex())) == 6
+        assert result.min_distance(metric=metric) > 0
+
+    @pytest.mark.parametrize("metric", ["oklab", "cam16ucs", "cie94", "cmc"])
+    def test_generate_selects_most_distinct(self, metric):
+        """Test that the selection maximizes the minimum distance."""
+        colors = ["#ff0000", "#fe0000", "#00ff00", "#01ff00", "#0000ff"]
+        qp = Qualpal(colors=colors, metric=metric)
+
+        result = qp.generate(3)
+
+        assert sorted(result.hex()) in (
+            sorted(["#ff0000", "#00ff00", "#0000ff"]),
+            sorted(["#fe0000", "#00ff00", "#0000ff"]),
+            sorted(["#ff0000", "#01ff00", "#0000ff"]),
+            sorted(["#fe0000", "#01ff00", "#0000ff"]),
+        )
+
+    def test_generate_too_many_colors(self):
+        """Test that requesting more colors than available fails."""
+        qp = Qualpal(colors=["#ff0000", "#00ff00"], metric="oklab")
+
+        with pytest.raises(RuntimeError, match="Cannot select"):
+            qp.generate(3)
+
+
+class TestGenerateWorstCaseCvd:
+    """Test generate() with cvd_mode='worst_case'."""
+
+    @staticmethod
+    def _worst_distance(palette: Palette, cvd: dict[str, float]) -> float:
+        matrix = palette.cvd_distance_matrix(cvd=cvd, metric="oklab")
+        return min(
+            matrix[i][j]
+            for i in range(len(matrix))
+            for j in range(len(matrix))
+            if i != j
+        )
+
+    @pytest.mark.parametrize("metric", ["ciede2000", "oklab"])
+    def test_generate_worst_case(self, metric):
+        """Test generation for several deficiencies at once."""
+        cvd = {"protan": 1.0, "deutan": 1.0, "tritan": 1.0}
+        qp = Qualpal(cvd=cvd, cvd_mode="worst_case", metric=metric)
+
+        result = qp.generate(5)
+
+        assert len(result) == 5
+        assert len(set(result.hex())) == 5
+
+    def test_worst_case_beats_combined(self):
+        """Test that the worst case over the conditions is what is maximized."""
+        cvd = {"protan": 1.0, "tritan": 1.0}
+        space = {"h": (0, 360), "c": (0, 130), "l": (0, 100)}
+        palettes = {
+            mode: Qualpal(
+                colorspace=space,
+                space="lchab",
+                cvd=cvd,
+                cvd_mode=mode,
+                metric="oklab",
+                colorspace_size=500,
+            ).generate(6)
+            for mode in ("combined", "worst_case")
+        }
+
+        worst_case = self._worst_distance(palettes["worst_case"], cvd)
+        combined = self._worst_distance(palettes["combined"], cvd)
+        assert worst_case > combined
+
+
+class TestGenerateGrouped:
+    """Test generate_grouped()."""
+
+    @staticmethod
+    def _hue_offset(a: float, b: float) -> float:
+        return abs((a - b + 180.0) % 360.0 - 180.0)
+
+    @pytest.mark.parametrize("metric", ["ciede2000", "oklab"])
+    def test_groups_share_hues(self, metric):
+        """Test that each color is closest in hue to its own group's anchor."""
+        qp = Qualpal(
+            colorspace={"h": (0, 360), "c": (20, 100), "l": (30, 85)},
+            space="lchab",
+            metric=metric,
+        )
+
+        groups = qp.generate_grouped(3, 4)
+
+        assert [len(group) for group in groups] == [4, 4, 4]
+        hexes = [c.hex() for group in groups for c in group]
+        assert len(set(hexes)) == 12
+        anchors = [group[0].lch()[2] for group in groups]
+        assert anchors == sorted(anchors)
+        for g, group in enumerate(groups):
+            for color in group:
+                offsets = [self._hue_offset(color.lch()[2], a) for a in anchors]
+                assert min(offsets) == offsets[g]
+
+    def test_narrow_spread_tightens_groups(self):
+        """Test that a smaller spread keeps groups closer to their anchors."""
+        qp = Qualpal(
+            colorspace={"h": (0, 360), "c": (20, 100), "l": (30, 85)},
+            space="lchab",
+        )
+
+        def widest(groups: list[Palette]) -> float:
+            return max(
+                self._hue_offset(c.lch()[2], group[0].lch()[2])
+                for group in groups
+                for c in group
+            )
+
+        assert widest(qp.generate_grouped(3, 3, spread=0.3)) < widest(
+            qp.generate_grouped(3, 3, spread=1.0)
+        )
+
+    def test_single_group_spans_all_hues(self):
+        """Test that one group draws from the whole hue circle."""
+        colors = ["#ff0000", "#00ff00", "#0000ff", "#ffff00"]
+        qp = Qualpal(colors=colors)
+
+        (group,) = qp.generate_grouped(1, 4, spread=1.0)
+
+        assert sorted(c.hex() for c in group) == sorted(colors)
+
+    def test_too_few_candidates(self):
+        """Test that a sector without enough candidates raises an error."""
+        qp = Qualpal(colors=["#ff0000", "#00ff00", "#0000ff", "#ff1100"])
+
+        with pytest.raises(RuntimeError, match="candidates"):
+            qp.generate_grouped(3, 5)
+
+    def test_invalid_arguments(self):
+        """Test validation of the group counts and spread."""
+        qp = Qualpal()
+
+        with pytest.raises(ValueError, match="n_groups must be positive"):
+            qp.generate_grouped(0, 3)
+        with pytest.raises(TypeError, match="group_size must be an integer"):
+            qp.generate_grouped(2, 2.5)  # type: ignore[arg-type]
+        with pytest.raises(TypeError, match="n_groups must be an integer"):
+            qp.generate_grouped(True, 3)
+        with pytest.raises(ValueError, match="spread"):
+            qp.generate_grouped(2, 3, spread=0.0)
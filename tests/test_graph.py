@@ -0,0 +1,114 @@
+"""Tests for color assignment to graph nodes."""
+
+from __future__ import annotations
+
+import itertools
+from array import array
+
+import pytest
+
+from qualpal import Palette
+from qualpal.graph import assign_colors
+
+
+def _csr(n_nodes: int, edges: list[tuple[int, int]]) -> tuple[array, array]:
+    """Build CSR arrays listing each edge once, in the row of its first node."""
+    indptr = array("q", [0])
+    indices = array("q")
+    for u in range(n_nodes):
+        indices.extend(v for a, v in edges if a == u)
+        indptr.append(len(indices))
+    return indptr, indices
+
+
+def _edge_min(palette: Palette, edges, node_colors) -> float:
+    """Smallest distance between the colors of adjacent nodes."""
+    matrix = palette.distance_matrix()
+    return min(matrix[node_colors[u]][node_colors[v]] for u, v in edges)
+
+
+class TestAssignColors:
+    """Test qualpal.graph.assign_colors()."""
+
+    palette = Palette(["#e41a1c", "#377eb8", "#4daf4a", "#984ea3", "#ffff33"])
+
+    def test_matches_exhaustive_search(self):
+        """Test a small graph against all possible assignments."""
+        # Two triangles sharing an edge, plus a pendant node
+        edges = [(0, 1), (0, 2), (1, 2), (1, 3), (2, 3), (3, 4)]
+        indptr, indices = _csr(5, edges)
+
+        palette, node_colors = assign_colors(indptr, indices, self.palette)
+        best = max(
+            _edge_min(self.palette, edges, assignment)
+            for assignment in itertools.product(range(5), repeat=5)
+        )
+
+        assert palette is self.palette
+        assert len(node_colors) == 5
+        assert _edge_min(palette, edges, node_colors) == pytest.approx(best)
+
+    def test_edges_listed_in_either_row(self):
+        """Test that the graph is treated as undirected."""
+        edges = [(0, 1), (1, 2), (2, 0)]
+        indptr, indices = _csr(3, edges)
+        reverse_indptr, reverse_indices = _csr(3, [(v, u) for u, v in edges])
+
+        _, forward = assign_colors(indptr, indices, self.palette)
+        _, reverse = assign_colors(reverse_indptr, reverse_indices, self.palette)
+
+        assert len(set(forward.tolist())) == 3
+        assert len(set(reverse.tolist())) == 3
+
+    def test_grid_uses_distant_colors(self):
+        """Test that a grid map gets a proper coloring with distant colors."""
+        side = 30
+        edges = [
+            (y * side + x, y * side + x + 1)
+            for y in range(side)
+            for x in range(side - 1)
+        ] + [
+            (y * side + x, (y + 1) * side + x)
+            for y in range(side - 1)
+            for x in range(side)
+        ]
+        indptr, indices = _csr(side * side, edges)
+
+        palette, node_colors = assign_colors(indptr, indices, self.palette)
+
+        assert node_colors.format == "q"
+        # A grid is bipartite, so the two most distant colors suffice
+        assert _edge_min(palette, edges, node_colors) == pytest.approx(
+            max(max(row) for row in palette.distance_matrix())
+        )
+
+    def test_color_budget(self):
+        """Test that an integer generates a palette of that size."""
+        indptr, indices = _csr(4, [(0, 1), (1, 2), (2, 3), (3, 0)])
+
+        palette, node_colors = assign_colors(indptr, indices, 3)
+
+        assert len(palette) == 3
+        assert all(0 <= c < 3 for c in node_colors)
+
+    def test_hex_strings_and_isolated_nodes(self):
+        """Test hex string input and nodes without edges."""
+        indptr, indices = array("q", [0, 0, 0]), array("q")
+
+        palette, node_colors = assign_colors(indptr, indices, ["#ff0000"])
+
+        assert palette.hex() == ["#ff0000"]
+        assert node_colors.tolist() == [0, 0]
+
+    def test_invalid_graphs(self):
+        """Test that inconsistent CSR arrays raise errors."""
+        with pytest.raises(ValueError, match="out of range"):
+            assign_colors(array("q", [0, 1]), array("q", [3]), self.palette)
+        with pytest.raises(ValueError, match="length of indices"):
+            assign_colors(array("q", [0, 2]), array("q", [0]), self.palette)
+        with pytest.raises(ValueError, match="non-decreasing"):
+            assign_colors(array("q", [0, 1, 0]), array("q", []), self.palette)
+        with pytest.raises(ValueError, match="element format"):
+            assign_colors(array("i", [0, 0]), array("q"), self.palette)
+        with pytest.raises(ValueError, match="at least one color"):
+            assign_colors(array("q", [0, 0]), array("q"), [])
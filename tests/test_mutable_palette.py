@@ -0,0 +1,227 @@
+"""Tests for MutablePalette class."""
+
+from __future__ import annotations
+
+import random
+import threading
+
+import pytest
+
+from qualpal import Color, MutablePalette, Palette
+
+
+def _random_hex(rng: random.Random) -> str:
+    return "#" + "".join(f"{rng.choice(range(0, 256, 51)):02x}" for _ in range(3))
+
+
+def _assert_matches_palette(mp: MutablePalette) -> None:
+    """Check the cached analysis against a freshly computed Palette."""
+    pal = Palette(mp.hex())
+
+    matrix = mp.distance_matrix()
+    for row, expected in zip(matrix, pal.distance_matrix()):
+        assert row == pytest.approx(expected)
+    if len(mp) >= 2:
+        min_dists = mp.min_distances()
+        assert min_dists == pytest.approx(pal.min_distances())
+        for i, j in enumerate(mp.nearest_neighbors()):
+            assert i != j
+            assert matrix[i][j] == pytest.approx(min_dists[i])
+
+
+class TestMutablePaletteBasics:
+    """Tests for construction and list-like behavior."""
+
+    def test_creation(self):
+        """Test creating a MutablePalette."""
+        mp = MutablePalette(["#ff0000", Color("#00ff00")])
+
+        assert len(mp) == 2
+        assert mp[0] == "#ff0000"
+        assert mp[-1] == "#00ff00"
+        assert mp.metric == "ciede2000"
+
+    def test_empty(self):
+        """Test creating an empty MutablePalette."""
+        mp = MutablePalette()
+
+        assert len(mp) == 0
+        assert mp.hex() == []
+
+    def test_invalid_color(self):
+        """Test that invalid colors raise errors."""
+        with pytest.raises(ValueError, match="Invalid hex color"):
+            MutablePalette(["#ff0000", "invalid"])
+        with pytest.raises(TypeError):
+            MutablePalette([123])  # type: ignore[list-item]
+
+    def test_invalid_metric(self):
+        """Test that an invalid metric raises ValueError."""
+        with pytest.raises(ValueError, match="Unknown metric"):
+            MutablePalette(["#ff0000"], metric="invalid")
+
+    def test_edits(self):
+        """Test append, insert, replace and removal."""
+        mp = MutablePalette(["#ff0000"])
+
+        mp.append("#00ff00")
+        mp.insert(0, "#0000ff")
+        mp[1] = "#ffff00"
+        del mp[-1]
+
+        assert mp.hex() == ["#0000ff", "#ffff00"]
+        assert mp.pop() == "#ffff00"
+        assert mp.hex() == ["#0000ff"]
+
+    def test_index_out_of_range(self):
+        """Test that out of range indices raise IndexError."""
+        mp = MutablePalette(["#ff0000"])
+
+        with pytest.raises(IndexError):
+            _ = mp[1]
+        with pytest.raises(IndexError):
+            del mp[-2]
+
+    def test_failed_edit_leaves_palette_unchanged(self):
+        """Test that an invalid replacement does not modify the palette."""
+        mp = MutablePalette(["#ff0000", "#00ff00"])
+
+        with pytest.raises(ValueError):
+            mp[0] = "invalid"
+
+        assert mp.hex() == ["#ff0000", "#00ff00"]
+
+    def test_to_palette(self):
+        """Test snapshot conversion to Palette."""
+        mp = MutablePalette(["#ff0000", "#00ff00"])
+        pal = mp.to_palette()
+        mp.append("#0000ff")
+
+        assert isinstance(pal, Palette)
+        assert pal == Palette(["#ff0000", "#00ff00"])
+
+
+class TestMutablePaletteDistances:
+    """Tests for incrementally maintained distances."""
+
+    @pytest.mark.parametrize("metric", ["ciede2000", "din99d", "cie76"])
+    def test_random_edits_match_palette(self, metric):
+        """Test that cached distances match recomputation after edits."""
+        rng = random.Random(42)
+        mp = MutablePalette([_random_hex(rng) for _ in range(6)], metric=metric)
+
+        for _ in range(100):
+            n = len(mp)
+            op = rng.randrange(3)
+            if op == 0 and n > 2:
+                del mp[rng.randrange(n)]
+            elif op == 1:
+                mp[rng.randrange(n)] = _random_hex(rng)
+            else:
+                mp.insert(rng.randrange(n + 1), _random_hex(rng))
+
+            _assert_matches_palette(mp)
+
+    def test_distance(self):
+        """Test distance() against Color.distance()."""
+        mp = MutablePalette(["#ff0000", "#00ff00"], metric="din99d")
+
+        expected = Color("#ff0000").distance("#00ff00", metric="din99d")
+
+        assert mp.distance(0, 1) == pytest.approx(expected)
+        assert mp.distance(1, 1) == 0.0
+
+    def test_min_distance_skips_duplicates(self):
+        """Test that duplicate colors are skipped like in Palette."""
+        colors = ["#ff0000", "#ff0000", "#00ff00"]
+        mp = MutablePalette(colors)
+
+        assert mp.min_distance() > 0.0
+        assert mp.min_distance() == pytest.approx(Palette(colors).min_distance())
+        assert mp.min_distance_if_removed(2) == float("inf")
+        assert mp.min_distance_if_added("#ff0000") == pytest.approx(
+            mp.min_distance()
+        )
+
+    def test_too_few_colors(self):
+        """Test that distance queries need at least 2 colors."""
+        mp = MutablePalette(["#ff0000"])
+
+        with pytest.raises(ValueError, match="Need at least 2 colors"):
+            mp.min_distance()
+
+
+class TestMutablePaletteWhatIf:
+    """Tests for what-if queries."""
+
+    def test_if_replaced(self):
+        """Test min_distance_if_replaced() against performing the edit."""
+        rng = random.Random(1)
+        mp = MutablePalette([_random_hex(rng) for _ in range(12)])
+
+        for _ in range(20):
+            index = rng.randrange(len(mp))
+            color = _random_hex(rng)
+
+            predicted = mp.min_distance_if_replaced(index, color)
+            before = mp.hex()
+            mp[index] = color
+
+            assert predicted == pytest.approx(mp.min_distance())
+            assert mp.hex()[:index] == before[:index]
+
+    def test_if_removed(self):
+        """Test min_distance_if_removed() against performing the edit."""
+        mp = MutablePalette(["#ff0000", "#fe0000", "#00ff00", "#0000ff"])
+
+        predicted = mp.min_distance_if_removed(1)
+        del mp[1]
+
+        assert predicted == pytest.approx(mp.min_distance())
+        assert predicted > 1
+
+    def test_if_added(self):
+        """Test min_distance_if_added() against performing the edit."""
+        mp = MutablePalette(["#ff0000", "#00ff00", "#0000ff"])
+
+        predicted = mp.min_distance_if_added("#fe0000")
+        mp.append("#fe0000")
+
+        assert predicted == pytest.approx(mp.min_distance())
+        assert predicted < 1
+
+    def test_queries_do_not_modify(self):
+        """Test that what-if queries leave the palette unchanged."""
+        mp = MutablePalette(["#ff0000", "#00ff00", "#0000ff"])
+        before = mp.distance_matrix()
+
+        mp.min_distance_if_replaced(0, "#ffffff")
+        mp.min_distance_if_removed(1)
+        mp.min_distance_if_added("#000000")
+
+        assert mp.hex() == ["#ff0000", "#00ff00", "#0000ff"]
+        assert mp.distance_matrix() == before
+
+
+class TestMutablePaletteThreads:
+    """Tests for sharing a palette between threads."""
+
+    def test_concurrent_edits(self):
+        """Test that edits from several threads keep the caches consistent."""
+        mp = MutablePalette(["#ff0000", "#00ff00", "#0000ff"])
+
+        def edit(seed: int) -> None:
+            rng = random.Random(seed)
+            for _ in range(50):
+                mp.append(_random_hex(rng))
+                mp[0] = _random_hex(rng)
+                mp.min_distance_if_added(_random_hex(rng))
+
+        threads = [threading.Thread(target=edit, args=(k,)) for k in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        assert len(mp) == 3 + 4 * 50
+        _assert_matches_palette(mp)
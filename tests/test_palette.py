@@ -2,6 +2,8 @@
 
 from __future__ import annotations
 
+import copy
+import pickle
 import unittest
 
 import pytest
@@ -186,6 +188,37 @@ class TestPaletteConversions(unittest.TestCase):
         assert rgb_list[1] == (0.0, 1.0, 0.0)
         assert rgb_list[2] == (0.0, 0.0, 1.0)
 
+    def test_array_rgb(self):
+        """Test array() exposes RGB values through the buffer protocol."""
+        buf = self.palette.array()
+
+        assert isinstance(buf, memoryview)
+        assert buf.shape == (3, 3)
+        assert buf.format == "d"
+        assert buf.readonly
+        assert buf.tolist() == [list(c) for c in self.palette.rgb()]
+
+    def test_array_lab(self):
+        """Test array('lab') matches Color.lab()."""
+        buf = self.palette.array("lab")
+
+        for row, color in zip(buf.tolist(), self.palette):
+            assert row == pytest.approx(list(color.lab()))
+
+    def test_array_slice_is_view(self):
+        """Test that sliced palettes expose strided views."""
+        sub = self.palette[::-2]
+        buf = sub.array()
+
+        assert buf.shape == (2, 3)
+        assert not buf.c_contiguous
+        assert buf.tolist() == [[0.0, 0.0, 1.0], [1.0, 0.0, 0.0]]
+
+    def test_array_invalid_space(self):
+        """Test that an invalid space raises ValueError."""
+        with pytest.raises(ValueError, match="space must be"):
+            self.palette.array("hsl")
+
 
 class TestPaletteRepresentation(unittest.TestCase):
     """Tests for Palette string representation."""
@@ -260,5 +293,54 @@ class TestPaletteEquality(unittest.TestCase):
         assert palette != ["#ff0000"]
 
 
+class TestPaletteSerialization(unittest.TestCase):
+    """Tests for binary serialization and pickling."""
+
+    def test_round_trip(self):
+        """Test that RGB and Lab values are restored exactly."""
+        palette = Palette(["#ff0000", "#00ff00", "#0000ff"])
+        restored = Palette.from_bytes(palette.to_bytes())
+
+        assert restored == palette
+        assert restored.array().tolist() == palette.array().tolist()
+        assert restored.array("lab").tolist() == palette.array("lab").tolist()
+
+    def test_size(self):
+        """Test that each color takes 48 bytes after the header."""
+        assert len(Palette([]).to_bytes()) == 24
+        assert len(Palette(["#ff0000", "#00ff00"]).to_bytes()) == 24 + 2 * 48
+
+    def test_slice(self):
+        """Test that a strided view is serialized as the colors it covers."""
+        palette = Palette(["#ff0000", "#00ff00", "#0000ff", "#ffff00"])
+        view = palette[::-2]
+
+        assert Palette.from_bytes(view.to_bytes()) == view
+
+    def test_pickle(self):
+        """Test that palettes survive pickling."""
+        palette = Palette(["#ff0000", "#00ff00"])
+        restored = pickle.loads(pickle.dumps(palette))
+
+        assert restored == palette
+        assert restored.min_distance() == palette.min_distance()
+
+    def test_copy(self):
+        """Test that copies hold the same colors."""
+        palette = Palette(["#ff0000", "#00ff00", "#0000ff"])[::2]
+
+        assert copy.copy(palette) == palette
+        assert copy.deepcopy(palette) == palette
+
+    def test_invalid_data(self):
+        """Test that malformed data is rejected."""
+        data = Palette(["#ff0000"]).to_bytes()
+
+        with pytest.raises(ValueError, match="serialized palette"):
+            Palette.from_bytes(b"not a palette")
+        with pytest.raises(ValueError, match="wrong size"):
+            Palette.from_bytes(data[:-8])
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -6,6 +6,8 @@ Tests the distance matrix and analysis functionality.
 
 from __future__ import annotations
 
+import itertools
+
 import pytest
 
 from qualpal import Palette
@@ -306,3 +308,421 @@ class TestPaletteAnalysisEdgeCases:
         # Distance between identical colors should be 0
         assert matrix[0][1] == 0.0
         assert matrix[1][0] == 0.0
+
+
+class TestPaletteNearestNeighbors:
+    """Test Palette.nearest_neighbors() method."""
+
+    def test_nearest_neighbors_pairs(self):
+        """Test that close pairs are each other's nearest neighbors."""
+        pal = Palette(["#ff0000", "#fe0000", "#00ff00", "#00fe00"])
+
+        assert pal.nearest_neighbors() == [1, 0, 3, 2]
+
+    def test_nearest_neighbors_consistent_with_matrix(self):
+        """Test that neighbors match the distance matrix."""
+        pal = Palette(["#ff0000", "#00ff00", "#0000ff", "#ffff00", "#808080"])
+
+        matrix = pal.distance_matrix()
+        nearest = pal.nearest_neighbors()
+        min_dists = pal.min_distances()
+
+        for i, j in enumerate(nearest):
+            assert i != j
+            assert matrix[i][j] == pytest.approx(min_dists[i])
+
+    def test_nearest_neighbors_with_one_color_raises_error(self):
+        """Test that nearest_neighbors with 1 color raises ValueError."""
+        pal = Palette(["#ff0000"])
+
+        with pytest.raises(ValueError, match="Need at least 2 colors"):
+            pal.nearest_neighbors()
+
+
+class TestPaletteClosePairs:
+    """Test Palette.close_pairs() method."""
+
+    def test_close_pairs_finds_near_duplicates(self):
+        """Test that only the near-duplicate pairs are returned."""
+        pal = Palette(["#ff0000", "#fe0000", "#00ff00", "#00fe00"])
+
+        pairs = pal.close_pairs(2.0)
+
+        assert [(i, j) for i, j, _ in pairs] == [(0, 1), (2, 3)]
+        for i, j, d in pairs:
+            assert d == pytest.approx(pal.distance_matrix()[i][j])
+
+    def test_close_pairs_matches_distance_matrix(self):
+        """Test against a brute-force scan of the matrix for every metric."""
+        colors = [
+            f"#{r:02x}{g:02x}{b:02x}"
+            for r in range(0, 256, 51)
+            for g in range(0, 256, 85)
+            for b in range(0, 256, 64)
+        ]
+        pal = Palette(colors)
+
+        for metric in (
+            "ciede2000",
+            "din99d",
+            "cie76",
+            "oklab",
+            "cam16ucs",
+            "cie94",
+            "cmc",
+        ):
+            matrix = pal.distance_matrix(metric=metric)
+            threshold = 20.0
+            expected = [
+                (i, j)
+                for i in range(len(pal))
+                for j in range(i + 1, len(pal))
+                if matrix[i][j] < threshold
+            ]
+
+            pairs = pal.close_pairs(threshold, metric=metric)
+
+            assert [(i, j) for i, j, _ in pairs] == expected
+            for i, j, d in pairs:
+                assert d == pytest.approx(matrix[i][j])
+
+    def test_close_pairs_empty(self):
+        """Test that distinct colors and a zero threshold give no pairs."""
+        pal = Palette(["#ff0000", "#00ff00", "#0000ff"])
+
+        assert pal.close_pairs(1.0) == []
+        assert pal.close_pairs(0) == []
+        assert Palette(["#ff0000"]).close_pairs(100.0) == []
+
+    def test_close_pairs_invalid_threshold(self):
+        """Test that invalid thresholds raise errors."""
+        pal = Palette(["#ff0000", "#00ff00"])
+
+        with pytest.raises(ValueError, match="non-negative"):
+            pal.close_pairs(-1.0)
+        with pytest.raises(ValueError, match="non-negative"):
+            pal.close_pairs(float("nan"))
+        with pytest.raises(TypeError, match="must be a number"):
+            pal.close_pairs("1")
+        with pytest.raises(ValueError, match="Unknown metric"):
+            pal.close_pairs(1.0, metric="invalid")
+
+
+class TestPaletteKnnGraph:
+    """Test Palette.knn_graph() method."""
+
+    def test_knn_graph_matches_distance_matrix(self):
+        """Test every row against a sorted row of the distance matrix."""
+        colors = [
+            f"#{r:02x}{g:02x}{b:02x}"
+            for r in range(0, 256, 51)
+            for g in range(0, 256, 85)
+            for b in range(0, 256, 64)
+        ]
+        pal = Palette(colors)
+
+        for metric in ("ciede2000", "din99d", "oklab", "cmc"):
+            matrix = pal.distance_matrix(metric=metric)
+            indptr, indices, distances = pal.knn_graph(5, metric=metric)
+
+            assert indptr.tolist() == list(range(0, 5 * len(pal) + 1, 5))
+            for i in range(len(pal)):
+                row = sorted((matrix[i][j], j) for j in range(len(pal)) if j != i)
+                start, stop = indptr[i], indptr[i + 1]
+                assert indices[start:stop].tolist() == [j for _, j in row[:5]]
+                assert distances[start:stop].tolist() == pytest.approx(
+                    [d for d, _ in row[:5]]
+                )
+
+    def test_knn_graph_caps_k(self):
+        """Test that k is capped at the number of other colors."""
+        pal = Palette(["#ff0000", "#00ff00", "#0000ff"])
+
+        indptr, indices, distances = pal.knn_graph(10)
+
+        assert indptr.tolist() == [0, 2, 4, 6]
+        assert len(indices) == len(distances) == 6
+        assert Palette(["#ff0000"]).knn_graph(3)[0].tolist() == [0, 0]
+
+    def test_knn_graph_buffer_formats(self):
+        """Test the element types of the returned buffers."""
+        indptr, indices, distances = Palette(["#ff0000", "#00ff00"]).knn_graph(1)
+
+        assert indptr.format == "q"
+        assert indices.format == "q"
+        assert distances.format == "d"
+
+    def test_knn_graph_invalid_k(self):
+        """Test that invalid k raises errors."""
+        pal = Palette(["#ff0000", "#00ff00"])
+
+        with pytest.raises(ValueError, match="at least 1"):
+            pal.knn_graph(0)
+        with pytest.raises(TypeError, match="integer"):
+            pal.knn_graph(1.5)
+        with pytest.raises(ValueError, match="Unknown metric"):
+            pal.knn_graph(1, metric="invalid")
+
+
+def _adjacent_score(matrix, order):
+    """Shortest and total distance between neighbors in an order."""
+    order = list(order)
+    edges = [matrix[a][b] for a, b in zip(order, order[1:])]
+    return min(edges), sum(edges)
+
+
+class TestPalettePerceptualOrder:
+    """Test Palette.perceptual_order() and Palette.reorder() methods."""
+
+    def test_perceptual_order_is_optimal_for_small_palettes(self):
+        """Test against a search over all orders."""
+        pal = Palette(
+            ["#e41a1c", "#377eb8", "#4daf4a", "#984ea3", "#ff7f00", "#ffff33"]
+            + ["#a65628", "#f781bf"]
+        )
+        matrix = pal.distance_matrix()
+
+        order = pal.perceptual_order()
+        best = max(
+            _adjacent_score(matrix, p) for p in itertools.permutations(range(8))
+        )
+
+        assert sorted(order) == list(range(8))
+        assert _adjacent_score(matrix, order) == pytest.approx(best)
+
+    def test_perceptual_order_large_palette(self):
+        """Test that the heuristic returns a permutation that helps."""
+        colors = [
+            f"#{r:02x}{g:02x}{b:02x}"
+            for r in range(0, 256, 85)
+            for g in range(0, 256, 85)
+            for b in range(0, 256, 128)
+        ]
+        pal = Palette(colors)
+        matrix = pal.distance_matrix(metric="cie76")
+
+        order = pal.perceptual_order(metric="cie76")
+
+        assert sorted(order) == list(range(len(pal)))
+        identity = range(len(pal))
+        assert (
+            _adjacent_score(matrix, order)[0]
+            > _adjacent_score(matrix, identity)[0]
+        )
+
+    def test_reorder(self):
+        """Test that reorder returns the colors in perceptual order."""
+        pal = Palette(["#000000", "#111111", "#ffffff", "#eeeeee"])
+
+        reordered = pal.reorder()
+
+        assert reordered.hex() == [pal.hex()[i] for i in pal.perceptual_order()]
+        assert reordered.hex()[0] in ("#eeeeee", "#111111")
+
+    def test_perceptual_order_trivial_sizes(self):
+        """Test palettes with fewer than three colors."""
+        assert Palette([]).perceptual_order() == []
+        assert Palette(["#ff0000"]).perceptual_order() == [0]
+        assert Palette(["#ff0000", "#00ff00"]).perceptual_order() == [0, 1]
+
+    def test_perceptual_order_invalid_metric(self):
+        """Test that an unknown metric raises an error."""
+        with pytest.raises(ValueError, match="Unknown metric"):
+            Palette(["#ff0000", "#00ff00"]).perceptual_order(metric="invalid")
+
+
+class TestPaletteMatch:
+    """Test Palette.match() method."""
+
+    def test_match_is_optimal(self):
+        """Test against a search over all matchings."""
+        old = Palette(["#e41a1c", "#377eb8", "#4daf4a", "#984ea3", "#ff7f00"])
+        new = Palette(
+            ["#ff8000", "#3080c0", "#a050a0", "#50b050", "#e01020", "#ffff33"]
+        )
+        cross = [[old[i].distance(new[j]) for j in range(6)] for i in range(5)]
+
+        order = new.match(old)
+        best = min(
+            sum(cross[i][j] for i, j in enumerate(p))
+            for p in itertools.permutations(range(6), 5)
+        )
+
+        assert sorted(order) == list(range(6))
+        assert sum(cross[i][order[i]] for i in range(5)) == pytest.approx(best)
+        assert order == [4, 1, 3, 2, 0, 5]
+
+    def test_match_fewer_colors(self):
+        """Test that a shrinking palette keeps the closest old colors."""
+        old = ["#ff0000", "#00ff00", "#0000ff"]
+        new = Palette(["#0000ee", "#ee0000"])
+
+        assert new.match(old) == [1, 0]
+
+    def test_match_trivial_sizes(self):
+        """Test empty palettes on either side."""
+        pal = Palette(["#ff0000", "#00ff00"])
+
+        assert pal.match([]) == [0, 1]
+        assert Palette([]).match(pal) == []
+
+    def test_match_invalid_metric(self):
+        """Test that an unknown metric raises an error."""
+        with pytest.raises(ValueError, match="Unknown metric"):
+            Palette(["#ff0000"]).match(["#00ff00"], metric="invalid")
+
+
+class TestPaletteAnalysisNative:
+    """Test that native analysis agrees with per-color computations."""
+
+    def test_distance_matrix_matches_color_distance(self):
+        """Test matrix entries against Color.distance()."""
+        pal = Palette(["#ff0000", "#00ff00", "#0000ff", "#123456"])
+
+        for metric in ("ciede2000", "din99d", "cie76"):
+            matrix = pal.distance_matrix(metric=metric)
+            for i, ci in enumerate(pal):
+                for j, cj in enumerate(pal):
+                    if i != j:
+                        assert matrix[i][j] == pytest.approx(
+                            ci.distance(cj, metric=metric)
+                        )
+
+    def test_slice_analysis(self):
+        """Test analysis on sliced palettes (views)."""
+        pal = Palette(["#ff0000", "#00ff00", "#0000ff", "#ffff00"])
+        sub = pal[::-2]
+
+        expected = Palette(["#ffff00", "#00ff00"])
+
+        assert sub.distance_matrix() == expected.distance_matrix()
+        assert sub.min_distance() == expected.min_distance()
+
+    def test_invalid_metric(self):
+        """Test that an invalid metric raises ValueError."""
+        pal = Palette(["#ff0000", "#00ff00"])
+
+        with pytest.raises(ValueError, match="Unknown metric"):
+            pal.distance_matrix(metric="invalid")
+
+
+class TestPaletteSimulateCvd:
+    """Test Palette.simulate_cvd() method."""
+
+    def test_matches_color_simulation(self):
+        """Test that palette simulation matches per-color simulation."""
+        pal = Palette(["#ff0000", "#00ff00", "#0000ff", "#ffa500"])
+
+        for cvd_type in ("protan", "deutan", "tritan"):
+            simulated = pal.simulate_cvd(cvd_type, severity=0.6)
+            expected = [c.simulate_cvd(cvd_type, severity=0.6) for c in pal]
+
+            assert list(simulated) == expected
+
+    def test_zero_severity_is_identity(self):
+        """Test that zero severity leaves the palette unchanged."""
+        pal = Palette(["#ff0000", "#00ff00", "#0000ff"])
+
+        assert pal.simulate_cvd("deutan", severity=0.0) == pal
+
+    def test_invalid_cvd_type(self):
+        """Test that invalid cvd_type raises ValueError."""
+        pal = Palette(["#ff0000"])
+
+        with pytest.raises(ValueError, match="cvd_type must be one of"):
+            pal.simulate_cvd("invalid")
+
+    def test_invalid_severity(self):
+        """Test that out of range severity raises ValueError."""
+        pal = Palette(["#ff0000"])
+
+        with pytest.raises(ValueError, match="severity must be in range"):
+            pal.simulate_cvd("protan", severity=1.5)
+
+
+class TestPaletteCvdDistanceMatrix:
+    """Test Palette.cvd_distance_matrix() method."""
+
+    COLORS = ["#ff0000", "#00ff00", "#0000ff", "#ffa500", "#808080"]
+
+    def _matrices(self, pal, cvd):
+        matrices = [pal.distance_matrix()]
+        for cvd_type, severities in cvd.items():
+            for severity in severities:
+                matrices.append(pal.simulate_cvd(cvd_type, severity).distance_matrix())
+        return matrices
+
+    def test_min_matches_per_condition_matrices(self):
+        """Test that 'min' is the element-wise minimum over conditions."""
+        pal = Palette(self.COLORS)
+        cvd = {"protan": [0.5, 1.0], "deutan": [1.0], "tritan": [1.0]}
+        matrices = self._matrices(pal, cvd)
+
+        result = pal.cvd_distance_matrix(cvd)
+
+        n = len(pal)
+        for i in range(n):
+            for j in range(n):
+                expected = min(m[i][j] for m in matrices)
+                assert result[i][j] == pytest.approx(expected)
+
+    def test_weighted_mean(self):
+        """Test that 'mean' is the weighted element-wise mean."""
+        pal = Palette(self.COLORS)
+        matrices = self._matrices(pal, {"deutan": [1.0], "tritan": [1.0]})
+        weights = {"normal": 2.0, "deutan": 1.0, "tritan": 0.5}
+
+        result = pal.cvd_distance_matrix(
+            {"deutan": 1.0, "tritan": 1.0}, reduction="mean", weights=weights
+        )
+
+        w = [2.0, 1.0, 0.5]
+        for i in range(len(pal)):
+            for j in range(len(pal)):
+                expected = sum(wk * m[i][j] for wk, m in zip(w, matrices)) / 3.5
+                assert result[i][j] == pytest.approx(expected)
+
+    def test_exclude_normal_vision(self):
+        """Test that a zero weight removes normal vision."""
+        pal = Palette(self.COLORS)
+
+        result = pal.cvd_distance_matrix({"deutan": 1.0}, weights={"normal": 0})
+
+        expected = pal.simulate_cvd("deutan").distance_matrix()
+        for row, expected_row in zip(result, expected):
+            assert row == pytest.approx(expected_row)
+
+    def test_symmetric_with_zero_diagonal(self):
+        """Test that the matrix is symmetric with zeros on the diagonal."""
+        pal = Palette(self.COLORS)
+
+        result = pal.cvd_distance_matrix(metric="din99d")
+
+        for i in range(len(pal)):
+            assert result[i][i] == 0.0
+            for j in range(len(pal)):
+                assert result[i][j] == result[j][i]
+
+    def test_invalid_arguments(self):
+        """Test that invalid arguments raise errors."""
+        pal = Palette(self.COLORS)
+
+        with pytest.raises(ValueError, match="cvd_type must be one of"):
+            pal.cvd_distance_matrix({"invalid": 1.0})
+        with pytest.raises(ValueError, match="severity must be in range"):
+            pal.cvd_distance_matrix({"protan": [0.5, 1.5]})
+        with pytest.raises(ValueError, match="weights"):
+            pal.cvd_distance_matrix(weights={"protan": -1.0})
+        with pytest.raises(ValueError, match="reduction"):
+            pal.cvd_distance_matrix(reduction="max")
+        with pytest.raises(ValueError, match="positive weight"):
+            pal.cvd_distance_matrix({}, weights={"normal": 0})
+
+    def test_invalid_conditions_native(self):
+        """Test that the native code rejects invalid conditions by itself."""
+        data = Palette(self.COLORS)._data
+
+        with pytest.raises(ValueError, match="Unknown CVD type"):
+            data.cvd_distance_matrix("ciede2000", [("green", 1.0, 1.0)], 1.0, "min")
+        with pytest.raises(ValueError, match="Severity"):
+            data.cvd_distance_matrix("ciede2000", [("protan", 2.0, 1.0)], 1.0, "min")
@@ -0,0 +1,129 @@
+"""Tests for batched palette scoring."""
+
+from __future__ import annotations
+
+import math
+import random
+from array import array
+
+import _qualpal
+import pytest
+
+from qualpal import Color, Palette
+from qualpal.scoring import pack_palettes, score_palettes
+
+
+@pytest.fixture
+def palettes() -> list[Palette]:
+    rng = random.Random(42)
+    out = []
+    for size in [0, 1, 2, 3, 5, 8]:
+        out.append(
+            Palette(
+                [
+                    "#" + "".join(f"{rng.randrange(0, 256, 51):02x}" for _ in range(3))
+                    for _ in range(size)
+                ]
+            )
+        )
+    out.append(Palette(["#ff0000", "#00ff00", "#ff0000"]))
+    return out
+
+
+class TestPackPalettes:
+    def test_layout(self, palettes: list[Palette]):
+        """Offsets delimit each palette's colors in the packed RGB bytes."""
+        offsets, rgb = pack_palettes(palettes)
+        assert len(offsets) == len(palettes) + 1
+        assert offsets[-1] * 3 == len(rgb)
+        for p, pal in enumerate(palettes):
+            start, stop = offsets[p], offsets[p + 1]
+            chunk = rgb[start * 3 : stop * 3]
+            assert ["#" + chunk[i : i + 3].hex() for i in range(0, len(chunk), 3)] == (
+                pal.hex()
+            )
+
+
+class TestScorePalettes:
+    def test_min_distance(self, palettes: list[Palette]):
+        """Minimum distances match per-palette computation."""
+        scores = score_palettes(*pack_palettes(palettes), metric="din99d")
+        values = scores["min_distance"].tolist()
+        assert len(values) == len(palettes)
+        for pal, value in zip(palettes, values):
+            if len(pal) < 2:
+                assert math.isinf(value)
+            elif len(set(pal.hex())) < len(pal):
+                assert value == 0.0
+            else:
+                assert value == pytest.approx(pal.min_distance(metric="din99d"))
+
+    def test_background_distance(self, palettes: list[Palette]):
+        """Background distances match Color.distance."""
+        scores = score_palettes(*pack_palettes(palettes), background="#ffffff")
+        values = scores["background_distance"].tolist()
+        bg = Color("#ffffff")
+        for pal, value in zip(palettes, values):
+            if len(pal) == 0:
+                assert math.isinf(value)
+            else:
+                expected = min(c.distance(bg) for c in pal)
+                assert value == pytest.approx(expected)
+
+    def test_cvd_min_distance(self, palettes: list[Palette]):
+        """CVD scores are the worst minimum distance over all conditions."""
+        cvd = {"protan": 1.0, "tritan": 0.5}
+        scores = score_palettes(*pack_palettes(palettes), cvd=cvd)
+        values = scores["cvd_min_distance"].tolist()
+        for pal, value in zip(palettes, values):
+            if len(set(pal.hex())) < 2 or len(set(pal.hex())) < len(pal):
+                continue
+            expected = min(
+                min(pal.simulate_cvd(t, s).min_distances()) for t, s in cvd.items()
+            )
+            assert value == pytest.approx(expected)
+
+    def test_optional_scores_absent(self, palettes: list[Palette]):
+        """Only requested scores are returned."""
+        scores = score_palettes(*pack_palettes(palettes))
+        assert set(scores) == {"min_distance"}
+
+    def test_two_dimensional_rgb(self):
+        """RGB may be given as an (n, 3) buffer."""
+        offsets = array("q", [0, 2])
+        rgb = memoryview(bytes([255, 0, 0, 0, 0, 255])).cast("B", (2, 3))
+        scores = score_palettes(offsets, rgb)
+        expected = Palette(["#ff0000", "#0000ff"]).min_distance()
+        assert scores["min_distance"].tolist()[0] == pytest.approx(expected)
+
+    @pytest.mark.parametrize(
+        "offsets",
+        [
+            array("q", []),
+            array("q", [-1, 1]),
+            array("q", [0, 2, 1]),
+            array("q", [0, 5]),
+        ],
+    )
+    def test_invalid_offsets(self, offsets: array):
+        """Inconsistent offsets are rejected."""
+        with pytest.raises(ValueError):
+            score_palettes(offsets, bytes(6))
+
+    def test_invalid_options(self):
+        """Invalid metric, background or CVD specifications are rejected."""
+        offsets, rgb = array("q", [0, 2]), bytes(6)
+        with pytest.raises(ValueError):
+            score_palettes(offsets, rgb, metric="invalid")
+        with pytest.raises(ValueError):
+            score_palettes(offsets, rgb, background="white")
+        with pytest.raises(ValueError):
+            score_palettes(offsets, rgb, cvd={"protan": 2.0})
+
+    def test_invalid_cvd_native(self):
+        """Invalid CVD conditions are rejected natively, not only in Python."""
+        offsets, rgb = array("q", [0, 2]), bytes(6)
+        with pytest.raises(ValueError, match="Unknown CVD type"):
+            _qualpal.score_palettes(offsets, rgb, "ciede2000", None, {"green": 1.0})
+        with pytest.raises(ValueError, match="Severity"):
+            _qualpal.score_palettes(offsets, rgb, "ciede2000", None, {"protan": 2.0})
@@ -2,6 +2,9 @@
 
 from __future__ import annotations
 
+import pickle
+
+import _qualpal
 import pytest
 
 from qualpal import Qualpal
@@ -107,9 +110,19 @@ class TestColorspaceValidation:
         assert qp._colorspace == colorspace
         assert qp._space == "lchab"
 
+    def test_colorspace_oklch_valid(self):
+        """Test valid OKLCh colorspace."""
+        colorspace = {"h": (0, 360), "c": (0, 0.3), "l": (0.2, 0.9)}
+        qp = Qualpal(colorspace=colorspace, space="oklch")  # type: ignore[arg-type]
+
+        assert qp._colorspace == colorspace
+        assert qp._space == "oklch"
+
     def test_colorspace_invalid_space(self):
         """Test invalid space parameter."""
-        with pytest.raises(ValueError, match="space must be 'hsl' or 'lchab'"):
+        with pytest.raises(
+            ValueError, match="space must be 'hsl', 'lchab' or 'oklch'"
+        ):
             Qualpal(
                 colorspace={"h": (0, 360), "s": (0, 1), "l": (0, 1)}, space="invalid"
             )
@@ -245,6 +258,40 @@ class TestCVDProperty:
         assert qp.cvd is None
 
 
+class TestCvdModeProperty:
+    """Test cvd_mode property and setter."""
+
+    def test_cvd_mode_default(self):
+        """Test cvd_mode defaults to 'combined'."""
+        assert Qualpal().cvd_mode == "combined"
+
+    def test_cvd_mode_init_valid(self):
+        """Test setting cvd_mode in __init__."""
+        qp = Qualpal(cvd={"protan": 1.0, "tritan": 1.0}, cvd_mode="worst_case")
+
+        assert qp.cvd_mode == "worst_case"
+
+    def test_cvd_mode_invalid(self):
+        """Test that unknown modes are rejected."""
+        qp = Qualpal()
+
+        with pytest.raises(ValueError, match="cvd_mode must be"):
+            qp.cvd_mode = "mean"
+
+    def test_invalid_cvd_native(self):
+        """Test that the native generators reject bad conditions up front."""
+        colors = ["#ff0000", "#00ff00", "#0000ff", "#ffff00"]
+        for mode in ("combined", "worst_case"):
+            with pytest.raises(ValueError, match="Unknown CVD type"):
+                _qualpal.generate_palette_unified(
+                    2, colors=colors, cvd={"green": 1.0}, cvd_mode=mode
+                )
+            with pytest.raises(ValueError, match="Severity"):
+                _qualpal.generate_palette_grouped(
+                    2, 2, colors=colors, cvd={"deutan": 2.0}, cvd_mode=mode
+                )
+
+
 class TestMetricProperty:
     """Test metric property and setter."""
 
@@ -333,6 +380,63 @@ class TestBackgroundProperty:
         assert qp.background is None
 
 
+class TestBackgroundsProperty:
+    """Test backgrounds property and setter."""
+
+    def test_backgrounds_default_none(self):
+        """Test backgrounds default is None."""
+        assert Qualpal().backgrounds is None
+
+    def test_backgrounds_init_valid(self):
+        """Test setting weighted backgrounds in __init__."""
+        backgrounds = {"#ffffff": 1.0, "#1e1e1e": 2}
+        qp = Qualpal(backgrounds=backgrounds)
+
+        assert qp.backgrounds == backgrounds
+
+    def test_backgrounds_not_dict(self):
+        """Test backgrounds must be a dict."""
+        qp = Qualpal()
+
+        with pytest.raises(TypeError, match="backgrounds must be a dict"):
+            qp.backgrounds = ["#ffffff", "#000000"]  # type: ignore[assignment]
+
+    def test_backgrounds_invalid_color(self):
+        """Test backgrounds with an invalid hex color."""
+        qp = Qualpal()
+
+        with pytest.raises(ValueError, match="Invalid hex color"):
+            qp.backgrounds = {"white": 1.0}
+
+    @pytest.mark.parametrize("weight", [0.0, -1.0, float("inf")])
+    def test_backgrounds_weight_not_positive(self, weight):
+        """Test that weights must be positive and finite."""
+        qp = Qualpal()
+
+        with pytest.raises(ValueError, match="must be positive"):
+            qp.backgrounds = {"#ffffff": weight}
+
+    def test_backgrounds_weight_not_number(self):
+        """Test that weights must be numbers."""
+        qp = Qualpal()
+
+        with pytest.raises(TypeError, match="must be a number"):
+            qp.backgrounds = {"#ffffff": "1"}  # type: ignore[dict-item]
+
+    def test_backgrounds_lower_case(self):
+        """Test that colors are stored in lower case, merging equal entries."""
+        qp = Qualpal(backgrounds={"#FFFFFF": 2.0, "#ffffff": 2.0, "#1E1e1E": 1})
+
+        assert qp.backgrounds == {"#ffffff": 2.0, "#1e1e1e": 1}
+
+    def test_backgrounds_conflicting_weights(self):
+        """Test that one color with two weights is rejected."""
+        qp = Qualpal()
+
+        with pytest.raises(ValueError, match="different weights"):
+            qp.backgrounds = {"#FFFFFF": 1.0, "#ffffff": 2.0}
+
+
 class TestMaxMemoryProperty:
     """Test max_memory property and setter."""
 
@@ -528,3 +632,45 @@ class TestComplexScenarios:
         assert qp.max_memory == 0.5
         assert qp.colorspace_size == 500
         assert qp.white_point == "d55"
+
+
+class TestSerialization:
+    """Test binary serialization and pickling of the configuration."""
+
+    def test_round_trip(self):
+        """Test that every setting is restored."""
+        qp = Qualpal(
+            colorspace={"h": (0, 180), "c": (20, 60), "l": (30, 80)},
+            space="lchab",
+            cvd={"protan": 0.5},
+            metric="din99d",
+            backgrounds={"#ffffff": 1.0, "#000000": 2.0},
+            cvd_mode="worst_case",
+            colorspace_size=500,
+        )
+        restored = Qualpal.from_bytes(qp.to_bytes())
+
+        assert restored._colorspace == qp._colorspace
+        assert restored._space == "lchab"
+        assert restored.cvd == {"protan": 0.5}
+        assert restored.metric == "din99d"
+        assert restored.backgrounds == {"#ffffff": 1.0, "#000000": 2.0}
+        assert restored.cvd_mode == "worst_case"
+        assert restored.colorspace_size == 500
+
+    def test_pickle(self):
+        """Test that a pickled generator produces the same palette."""
+        qp = Qualpal(colors=["#ff0000", "#00ff00", "#0000ff", "#ffff00"])
+        restored = pickle.loads(pickle.dumps(qp))
+
+        assert restored._colors == qp._colors
+        assert restored.generate(2) == qp.generate(2)
+
+    def test_invalid_data(self):
+        """Test that malformed data is rejected."""
+        data = Qualpal().to_bytes()
+
+        with pytest.raises(ValueError, match="serialized Qualpal"):
+            Qualpal.from_bytes(b"QPALDATA" + data[8:])
+        with pytest.raises(ValueError, match="version"):
+            Qualpal.from_bytes(data[:8] + b"\x02\x00\x00\x00" + data[12:])
@@ -0,0 +1,137 @@
+"""Tests for candidate sets in shared memory."""
+
+from __future__ import annotations
+
+import pickle
+import struct
+import sys
+from concurrent.futures import ProcessPoolExecutor
+
+import pytest
+
+pytest.importorskip("multiprocessing.shared_memory")
+
+from qualpal import Palette, Qualpal  # noqa: E402
+from qualpal.shared import SharedCandidates  # noqa: E402
+
+CANDIDATES = ["#ff0000", "#00ff00", "#0000ff", "#ffff00", "#00ffff", "#808080"]
+
+
+def _generate(shared: SharedCandidates, n: int) -> list[str]:
+    return shared.generate(n).hex()
+
+
+@pytest.fixture
+def shared():
+    """A published set of CANDIDATES with a deuteranopia view."""
+    s = SharedCandidates.publish(CANDIDATES, cvd={"deutan": 1.0})
+    yield s
+    s.close()
+    s.unlink()
+
+
+class TestSharedCandidates:
+    """Test publishing, attaching and using shared candidate sets."""
+
+    def test_publish(self, shared):
+        """Test that the set stores the candidates and their views."""
+        assert len(shared) == len(CANDIDATES)
+        assert shared.views == ["normal", "deutan"]
+        assert shared.cvd == {"deutan": 1.0}
+
+        pal = Palette(CANDIDATES)
+        assert shared.rgb().tolist() == pal.array().tolist()
+        for got, expected in zip(shared.lab().tolist(), pal.array("lab").tolist()):
+            assert got == pytest.approx(expected)
+        deutan = pal.simulate_cvd("deutan", 1.0).array("lab").tolist()
+        for got, expected in zip(shared.lab("deutan").tolist(), deutan):
+            assert got == pytest.approx(expected)
+
+    def test_attach_reads_in_place(self, shared):
+        """Test that an attached set sees the published values."""
+        with SharedCandidates.attach(shared.name) as other:
+            assert other.views == shared.views
+            assert other.lab("deutan").tolist() == shared.lab("deutan").tolist()
+
+    def test_generate_matches_qualpal(self, shared):
+        """Test that selection agrees with worst-case generation."""
+        expected = Qualpal(
+            colors=CANDIDATES, cvd={"deutan": 1.0}, cvd_mode="worst_case"
+        ).generate(3)
+        assert shared.generate(3).hex() == expected.hex()
+
+    def test_distances(self, shared):
+        """Test distances from a color to every candidate."""
+        dists = shared.distances("#ff0000").tolist()
+        assert dists[0] == pytest.approx(0.0)
+        assert dists == pytest.approx(
+            Palette(CANDIDATES).distance_matrix()[0], abs=1e-9
+        )
+
+    def test_publish_from_qualpal(self):
+        """Test that a generator's candidates and cvd are published."""
+        qp = Qualpal(colorspace_size=200, cvd={"protan": 0.5, "tritan": 0.0})
+        with SharedCandidates.publish(qp) as s:
+            s.unlink()
+            assert len(s) == 200
+            assert s.cvd == {"protan": 0.5}
+
+    def test_pickle_attaches(self, shared):
+        """Test that a pickled set refers to the same segment."""
+        with pickle.loads(pickle.dumps(shared)) as other:
+            assert other.name == shared.name
+            assert other.rgb().tolist() == shared.rgb().tolist()
+
+    def test_bytes_round_trip(self, shared):
+        """Test that a serialized set is published again unchanged."""
+        data = shared.to_bytes()
+        with SharedCandidates.from_bytes(data) as copy:
+            copy.unlink()
+            assert copy.to_bytes() == data
+            assert copy.views == shared.views
+
+    @pytest.mark.skipif(
+        sys.platform in {"emscripten", "ios", "android"},
+        reason="Worker processes cannot be started",
+    )
+    def test_process_pool(self, shared):
+        """Test that worker processes select from the shared set."""
+        with ProcessPoolExecutor(max_workers=2) as pool:
+            results = list(pool.map(_generate, [shared] * 2, [2, 3]))
+        assert results == [shared.generate(2).hex(), shared.generate(3).hex()]
+
+    def test_errors(self, shared):
+        """Test that invalid arguments are rejected."""
+        with pytest.raises(ValueError, match="view"):
+            shared.lab("tritan")
+        with pytest.raises(ValueError, match="positive"):
+            shared.generate(0)
+        with pytest.raises(ValueError, match="cvd"):
+            SharedCandidates.publish(CANDIDATES, cvd={"green": 1.0})
+        with pytest.raises(FileNotFoundError):
+            SharedCandidates.attach("qualpal-missing-segment")
+
+    def test_invalid_views(self, shared):
+        """Test that sets with views no writer produces are not attached."""
+        data = shared.to_bytes()
+        # The deutan view follows the 64-byte header and the normal view
+        name, severity = 64 + 24, 64 + 24 + 16
+        for offset, value, match in [
+            (name, b"green\0", "Unknown CVD type"),
+            (name, b"normal", "Unknown CVD type"),
+            (severity, struct.pack("=d", 2.0), "Severity"),
+            (severity, struct.pack("=d", 0.0), "invalid view"),
+            (64, b"deutan", "normal"),
+        ]:
+            corrupt = bytearray(data)
+            corrupt[offset : offset + len(value)] = value
+            with pytest.raises(ValueError, match=match):
+                SharedCandidates.from_bytes(corrupt)
+
+    def test_oversized_header(self, shared):
+        """Test that sizes that overflow are rejected, not wrapped around."""
+        corrupt = bytearray(shared.to_bytes())
+        corrupt[16:24] = struct.pack("=Q", 2**62)
+        with pytest.raises(ValueError, match="too large|truncated"):
+            SharedCandidates.from_bytes(corrupt)
+